@@ -1,6 +1,5 @@
 #pragma once
 
-#include <utility>
 #include <Typedefs.hpp>
 #include <Components.hpp>
 
@@ -12,9 +11,11 @@
 /**
  * This macro is used in helpers to load a component either from cache or an entity system.
  * Note that this requires a variable "cache" of type *Cache where * is equal to the name of the component
- * (as seen above).
+ * (as seen above). Cache hits are reported to the entity system as accesses, so that they're
+ * tracked as changes by incremental saves. Cached pointers are used only while the generation
+ * of the entity system's component containers stays the same (see EntitySystem::get_generation).
  */
-#define GET_COMPONENT(ID, ENTS, COMP, TYPE) if(cache.first == ID) COMP = cache.second; else { COMP = ENTS.get_component<TYPE>(ID); cache.first = ID; cache.second = COMP; }
+#define GET_COMPONENT(ID, ENTS, COMP, TYPE) if(cache.first == ID && cache.generation == ENTS.get_generation()) { COMP = cache.second; if(COMP) ENTS.track_access<TYPE>(ID); } else { COMP = ENTS.get_component<TYPE>(ID); cache.first = ID; cache.second = COMP; cache.generation = ENTS.get_generation(); }
 #else
 /**
  * This macro has the exact same functionality as the old component loading and is used
@@ -27,46 +28,57 @@ namespace tdt
 {
 	namespace cache
 	{
-		using ActivationCache      = std::pair<tdt::uint, ActivationComponent*>;
-		using AICache              = std::pair<tdt::uint, AIComponent*>;
-		using AlignCache           = std::pair<tdt::uint, AlignComponent*>;
-		using AnimationCache       = std::pair<tdt::uint, AnimationComponent*>;
-		using CombatCache          = std::pair<tdt::uint, CombatComponent*>;
-		using CommandCache         = std::pair<tdt::uint, CommandComponent*>;
-		using ConstructorCache     = std::pair<tdt::uint, ConstructorComponent*>;
-		using CounterCache         = std::pair<tdt::uint, CounterComponent*>;
-		using DestructorCache      = std::pair<tdt::uint, DestructorComponent*>;
-		using EventHandlerCache    = std::pair<tdt::uint, EventHandlerComponent*>;
-		using EventCache           = std::pair<tdt::uint, EventComponent*>;
-		using ExperienceValueCache = std::pair<tdt::uint, ExperienceValueComponent*>;
-		using ExplosionCache       = std::pair<tdt::uint, ExplosionComponent*>;
-		using FactionCache         = std::pair<tdt::uint, FactionComponent*>;
-		using GoldCache            = std::pair<tdt::uint, GoldComponent*>;
-		using GraphicsCache        = std::pair<tdt::uint, GraphicsComponent*>;
-		using GridNodeCache        = std::pair<tdt::uint, GridNodeComponent*>;
-		using HealthCache          = std::pair<tdt::uint, HealthComponent*>;
-		using HomingCache          = std::pair<tdt::uint, HomingComponent*>;
-		using InputCache           = std::pair<tdt::uint, InputComponent*>;
-		using LightCache           = std::pair<tdt::uint, LightComponent*>;
-		using LimitedLifeSpanCache = std::pair<tdt::uint, LimitedLifeSpanComponent*>;
-		using ManaCrystalCache     = std::pair<tdt::uint, ManaCrystalComponent*>;
-		using ManaCache            = std::pair<tdt::uint, ManaComponent*>;
-		using MovementCache        = std::pair<tdt::uint, MovementComponent*>;
-		using NameCache            = std::pair<tdt::uint, NameComponent*>;
-		using NotificationCache    = std::pair<tdt::uint, NotificationComponent*>;
-		using OnHitCache           = std::pair<tdt::uint, OnHitComponent*>;
-		using PathfindingCache     = std::pair<tdt::uint, PathfindingComponent*>;
-		using PhysicsCache         = std::pair<tdt::uint, PhysicsComponent*>;
-		using PriceCache           = std::pair<tdt::uint, PriceComponent*>;
-		using ProductCache         = std::pair<tdt::uint, ProductComponent*>;
-		using ProductionCache      = std::pair<tdt::uint, ProductionComponent*>;
-		using SelectionCache       = std::pair<tdt::uint, SelectionComponent*>;
-		using SpellCache           = std::pair<tdt::uint, SpellComponent*>;
-		using StructureCache       = std::pair<tdt::uint, StructureComponent*>;
-		using TaskHandlerCache     = std::pair<tdt::uint, TaskHandlerComponent*>;
-		using TaskCache            = std::pair<tdt::uint, TaskComponent*>;
-		using TimeCache            = std::pair<tdt::uint, TimeComponent*>;
-		using TriggerCache         = std::pair<tdt::uint, TriggerComponent*>;
-		using UpgradeCache         = std::pair<tdt::uint, UpgradeComponent*>;
+		/**
+		 * Last loaded component of a helper, the ID of it's entity and the generation
+		 * of the component containers it was loaded in.
+		 */
+		template<typename COMP>
+		struct Cache
+		{
+			tdt::uint first;
+			COMP* second;
+			tdt::uint generation;
+		};
+
+		using ActivationCache      = Cache<ActivationComponent>;
+		using AICache              = Cache<AIComponent>;
+		using AlignCache           = Cache<AlignComponent>;
+		using AnimationCache       = Cache<AnimationComponent>;
+		using CombatCache          = Cache<CombatComponent>;
+		using CommandCache         = Cache<CommandComponent>;
+		using ConstructorCache     = Cache<ConstructorComponent>;
+		using CounterCache         = Cache<CounterComponent>;
+		using DestructorCache      = Cache<DestructorComponent>;
+		using EventHandlerCache    = Cache<EventHandlerComponent>;
+		using EventCache           = Cache<EventComponent>;
+		using ExperienceValueCache = Cache<ExperienceValueComponent>;
+		using ExplosionCache       = Cache<ExplosionComponent>;
+		using FactionCache         = Cache<FactionComponent>;
+		using GoldCache            = Cache<GoldComponent>;
+		using GraphicsCache        = Cache<GraphicsComponent>;
+		using GridNodeCache        = Cache<GridNodeComponent>;
+		using HealthCache          = Cache<HealthComponent>;
+		using HomingCache          = Cache<HomingComponent>;
+		using InputCache           = Cache<InputComponent>;
+		using LightCache           = Cache<LightComponent>;
+		using LimitedLifeSpanCache = Cache<LimitedLifeSpanComponent>;
+		using ManaCrystalCache     = Cache<ManaCrystalComponent>;
+		using ManaCache            = Cache<ManaComponent>;
+		using MovementCache        = Cache<MovementComponent>;
+		using NameCache            = Cache<NameComponent>;
+		using NotificationCache    = Cache<NotificationComponent>;
+		using OnHitCache           = Cache<OnHitComponent>;
+		using PathfindingCache     = Cache<PathfindingComponent>;
+		using PhysicsCache         = Cache<PhysicsComponent>;
+		using PriceCache           = Cache<PriceComponent>;
+		using ProductCache         = Cache<ProductComponent>;
+		using ProductionCache      = Cache<ProductionComponent>;
+		using SelectionCache       = Cache<SelectionComponent>;
+		using SpellCache           = Cache<SpellComponent>;
+		using StructureCache       = Cache<StructureComponent>;
+		using TaskHandlerCache     = Cache<TaskHandlerComponent>;
+		using TimeCache            = Cache<TimeComponent>;
+		using TriggerCache         = Cache<TriggerComponent>;
+		using UpgradeCache         = Cache<UpgradeComponent>;
 	}
 }
@@ -11,6 +11,7 @@
 #include <map>
 #include <Enums.hpp>
 #include <Typedefs.hpp>
+#include <tools/Symbol.hpp>
 
 struct Component
 {
@@ -26,6 +27,9 @@ struct Component
  * \note As constructors are called in the EntitySystem::load_component function, strings will be read
  *       from Lua and immediately discarded. Hence it was decided to make the string parameters
  *       accepted as rvalues for faster construction.
+ * \note Names of Lua tables (blueprints, handlers, entity names) are stored as symbols (interned strings),
+ *       so that copying components does not copy strings and calling a blueprint's function
+ *       does not concatenate them (see Symbol::get_function).
  */
 
 /**
@@ -92,7 +96,7 @@ struct AIComponent
 	AIComponent& operator=(AIComponent&&) = default;
 	~AIComponent() = default;
 
-	std::string blueprint;
+	Symbol blueprint;
 	ENTITY_STATE::VAL state;
 };
 
@@ -174,7 +178,7 @@ struct CombatComponent
 	tdt::real range;
 	ATTACK_TYPE atk_type;
 	bool pursue;
-	std::string projectile_blueprint;
+	Symbol projectile_blueprint;
 };
 
 /**
@@ -219,7 +223,7 @@ struct InputComponent
 	InputComponent& operator=(InputComponent&&) = default;
 	~InputComponent() = default;
 
-	std::string input_handler;
+	Symbol input_handler;
 };
 
 /**
@@ -283,7 +287,7 @@ struct SpellComponent
 	SpellComponent& operator=(SpellComponent&&) = default;
 	~SpellComponent() = default;
 
-	std::string blueprint;
+	Symbol blueprint;
 	tdt::real cd_time;
 	tdt::real cooldown;
 };
@@ -306,7 +310,7 @@ struct ProductionComponent
 	ProductionComponent& operator=(ProductionComponent&&) = default;
 	~ProductionComponent() = default;
 
-	std::string product_blueprint;
+	Symbol product_blueprint;
 	tdt::uint curr_produced;
 	tdt::uint max_produced;
 	tdt::real cooldown;
@@ -381,7 +385,7 @@ struct PathfindingComponent
 	
 	tdt::uint target_id, last_id;
 	std::deque<tdt::uint> path_queue;
-	std::string blueprint; // Name of the table the get_cost(id1, id2) function is in.
+	Symbol blueprint; // Name of the table the get_cost(id1, id2) function is in.
 };
 
 /**
@@ -419,7 +423,8 @@ struct TaskHandlerComponent
 
 	TaskHandlerComponent(std::string&& b = "ERROR")
 		: curr_task{Component::NO_ENTITY}, possible_tasks{}, task_queue{},
-		  busy{false}, blueprint{std::move(b)}
+		  busy{false}, blueprint{std::move(b)}, wait_condition{TASK_WAIT::NONE},
+		  wait_time{0.f}
 	{  /* DUMMY BODY */ }
 	TaskHandlerComponent(const TaskHandlerComponent&) = default;
 	TaskHandlerComponent(TaskHandlerComponent&&) = default;
@@ -431,7 +436,15 @@ struct TaskHandlerComponent
 	std::bitset<(tdt::uint)TASK_TYPE::COUNT> possible_tasks;
 	std::deque<tdt::uint> task_queue;
 	bool busy;
-	std::string blueprint;
+	Symbol blueprint;
+
+	/**
+	 * Condition the current task is waiting on, the task_complete
+	 * function of the blueprint is called only once it's met
+	 * (TASK_WAIT::NONE means it's called on every frame).
+	 */
+	TASK_WAIT wait_condition;
+	tdt::real wait_time;
 };
 
 /**
@@ -498,7 +511,7 @@ struct EventHandlerComponent
 	EventHandlerComponent& operator=(EventHandlerComponent&&) = default;
 	~EventHandlerComponent() = default;
 
-	std::string handler;
+	Symbol handler;
 	std::bitset<(tdt::uint)EVENT_TYPE::COUNT> possible_events;
 };
 
@@ -519,7 +532,7 @@ struct DestructorComponent
 	DestructorComponent& operator=(DestructorComponent&&) = default;
 	~DestructorComponent() = default;
 
-	std::string blueprint;
+	Symbol blueprint;
 };
 
 /**
@@ -658,7 +671,7 @@ struct OnHitComponent
 	OnHitComponent& operator=(OnHitComponent&&) = default;
 	~OnHitComponent() = default;
 
-	std::string blueprint;
+	Symbol blueprint;
 	tdt::real curr_time;
 	tdt::real cooldown;
 };
@@ -680,7 +693,7 @@ struct ConstructorComponent
 	ConstructorComponent& operator=(ConstructorComponent&&) = default;
 	~ConstructorComponent() = default;
 
-	std::string blueprint;
+	Symbol blueprint;
 };
 
 /**
@@ -701,7 +714,7 @@ struct TriggerComponent
 	TriggerComponent& operator=(TriggerComponent&&) = default;
 	~TriggerComponent() = default;
 
-	std::string blueprint;
+	Symbol blueprint;
 	tdt::uint linked_entity;
 	tdt::real curr_time;
 	tdt::real cooldown;
@@ -725,7 +738,7 @@ struct UpgradeComponent
 	UpgradeComponent& operator=(UpgradeComponent&&) = default;
 	~UpgradeComponent() = default;
 
-	std::string blueprint;
+	Symbol blueprint;
 	tdt::uint experience;
 	tdt::uint exp_needed;
 	tdt::uint level;
@@ -814,7 +827,7 @@ struct NameComponent
 	NameComponent& operator=(NameComponent&&) = default;
 	~NameComponent() = default;
 
-	std::string name;
+	Symbol name;
 };
 
 /**
@@ -942,7 +955,7 @@ struct SelectionComponent
 	SelectionComponent& operator=(SelectionComponent&&) = default;
 	~SelectionComponent() = default;
 
-	std::string blueprint;
+	Symbol blueprint;
 	std::string material;
 	Ogre::Vector3 scale;
 	Ogre::Entity* entity;
@@ -979,6 +992,6 @@ struct ActivationComponent
 	ActivationComponent& operator=(ActivationComponent&&) = default;
 	~ActivationComponent() = default;
 
-	std::string blueprint;
+	Symbol blueprint;
 	bool activated;
 };
\ No newline at end of file
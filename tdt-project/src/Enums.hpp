@@ -38,6 +38,18 @@ enum class TASK_TYPE
 	COUNT
 };
 
+enum class TASK_WAIT
+{
+	NONE = 0, PATH, TARGET, COMBAT_TARGET, IN_RANGE, TIME,
+	COUNT
+};
+
+enum class PATH_HEURISTIC
+{
+	NONE = 0, MANHATTAN, PORTAL,
+	COUNT
+};
+
 enum class ATTACK_TYPE
 {
 	NONE = 0, MELEE, RANGED,
@@ -89,6 +101,11 @@ namespace KEY_BIND_ACTION
 	};
 }
 
+enum class JOURNAL_COMMAND
+{
+	PLACE = 0, CAST, COMMAND, RESEARCH, LUA
+};
+
 enum class WAVE_STATE
 {
 	ACTIVE = 0, WAITING, INACTIVE
@@ -106,4 +123,15 @@ namespace ANIMATION_TYPE
 enum class SELECTION_MARKER_TYPE
 {
 	CIRCLE = 0, SQUARE, HALF_SQUARE
+};
+
+enum class FIELD_TYPE
+{
+	BOOL = 0, UINT, INT, REAL, SYMBOL
+};
+
+enum class TARGET_QUERY
+{
+	ENEMY_ENTITY = 0, FRIENDLY_ENTITY, ENEMY_STRUCTURE, FRIENDLY_STRUCTURE,
+	GOLD_DEPOSIT, GOLD_VAULT, FREE_GOLD_VAULT
 };
\ No newline at end of file
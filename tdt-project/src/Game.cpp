@@ -1,3 +1,4 @@
+#include <CEGUI/RendererModules/Null/Renderer.h>
 #include <lppscript/LppScript.hpp>
 #include <systems/EntitySystem.hpp>
 #include <systems/HealthSystem.hpp>
@@ -23,13 +24,19 @@
 #include <tools/SelectionBox.hpp>
 #include <tools/EntityPlacer.hpp>
 #include <tools/GameSerializer.hpp>
+#include <tools/QuickSaveRing.hpp>
+#include <tools/Journal.hpp>
+#include <tools/Profiler.hpp>
+#include <tools/PathService.hpp>
+#include <tools/SystemScheduler.hpp>
+#include <tools/Util.hpp>
 #include <tools/deferred_shading/DeferredShading.h>
 #include <gui/GUI.hpp>
 #include <gui/EntityCreator.hpp>
 #include "Game.hpp"
 #include "LuaInterface.hpp"
 
-Game::Game() // TODO: Init systems.
+Game::Game(bool headless) // TODO: Init systems.
 	: state_{GAME_STATE::INTRO_MENU}, root_{}, window_{},
 	  scene_mgr_{}, main_cam_{}, main_light_{},
 	  main_view_{}, input_{}, keyboard_{}, mouse_{},
@@ -38,23 +45,26 @@ Game::Game() // TODO: Init systems.
 	  mouse_position_{}, level_generator_{}, spell_caster_{},
 	  throne_id_{Component::NO_ENTITY}, ds_system_{}
 {
+	util::set_headless(headless);
 	main_cam_.reset(new Camera{});
 	ogre_init();
-	ois_init();
+	if(!headless)
+		ois_init();
 	cegui_init();
-	windowResized(window_); // Will adjust dimensions for OIS mouse.
+	if(!headless)
+		windowResized(window_); // Will adjust dimensions for OIS mouse.
 
 	entity_system_.reset(new EntitySystem{*scene_mgr_});
 	health_system_.reset(new HealthSystem{*entity_system_});
 	movement_system_.reset(new MovementSystem{*entity_system_});
-	input_system_.reset(new InputSystem{*entity_system_, *keyboard_, *(main_cam_->camera_)});
+	input_system_.reset(new InputSystem{*entity_system_, keyboard_, *(main_cam_->camera_)});
 	grid_system_.reset(new GridSystem{*entity_system_, *scene_mgr_});
 	combat_system_.reset(new CombatSystem{*entity_system_, *scene_mgr_, *grid_system_});
 	event_system_.reset(new EventSystem{*entity_system_});
 	task_system_.reset(new TaskSystem{*entity_system_, *grid_system_, *combat_system_});
 	production_system_.reset(new ProductionSystem{*entity_system_});
 	time_system_.reset(new TimeSystem{*entity_system_});
-	ai_system_.reset(new AISystem{*entity_system_});
+	ai_system_.reset(new AISystem{*entity_system_, *combat_system_, *this});
 	graphics_system_.reset(new GraphicsSystem{*entity_system_});
 	trigger_system_.reset(new TriggerSystem{*entity_system_});
 	mana_spell_system_.reset(new ManaSpellSystem{*entity_system_});
@@ -77,6 +87,7 @@ Game::Game() // TODO: Init systems.
 	systems_.emplace_back(mana_spell_system_.get());
 	systems_.emplace_back(wave_system_.get());
 	systems_.emplace_back(animation_system_.get());
+	scheduler_.reset(new SystemScheduler{systems_});
 
 	selection_box_.reset(new SelectionBox{"MainSelectionBox", *entity_system_,
 						                  *scene_mgr_->createPlaneBoundedVolumeQuery(Ogre::PlaneBoundedVolumeList{}),
@@ -84,12 +95,14 @@ Game::Game() // TODO: Init systems.
 	placer_.reset(new EntityPlacer{*entity_system_, *grid_system_, *scene_mgr_});
 	entity_creator_.reset(new EntityCreator{*placer_, *entity_system_});
 	game_serializer_.reset(new GameSerializer{*entity_system_});
+	quick_save_ring_.reset(new QuickSaveRing{*entity_system_});
 
 	level_generator_.reset(new level_generators::DEFAULT_LEVEL_GENERATOR(*entity_system_, 10));
 
 	auto& gui = GUI::instance();
 	gui.init(this);
 	LuaInterface::init(this);
+	lpp::Script::instance().get_gc().set_manual(true); // Stepped at the end of every frame.
 	entity_creator_->init(gui.get_window("ENTITY_MANAGER"));
 	gui.get_research().init(gui.get_window("RESEARCH"));
 	Player::instance().init(entity_system_.get());
@@ -98,46 +111,84 @@ Game::Game() // TODO: Init systems.
 	Player::instance().set_initial_unlocks(gui.get_spell_casting().get_spells(),
 										   gui.get_builder().get_buildings());
 
-	// Wave system has it's countdown label directly wired to the GUI.
-	wave_system_->set_countdown_window(GUI::instance().get_window("NEXT_WAVE/NEXT_LABEL"));
+	// Wave system has it's countdown label directly wired to the GUI (left unwired when headless).
+	if(!headless)
+		wave_system_->set_countdown_window(GUI::instance().get_window("NEXT_WAVE/NEXT_LABEL"));
 
 	create_empty_level(16, 16); // In case initial load fails.
 	main_cam_->look_at(Grid::instance().get_center_position(*entity_system_));
 
-	ds_system_.reset(new DeferredShadingSystem{main_view_, scene_mgr_, main_cam_->camera_});
+	if(!headless)
+	{
+		ds_system_.reset(new DeferredShadingSystem{main_view_, scene_mgr_, main_cam_->camera_});
 #if DEFERRED_SHADING_ALLOWED == 1
-	ds_system_->initialize();
+		ds_system_->initialize();
 #endif
+	}
 }
 
 Game::~Game()
 {
-	Ogre::WindowEventUtilities::removeWindowEventListener(window_, this);
-	windowClosed(window_);
+	PathService::instance().shutdown();
+	if(window_)
+	{
+		Ogre::WindowEventUtilities::removeWindowEventListener(window_, this);
+		windowClosed(window_);
+	}
 }
 
 void Game::run()
 {
+	if(util::is_headless())
+	{
+		run_headless();
+		return;
+	}
+
 	scene_mgr_->setAmbientLight(Ogre::ColourValue{.8f, .8f, .8f});
 
-	game_serializer_->load_game(*this, "intro_dummy_level");
+	// A journal replayed from the command line already started it's game.
+	if(!Journal::instance().is_deterministic())
+		game_serializer_->load_game(*this, "intro_dummy_level");
 	root_->startRendering();
 }
 
 void Game::update(tdt::real delta)
 {
-	GUI::instance().get_top_bar().update_time(delta);
-	CEGUI::System::getSingleton().injectTimePulse((float)delta);
+	Profiler::instance().next_frame();
+	PROFILE_ZONE("Game::update");
+	auto& gc = lpp::Script::instance().get_gc();
+	gc.start_frame();
+
+	if(!util::is_headless())
+	{
+		GUI::instance().get_top_bar().update_time(delta);
+		CEGUI::System::getSingleton().injectTimePulse((float)delta);
 
-	if(GUI::instance().get_console().is_visible())
-		GUI::instance().get_console().update_fps(delta, window_->getLastFPS());
+		if(GUI::instance().get_console().is_visible())
+			GUI::instance().get_console().update_fps(delta, window_->getLastFPS());
+		if(GUI::instance().get_profiler().is_visible())
+			GUI::instance().get_profiler().update(delta);
+	}
 
 	if(state_ == GAME_STATE::RUNNING || state_ == GAME_STATE::INTRO_MENU)
 	{
-		for(auto& sys : systems_)
-			sys->update(delta);
+		auto& journal = Journal::instance();
+		if(journal.is_deterministic())
+			journal.update(*this, delta);
+		else
+			scheduler_->update(delta);
 	}
 
+	if(state_ == GAME_STATE::RUNNING)
+		game_serializer_->update(*this, delta);
+
+	// Garbage from this frame's Lua calls is collected in what is left of the frame.
+	gc.update();
+
+	if(util::is_headless())
+		return; // Nothing to look at.
+
 	// Camera movement caused by mouse.
 	if(!main_cam_->get_free_mode())
 	{
@@ -195,6 +246,8 @@ void Game::new_game(tdt::uint width, tdt::uint height)
 
 void Game::create_empty_level(tdt::uint width, tdt::uint height)
 {
+	if(quick_save_ring_) // Saved states belong to the old level.
+		quick_save_ring_->clear();
 	entity_system_->delete_entities();
 	entity_system_->cleanup();
 
@@ -217,19 +270,22 @@ void Game::create_empty_level(tdt::uint width, tdt::uint height)
 
 	tdt::real actual_width{width * 100.f - 100.f}, actual_height{height * 100.f - 100.f};
 	ground_.reset(new Ogre::Plane{Ogre::Vector3::UNIT_Y, 0});
-	Ogre::MeshManager::getSingleton().createPlane(
-		"ground", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
-		*ground_, actual_width, actual_height, 20, 20, true, 1, (tdt::real)width, (tdt::real)height, Ogre::Vector3::UNIT_Z
-	);
-
-	ground_entity_ = scene_mgr_->createEntity("ground");
-	ground_node = scene_mgr_->getRootSceneNode()->createChildSceneNode();
-
-	ground_entity_->setCastShadows(false);
-	ground_node->attachObject(ground_entity_);
-	ground_node->setPosition((width * 100.f - 100.f) / 2.f, 0.f, (height * 100.f - 100.f) / 2.f);
-	ground_entity_->setMaterialName("rocky_ground");
-	ground_entity_->setQueryFlags(0);
+	if(!util::is_headless())
+	{ // The ground mesh is only visual, the plane is enough for the headless mode.
+		Ogre::MeshManager::getSingleton().createPlane(
+			"ground", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+			*ground_, actual_width, actual_height, 20, 20, true, 1, (tdt::real)width, (tdt::real)height, Ogre::Vector3::UNIT_Z
+		);
+
+		ground_entity_ = scene_mgr_->createEntity("ground");
+		ground_node = scene_mgr_->getRootSceneNode()->createChildSceneNode();
+
+		ground_entity_->setCastShadows(false);
+		ground_node->attachObject(ground_entity_);
+		ground_node->setPosition((width * 100.f - 100.f) / 2.f, 0.f, (height * 100.f - 100.f) / 2.f);
+		ground_entity_->setMaterialName("rocky_ground");
+		ground_entity_->setQueryFlags(0);
+	}
 	Grid::instance().create_graph(*entity_system_, Ogre::Vector2{0, 0}, width, height, 100.f);
 
 	// Adjust camera.
@@ -413,6 +469,10 @@ bool Game::mousePressed(const OIS::MouseEvent& event, OIS::MouseButtonID id)
 	if(gui_context.injectMouseButtonDown(ois_to_cegui(id)) || state_ == GAME_STATE::MENU)
 		return true;
 
+	// Placing and casting would desynchronize the replay.
+	if(Journal::instance().is_replaying())
+		return true;
+
 	if(id == OIS::MB_Left && !placer_->is_visible())
 	{ // Start selection.
 		auto& mouse = gui_context.getMouseCursor();
@@ -536,7 +596,8 @@ void Game::ogre_init()
 	plugs = "plugins.cfg";
 	res = "resources.cfg";
 #endif
-	root_.reset(new Ogre::Root{plugs});
+	// Render systems and scene managers are plugins, none are needed when headless.
+	root_.reset(new Ogre::Root{util::is_headless() ? "" : plugs});
 
 	Ogre::ConfigFile cf;
 	cf.load(res);
@@ -556,6 +617,13 @@ void Game::ogre_init()
 		}
 	}
 
+	if(util::is_headless())
+	{ // Resources are only read from their locations (meshes for their bounds), no window is created.
+		scene_mgr_ = root_->createSceneManager(Ogre::ST_GENERIC);
+		main_cam_->init(scene_mgr_->createCamera("MainCam"), Ogre::Vector3{300.f, 0.f, 300.f});
+		return;
+	}
+
 	if(!(root_->restoreConfig() || root_->showConfigDialog()))
 	{   // Configuration read failed, end the game.
 		throw std::exception{"[Error] Failed to create or load config file."};
@@ -611,7 +679,24 @@ void Game::ois_init()
 
 void Game::cegui_init()
 {
-	renderer_ = &CEGUI::OgreRenderer::bootstrapSystem(*window_);
+	if(util::is_headless())
+	{ // Windows are still created (so that the GUI can be used), but never rendered.
+		CEGUI::NullRenderer::bootstrapSystem();
+		auto provider = static_cast<CEGUI::DefaultResourceProvider*>(
+			CEGUI::System::getSingleton().getResourceProvider()
+		);
+
+		// Without the Ogre renderer, CEGUI cannot use Ogre's resource groups.
+		auto& resources = Ogre::ResourceGroupManager::getSingleton();
+		for(const auto& group : {"Imagesets", "Fonts", "Schemes", "LookNFeel", "Layouts"})
+		{
+			auto& locations = resources.getResourceLocationList(group);
+			if(!locations.empty())
+				provider->setResourceGroupDirectory(group, locations.front()->archive->getName() + "/");
+		}
+	}
+	else
+		renderer_ = &CEGUI::OgreRenderer::bootstrapSystem(*window_);
 	CEGUI::ImageManager::setImagesetDefaultResourceGroup("Imagesets");
 	CEGUI::Font::setDefaultResourceGroup("Fonts");
 	CEGUI::Scheme::setDefaultResourceGroup("Schemes");
@@ -633,6 +718,14 @@ void Game::cegui_init()
 	CEGUI::System::getSingleton().getDefaultGUIContext().setRootWindow(sheet);
 }
 
+void Game::run_headless()
+{
+	auto& journal = Journal::instance();
+	bool replay{journal.is_replaying()};
+	while(state_ != GAME_STATE::ENDED && (!replay || journal.is_replaying()))
+		update(journal.get_step());
+}
+
 CEGUI::MouseButton Game::ois_to_cegui(OIS::MouseButtonID id)
 {
 	switch(id)
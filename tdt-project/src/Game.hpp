@@ -30,10 +30,12 @@ class TriggerSystem;
 class ManaSpellSystem;
 class WaveSystem;
 class AnimationSystem;
+class SystemScheduler;
 class Camera;
 class Spellcaster;
 class SelectionBox;
 class GameSerializer;
+class QuickSaveRing;
 class EntityPlacer;
 class EntityCreator;
 class LevelGenerator;
@@ -43,6 +45,9 @@ class Game : public Ogre::FrameListener, public OIS::KeyListener,
 			 public OIS::MouseListener, public Ogre::WindowEventListener
 {
 	friend class GameSerializer;
+	friend class QuickSaveRing;
+	friend class Journal;
+	friend class Benchmark;
 	friend class LuaInterface;
 	friend class GUI;
 	friend class NewGameDialog;
@@ -52,8 +57,10 @@ class Game : public Ogre::FrameListener, public OIS::KeyListener,
 	public:
 		/**
 		 * Constructor.
+		 * \param If true, the game runs headless: without a window, input devices and
+		 *        rendering (see util::set_headless).
 		 */
-		Game();
+		Game(bool = false);
 
 		/**
 		 * Destructor.
@@ -62,6 +69,8 @@ class Game : public Ogre::FrameListener, public OIS::KeyListener,
 
 		/**
 		 * \brief Starts the game.
+		 * \note In the headless mode, the simulation runs as fast as possible until the game
+		 *       ends or, if a journal is being replayed at the start, until the replay ends.
 		 */
 		void run();
 
@@ -171,6 +180,12 @@ class Game : public Ogre::FrameListener, public OIS::KeyListener,
 		void ois_init();
 		void cegui_init();
 
+		/**
+		 * \brief Main loop of the headless mode, updates the game in steps of the journal's
+		 *        step length without rendering.
+		 */
+		void run_headless();
+
 		/**
 		 * Current game state.
 		 */
@@ -221,11 +236,21 @@ class Game : public Ogre::FrameListener, public OIS::KeyListener,
 		 */
 		std::unique_ptr<GameSerializer> game_serializer_{nullptr};
 
+		/**
+		 * Keeps the last few quick saves in memory.
+		 */
+		std::unique_ptr<QuickSaveRing> quick_save_ring_{nullptr};
+
 		/**
 		 * Vector of all systems used for updating the game's logic.
 		 */
 		std::vector<System*> systems_{};
 
+		/**
+		 * Updates the systems and measures their update times.
+		 */
+		std::unique_ptr<SystemScheduler> scheduler_{nullptr};
+
 		/**
 		 * CEGUI renderer.
 		 */
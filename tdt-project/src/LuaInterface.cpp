@@ -1,7 +1,10 @@
+#include <iomanip>
+#include <sstream>
 #include <tools/Player.hpp>
 #include <tools/Pathfinding.hpp>
 #include <tools/PathfindingAlgorithms.hpp>
 #include <tools/GameSerializer.hpp>
+#include <tools/QuickSaveRing.hpp>
 #include <tools/Grid.hpp>
 #include <tools/Spellcaster.hpp>
 #include <tools/SelectionBox.hpp>
@@ -25,6 +28,11 @@
 #include <systems/GridSystem.hpp>
 #include <gui/GUI.hpp>
 #include <gui/EntityCreator.hpp>
+#include <tools/Journal.hpp>
+#include <tools/Benchmark.hpp>
+#include <tools/Profiler.hpp>
+#include <tools/ComponentProxy.hpp>
+#include <tools/NativeAI.hpp>
 #include "Game.hpp"
 #include "LuaInterface.hpp"
 
@@ -34,6 +42,24 @@
 #define GET_BOOL(state, position) (lua_toboolean(state, position) == 1)
 #define GET_STR(state, position)  (luaL_checkstring(state, position))
 
+namespace
+{
+	/**
+	 * \brief Returns a component of an entity (nullptr if it does not have it) without
+	 *        tracking the access, used by the read-only API of the worker states.
+	 * \param Entity system containing the entity.
+	 * \param ID of the entity.
+	 */
+	template<typename COMP>
+	const COMP* peek_component(EntitySystem& ents, tdt::uint id)
+	{
+		const auto& container = ents.get_component_container<COMP>();
+		auto it = container.find(id);
+
+		return it != container.end() ? &it->second : nullptr;
+	}
+}
+
 /**
  * Static member initialization, will be set in the
  * init method.
@@ -65,6 +91,21 @@ void LuaInterface::init(Game* game)
 		{"reload_all", LuaInterface::lua_reload_all},
 		{"save_game", LuaInterface::lua_save_game},
 		{"load_game", LuaInterface::lua_load_game},
+		{"export_game", LuaInterface::lua_export_game},
+		{"autosave", LuaInterface::lua_autosave},
+		{"set_autosave_interval", LuaInterface::lua_set_autosave_interval},
+		{"get_autosave_interval", LuaInterface::lua_get_autosave_interval},
+		{"set_autosave_slots", LuaInterface::lua_set_autosave_slots},
+		{"get_autosave_slots", LuaInterface::lua_get_autosave_slots},
+		{"set_incremental_autosaves", LuaInterface::lua_set_incremental_autosaves},
+		{"get_incremental_autosaves", LuaInterface::lua_get_incremental_autosaves},
+		{"set_autosave_chain_length", LuaInterface::lua_set_autosave_chain_length},
+		{"get_autosave_chain_length", LuaInterface::lua_get_autosave_chain_length},
+		{"quick_save", LuaInterface::lua_quick_save},
+		{"quick_load", LuaInterface::lua_quick_load},
+		{"set_quick_save_capacity", LuaInterface::lua_set_quick_save_capacity},
+		{"get_quick_save_capacity", LuaInterface::lua_get_quick_save_capacity},
+		{"get_quick_save_count", LuaInterface::lua_get_quick_save_count},
 		{"get_cursor_position", LuaInterface::lua_get_cursor_position},
 		{"get_selected_entity", LuaInterface::lua_get_tracked_entity}, // Alias.
 		{"get_enum_direction", LuaInterface::lua_get_enum_direction},
@@ -136,6 +177,7 @@ void LuaInterface::init(Game* game)
 		{"kill", LuaInterface::lua_kill_entity},
 		{"has_component", LuaInterface::lua_has_component},
 		{"reset", LuaInterface::lua_entity_reset_state},
+		{"get", LuaInterface::lua_get_component_proxy},
 		{nullptr, nullptr}
 	};
 	
@@ -206,6 +248,9 @@ void LuaInterface::init(Game* game)
 		{"get_update_period", LuaInterface::lua_get_update_period},
 		{"force_update", LuaInterface::lua_force_update},
 		{"get_faction_name", LuaInterface::lua_get_faction_name},
+		{"set_native_enabled", LuaInterface::lua_set_native_ai_enabled},
+		{"is_native_enabled", LuaInterface::lua_is_native_ai_enabled},
+		{"pin_native", LuaInterface::lua_pin_native_ai},
 		{nullptr, nullptr}
 	};
 
@@ -246,6 +291,8 @@ void LuaInterface::init(Game* game)
 	lpp::Script::regs path_funcs[] = {
 		// Pathfinding.
 		{"pathfind", LuaInterface::lua_pathfind},
+		{"request", LuaInterface::lua_path_request},
+		{"pending", LuaInterface::lua_path_pending},
 		{"pop_first", LuaInterface::lua_pop_first_path_node},
 		{"pop_last", LuaInterface::lua_pop_last_path_node},
 		{"empty", LuaInterface::lua_path_queue_empty},
@@ -282,6 +329,8 @@ void LuaInterface::init(Game* game)
 		{"set_complete", LuaInterface::lua_set_task_complete},
 		{"is_complete", LuaInterface::lua_is_task_complete},
 		{"clear", LuaInterface::lua_task_clear},
+		{"wait", LuaInterface::lua_task_wait},
+		{"get_wait", LuaInterface::lua_task_get_wait},
 		{nullptr, nullptr}
 	};
 
@@ -324,6 +373,10 @@ void LuaInterface::init(Game* game)
 		{"closest_enemy_structure", LuaInterface::lua_closest_enemy_structure},
 		{"closest_friendly_structure_in_sight", LuaInterface::lua_closest_friendly_structure_in_sight},
 		{"closest_enemy_structure_in_sight", LuaInterface::lua_closest_enemy_structure_in_sight},
+		{"set_target_cache_enabled", LuaInterface::lua_set_target_cache_enabled},
+		{"is_target_cache_enabled", LuaInterface::lua_is_target_cache_enabled},
+		{"set_target_cache_size", LuaInterface::lua_set_target_cache_size},
+		{"get_target_cache_size", LuaInterface::lua_get_target_cache_size},
 		{nullptr, nullptr}
 	};
 
@@ -804,6 +857,83 @@ void LuaInterface::init(Game* game)
 		{nullptr, nullptr}
 	};
 
+	lpp::Script::regs journal_funcs[] = {
+		// Journal.
+		{"record", LuaInterface::lua_journal_record},
+		{"stop", LuaInterface::lua_journal_stop},
+		{"save", LuaInterface::lua_journal_save},
+		{"replay", LuaInterface::lua_journal_replay},
+		{"is_recording", LuaInterface::lua_journal_is_recording},
+		{"is_replaying", LuaInterface::lua_journal_is_replaying},
+		{"get_tick", LuaInterface::lua_journal_get_tick},
+		{"set_step", LuaInterface::lua_journal_set_step},
+		{"get_step", LuaInterface::lua_journal_get_step},
+		{nullptr, nullptr}
+	};
+
+	lpp::Script::regs benchmark_funcs[] = {
+		// Benchmark.
+		{"run", LuaInterface::lua_benchmark_run},
+		{"is_running", LuaInterface::lua_benchmark_is_running},
+		{"get_allocation_count", LuaInterface::lua_benchmark_get_allocation_count},
+		{nullptr, nullptr}
+	};
+
+	lpp::Script::regs profiler_funcs[] = {
+		// Profiler.
+		{"start", LuaInterface::lua_profiler_start},
+		{"stop", LuaInterface::lua_profiler_stop},
+		{"is_running", LuaInterface::lua_profiler_is_running},
+		{"dump", LuaInterface::lua_profiler_dump},
+		{"set_overlay_visible", LuaInterface::lua_profiler_set_overlay_visible},
+		{"is_overlay_visible", LuaInterface::lua_profiler_is_overlay_visible},
+		{"set_overlay_frames", LuaInterface::lua_profiler_set_overlay_frames},
+		{"set_buffer_size", LuaInterface::lua_profiler_set_buffer_size},
+		{"get_buffer_size", LuaInterface::lua_profiler_get_buffer_size},
+		{nullptr, nullptr}
+	};
+
+	lpp::Script::regs lua_profiler_funcs[] = {
+		// Lua profiler.
+		{"start", LuaInterface::lua_lua_profiler_start},
+		{"stop", LuaInterface::lua_lua_profiler_stop},
+		{"reset", LuaInterface::lua_lua_profiler_reset},
+		{"is_running", LuaInterface::lua_lua_profiler_is_running},
+		{"print", LuaInterface::lua_lua_profiler_print},
+		{"dump", LuaInterface::lua_lua_profiler_dump},
+		{nullptr, nullptr}
+	};
+
+	lpp::Script::regs gc_funcs[] = {
+		// Lua garbage collector.
+		{"set_manual", LuaInterface::lua_gc_set_manual},
+		{"is_manual", LuaInterface::lua_gc_is_manual},
+		{"collect", LuaInterface::lua_gc_collect},
+		{"set_budget", LuaInterface::lua_gc_set_budget},
+		{"get_budget", LuaInterface::lua_gc_get_budget},
+		{"set_frame_time", LuaInterface::lua_gc_set_frame_time},
+		{"get_frame_time", LuaInterface::lua_gc_get_frame_time},
+		{"set_step_size", LuaInterface::lua_gc_set_step_size},
+		{"get_step_size", LuaInterface::lua_gc_get_step_size},
+		{"set_pause", LuaInterface::lua_gc_set_pause},
+		{"get_pause", LuaInterface::lua_gc_get_pause},
+		{"get_memory", LuaInterface::lua_gc_get_memory},
+		{"print", LuaInterface::lua_gc_print},
+		{"reset_stats", LuaInterface::lua_gc_reset_stats},
+		{nullptr, nullptr}
+	};
+
+	lpp::Script::regs workers_funcs[] = {
+		// Lua worker states.
+		{"start", LuaInterface::lua_workers_start},
+		{"stop", LuaInterface::lua_workers_stop},
+		{"is_running", LuaInterface::lua_workers_is_running},
+		{"get_count", LuaInterface::lua_workers_get_count},
+		{"set_min_calls", LuaInterface::lua_workers_set_min_calls},
+		{"get_last_error", LuaInterface::lua_workers_get_last_error},
+		{nullptr, nullptr}
+	};
+
 	auto state = script.get_state();
 	luaL_newlib(state, game_funcs);
 	lua_setglobal(state, "game");
@@ -892,6 +1022,18 @@ void LuaInterface::init(Game* game)
 	lua_setfield(state, -2, "selection");
 	luaL_newlib(state, activation_funcs);
 	lua_setfield(state, -2, "activation");
+	luaL_newlib(state, journal_funcs);
+	lua_setfield(state, -2, "journal");
+	luaL_newlib(state, benchmark_funcs);
+	lua_setfield(state, -2, "benchmark");
+	luaL_newlib(state, profiler_funcs);
+	lua_setfield(state, -2, "profiler");
+	luaL_newlib(state, lua_profiler_funcs);
+	lua_setfield(state, -2, "lua_profiler");
+	luaL_newlib(state, gc_funcs);
+	lua_setfield(state, -2, "gc");
+	luaL_newlib(state, workers_funcs);
+	lua_setfield(state, -2, "workers");
 
 	// GUI subtable has it's own subtables.
 	luaL_newlib(state, gui_funcs);
@@ -912,19 +1054,26 @@ void LuaInterface::init(Game* game)
 
 	// Pop the residual tables.
 	lua_pop(state, 2);
+
+	// Metatables of the component proxies returned by game.entity.get.
+	ComponentProxy::init(state, *ents);
+
+	// Read-only API and constants of the worker states evaluating pure blueprint functions.
+	script.get_worker_pool().set_api(LuaInterface::lua_init_pure_api, {"game.enum", "game.const"});
 	
 	// Set some C++ constants.
-	script.execute("game.const = {}");
-	script.execute("game.const.no_ent = " + std::to_string(Component::NO_ENTITY));
+	script.set_table<tdt::uint>("game.const", {
+		{"no_ent", Component::NO_ENTITY}
+	});
 
 	// Load all necessary scripts.
 	script.load("init.lua");
 
 	// InputComponent related enums.
-	script.set("game.enum.input.key_up", OIS::KC_W);
-	script.set("game.enum.input.key_down", OIS::KC_S);
-	script.set("game.enum.input.key_left", OIS::KC_A);
-	script.set("game.enum.input.key_right", OIS::KC_D);
+	script.set_table<int>("game.enum.input", {
+		{"key_up", OIS::KC_W}, {"key_down", OIS::KC_S},
+		{"key_left", OIS::KC_A}, {"key_right", OIS::KC_D}
+	});
 
 	auto testing = lpp::Script::instance().get<bool>("game.config.testing_mode");
 	if(testing)
@@ -941,13 +1090,13 @@ void LuaInterface::init(Game* game)
 #pragma region LUA
 int LuaInterface::lua_get_avg_fps(lpp::Script::state L)
 {
-	auto res = lua_this->window_->getAverageFPS();
+	auto res = lua_this->window_ ? lua_this->window_->getAverageFPS() : 0.f;
 	lua_pushnumber(L, res);
 	return 1;
 }
 int LuaInterface::lua_get_fps(lpp::Script::state L)
 {
-	auto res = lua_this->window_->getLastFPS();
+	auto res = lua_this->window_ ? lua_this->window_->getLastFPS() : 0.f;
 	lua_pushnumber(L, res);
 	return 1;
 }
@@ -1076,6 +1225,133 @@ int LuaInterface::lua_load_game(lpp::Script::state L)
 	return 0;
 }
 
+int LuaInterface::lua_export_game(lpp::Script::state L)
+{
+	if(lua_gettop(L) > 0)
+	{
+		std::string fname = GET_STR(L, -1);
+		lua_this->game_serializer_->export_game(*lua_this, fname);
+	}
+	else
+		lua_this->game_serializer_->export_game(*lua_this);
+
+	return 0;
+}
+
+int LuaInterface::lua_autosave(lpp::Script::state L)
+{
+	bool res = lua_this->game_serializer_->autosave(*lua_this);
+
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_set_autosave_interval(lpp::Script::state L)
+{
+	tdt::real interval = GET_REAL(L, -1);
+	lua_this->game_serializer_->set_autosave_interval(interval);
+
+	return 0;
+}
+
+int LuaInterface::lua_get_autosave_interval(lpp::Script::state L)
+{
+	auto res = lua_this->game_serializer_->get_autosave_interval();
+
+	lua_pushnumber(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_set_autosave_slots(lpp::Script::state L)
+{
+	tdt::uint slots = GET_UINT(L, -1);
+	lua_this->game_serializer_->set_autosave_slots(slots);
+
+	return 0;
+}
+
+int LuaInterface::lua_get_autosave_slots(lpp::Script::state L)
+{
+	auto res = lua_this->game_serializer_->get_autosave_slots();
+
+	lua_pushinteger(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_set_incremental_autosaves(lpp::Script::state L)
+{
+	bool on_off = GET_BOOL(L, -1);
+	lua_this->game_serializer_->set_incremental_autosaves(on_off);
+
+	return 0;
+}
+
+int LuaInterface::lua_get_incremental_autosaves(lpp::Script::state L)
+{
+	auto res = lua_this->game_serializer_->get_incremental_autosaves();
+
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_set_autosave_chain_length(lpp::Script::state L)
+{
+	tdt::uint length = GET_UINT(L, -1);
+	lua_this->game_serializer_->set_autosave_chain_length(length);
+
+	return 0;
+}
+
+int LuaInterface::lua_get_autosave_chain_length(lpp::Script::state L)
+{
+	auto res = lua_this->game_serializer_->get_autosave_chain_length();
+
+	lua_pushinteger(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_quick_save(lpp::Script::state L)
+{
+	lua_this->quick_save_ring_->save(*lua_this);
+
+	return 0;
+}
+
+int LuaInterface::lua_quick_load(lpp::Script::state L)
+{
+	tdt::uint index{};
+	if(lua_gettop(L) > 0)
+		index = GET_UINT(L, -1);
+	bool res = lua_this->quick_save_ring_->load(*lua_this, index);
+
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_set_quick_save_capacity(lpp::Script::state L)
+{
+	tdt::uint capacity = GET_UINT(L, -1);
+	lua_this->quick_save_ring_->set_capacity(capacity);
+
+	return 0;
+}
+
+int LuaInterface::lua_get_quick_save_capacity(lpp::Script::state L)
+{
+	auto res = lua_this->quick_save_ring_->get_capacity();
+
+	lua_pushinteger(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_get_quick_save_count(lpp::Script::state L)
+{
+	auto res = lua_this->quick_save_ring_->get_size();
+
+	lua_pushinteger(L, res);
+	return 1;
+}
+
 int LuaInterface::lua_get_cursor_position(lpp::Script::state L)
 {
 	auto pos = lua_this->mouse_position_;
@@ -1161,15 +1437,7 @@ int LuaInterface::lua_get_enemies(lpp::Script::state L)
 			res.emplace_back(ent.first);
 	}
 
-	lua_createtable(L, res.size(), 0);
-	int table = lua_gettop(L);
-	int i = 1;
-	for(const auto& ent : res)
-	{
-		lua_pushinteger(L, ent);
-		lua_rawseti(L, table, i);
-		++i;
-	}
+	lpp::IdList::push(L, res);
 	return 1;
 }
 
@@ -1182,15 +1450,7 @@ int LuaInterface::lua_get_friends(lpp::Script::state L)
 			res.emplace_back(ent.first);
 	}
 
-	lua_createtable(L, res.size(), 0);
-	int table = lua_gettop(L);
-	int i = 1;
-	for(const auto& ent : res)
-	{
-		lua_pushinteger(L, ent);
-		lua_rawseti(L, table, i);
-		++i;
-	}
+	lpp::IdList::push(L, res);
 	return 1;
 }
 
@@ -1550,13 +1810,23 @@ int LuaInterface::lua_entity_reset_state(lpp::Script::state L)
 	auto path = ents->get_component<PathfindingComponent>(id);
 	if(path)
 	{
+		Grid::instance().remove_path_subscriber(id, path->path_queue);
 		path->path_queue.clear();
 		path->target_id = Component::NO_ENTITY;
 		path->last_id = Component::NO_ENTITY;
 	}
+	PathService::instance().cancel(id);
 	return 0;
 }
 
+int LuaInterface::lua_get_component_proxy(lpp::Script::state L)
+{
+	int type     = GET_SINT(L, -1);
+	tdt::uint id = GET_UINT(L, -2);
+
+	return ComponentProxy::push(L, id, type);
+}
+
 int LuaInterface::lua_move_to(lpp::Script::state L)
 {
 	tdt::real z  = GET_REAL(L, -1);
@@ -2074,6 +2344,29 @@ int LuaInterface::lua_get_faction_name(lpp::Script::state L)
 	return 1;
 }
 
+int LuaInterface::lua_set_native_ai_enabled(lpp::Script::state L)
+{
+	bool val = GET_BOOL(L, -1);
+
+	NativeAI::instance().set_enabled(val);
+	return 0;
+}
+
+int LuaInterface::lua_is_native_ai_enabled(lpp::Script::state L)
+{
+	auto res = NativeAI::instance().is_enabled();
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_pin_native_ai(lpp::Script::state L)
+{
+	std::string blueprint = GET_STR(L, -1);
+
+	NativeAI::instance().pin_update(blueprint);
+	return 0;
+}
+
 int LuaInterface::lua_set_input_handler(lpp::Script::state L)
 {
 	std::string handler = GET_STR(L, -1);
@@ -2186,13 +2479,39 @@ int LuaInterface::lua_pathfind(lpp::Script::state L)
 	return 1;
 }
 
+int LuaInterface::lua_path_request(lpp::Script::state L)
+{
+	bool go_near{false};
+	if(lua_gettop(L) >= 3)
+		go_near = GET_BOOL(L, -1);
+	else
+		lua_pushnil(L); // Keeps the indices below the same.
+	tdt::uint end = GET_UINT(L, -2);
+	tdt::uint id  = GET_UINT(L, -3);
+
+	auto res = PathService::instance().request(*ents, id, end, PATH_HEURISTIC::PORTAL, true, go_near);
+	lua_pushboolean(L, res != 0);
+	return 1;
+}
+
+int LuaInterface::lua_path_pending(lpp::Script::state L)
+{
+	tdt::uint id = GET_UINT(L, -1);
+
+	lua_pushboolean(L, PathService::instance().pending(id));
+	return 1;
+}
+
 int LuaInterface::lua_pop_first_path_node(lpp::Script::state L)
 {
 	tdt::uint id = GET_UINT(L, -1);
 
 	auto& path = PathfindingHelper::get_path(*ents, id);
 	if(!path.empty())
+	{
+		Grid::instance().remove_path_subscriber(id, path.front());
 		path.pop_front();
+	}
 	return 0;
 }
 
@@ -2202,7 +2521,10 @@ int LuaInterface::lua_pop_last_path_node(lpp::Script::state L)
 
 	auto& path = PathfindingHelper::get_path(*ents, id);
 	if(!path.empty())
+	{
+		Grid::instance().remove_path_subscriber(id, path.back());
 		path.pop_back();
+	}
 	return 0;
 }
 
@@ -2221,7 +2543,11 @@ int LuaInterface::lua_clear_path(lpp::Script::state L)
 
 	auto& queue = PathfindingHelper::get_path(*ents, id);
 	if(!queue.empty())
+	{
+		Grid::instance().remove_path_subscriber(id, queue);
 		queue.clear();
+	}
+	PathService::instance().cancel(id);
 	return 0;
 }
 
@@ -2362,6 +2688,7 @@ int LuaInterface::lua_set_portal_neighbour(lpp::Script::state L)
 	tdt::uint id  = GET_UINT(L, -2);
 
 	GridNodeHelper::set_portal_neighbour(*ents, id, val);
+	PathService::instance().invalidate(*ents, std::set<tdt::uint>{id});
 	return 0;
 }
 
@@ -2397,7 +2724,10 @@ int LuaInterface::lua_pathfinding_skip_next_node(lpp::Script::state L)
 
 	auto comp = ents->get_component<PathfindingComponent>(id);
 	if(comp && !comp->path_queue.empty())
+	{
+		Grid::instance().remove_path_subscriber(id, comp->path_queue.front());
 		comp->path_queue.pop_front();
+	}
 	return 0;
 }
 
@@ -2464,7 +2794,7 @@ int LuaInterface::lua_list_tasks_of(lpp::Script::state L)
 		if(comp->curr_task != Component::NO_ENTITY)
 		{ // Current task.
 			++task_count;
-			auto curr = lua_this->entity_system_->get_component<TaskComponent>(comp->curr_task);
+			auto curr = lua_this->entity_system_->get_task_pool().get(comp->curr_task);
 			if(curr)
 			{
 				report.append(std::to_string(comp->curr_task) + ": "
@@ -2479,7 +2809,7 @@ int LuaInterface::lua_list_tasks_of(lpp::Script::state L)
 		{
 			++task_count;
 			report.append(std::to_string(task) + ": ");
-			auto task_comp = lua_this->entity_system_->get_component<TaskComponent>(task);
+			auto task_comp = lua_this->entity_system_->get_task_pool().get(task);
 			if(task_comp)
 			{
 				report.append(lua_this->task_system_->get_task_name(task_comp->task_type)
@@ -2650,6 +2980,27 @@ int LuaInterface::lua_task_clear(lpp::Script::state L)
 	return 0;
 }
 
+int LuaInterface::lua_task_wait(lpp::Script::state L)
+{
+	tdt::uint id   = GET_UINT(L, 1);
+	TASK_WAIT cond = (TASK_WAIT)luaL_checkinteger(L, 2);
+	tdt::real time{};
+	if(lua_gettop(L) >= 3)
+		time = GET_REAL(L, 3);
+
+	TaskHandlerHelper::set_wait_condition(*ents, id, cond, time);
+	return 0;
+}
+
+int LuaInterface::lua_task_get_wait(lpp::Script::state L)
+{
+	tdt::uint id = GET_UINT(L, -1);
+
+	auto res = TaskHandlerHelper::get_wait_condition(*ents, id);
+	lua_pushinteger(L, (int)res);
+	return 1;
+}
+
 int LuaInterface::lua_set_combat_target(lpp::Script::state L)
 {
 	tdt::uint target = GET_UINT(L, -1);
@@ -3050,6 +3401,38 @@ int LuaInterface::lua_closest_enemy_structure_in_sight(lpp::Script::state L)
 	return 1;
 }
 
+int LuaInterface::lua_set_target_cache_enabled(lpp::Script::state L)
+{
+	bool val = GET_BOOL(L, -1);
+
+	lua_this->combat_system_->set_target_cache_enabled(val);
+	return 0;
+}
+
+int LuaInterface::lua_is_target_cache_enabled(lpp::Script::state L)
+{
+	auto res = lua_this->combat_system_->is_target_cache_enabled();
+
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_set_target_cache_size(lpp::Script::state L)
+{
+	tdt::uint val = GET_UINT(L, -1);
+
+	lua_this->combat_system_->set_target_cache_size(val);
+	return 0;
+}
+
+int LuaInterface::lua_get_target_cache_size(lpp::Script::state L)
+{
+	auto res = lua_this->combat_system_->get_target_cache_size();
+
+	lua_pushinteger(L, res);
+	return 1;
+}
+
 int LuaInterface::lua_set_production_blueprint(lpp::Script::state L)
 {
 	std::string blueprint = GET_STR(L, -1);
@@ -5535,33 +5918,596 @@ int LuaInterface::lua_activation_is_activated(lpp::Script::state L)
 	return 1;
 }
 
-int LuaInterface::lua_set_tracker_visible(lpp::Script::state L)
+int LuaInterface::lua_journal_record(lpp::Script::state L)
 {
-	bool val = GET_BOOL(L, -1);
+	tdt::uint height = GET_UINT(L, -1);
+	tdt::uint width = GET_UINT(L, -2);
+	tdt::uint seed = GET_UINT(L, -3);
 
-	GUI::instance().get_tracker().set_visible(val);
+	Journal::instance().start_recording(*lua_this, seed, width, height);
 	return 0;
 }
 
-int LuaInterface::lua_is_tracker_visible(lpp::Script::state L)
+int LuaInterface::lua_journal_stop(lpp::Script::state L)
 {
-	auto res = GUI::instance().get_tracker().is_visible();
+	Journal::instance().stop(*lua_this);
+
+	return 0;
+}
+
+int LuaInterface::lua_journal_save(lpp::Script::state L)
+{
+	std::string fname = GET_STR(L, -1);
+
+	auto res = Journal::instance().save(*lua_this, fname);
+
 	lua_pushboolean(L, res);
 	return 1;
 }
 
-int LuaInterface::lua_set_log_visible(lpp::Script::state L)
+int LuaInterface::lua_journal_replay(lpp::Script::state L)
 {
-	bool val = GET_BOOL(L, -1);
+	bool fast{false};
+	if(lua_gettop(L) > 1)
+		fast = GET_BOOL(L, 2);
+	std::string fname = GET_STR(L, 1);
+
+	auto res = Journal::instance().replay(*lua_this, fname, fast);
+
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_journal_is_recording(lpp::Script::state L)
+{
+	auto res = Journal::instance().is_recording();
+
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_journal_is_replaying(lpp::Script::state L)
+{
+	auto res = Journal::instance().is_replaying();
+
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_journal_get_tick(lpp::Script::state L)
+{
+	auto res = Journal::instance().get_tick();
+
+	lua_pushinteger(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_journal_set_step(lpp::Script::state L)
+{
+	tdt::real step = GET_REAL(L, -1);
+	Journal::instance().set_step(step);
 
-	GUI::instance().get_log().set_visible(val);
 	return 0;
 }
 
-int LuaInterface::lua_is_log_visible(lpp::Script::state L)
+int LuaInterface::lua_journal_get_step(lpp::Script::state L)
 {
-	auto res = GUI::instance().get_log().is_visible();
+	auto res = Journal::instance().get_step();
+
+	lua_pushnumber(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_benchmark_run(lpp::Script::state L)
+{
+	std::string output{};
+	if(lua_gettop(L) > 1)
+		output = GET_STR(L, 2);
+	std::string scenario = GET_STR(L, 1);
+
+	auto res = Benchmark::instance().run(*lua_this, scenario, output);
+
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_benchmark_is_running(lpp::Script::state L)
+{
+	auto res = Benchmark::instance().is_running();
+
 	lua_pushboolean(L, res);
 	return 1;
 }
-#pragma endregion
\ No newline at end of file
+
+int LuaInterface::lua_benchmark_get_allocation_count(lpp::Script::state L)
+{
+#if BENCHMARK_ALLOCATIONS == 1
+	auto res = Benchmark::instance().get_allocation_count();
+
+	lua_pushinteger(L, (lua_Integer)res);
+#else
+	lua_pushnil(L);
+#endif
+	return 1;
+}
+
+int LuaInterface::lua_profiler_start(lpp::Script::state L)
+{
+	Profiler::instance().start();
+
+	return 0;
+}
+
+int LuaInterface::lua_profiler_stop(lpp::Script::state L)
+{
+	Profiler::instance().stop();
+
+	return 0;
+}
+
+int LuaInterface::lua_profiler_is_running(lpp::Script::state L)
+{
+	auto res = Profiler::instance().is_running();
+
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_profiler_dump(lpp::Script::state L)
+{
+	std::string fname = GET_STR(L, -1);
+
+	auto res = Profiler::instance().dump(fname);
+
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_profiler_set_overlay_visible(lpp::Script::state L)
+{
+	bool val = GET_BOOL(L, -1);
+
+	GUI::instance().get_profiler().set_visible(val);
+	return 0;
+}
+
+int LuaInterface::lua_profiler_is_overlay_visible(lpp::Script::state L)
+{
+	auto res = GUI::instance().get_profiler().is_visible();
+
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_profiler_set_overlay_frames(lpp::Script::state L)
+{
+	tdt::uint frames = GET_UINT(L, -1);
+
+	GUI::instance().get_profiler().set_frames(frames);
+	return 0;
+}
+
+int LuaInterface::lua_profiler_set_buffer_size(lpp::Script::state L)
+{
+	tdt::uint size = GET_UINT(L, -1);
+
+	Profiler::instance().set_buffer_size(size);
+	return 0;
+}
+
+int LuaInterface::lua_profiler_get_buffer_size(lpp::Script::state L)
+{
+	auto res = Profiler::instance().get_buffer_size();
+
+	lua_pushinteger(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_lua_profiler_start(lpp::Script::state L)
+{
+	lpp::Script::instance().get_profiler().start();
+
+	return 0;
+}
+
+int LuaInterface::lua_lua_profiler_stop(lpp::Script::state L)
+{
+	lpp::Script::instance().get_profiler().stop();
+
+	return 0;
+}
+
+int LuaInterface::lua_lua_profiler_reset(lpp::Script::state L)
+{
+	lpp::Script::instance().get_profiler().reset();
+
+	return 0;
+}
+
+int LuaInterface::lua_lua_profiler_is_running(lpp::Script::state L)
+{
+	auto res = lpp::Script::instance().get_profiler().is_running();
+
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_lua_profiler_print(lpp::Script::state L)
+{
+	tdt::uint count{10};
+	if(lua_gettop(L) > 0)
+		count = GET_UINT(L, -1);
+
+	auto& profiler = lpp::Script::instance().get_profiler();
+	auto& console = GUI::instance().get_console();
+	auto ms = [](std::uint64_t time) -> std::string {
+		std::ostringstream oss{};
+		oss << std::fixed << std::setprecision(3) << time / 1000000.0 << " ms";
+		return oss.str();
+	};
+
+	console.print_text("LUA FUNCTIONS (self time, total time, calls, bytes):", Console::ORANGE_TEXT);
+	auto functions = profiler.get_functions();
+	for(tdt::uint i = 0; i < count && i < functions.size(); ++i)
+	{
+		const auto& function = functions[i];
+		console.print_text(function.name + ": " + ms(function.self) + ", " + ms(function.total) + ", "
+						   + std::to_string(function.calls) + ", " + std::to_string(function.bytes), Console::ORANGE_TEXT);
+	}
+
+	console.print_text("BLUEPRINTS (time, calls, bytes):", Console::ORANGE_TEXT);
+	auto blueprints = profiler.get_blueprints();
+	for(tdt::uint i = 0; i < count && i < blueprints.size(); ++i)
+	{
+		const auto& blueprint = blueprints[i];
+		console.print_text(blueprint.name + ": " + ms(blueprint.total) + ", " + std::to_string(blueprint.calls)
+						   + ", " + std::to_string(blueprint.bytes), Console::ORANGE_TEXT);
+	}
+
+	console.print_text("CALLSITES (time, calls, bytes):", Console::ORANGE_TEXT);
+	for(const auto& callsite : profiler.get_callsites())
+	{
+		console.print_text(callsite.name + ": " + ms(callsite.total) + ", " + std::to_string(callsite.calls)
+						   + ", " + std::to_string(callsite.bytes), Console::ORANGE_TEXT);
+	}
+
+	return 0;
+}
+
+int LuaInterface::lua_lua_profiler_dump(lpp::Script::state L)
+{
+	std::string fname = GET_STR(L, -1);
+
+	auto res = lpp::Script::instance().get_profiler().dump(fname);
+
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_gc_set_manual(lpp::Script::state L)
+{
+	bool val = GET_BOOL(L, -1);
+
+	lpp::Script::instance().get_gc().set_manual(val);
+	return 0;
+}
+
+int LuaInterface::lua_gc_is_manual(lpp::Script::state L)
+{
+	auto res = lpp::Script::instance().get_gc().is_manual();
+
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_gc_collect(lpp::Script::state L)
+{
+	lpp::Script::instance().get_gc().collect();
+
+	return 0;
+}
+
+int LuaInterface::lua_gc_set_budget(lpp::Script::state L)
+{
+	tdt::real budget = GET_REAL(L, -1);
+
+	lpp::Script::instance().get_gc().set_budget(budget);
+	return 0;
+}
+
+int LuaInterface::lua_gc_get_budget(lpp::Script::state L)
+{
+	auto res = lpp::Script::instance().get_gc().get_budget();
+
+	lua_pushnumber(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_gc_set_frame_time(lpp::Script::state L)
+{
+	tdt::real time = GET_REAL(L, -1);
+
+	lpp::Script::instance().get_gc().set_frame_time(time);
+	return 0;
+}
+
+int LuaInterface::lua_gc_get_frame_time(lpp::Script::state L)
+{
+	auto res = lpp::Script::instance().get_gc().get_frame_time();
+
+	lua_pushnumber(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_gc_set_step_size(lpp::Script::state L)
+{
+	tdt::uint size = GET_UINT(L, -1);
+
+	lpp::Script::instance().get_gc().set_step_size(size);
+	return 0;
+}
+
+int LuaInterface::lua_gc_get_step_size(lpp::Script::state L)
+{
+	auto res = lpp::Script::instance().get_gc().get_step_size();
+
+	lua_pushinteger(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_gc_set_pause(lpp::Script::state L)
+{
+	tdt::real pause = GET_REAL(L, -1);
+
+	lpp::Script::instance().get_gc().set_pause(pause);
+	return 0;
+}
+
+int LuaInterface::lua_gc_get_pause(lpp::Script::state L)
+{
+	auto res = lpp::Script::instance().get_gc().get_pause();
+
+	lua_pushnumber(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_gc_get_memory(lpp::Script::state L)
+{
+	auto res = lpp::Script::instance().get_gc().get_stats().memory;
+
+	lua_pushinteger(L, (lua_Integer)res);
+	return 1;
+}
+
+int LuaInterface::lua_gc_print(lpp::Script::state L)
+{
+	auto& gc = lpp::Script::instance().get_gc();
+	const auto& gc_stats = gc.get_stats();
+	const auto& alloc_stats = lpp::Script::instance().get_allocator().get_stats();
+	auto& console = GUI::instance().get_console();
+	auto kb = [](std::size_t bytes) -> std::string {
+		return std::to_string(bytes / 1024) + " KB";
+	};
+	auto ms = [](tdt::real time) -> std::string {
+		std::ostringstream oss{};
+		oss << std::fixed << std::setprecision(3) << time << " ms";
+		return oss.str();
+	};
+
+	console.print_text("LUA MEMORY: " + kb(gc_stats.memory) + " (" + kb(gc_stats.live) + " after the last cycle)",
+					   Console::ORANGE_TEXT);
+	console.print_text("ALLOCATOR: " + kb(alloc_stats.pooled) + " pooled of " + kb(alloc_stats.arenas) + " in arenas, "
+					   + kb(alloc_stats.large) + " large, " + std::to_string(alloc_stats.allocations) + " allocations, "
+					   + std::to_string(alloc_stats.frees) + " frees", Console::ORANGE_TEXT);
+	console.print_text("GC: " + std::string{gc.is_manual() ? "manual" : "automatic"} + ", budget " + ms(gc.get_budget())
+					   + ", " + std::to_string(gc_stats.cycles) + " cycles, " + std::to_string(gc_stats.steps) + " steps, "
+					   + std::to_string(gc_stats.emergencies) + " emergency collections", Console::ORANGE_TEXT);
+	console.print_text("GC TIME: last frame " + ms(gc_stats.last_time) + ", max " + ms(gc_stats.max_time)
+					   + ", total " + ms(gc_stats.total_time), Console::ORANGE_TEXT);
+
+	return 0;
+}
+
+int LuaInterface::lua_gc_reset_stats(lpp::Script::state L)
+{
+	lpp::Script::instance().get_gc().reset_stats();
+
+	return 0;
+}
+
+int LuaInterface::lua_set_tracker_visible(lpp::Script::state L)
+{
+	bool val = GET_BOOL(L, -1);
+
+	GUI::instance().get_tracker().set_visible(val);
+	return 0;
+}
+
+int LuaInterface::lua_is_tracker_visible(lpp::Script::state L)
+{
+	auto res = GUI::instance().get_tracker().is_visible();
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_set_log_visible(lpp::Script::state L)
+{
+	bool val = GET_BOOL(L, -1);
+
+	GUI::instance().get_log().set_visible(val);
+	return 0;
+}
+
+int LuaInterface::lua_is_log_visible(lpp::Script::state L)
+{
+	auto res = GUI::instance().get_log().is_visible();
+	lua_pushboolean(L, res);
+	return 1;
+}
+#pragma endregion
+int LuaInterface::lua_workers_start(lpp::Script::state L)
+{
+	tdt::uint count{};
+	if(lua_gettop(L) > 0)
+		count = GET_UINT(L, -1);
+
+	lpp::Script::instance().get_worker_pool().start(count);
+	return 0;
+}
+
+int LuaInterface::lua_workers_stop(lpp::Script::state L)
+{
+	lpp::Script::instance().get_worker_pool().stop();
+	return 0;
+}
+
+int LuaInterface::lua_workers_is_running(lpp::Script::state L)
+{
+	auto res = lpp::Script::instance().get_worker_pool().is_running();
+	lua_pushboolean(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_workers_get_count(lpp::Script::state L)
+{
+	auto res = lpp::Script::instance().get_worker_pool().get_count();
+	lua_pushinteger(L, res);
+	return 1;
+}
+
+int LuaInterface::lua_workers_set_min_calls(lpp::Script::state L)
+{
+	tdt::uint count = GET_UINT(L, -1);
+
+	lpp::Script::instance().get_worker_pool().set_min_calls(count);
+	return 0;
+}
+
+int LuaInterface::lua_workers_get_last_error(lpp::Script::state L)
+{
+	const auto& res = lpp::Script::instance().get_worker_pool().get_last_error();
+	lua_pushstring(L, res.c_str());
+	return 1;
+}
+
+int LuaInterface::lua_init_pure_api(lpp::Script::state L)
+{
+	lpp::Script::regs entity_funcs[] = {
+		{"exists", LuaInterface::lua_exists},
+		{"has_component", LuaInterface::lua_has_component},
+		{nullptr, nullptr}
+	};
+
+	lpp::Script::regs phys_funcs[] = {
+		{"get_position", LuaInterface::lua_pure_get_position},
+		{nullptr, nullptr}
+	};
+
+	lpp::Script::regs hp_funcs[] = {
+		{"get", LuaInterface::lua_pure_get_health},
+		{"get_defense", LuaInterface::lua_pure_get_defense},
+		{"is_alive", LuaInterface::lua_pure_is_alive},
+		{nullptr, nullptr}
+	};
+
+	lpp::Script::regs ai_funcs[] = {
+		{"get_faction", LuaInterface::lua_pure_get_faction},
+		{nullptr, nullptr}
+	};
+
+	lpp::Script::regs grid_funcs[] = {
+		{"is_free", LuaInterface::lua_pure_is_free},
+		{"get_resident", LuaInterface::lua_pure_get_resident},
+		{"is_walk_through", LuaInterface::lua_pure_is_walk_through},
+		{nullptr, nullptr}
+	};
+
+	lua_newtable(L);
+	luaL_newlib(L, entity_funcs);
+	lua_setfield(L, -2, "entity");
+	luaL_newlib(L, phys_funcs);
+	lua_setfield(L, -2, "physics");
+	luaL_newlib(L, hp_funcs);
+	lua_setfield(L, -2, "health");
+	luaL_newlib(L, ai_funcs);
+	lua_setfield(L, -2, "ai");
+	luaL_newlib(L, grid_funcs);
+	lua_setfield(L, -2, "grid");
+	lua_setglobal(L, "game");
+	return 0;
+}
+
+int LuaInterface::lua_pure_get_position(lpp::Script::state L)
+{
+	tdt::uint id = GET_UINT(L, -1);
+
+	auto comp = peek_component<PhysicsComponent>(*ents, id);
+	Ogre::Vector3 res = comp ? comp->position : Ogre::Vector3{-1.f, -1.f, -1.f};
+	lua_pushnumber(L, res.x);
+	lua_pushnumber(L, res.y);
+	lua_pushnumber(L, res.z);
+	return 3;
+}
+
+int LuaInterface::lua_pure_get_health(lpp::Script::state L)
+{
+	tdt::uint id = GET_UINT(L, -1);
+
+	auto comp = peek_component<HealthComponent>(*ents, id);
+	lua_pushinteger(L, comp ? comp->curr_hp : 1);
+	return 1;
+}
+
+int LuaInterface::lua_pure_get_defense(lpp::Script::state L)
+{
+	tdt::uint id = GET_UINT(L, -1);
+
+	auto comp = peek_component<HealthComponent>(*ents, id);
+	lua_pushinteger(L, comp ? comp->defense : 0);
+	return 1;
+}
+
+int LuaInterface::lua_pure_is_alive(lpp::Script::state L)
+{
+	tdt::uint id = GET_UINT(L, -1);
+
+	auto comp = peek_component<HealthComponent>(*ents, id);
+	lua_pushboolean(L, comp && comp->alive);
+	return 1;
+}
+
+int LuaInterface::lua_pure_get_faction(lpp::Script::state L)
+{
+	tdt::uint id = GET_UINT(L, -1);
+
+	auto comp = peek_component<FactionComponent>(*ents, id);
+	lua_pushinteger(L, (int)(comp ? comp->faction : FACTION::NEUTRAL));
+	return 1;
+}
+
+int LuaInterface::lua_pure_is_free(lpp::Script::state L)
+{
+	tdt::uint id = GET_UINT(L, -1);
+
+	auto comp = peek_component<GridNodeComponent>(*ents, id);
+	lua_pushboolean(L, !comp || comp->free);
+	return 1;
+}
+
+int LuaInterface::lua_pure_get_resident(lpp::Script::state L)
+{
+	tdt::uint id = GET_UINT(L, -1);
+
+	auto comp = peek_component<GridNodeComponent>(*ents, id);
+	lua_pushinteger(L, comp ? comp->resident : Component::NO_ENTITY);
+	return 1;
+}
+
+int LuaInterface::lua_pure_is_walk_through(lpp::Script::state L)
+{
+	tdt::uint id = GET_UINT(L, -1);
+
+	auto comp = peek_component<StructureComponent>(*ents, id);
+	lua_pushboolean(L, !comp || comp->walk_through);
+	return 1;
+}
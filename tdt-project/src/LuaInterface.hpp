@@ -50,6 +50,21 @@ class LuaInterface
 		static int lua_reload_all(lpp::Script::state);
 		static int lua_save_game(lpp::Script::state);
 		static int lua_load_game(lpp::Script::state);
+		static int lua_export_game(lpp::Script::state);
+		static int lua_autosave(lpp::Script::state);
+		static int lua_set_autosave_interval(lpp::Script::state);
+		static int lua_get_autosave_interval(lpp::Script::state);
+		static int lua_set_autosave_slots(lpp::Script::state);
+		static int lua_get_autosave_slots(lpp::Script::state);
+		static int lua_set_incremental_autosaves(lpp::Script::state);
+		static int lua_get_incremental_autosaves(lpp::Script::state);
+		static int lua_set_autosave_chain_length(lpp::Script::state);
+		static int lua_get_autosave_chain_length(lpp::Script::state);
+		static int lua_quick_save(lpp::Script::state);
+		static int lua_quick_load(lpp::Script::state);
+		static int lua_set_quick_save_capacity(lpp::Script::state);
+		static int lua_get_quick_save_capacity(lpp::Script::state);
+		static int lua_get_quick_save_count(lpp::Script::state);
 		static int lua_get_cursor_position(lpp::Script::state);
 		static int lua_can_place_when_game_paused(lpp::Script::state);
 		static int lua_toggle_placing_when_game_paused(lpp::Script::state);
@@ -111,6 +126,7 @@ class LuaInterface
 		static int lua_kill_entity(lpp::Script::state);
 		static int lua_has_component(lpp::Script::state);
 		static int lua_entity_reset_state(lpp::Script::state);
+		static int lua_get_component_proxy(lpp::Script::state);
 
 		// Physics.
 		static int lua_set_position(lpp::Script::state);
@@ -171,6 +187,9 @@ class LuaInterface
 		static int lua_get_update_period(lpp::Script::state);
 		static int lua_force_update(lpp::Script::state);
 		static int lua_get_faction_name(lpp::Script::state);
+		static int lua_set_native_ai_enabled(lpp::Script::state);
+		static int lua_is_native_ai_enabled(lpp::Script::state);
+		static int lua_pin_native_ai(lpp::Script::state);
 
 		// Input handling.
 		static int lua_set_input_handler(lpp::Script::state);
@@ -188,6 +207,8 @@ class LuaInterface
 		static int lua_set_free(lpp::Script::state);
 		static int lua_set_free_selected(lpp::Script::state);
 		static int lua_pathfind(lpp::Script::state);
+		static int lua_path_request(lpp::Script::state);
+		static int lua_path_pending(lpp::Script::state);
 		static int lua_pop_first_path_node(lpp::Script::state);
 		static int lua_pop_last_path_node(lpp::Script::state);
 		static int lua_path_queue_empty(lpp::Script::state);
@@ -233,6 +254,8 @@ class LuaInterface
 		static int lua_set_task_complete(lpp::Script::state);
 		static int lua_is_task_complete(lpp::Script::state);
 		static int lua_task_clear(lpp::Script::state);
+		static int lua_task_wait(lpp::Script::state);
+		static int lua_task_get_wait(lpp::Script::state);
 
 		// Combat & homing projectiles.
 		static int lua_set_combat_target(lpp::Script::state);
@@ -278,6 +301,10 @@ class LuaInterface
 		static int lua_closest_enemy_structure(lpp::Script::state);
 		static int lua_closest_friendly_structure_in_sight(lpp::Script::state);
 		static int lua_closest_enemy_structure_in_sight(lpp::Script::state);
+		static int lua_set_target_cache_enabled(lpp::Script::state);
+		static int lua_is_target_cache_enabled(lpp::Script::state);
+		static int lua_set_target_cache_size(lpp::Script::state);
+		static int lua_get_target_cache_size(lpp::Script::state);
 
 		// Production & products.
 		static int lua_set_production_blueprint(lpp::Script::state);
@@ -642,4 +669,78 @@ class LuaInterface
 		static int lua_activation_activate(lpp::Script::state);
 		static int lua_activation_deactivate(lpp::Script::state);
 		static int lua_activation_is_activated(lpp::Script::state);
+
+		// Journal.
+		static int lua_journal_record(lpp::Script::state);
+		static int lua_journal_stop(lpp::Script::state);
+		static int lua_journal_save(lpp::Script::state);
+		static int lua_journal_replay(lpp::Script::state);
+		static int lua_journal_is_recording(lpp::Script::state);
+		static int lua_journal_is_replaying(lpp::Script::state);
+		static int lua_journal_get_tick(lpp::Script::state);
+		static int lua_journal_set_step(lpp::Script::state);
+		static int lua_journal_get_step(lpp::Script::state);
+
+		// Benchmark.
+		static int lua_benchmark_run(lpp::Script::state);
+		static int lua_benchmark_is_running(lpp::Script::state);
+		static int lua_benchmark_get_allocation_count(lpp::Script::state);
+
+		// Profiler.
+		static int lua_profiler_start(lpp::Script::state);
+		static int lua_profiler_stop(lpp::Script::state);
+		static int lua_profiler_is_running(lpp::Script::state);
+		static int lua_profiler_dump(lpp::Script::state);
+		static int lua_profiler_set_overlay_visible(lpp::Script::state);
+		static int lua_profiler_is_overlay_visible(lpp::Script::state);
+		static int lua_profiler_set_overlay_frames(lpp::Script::state);
+		static int lua_profiler_set_buffer_size(lpp::Script::state);
+		static int lua_profiler_get_buffer_size(lpp::Script::state);
+
+		// Lua profiler.
+		static int lua_lua_profiler_start(lpp::Script::state);
+		static int lua_lua_profiler_stop(lpp::Script::state);
+		static int lua_lua_profiler_reset(lpp::Script::state);
+		static int lua_lua_profiler_is_running(lpp::Script::state);
+		static int lua_lua_profiler_print(lpp::Script::state);
+		static int lua_lua_profiler_dump(lpp::Script::state);
+
+		// Lua garbage collector.
+		static int lua_gc_set_manual(lpp::Script::state);
+		static int lua_gc_is_manual(lpp::Script::state);
+		static int lua_gc_collect(lpp::Script::state);
+		static int lua_gc_set_budget(lpp::Script::state);
+		static int lua_gc_get_budget(lpp::Script::state);
+		static int lua_gc_set_frame_time(lpp::Script::state);
+		static int lua_gc_get_frame_time(lpp::Script::state);
+		static int lua_gc_set_step_size(lpp::Script::state);
+		static int lua_gc_get_step_size(lpp::Script::state);
+		static int lua_gc_set_pause(lpp::Script::state);
+		static int lua_gc_get_pause(lpp::Script::state);
+		static int lua_gc_get_memory(lpp::Script::state);
+		static int lua_gc_print(lpp::Script::state);
+		static int lua_gc_reset_stats(lpp::Script::state);
+
+		// Lua worker states.
+		static int lua_workers_start(lpp::Script::state);
+		static int lua_workers_stop(lpp::Script::state);
+		static int lua_workers_is_running(lpp::Script::state);
+		static int lua_workers_get_count(lpp::Script::state);
+		static int lua_workers_set_min_calls(lpp::Script::state);
+		static int lua_workers_get_last_error(lpp::Script::state);
+
+		/**
+		 * Read-only API of the worker states (see lpp::WorkerPool), these functions
+		 * are called from the worker threads and thus must not change anything
+		 * (not even the component caches or the change tracking).
+		 */
+		static int lua_init_pure_api(lpp::Script::state);
+		static int lua_pure_get_position(lpp::Script::state);
+		static int lua_pure_get_health(lpp::Script::state);
+		static int lua_pure_get_defense(lpp::Script::state);
+		static int lua_pure_is_alive(lpp::Script::state);
+		static int lua_pure_get_faction(lpp::Script::state);
+		static int lua_pure_is_free(lpp::Script::state);
+		static int lua_pure_get_resident(lpp::Script::state);
+		static int lua_pure_is_walk_through(lpp::Script::state);
 };
\ No newline at end of file
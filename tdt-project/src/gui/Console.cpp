@@ -1,4 +1,7 @@
+#include <iostream>
 #include <lppscript/LppScript.hpp>
+#include <tools/Journal.hpp>
+#include <tools/Util.hpp>
 #include "Console.hpp"
 
 // Static initialization:
@@ -46,6 +49,8 @@ bool Console::execute(const CEGUI::EventArgs& args)
 	bool success{true};
 	std::string err_msg{};
 
+	Journal::instance().record(JOURNAL_COMMAND::LUA, curr_command_);
+	Journal::Scope scope{};
 	try
 	{
 		lpp::Script::instance().execute(curr_command_);
@@ -84,6 +89,9 @@ void Console::print_text(const std::string& msg, CEGUI::Colour col)
 	if(msg == "`") // Garbage value from toggling the console.
 		return;
 
+	if(util::is_headless()) // The console is never shown.
+		std::cout << msg << std::endl;
+
 	CEGUI::ListboxTextItem* text;
 
 	if(list_box_->getItemCount() >= console_history_)
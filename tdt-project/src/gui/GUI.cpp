@@ -1,6 +1,7 @@
 #include <helpers/Helpers.hpp>
 #include <systems/EntitySystem.hpp>
 #include <tools/GameSerializer.hpp>
+#include <tools/QuickSaveRing.hpp>
 #include "GUI.hpp"
 #include "Game.hpp"
 
@@ -8,7 +9,7 @@ GUI::GUI()
 	: window_{}, curr_tool_{"TOOLS/MENU"}, game_{},
 	  console_{}, tracker_{}, builder_{}, top_bar_{},
 	  research_{}, spell_casting_{}, menu_{}, message_{},
-	  options_{}, new_game_{}
+	  options_{}, new_game_{}, profiler_{}
 { /* DUMMY BODY */ }
 
 void GUI::init(Game* game)
@@ -29,6 +30,7 @@ void GUI::init(Game* game)
 	spell_casting_.init(window_->getChild("TOOLS/SPELLS"));
 	message_.init(window_->getChild("MESSAGE_TO_PLAYER"));
 	new_game_.init(window_->getChild("MAIN_MENU/NEW_GAME_DIALOG"));
+	profiler_.init(window_->getChild("PROFILER"));
 	
 	/**
 	 * The options menu was stored in it's own separate file
@@ -197,7 +199,7 @@ void GUI::init(Game* game)
 	window_->getChild("TOOLS/MENU/FRAME/QUICK_SAVE")->subscribeEvent(
 		CEGUI::PushButton::EventClicked,
 		[this](const CEGUI::EventArgs&) -> bool {
-			game_->game_serializer_->save_game(*game_, "quick_save");
+			game_->quick_save_ring_->save(*game_);
 			return true;
 		}
 	);
@@ -205,7 +207,7 @@ void GUI::init(Game* game)
 	window_->getChild("TOOLS/MENU/FRAME/QUICK_LOAD")->subscribeEvent(
 		CEGUI::PushButton::EventClicked,
 		[this](const CEGUI::EventArgs&) -> bool {
-			game_->game_serializer_->load_game(*game_, "quick_save");
+			game_->quick_save_ring_->load(*game_);
 			return true;
 		}
 	);
@@ -299,7 +301,7 @@ void GUI::show_load_save_dialog(const std::string& type)
 	dialog->getChild("FRAME")->setText(type);
 	dialog->getChild("FRAME/BUTT")->setText(type);
 	dialog->getChild("FRAME/INPUT")->setText("");
-	list_directory("saves/*.lua",
+	list_directory("saves/*",
 				   *((CEGUI::Listbox*)dialog->getChild("FRAME/ITEMS")),
 				   true);
 }
@@ -364,6 +366,11 @@ NewGameDialog& GUI::get_new_game()
 	return new_game_;
 }
 
+ProfilerOverlay& GUI::get_profiler()
+{
+	return profiler_;
+}
+
 bool GUI::escape_pressed()
 {
 	bool res{false};
@@ -456,10 +463,15 @@ void GUI::list_directory(const std::string& dir, CEGUI::Listbox& box, bool strip
 		do
 		{
 			tmp = fdata.cFileName;
-			if(strip_ext && tmp.substr(tmp.size() - 4, tmp.size() - 1) == ".lua")
+			if(strip_ext)
+			{ // Binary saves and exported Lua saves of the same name are loaded as one.
+				auto ext = tmp.size() > 4 ? tmp.substr(tmp.size() - 4) : "";
+				if(ext != ".lua" && ext != ".sav")
+					continue;
 				tmp = tmp.substr(0, tmp.size() - 4);
-			else if(strip_ext && tmp.substr(tmp.size() - 5, tmp.size() - 1) == ".lua~")
-				continue;
+				if(box.findItemWithText(tmp, nullptr))
+					continue;
+			}
 			box.addItem(new CEGUI::ListboxTextItem{tmp});
 		}
 		while(FindNextFile(handle, &fdata));
@@ -12,6 +12,7 @@
 #include "MessageToPlayerWindow.hpp"
 #include "OptionsWindow.hpp"
 #include "NewGameDialog.hpp"
+#include "ProfilerOverlay.hpp"
 #ifdef WIN32
 #include <windows.h>
 #else
@@ -145,6 +146,11 @@ class GUI
 		 */
 		NewGameDialog& get_new_game();
 
+		/**
+		 * \brief Returns a reference to the profiler overlay.
+		 */
+		ProfilerOverlay& get_profiler();
+
 		/**
 		 * \brief Notifies the GUI that the escape key was pressed so that
 		 *        it can close windows if needed. Returns true if anything
@@ -199,8 +205,8 @@ class GUI
 		 *        given directory.
 		 * \param Name of the directory.
 		 * \param List box to be filled.
-		 * \param If true, the .lua extension will be cut from the file name
-		 *        if present.
+		 * \param If true, only save files (.lua and .sav) will be listed
+		 *        and their extension will be cut from the file name.
 		 */
 		void list_directory(const std::string&, CEGUI::Listbox&, bool = false);
 
@@ -276,4 +282,9 @@ class GUI
 		 * Provides interface for new level creation.
 		 */
 		NewGameDialog new_game_;
+
+		/**
+		 * Shows the timings of the profiler's zones.
+		 */
+		ProfilerOverlay profiler_;
 };
\ No newline at end of file
@@ -1,5 +1,5 @@
 #include <fstream>
-#include <tools/GameSerializer.hpp>
+#include <tools/QuickSaveRing.hpp>
 #include <tools/Camera.hpp>
 #include <Game.hpp>
 #include "OptionsWindow.hpp"
@@ -19,7 +19,7 @@ void OptionsWindow::add_start_parameters(Ogre::RenderWindow* window, Ogre::Viewp
 	view_ = view;
 	renderer_ = renderer;
 	
-	fullscreen_ = window->isFullScreen();
+	fullscreen_ = window ? window->isFullScreen() : false; // No window in the headless mode.
 	update_labels_();
 }
 
@@ -515,12 +515,12 @@ void action::QUICK_SAVE()
 {
 	auto game = GUI::instance().game_;
 	if(game)
-		game->game_serializer_->save_game(*game, "quick_save");
+		game->quick_save_ring_->save(*game);
 }
 
 void action::QUICK_LOAD()
 {
 	auto game = GUI::instance().game_;
 	if(game)
-		game->game_serializer_->save_game(*game, "quick_load");
+		game->quick_save_ring_->load(*game);
 }
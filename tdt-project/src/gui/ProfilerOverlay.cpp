@@ -0,0 +1,58 @@
+#include <CEGUI/CEGUI.h>
+#include <cstdio>
+#include <tools/Profiler.hpp>
+#include "ProfilerOverlay.hpp"
+
+namespace
+{
+	/**
+	 * Maximal number of shown zones (the most expensive ones).
+	 */
+	constexpr tdt::uint max_zones = 40;
+}
+
+ProfilerOverlay::ProfilerOverlay()
+	: zones_{}, time_since_refresh_{}, frames_{60}
+{ /* DUMMY BODY */ }
+
+void ProfilerOverlay::update(tdt::real delta)
+{
+	time_since_refresh_ += delta;
+	if(time_since_refresh_ < .5f)
+		return;
+	time_since_refresh_ = 0.f;
+
+	zones_->resetList();
+	if(!Profiler::instance().is_running())
+	{
+		zones_->addItem(new CEGUI::ListboxTextItem{"Profiler stopped, run game.profiler.start()."});
+		return;
+	}
+
+	auto stats = Profiler::instance().get_zone_stats(frames_);
+	char line[256]{};
+	std::snprintf(line, sizeof(line), "%9s %9s %6s  %s", "MS/FRAME", "MAX MS", "CALLS", "ZONE");
+	zones_->addItem(new CEGUI::ListboxTextItem{line});
+	for(tdt::uint i = 0; i < stats.size() && i < max_zones; ++i)
+	{
+		std::snprintf(line, sizeof(line), "%9.3f %9.3f %6u  %s", stats[i].time, stats[i].max,
+					  (unsigned int)stats[i].calls, stats[i].name.c_str());
+		zones_->addItem(new CEGUI::ListboxTextItem{line});
+	}
+}
+
+void ProfilerOverlay::set_frames(tdt::uint frames)
+{
+	if(frames > 0)
+		frames_ = frames;
+}
+
+tdt::uint ProfilerOverlay::get_frames() const
+{
+	return frames_;
+}
+
+void ProfilerOverlay::init_()
+{
+	zones_ = (CEGUI::Listbox*)window_->getChild("ZONES");
+}
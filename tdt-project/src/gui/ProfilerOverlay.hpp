@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Typedefs.hpp>
+#include "GUIWindow.hpp"
+
+namespace CEGUI
+{
+	class Listbox;
+}
+
+/**
+ * Overlay window that shows the zones recorded by the profiler in the last
+ * few frames (average time and number of calls per frame and the longest call).
+ */
+class ProfilerOverlay : public GUIWindow
+{
+	public:
+		/**
+		 * Constructor.
+		 */
+		ProfilerOverlay();
+
+		/**
+		 * Destructor.
+		 */
+		~ProfilerOverlay() = default;
+
+		/**
+		 * \brief Refreshes the shown timings twice per second.
+		 * \param Time since the last frame.
+		 */
+		void update(tdt::real);
+
+		/**
+		 * \brief Sets the number of last frames the timings are averaged over.
+		 * \param Number of frames.
+		 */
+		void set_frames(tdt::uint);
+
+		/**
+		 * \brief Returns the number of last frames the timings are averaged over.
+		 */
+		tdt::uint get_frames() const;
+
+	protected:
+		/**
+		 * \brief Initializes the overlay (called by parent's init).
+		 */
+		void init_() override;
+
+	private:
+		/**
+		 * List of the zones.
+		 */
+		CEGUI::Listbox* zones_;
+
+		/**
+		 * Time since the timings were refreshed.
+		 */
+		tdt::real time_since_refresh_;
+
+		/**
+		 * Number of frames the timings are averaged over.
+		 */
+		tdt::uint frames_;
+};
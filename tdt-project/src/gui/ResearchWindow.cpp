@@ -1,5 +1,6 @@
 #include <CEGUI/CEGUI.h>
 #include <tools/Player.hpp>
+#include <tools/Journal.hpp>
 #include <lppscript/LppScript.hpp>
 #include "ResearchWindow.hpp"
 
@@ -9,6 +10,9 @@ ResearchWindow::ResearchWindow()
 
 void ResearchWindow::unlock(tdt::uint i, tdt::uint j)
 {
+	Journal::instance().record(JOURNAL_COMMAND::RESEARCH, "", {i, j});
+	Journal::Scope scope{};
+
 	if(i > rows_ || j > cols_ || is_unlocked_(i, j)
 	   || !Player::instance().sub_gold(get_price_(i, j)))
 		return;
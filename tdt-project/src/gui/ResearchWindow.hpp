@@ -18,6 +18,7 @@ namespace lpp
 class ResearchWindow : public GUIWindow
 {
 	friend class GameSerializer;
+	friend class QuickSaveRing;
 	public:
 		/**
 		 * Constructor.
@@ -28,23 +28,25 @@ const std::string& ActivationHelper::get_blueprint(EntitySystem& ents, tdt::uint
 
 void ActivationHelper::activate(EntitySystem& ents, tdt::uint id)
 {
+	static const auto activate_fn = Symbol::get_function_id("activate");
 	ActivationComponent* comp;
 	GET_COMPONENT(id, ents, comp, ActivationComponent);
 	if(comp && !comp->activated)
 	{
 		comp->activated = true;
-		lpp::Script::instance().call<void, tdt::uint>(comp->blueprint + ".activate", id);
+		lpp::Script::instance().call<void, tdt::uint>(comp->blueprint.get_function(activate_fn), id);
 	}
 }
 
 void ActivationHelper::deactivate(EntitySystem& ents, tdt::uint id)
 {
+	static const auto deactivate_fn = Symbol::get_function_id("deactivate");
 	ActivationComponent* comp;
 	GET_COMPONENT(id, ents, comp, ActivationComponent);
 	if(comp && comp->activated)
 	{
 		comp->activated = false;
-		lpp::Script::instance().call<void, tdt::uint>(comp->blueprint + ".deactivate", id);
+		lpp::Script::instance().call<void, tdt::uint>(comp->blueprint.get_function(deactivate_fn), id);
 	}
 }
 
@@ -1,6 +1,7 @@
 #include <systems/EntitySystem.hpp>
 #include <tools/SelectionBox.hpp>
 #include <tools/Grid.hpp>
+#include <tools/Journal.hpp>
 #include <gui/GUI.hpp>
 #include <helpers/Helpers.hpp>
 #include <systems/CombatSystem.hpp>
@@ -32,6 +33,10 @@ bool CommandHelper::test_command(EntitySystem& ents, tdt::uint id, COMMAND_TYPE
 
 void CommandHelper::command_to_mine(EntitySystem& ents, SelectionBox& selection)
 {
+	Journal::instance().record(JOURNAL_COMMAND::COMMAND, "", selection.get_selected_entities(),
+							   0.f, 0.f, (tdt::uint)COMMAND_TYPE::MINE);
+	Journal::Scope scope{};
+
 	if(selection.get_selected_entities().empty())
 		return;
 	std::size_t target = selection.get_selected_entities()[0];
@@ -77,6 +82,10 @@ void CommandHelper::command_to_mine(EntitySystem& ents, SelectionBox& selection)
 
 void CommandHelper::command_to_attack(EntitySystem& ents, SelectionBox& selection)
 {
+	Journal::instance().record(JOURNAL_COMMAND::COMMAND, "", selection.get_selected_entities(),
+							   0.f, 0.f, (tdt::uint)COMMAND_TYPE::ATTACK);
+	Journal::Scope scope{};
+
 	if(selection.get_selected_entities().empty())
 		return;
 	std::size_t target = selection.get_selected_entities()[0];
@@ -116,6 +125,9 @@ void CommandHelper::command_to_attack(EntitySystem& ents, SelectionBox& selectio
 
 void CommandHelper::command_to_reposition(EntitySystem& ents, Ogre::Real x, Ogre::Real y)
 {
+	Journal::instance().record(JOURNAL_COMMAND::COMMAND, "", {}, x, y, (tdt::uint)COMMAND_TYPE::REPOSITION);
+	Journal::Scope scope{};
+
 	auto target = Grid::instance().get_node_from_position(x, y);
 
 	// Find soldier with the smallest task queue (if more are found, take the closest).
@@ -153,6 +165,9 @@ void CommandHelper::command_to_reposition(EntitySystem& ents, Ogre::Real x, Ogre
 
 void CommandHelper::command_to_return_gold(EntitySystem& ents, CombatSystem& combat)
 {
+	Journal::instance().record(JOURNAL_COMMAND::COMMAND, "", {}, 0.f, 0.f, (tdt::uint)COMMAND_TYPE::RETURN_GOLD);
+	Journal::Scope scope{};
+
 	for(const auto& ent : ents.get_component_container<CommandComponent>())
 	{
 		if(!ent.second.possible_commands.test((std::size_t)COMMAND_TYPE::RETURN_GOLD))
@@ -177,6 +192,9 @@ void CommandHelper::command_to_return_gold(EntitySystem& ents, CombatSystem& com
 
 void CommandHelper::command_to_fall_back(EntitySystem& ents)
 {
+	Journal::instance().record(JOURNAL_COMMAND::COMMAND, "", {}, 0.f, 0.f, (tdt::uint)COMMAND_TYPE::FALL_BACK);
+	Journal::Scope scope{};
+
 	for(const auto& ent : ents.get_component_container<CommandComponent>())
 	{
 		if(!ent.second.possible_commands.test((std::size_t)COMMAND_TYPE::FALL_BACK))
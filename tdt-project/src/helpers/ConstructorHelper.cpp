@@ -28,8 +28,9 @@ const std::string& ConstructorHelper::get_blueprint(EntitySystem& ents, tdt::uin
 
 void ConstructorHelper::call(EntitySystem& ents, tdt::uint id)
 {
+	static const auto construct_fn = Symbol::get_function_id("construct");
 	ConstructorComponent* comp{nullptr};
 	GET_COMPONENT(id, ents, comp, ConstructorComponent);
 	if(comp)
-		lpp::Script::instance().call<void, tdt::uint>(comp->blueprint + ".construct", id);
+		lpp::Script::instance().call<void, tdt::uint>(comp->blueprint.get_function(construct_fn), id);
 }
@@ -2,6 +2,7 @@
 #include <Cache.hpp>
 #include <systems/EntitySystem.hpp>
 #include <tools/Util.hpp>
+#include <tools/ScriptBatch.hpp>
 #include <lppscript/LppScript.hpp>
 #include "DestructorHelper.hpp"
 
@@ -29,9 +30,23 @@ const std::string & DestructorHelper::get_blueprint(EntitySystem& ents, tdt::uin
 
 void DestructorHelper::destroy(EntitySystem& ents, tdt::uint id, bool supress_dtor, tdt::uint killer)
 {
+	static const auto dtor_fn = Symbol::get_function_id("dtor");
 	DestructorComponent* comp{nullptr};
 	GET_COMPONENT(id, ents, comp, DestructorComponent);
 	if(comp && !supress_dtor)
-		lpp::Script::instance().call<void, tdt::uint, tdt::uint>(comp->blueprint + ".dtor", id, killer);
+		lpp::Script::instance().call<void, tdt::uint, tdt::uint>(comp->blueprint.get_function(dtor_fn), id, killer);
 	util::EntityDestroyer::destroy(ents, id);
 }
+
+void DestructorHelper::destroy(EntitySystem& ents, tdt::uint id, ScriptBatch& batch, tdt::uint killer)
+{
+	DestructorComponent* comp{nullptr};
+	GET_COMPONENT(id, ents, comp, DestructorComponent);
+	if(comp && batch.is_batched(comp->blueprint))
+	{
+		batch.add(comp->blueprint, id, killer);
+		util::EntityDestroyer::destroy(ents, id);
+	}
+	else
+		destroy(ents, id, false, killer);
+}
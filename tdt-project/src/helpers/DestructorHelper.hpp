@@ -4,6 +4,7 @@
 #include <Components.hpp>
 #include <Typedefs.hpp>
 class EntitySystem;
+class ScriptBatch;
 
 /**
  * Namespace containing auxiliary functions that help with the management of
@@ -36,4 +37,15 @@ namespace DestructorHelper
 	 * \param ID of the killer (if any).
 	 */
 	void destroy(EntitySystem&, tdt::uint, bool = false, tdt::uint = Component::NO_ENTITY);
+
+	/**
+	 * \brief Destroys a given entity, if it's destructor blueprint defines the "dtor_batch"
+	 *        function, the entity is added to a batch instead of calling it's destructor
+	 *        (used when many entities die at once, the caller then calls the batch).
+	 * \param EntitySystem containing the entity.
+	 * \param ID of the entity.
+	 * \param Batch of destructors (with the killers as arguments).
+	 * \param ID of the killer (if any).
+	 */
+	void destroy(EntitySystem&, tdt::uint, ScriptBatch&, tdt::uint = Component::NO_ENTITY);
 }
\ No newline at end of file
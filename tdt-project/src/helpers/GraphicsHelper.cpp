@@ -1,12 +1,33 @@
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
 #include <Components.hpp>
 #include <Cache.hpp>
 #include <systems/EntitySystem.hpp>
+#include <tools/Util.hpp>
 #include "GraphicsHelper.hpp"
 
 #if CACHE_ALLOWED == 1
 static tdt::cache::GraphicsCache cache{Component::NO_ENTITY, nullptr};
 #endif
 
+namespace
+{
+	/**
+	 * Chunks of the Ogre mesh format. The file starts with the header chunk (ID followed
+	 * by a version string ending with a newline), all other chunks consist of their ID,
+	 * their size (including the ID and the size) and their data. The mesh chunk starts
+	 * with a bool (skeletally animated) followed by it's sub chunks, one of which contains
+	 * the minimum and maximum corners of the bounding box and the bounding radius.
+	 */
+	constexpr Ogre::uint16 mesh_header_chunk = 0x1000;
+	constexpr Ogre::uint16 mesh_chunk = 0x3000;
+	constexpr Ogre::uint16 mesh_bounds_chunk = 0x9000;
+	constexpr std::size_t mesh_chunk_header_size = sizeof(Ogre::uint16) + sizeof(Ogre::uint32);
+}
+
 void GraphicsHelper::set_mesh(EntitySystem& ents, tdt::uint id, const std::string& mesh)
 {
 	GraphicsComponent* comp{nullptr};
@@ -150,16 +171,84 @@ void GraphicsHelper::rotate(EntitySystem& ents, tdt::uint id, Ogre::Real delta,
 	}
 }
 
-const Ogre::AxisAlignedBox& GraphicsHelper::get_bounds(EntitySystem& ents, tdt::uint id)
+Ogre::AxisAlignedBox GraphicsHelper::get_bounds(EntitySystem& ents, tdt::uint id, bool update)
 {
 	GraphicsComponent* comp{nullptr};
 	GET_COMPONENT(id, ents, comp, GraphicsComponent);
-	if(comp)
-		return comp->entity->getWorldBoundingBox();
+	if(comp && comp->entity)
+		return comp->entity->getWorldBoundingBox(update);
+	else if(comp && comp->node && util::is_headless())
+	{
+		auto box = get_mesh_bounds(comp->mesh);
+		if(!box.isNull())
+		{
+			auto& position = comp->node->getPosition();
+			box.scale(comp->node->getScale());
+			box.setExtents(box.getMinimum() + position, box.getMaximum() + position);
+		}
+		return box;
+	}
 	else
 		return Ogre::AxisAlignedBox::BOX_NULL; // TODO: Test this vs BOX_INFINITE.
 }
 
+const Ogre::AxisAlignedBox& GraphicsHelper::get_mesh_bounds(const std::string& mesh)
+{
+	static std::map<std::string, Ogre::AxisAlignedBox> bounds{};
+	static std::mutex bounds_mutex{};
+
+	std::lock_guard<std::mutex> lock{bounds_mutex};
+	auto it = bounds.find(mesh);
+	if(it != bounds.end())
+		return it->second;
+
+	Ogre::AxisAlignedBox box{};
+	try
+	{
+		auto stream = Ogre::ResourceGroupManager::getSingleton().openResource(mesh);
+		std::vector<char> data(stream->size());
+		stream->read(data.data(), data.size());
+
+		Ogre::uint16 chunk_id{};
+		Ogre::uint32 chunk_size{};
+		std::size_t pos{data.size()};
+		if(data.size() >= sizeof(chunk_id))
+			std::memcpy(&chunk_id, data.data(), sizeof(chunk_id));
+		if(chunk_id == mesh_header_chunk) // Otherwise not a (little endian) mesh.
+			pos = (std::find(data.begin(), data.end(), '\n') - data.begin()) + 1;
+
+		while(pos + mesh_chunk_header_size <= data.size())
+		{
+			std::memcpy(&chunk_id, &data[pos], sizeof(chunk_id));
+			std::memcpy(&chunk_size, &data[pos + sizeof(chunk_id)], sizeof(chunk_size));
+			if(chunk_size < mesh_chunk_header_size)
+				break; // Corrupted.
+
+			if(chunk_id == mesh_chunk)
+			{ // Enter the mesh chunk, it's sub chunks follow the skeletally animated flag.
+				pos += mesh_chunk_header_size + sizeof(bool);
+				continue;
+			}
+			else if(chunk_id == mesh_bounds_chunk)
+			{
+				float extents[6]{};
+				if(pos + mesh_chunk_header_size + sizeof(extents) <= data.size())
+				{
+					std::memcpy(extents, &data[pos + mesh_chunk_header_size], sizeof(extents));
+					if(extents[0] <= extents[3] && extents[1] <= extents[4] && extents[2] <= extents[5])
+						box.setExtents(extents[0], extents[1], extents[2], extents[3], extents[4], extents[5]);
+				}
+				break;
+			}
+			pos += chunk_size;
+		}
+	}
+	catch(const Ogre::Exception&)
+	{ /* Mesh not found, use the null box. */ }
+
+	return bounds.emplace(mesh, box).first->second;
+}
+
 bool GraphicsHelper::collide(EntitySystem& ents, tdt::uint id1, tdt::uint id2)
 {
 	return get_bounds(ents, id1).intersects(get_bounds(ents, id2));
@@ -182,22 +271,25 @@ void GraphicsHelper::init_graphics_component(EntitySystem& ents, Ogre::SceneMana
 	if(!comp->node)
 		comp->node = scene.getRootSceneNode()->createChildSceneNode("entity_" + std::to_string(id));
 	
-	comp->entity = scene.createEntity(comp->mesh);
-	comp->entity->setRenderingDistance(4000.f);
-	comp->node->attachObject(comp->entity);
-	comp->node->setVisible(comp->visible);
+	if(!util::is_headless())
+	{ // Only the scene node is kept in the headless mode.
+		comp->entity = scene.createEntity(comp->mesh);
+		comp->entity->setRenderingDistance(4000.f);
+		comp->node->attachObject(comp->entity);
 
 #if NO_SHADOWS == 1
-	comp->entity->setCastShadows(false);
+		comp->entity->setCastShadows(false);
 #endif
+	}
+	comp->node->setVisible(comp->visible);
 
 	if(comp->manual_scaling)
 		comp->node->setScale(comp->scale);
 
-	if(comp->material != "NO_MAT")
+	if(comp->entity && comp->material != "NO_MAT")
 		comp->entity->setMaterialName(comp->material);
 
-	auto half_height = comp->entity->getWorldBoundingBox(true).getHalfSize().y;
+	auto half_height = get_bounds(ents, id, true).getHalfSize().y;
 	auto phys_comp = ents.get_component<PhysicsComponent>(id);
 	if(phys_comp)
 	{
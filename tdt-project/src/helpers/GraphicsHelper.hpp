@@ -122,10 +122,21 @@ namespace GraphicsHelper
 	 * \brief Returns a given entity's bounding box.
 	 * \param Reference to the entity system that contains components.
 	 * \param ID of th entity.
+	 * \param If true, the bounding box is recalculated (e.g. after scaling).
 	 * \note The entity has to have a GraphicsComponent, because collision detection is
-	 *       done using Ogre's bounding boxes.
+	 *       done using Ogre's bounding boxes. In the headless mode, the box is calculated
+	 *       from the mesh bounds, the scale and the position of the entity's scene node
+	 *       (rotations are ignored).
 	 */
-	const Ogre::AxisAlignedBox& get_bounds(EntitySystem&, tdt::uint);
+	Ogre::AxisAlignedBox get_bounds(EntitySystem&, tdt::uint, bool = false);
+
+	/**
+	 * \brief Returns the bounding box of a given mesh (in model space) as stored
+	 *        in the mesh file, used instead of Ogre entities in the headless mode.
+	 * \param Name of the mesh.
+	 * \note Returns a null box if the mesh cannot be read.
+	 */
+	const Ogre::AxisAlignedBox& get_mesh_bounds(const std::string&);
 
 	/**
 	 * \brief Returns true if two given entities collide, false otherwise.
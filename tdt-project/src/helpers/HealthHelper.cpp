@@ -3,6 +3,7 @@
 #include <systems/EntitySystem.hpp>
 #include <gui/GUI.hpp>
 #include <gui/EntityTracker.hpp>
+#include <tools/PathService.hpp>
 #include "HealthHelper.hpp"
 
 #if CACHE_ALLOWED == 1
@@ -18,6 +19,8 @@ void HealthHelper::set_health(EntitySystem& ents, tdt::uint id, tdt::uint val)
 		if(val == 0)
 			comp->alive = false;
 		comp->curr_hp = val;
+		// Pathfinding costs of the nodes a structure stands on may depend on it's health.
+		PathService::instance().invalidate_costs(ents, id);
 		auto& tracker = GUI::instance().get_tracker();
 		if(tracker.get_tracked_entity() == id)
 			tracker.update_tracking("HP_VALUE", std::to_string(comp->curr_hp)
@@ -42,6 +45,7 @@ void HealthHelper::add_health(EntitySystem& ents, tdt::uint id, tdt::uint val)
 	if(comp)
 	{
 		comp->curr_hp = (comp->curr_hp + val >= comp->max_hp ? comp->max_hp : comp->curr_hp + val);
+		PathService::instance().invalidate_costs(ents, id);
 		auto& tracker = GUI::instance().get_tracker();
 		if(tracker.get_tracked_entity() == id)
 			tracker.update_tracking("HP_VALUE", std::to_string(comp->curr_hp)
@@ -65,6 +69,7 @@ void HealthHelper::sub_health(EntitySystem& ents, tdt::uint id, tdt::uint val, b
 		}
 		else
 			comp->curr_hp -= val;
+		PathService::instance().invalidate_costs(ents, id);
 		auto& tracker = GUI::instance().get_tracker();
 		if(tracker.get_tracked_entity() == id)
 			tracker.update_tracking("HP_VALUE", std::to_string(comp->curr_hp)
@@ -79,6 +84,7 @@ void HealthHelper::heal(EntitySystem& ents, tdt::uint id)
 	if(comp)
 	{
 		comp->curr_hp = comp->max_hp;
+		PathService::instance().invalidate_costs(ents, id);
 		auto& tracker = GUI::instance().get_tracker();
 		if(tracker.get_tracked_entity() == id)
 			tracker.update_tracking("HP_VALUE", std::to_string(comp->curr_hp)
@@ -94,6 +100,7 @@ void HealthHelper::buff(EntitySystem& ents, tdt::uint id, tdt::uint val)
 	{
 		comp->max_hp += val;
 		comp->curr_hp += val;
+		PathService::instance().invalidate_costs(ents, id);
 		auto& tracker = GUI::instance().get_tracker();
 		if(tracker.get_tracked_entity() == id)
 			tracker.update_tracking("HP_VALUE", std::to_string(comp->curr_hp)
@@ -117,6 +124,7 @@ void HealthHelper::debuff(EntitySystem& ents, tdt::uint id, tdt::uint val)
 			comp->max_hp -= val;
 			comp->curr_hp -= val;
 		}
+		PathService::instance().invalidate_costs(ents, id);
 		auto& tracker = GUI::instance().get_tracker();
 		if(tracker.get_tracked_entity() == id)
 			tracker.update_tracking("HP_VALUE", std::to_string(comp->curr_hp)
@@ -165,7 +173,10 @@ void HealthHelper::set_defense(EntitySystem& ents, tdt::uint id, tdt::uint val)
 	HealthComponent* comp{nullptr};
 	GET_COMPONENT(id, ents, comp, HealthComponent);
 	if(comp)
+	{
 		comp->defense = val;
+		PathService::instance().invalidate_costs(ents, id);
+	}
 }
 
 tdt::uint HealthHelper::get_defense(EntitySystem& ents, tdt::uint id)
@@ -183,7 +194,10 @@ void HealthHelper::add_defense(EntitySystem& ents, tdt::uint id, tdt::uint val)
 	HealthComponent* comp{nullptr};
 	GET_COMPONENT(id, ents, comp, HealthComponent);
 	if(comp)
+	{
 		comp->defense += val;
+		PathService::instance().invalidate_costs(ents, id);
+	}
 }
 
 void HealthHelper::sub_defense(EntitySystem& ents, tdt::uint id, tdt::uint val)
@@ -196,6 +210,7 @@ void HealthHelper::sub_defense(EntitySystem& ents, tdt::uint id, tdt::uint val)
 			comp->defense = 0;
 		else
 			comp->defense -= val;
+		PathService::instance().invalidate_costs(ents, id);
 	}
 }
 
@@ -208,6 +223,7 @@ void HealthHelper::ubercharge(EntitySystem& ents, tdt::uint id)
 		comp->curr_hp = Component::NO_ENTITY;
 		comp->max_hp = Component::NO_ENTITY;
 		comp->defense = Component::NO_ENTITY;
+		PathService::instance().invalidate_costs(ents, id);
 		auto& tracker = GUI::instance().get_tracker();
 		if(tracker.get_tracked_entity() == id)
 			tracker.update_tracking("HP_VALUE", "UBER");
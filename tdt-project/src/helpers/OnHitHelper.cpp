@@ -28,12 +28,13 @@ const std::string& OnHitHelper::get_blueprint(EntitySystem& ents, tdt::uint id)
 
 void OnHitHelper::call(EntitySystem& ents, tdt::uint id, tdt::uint hitter)
 {
+	static const auto on_hit_fn = Symbol::get_function_id("on_hit");
 	OnHitComponent* comp{nullptr};
 	GET_COMPONENT(id, ents, comp, OnHitComponent);
 	if(comp && comp->curr_time >= comp->cooldown)
 	{
 		comp->curr_time = 0.f;
-		lpp::Script::instance().call<void, tdt::uint, tdt::uint>(comp->blueprint + ".on_hit", id, hitter);
+		lpp::Script::instance().call<void, tdt::uint, tdt::uint>(comp->blueprint.get_function(on_hit_fn), id, hitter);
 	}
 }
 
@@ -40,12 +40,14 @@ std::deque<tdt::uint>& PathfindingHelper::get_path(EntitySystem& ents, tdt::uint
 
 bool PathfindingHelper::can_break(tdt::uint id1, const PathfindingComponent& comp, tdt::uint id2)
 {
-	return lpp::Script::instance().call<bool, tdt::uint, tdt::uint>(comp.blueprint + ".can_break", id1, id2);
+	static const auto can_break_fn = Symbol::get_function_id("can_break");
+	return lpp::Script::instance().call<bool, tdt::uint, tdt::uint>(comp.blueprint.get_function(can_break_fn), id1, id2);
 }
 
 tdt::real PathfindingHelper::get_cost(tdt::uint id1, const PathfindingComponent& comp, tdt::uint id2, DIRECTION::VAL dir)
 {
-	auto cost = lpp::Script::instance().call<tdt::real, tdt::uint, tdt::uint>(comp.blueprint + ".get_cost", id1, id2);
+	static const auto get_cost_fn = Symbol::get_function_id("get_cost");
+	auto cost = lpp::Script::instance().call<tdt::real, tdt::uint, tdt::uint>(comp.blueprint.get_function(get_cost_fn), id1, id2);
 	if(cost <= 0.f)
 		cost = 1.f;
 	if(dir == DIRECTION::UP_LEFT || dir == DIRECTION::UP_RIGHT || dir == DIRECTION::DOWN_LEFT || dir == DIRECTION::DOWN_RIGHT)
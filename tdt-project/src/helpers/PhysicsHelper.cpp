@@ -33,6 +33,7 @@ void PhysicsHelper::set_position(EntitySystem& ents, tdt::uint id, const Ogre::V
 	if(comp)
 	{
 		comp->position = val;
+		ents.mark_moved();
 		auto graph = ents.get_component<GraphicsComponent>(id);
 		if(graph && graph->node)
 			graph->node->setPosition(val);
@@ -76,6 +77,7 @@ void PhysicsHelper::move_to(EntitySystem& ents, tdt::uint id, Ogre::Vector3 pos)
 	if(comp)
 	{
 		comp->position = pos;
+		ents.mark_moved();
 
 		auto graph_comp = ents.get_component<GraphicsComponent>(id);
 		if(graph_comp)
@@ -2,12 +2,15 @@
 #include <Cache.hpp>
 #include <systems/EntitySystem.hpp>
 #include <lppscript/LppScript.hpp>
+#include <tools/Util.hpp>
 #include "SelectionHelper.hpp"
 
 #if CACHE_ALLOWED == 1
 static tdt::cache::SelectionCache cache{Component::NO_ENTITY, nullptr};
 #endif
 
+static const Symbol no_blueprint{"ERROR"};
+
 void SelectionHelper::set_blueprint(EntitySystem& ents, tdt::uint id, const std::string& blueprint)
 {
 	SelectionComponent* comp{nullptr};
@@ -46,15 +49,16 @@ const std::string& SelectionHelper::get_material(EntitySystem& ents, tdt::uint i
 
 bool SelectionHelper::select(EntitySystem& ents, tdt::uint id, bool single)
 {
+	static const auto select_fn = Symbol::get_function_id("select");
 	SelectionComponent* comp{nullptr};
 	GET_COMPONENT(id, ents, comp, SelectionComponent);
 	if(comp)
 	{
-		if(comp->blueprint != "ERROR")
-			lpp::Script::instance().call<void, tdt::uint, bool>(comp->blueprint + ".select", id, single);
+		if(comp->blueprint != no_blueprint)
+			lpp::Script::instance().call<void, tdt::uint, bool>(comp->blueprint.get_function(select_fn), id, single);
 
-		if(!comp->entity)
-		{
+		if(!comp->entity && !util::is_headless())
+		{ // Markers are not shown in the headless mode.
 			auto graph = ents.get_component<GraphicsComponent>(id);
 			if(graph && graph->node)
 			{ // Should always be non-null, but just to be sure.
@@ -96,12 +100,13 @@ bool SelectionHelper::select(EntitySystem& ents, tdt::uint id, bool single)
 
 bool SelectionHelper::deselect(EntitySystem& ents, tdt::uint id)
 {
+	static const auto deselect_fn = Symbol::get_function_id("deselect");
 	SelectionComponent* comp{nullptr};
 	GET_COMPONENT(id, ents, comp, SelectionComponent);
 	if(comp)
 	{
-		if(comp->blueprint != "ERROR")
-			lpp::Script::instance().call<void, tdt::uint>(comp->blueprint + ".deselect", id);
+		if(comp->blueprint != no_blueprint)
+			lpp::Script::instance().call<void, tdt::uint>(comp->blueprint.get_function(deselect_fn), id);
 
 		if(comp->entity)
 		{
@@ -72,8 +72,9 @@ tdt::real SpellHelper::get_curr_time(EntitySystem& ents, tdt::uint id)
 
 void SpellHelper::cast(EntitySystem& ents, tdt::uint id)
 {
+	static const auto cast_fn = Symbol::get_function_id("cast");
 	SpellComponent* comp{nullptr};
 	GET_COMPONENT(id, ents, comp, SpellComponent);
 	if(comp)
-		lpp::Script::instance().call<void, tdt::uint>(comp->blueprint + ".cast", id);
+		lpp::Script::instance().call<void, tdt::uint>(comp->blueprint.get_function(cast_fn), id);
 }
@@ -23,7 +23,7 @@ bool TaskHandlerHelper::task_possible(EntitySystem& ents, tdt::uint id, tdt::uin
 {
 	TaskHandlerComponent* comp1{nullptr};
 	GET_COMPONENT(id, ents, comp1, TaskHandlerComponent);
-	auto comp2 = ents.get_component<TaskComponent>(task_id);
+	auto comp2 = ents.get_task_pool().get(task_id);
 	if(comp1 && comp2)
 		return comp1->possible_tasks.test((tdt::uint)comp2->task_type);
 	else
@@ -47,11 +47,9 @@ void TaskHandlerHelper::clear_task_queue(EntitySystem& ents, tdt::uint id)
 	if(comp)
 	{
 		auto& task_queue = comp->task_queue;
+		auto& tasks = ents.get_task_pool();
 		for(auto& task : task_queue)
-		{
-			if(ents.has_component<TaskComponent>(task))
-				DestructorHelper::destroy(ents, task);
-		}
+			tasks.destroy(task);
 		task_queue.clear();
 	}
 }
@@ -89,3 +87,25 @@ const std::string& TaskHandlerHelper::get_blueprint(EntitySystem& ents, tdt::uin
 	else
 		return ents.NO_BLUEPRINT;
 }
+
+
+void TaskHandlerHelper::set_wait_condition(EntitySystem& ents, tdt::uint id, TASK_WAIT cond, tdt::real time)
+{
+	TaskHandlerComponent* comp{nullptr};
+	GET_COMPONENT(id, ents, comp, TaskHandlerComponent);
+	if(comp && (tdt::uint)cond < (tdt::uint)TASK_WAIT::COUNT)
+	{
+		comp->wait_condition = cond;
+		comp->wait_time = time;
+	}
+}
+
+TASK_WAIT TaskHandlerHelper::get_wait_condition(EntitySystem& ents, tdt::uint id)
+{
+	TaskHandlerComponent* comp{nullptr};
+	GET_COMPONENT(id, ents, comp, TaskHandlerComponent);
+	if(comp)
+		return comp->wait_condition;
+	else
+		return TASK_WAIT::NONE;
+}
\ No newline at end of file
@@ -71,4 +71,22 @@ namespace TaskHandlerHelper
 	 * \param ID of the entity.
 	 */
 	const std::string& get_blueprint(EntitySystem&, tdt::uint);
+
+	/**
+	 * \brief Makes the current task of a given entity wait for a condition, the
+	 *        task_complete function of its blueprint will not be called until
+	 *        the condition is met.
+	 * \param EntitySystem that contains the entity.
+	 * \param ID of the entity.
+	 * \param The condition to wait for.
+	 * \param Time to wait (in seconds) when waiting for TASK_WAIT::TIME.
+	 */
+	void set_wait_condition(EntitySystem&, tdt::uint, TASK_WAIT, tdt::real = 0.f);
+
+	/**
+	 * \brief Returns the condition the current task of a given entity waits for.
+	 * \param EntitySystem that contains the entity.
+	 * \param ID of the entity.
+	 */
+	TASK_WAIT get_wait_condition(EntitySystem&, tdt::uint);
 }
\ No newline at end of file
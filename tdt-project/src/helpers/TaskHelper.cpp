@@ -1,24 +1,17 @@
 #include <Components.hpp>
-#include <Cache.hpp>
 #include <systems/EntitySystem.hpp>
 #include "TaskHelper.hpp"
 
-#if CACHE_ALLOWED == 1
-static tdt::cache::TaskCache cache{Component::NO_ENTITY, nullptr};
-#endif
-
 void TaskHelper::set_task_source(EntitySystem& ents, tdt::uint id, tdt::uint source)
 {
-	TaskComponent* comp{nullptr};
-	GET_COMPONENT(id, ents, comp, TaskComponent);
+	auto comp = ents.get_task_pool().get(id);
 	if(comp)
 		comp->source = source;
 }
 
 tdt::uint TaskHelper::get_task_source(EntitySystem& ents, tdt::uint id)
 {
-	TaskComponent* comp{nullptr};
-	GET_COMPONENT(id, ents, comp, TaskComponent);
+	auto comp = ents.get_task_pool().get(id);
 	if(comp)
 		return comp->source;
 	else
@@ -27,16 +20,14 @@ tdt::uint TaskHelper::get_task_source(EntitySystem& ents, tdt::uint id)
 
 void TaskHelper::set_task_target(EntitySystem& ents, tdt::uint id, tdt::uint target)
 {
-	TaskComponent* comp{nullptr};
-	GET_COMPONENT(id, ents, comp, TaskComponent);
+	auto comp = ents.get_task_pool().get(id);
 	if(comp)
 		comp->target = target;
 }
 
 tdt::uint TaskHelper::get_task_target(EntitySystem& ents, tdt::uint id)
 {
-	TaskComponent* comp{nullptr};
-	GET_COMPONENT(id, ents, comp, TaskComponent);
+	auto comp = ents.get_task_pool().get(id);
 	if(comp)
 		return comp->target;
 	else
@@ -45,16 +36,14 @@ tdt::uint TaskHelper::get_task_target(EntitySystem& ents, tdt::uint id)
 
 void TaskHelper::set_task_type(EntitySystem& ents, tdt::uint id, TASK_TYPE type)
 {
-	TaskComponent* comp{nullptr};
-	GET_COMPONENT(id, ents, comp, TaskComponent);
+	auto comp = ents.get_task_pool().get(id);
 	if(comp)
 		comp->task_type = type;
 }
 
 TASK_TYPE TaskHelper::get_task_type(EntitySystem& ents, tdt::uint id)
 {
-	TaskComponent* comp{nullptr};
-	GET_COMPONENT(id, ents, comp, TaskComponent);
+	auto comp = ents.get_task_pool().get(id);
 	if(comp)
 		return comp->task_type;
 	else
@@ -64,8 +53,7 @@ TASK_TYPE TaskHelper::get_task_type(EntitySystem& ents, tdt::uint id)
 void TaskHelper::add_task(EntitySystem& ents, tdt::uint ent_id, tdt::uint task_id, bool priority)
 {
 	auto comp1 = ents.get_component<TaskHandlerComponent>(ent_id);
-	TaskComponent* comp2{nullptr};
-	GET_COMPONENT(task_id, ents, comp2, TaskComponent);
+	auto comp2 = ents.get_task_pool().get(task_id);
 	if(comp1 && comp2)
 	{
 		// Make sure the entity can handle this task.
@@ -91,24 +79,12 @@ void TaskHelper::add_task(EntitySystem& ents, tdt::uint ent_id, tdt::uint task_i
 
 tdt::uint TaskHelper::create_task(EntitySystem& ents, tdt::uint target, TASK_TYPE type)
 {
-	tdt::uint id = ents.create_entity();
-	ents.add_component<TaskComponent>(id);
-
-	TaskComponent* comp{nullptr};
-	GET_COMPONENT(id, ents, comp, TaskComponent);
-	if(comp)
-	{
-		comp->target = target;
-		comp->task_type = type;
-	}
-
-	return id;
+	return ents.get_task_pool().create(target, type);
 }
 
 void TaskHelper::cancel_task(EntitySystem& ents, tdt::uint id)
 {
-	TaskComponent* comp{nullptr};
-	GET_COMPONENT(id, ents, comp, TaskComponent);
+	auto comp = ents.get_task_pool().get(id);
 	if(comp)
 	{
 		auto handler = ents.get_component<TaskHandlerComponent>(comp->source);
@@ -122,22 +98,20 @@ void TaskHelper::cancel_task(EntitySystem& ents, tdt::uint id)
 			if(handler->curr_task == id)
 				handler->curr_task = Component::NO_ENTITY;
 		}
-		DestructorHelper::destroy(ents, id);
+		ents.get_task_pool().destroy(id);
 	}
 }
 
 void TaskHelper::set_complete(EntitySystem& ents, tdt::uint id)
 {
-	TaskComponent* comp{nullptr};
-	GET_COMPONENT(id, ents, comp, TaskComponent);
+	auto comp = ents.get_task_pool().get(id);
 	if(comp)
 		comp->complete = true;
 }
 
 bool TaskHelper::is_complete(EntitySystem& ents, tdt::uint id)
 {
-	TaskComponent* comp{nullptr};
-	GET_COMPONENT(id, ents, comp, TaskComponent);
+	auto comp = ents.get_task_pool().get(id);
 	if(comp)
 		return comp->complete;
 	else
@@ -65,7 +65,8 @@ namespace TaskHelper
 	void add_task(EntitySystem&, tdt::uint, tdt::uint, bool = false);
 
 	/**
-	 * \brief Creates a new task of a given tasks and returns it's ID.
+	 * \brief Creates a new task of a given tasks in the task pool and returns it's ID
+	 *        (the ID is a TaskPool handle, not an entity ID).
 	 * \param Reference to the entity system containing components.
 	 * \param ID of the task's target (goto location, kill target etc.).
 	 * \param Type of the task.
@@ -73,8 +74,8 @@ namespace TaskHelper
 	tdt::uint create_task(EntitySystem&, tdt::uint, TASK_TYPE);
 
 	/**
-	 * \brief Destroys the TaskComponent of a given task, effectively stopping
-	 *        it's completion.
+	 * \brief Removes a given task from its handler and destroys it,
+	 *        effectively stopping it's completion.
 	 * \param Reference to the entity system containing components.
 	 * \param ID of the task.
 	 */
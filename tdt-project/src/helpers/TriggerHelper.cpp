@@ -64,10 +64,11 @@ tdt::real TriggerHelper::get_cooldown(EntitySystem& ents, tdt::uint id)
 
 void TriggerHelper::trigger(EntitySystem& ents, tdt::uint id, tdt::uint target)
 {
+	static const auto trigger_fn = Symbol::get_function_id("trigger");
 	TriggerComponent* comp{nullptr};
 	GET_COMPONENT(id, ents, comp, TriggerComponent);
 	if(comp)
-		lpp::Script::instance().call<void, tdt::uint, tdt::uint>(comp->blueprint + ".trigger", id, target);
+		lpp::Script::instance().call<void, tdt::uint, tdt::uint>(comp->blueprint.get_function(trigger_fn), id, target);
 }
 
 bool TriggerHelper::can_be_triggered_by(EntitySystem& ents, tdt::uint id, tdt::uint target)
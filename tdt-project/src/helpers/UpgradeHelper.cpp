@@ -184,13 +184,14 @@ bool UpgradeHelper::can_level_up(EntitySystem& ents, tdt::uint id)
 
 void UpgradeHelper::upgrade(EntitySystem& ents, tdt::uint id)
 {
+	static const auto upgrade_fn = Symbol::get_function_id("upgrade");
 	UpgradeComponent* comp{nullptr};
 	GET_COMPONENT(id, ents, comp, UpgradeComponent);
 	if(comp && comp->level < comp->level_cap && comp->experience >= comp->exp_needed)
 	{
 		comp->experience = 0;
 		++comp->level;
-		lpp::Script::instance().call<void, tdt::uint>(comp->blueprint + ".upgrade", id);
+		lpp::Script::instance().call<void, tdt::uint>(comp->blueprint.get_function(upgrade_fn), id);
 
 		auto& tracker = GUI::instance().get_tracker();
 		if(tracker.get_tracked_entity() == id)
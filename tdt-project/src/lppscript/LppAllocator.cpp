@@ -0,0 +1,165 @@
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include "LppAllocator.hpp"
+
+constexpr std::size_t lpp::Allocator::granularity;
+constexpr std::size_t lpp::Allocator::max_pooled;
+constexpr std::size_t lpp::Allocator::arena_size;
+
+lpp::Allocator::Allocator()
+	: free_lists_(max_pooled / granularity + 1, nullptr),
+	  class_usage_(max_pooled / granularity + 1, 0),
+	  arenas_{}, stats_{}
+{ /* DUMMY BODY */ }
+
+lpp::Allocator::~Allocator()
+{
+	for(auto arena : arenas_)
+		std::free(arena);
+}
+
+void* lpp::Allocator::reallocate(void* ptr, std::size_t osize, std::size_t nsize)
+{
+	if(nsize == 0)
+	{
+		if(ptr)
+			free_(ptr, osize);
+		return nullptr;
+	}
+	else if(!ptr)
+		return allocate_(nsize);
+
+	auto old_class = size_class_(osize);
+	auto new_class = size_class_(nsize);
+	if(old_class != 0 && old_class == new_class)
+	{
+		stats_.in_use += nsize;
+		stats_.in_use -= osize;
+		return ptr;
+	}
+	else if(old_class == 0 && new_class == 0)
+	{
+		auto res = std::realloc(ptr, nsize);
+		if(res)
+		{
+			stats_.in_use += nsize;
+			stats_.in_use -= osize;
+			stats_.large += nsize;
+			stats_.large -= osize;
+		}
+		return res;
+	}
+
+	auto res = allocate_(nsize);
+	if(!res)
+	{
+		/**
+		 * Lua expects shrinking to never fail, the old block is kept and
+		 * will be freed to the (smaller) size class of the new size.
+		 */
+		if(nsize <= osize)
+		{
+			if(old_class == 0)
+				stats_.large -= osize;
+			else
+			{
+				--class_usage_[old_class];
+				stats_.pooled -= old_class * granularity;
+			}
+			if(new_class == 0)
+				stats_.large += nsize;
+			else
+			{
+				++class_usage_[new_class];
+				stats_.pooled += new_class * granularity;
+			}
+			stats_.in_use += nsize;
+			stats_.in_use -= osize;
+			return ptr;
+		}
+		return nullptr;
+	}
+
+	std::memcpy(res, ptr, std::min(osize, nsize));
+	free_(ptr, osize);
+
+	return res;
+}
+
+const lpp::Allocator::Stats& lpp::Allocator::get_stats() const
+{
+	return stats_;
+}
+
+const std::vector<std::size_t>& lpp::Allocator::get_class_usage() const
+{
+	return class_usage_;
+}
+
+void* lpp::Allocator::allocate_(std::size_t size)
+{
+	void* res{nullptr};
+	auto size_class = size_class_(size);
+	if(size_class == 0)
+	{
+		res = std::malloc(size);
+		if(!res)
+			return nullptr;
+		stats_.large += size;
+	}
+	else
+	{
+		if(!free_lists_[size_class] && !refill_(size_class))
+			return nullptr;
+
+		res = free_lists_[size_class];
+		free_lists_[size_class] = *static_cast<void**>(res);
+		++class_usage_[size_class];
+		stats_.pooled += size_class * granularity;
+	}
+	stats_.in_use += size;
+	++stats_.allocations;
+
+	return res;
+}
+
+void lpp::Allocator::free_(void* ptr, std::size_t size)
+{
+	auto size_class = size_class_(size);
+	if(size_class == 0)
+	{
+		std::free(ptr);
+		stats_.large -= size;
+	}
+	else
+	{
+		*static_cast<void**>(ptr) = free_lists_[size_class];
+		free_lists_[size_class] = ptr;
+		--class_usage_[size_class];
+		stats_.pooled -= size_class * granularity;
+	}
+	stats_.in_use -= size;
+	++stats_.frees;
+}
+
+bool lpp::Allocator::refill_(std::size_t size_class)
+{
+	auto arena = static_cast<char*>(std::malloc(arena_size));
+	if(!arena)
+		return false;
+	arenas_.push_back(arena);
+	stats_.arenas += arena_size;
+
+	// Blocks are linked so that they are handed out in the order of their addresses.
+	auto block_size = size_class * granularity;
+	auto count = arena_size / block_size;
+	for(std::size_t i = count; i > 0; --i)
+	{
+		auto block = arena + (i - 1) * block_size;
+		*reinterpret_cast<void**>(block) = free_lists_[size_class];
+		free_lists_[size_class] = block;
+	}
+
+	return true;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace lpp
+{
+
+/**
+ * Memory allocator of the Lua virtual machine. Most objects Lua allocates (strings, tables,
+ * closures, upvalues) are small and short lived, so blocks up to max_pooled bytes are taken
+ * from free lists of fixed size classes, which are refilled from large arenas. Bigger blocks
+ * (array parts of tables, long strings, bytecode) use malloc.
+ * Since Lua passes the original size of a block when freeing or reallocating it, the blocks
+ * have no headers. Memory of the arenas is kept for reuse until the allocator is destroyed.
+ * Note: Not thread safe, every Lua state needs it's own allocator.
+ */
+class Allocator
+{
+	public:
+		/**
+		 * Granularity of the size classes and the largest pooled block.
+		 */
+		static constexpr std::size_t granularity{16};
+		static constexpr std::size_t max_pooled{512};
+
+		/**
+		 * Size of a single arena.
+		 */
+		static constexpr std::size_t arena_size{64 * 1024};
+
+		/**
+		 * Memory usage of the allocator (in bytes).
+		 */
+		struct Stats
+		{
+			std::size_t in_use; // Requested by Lua.
+			std::size_t pooled; // Size of the pooled blocks in use.
+			std::size_t large; // Allocated by malloc.
+			std::size_t arenas; // Reserved by arenas.
+			std::size_t allocations; // Number of allocations so far.
+			std::size_t frees; // Number of frees so far.
+		};
+
+		/**
+		 * \brief Constructor.
+		 */
+		Allocator();
+
+		/**
+		 * \brief Destructor, releases all arenas.
+		 */
+		~Allocator();
+
+		Allocator(const Allocator&) = delete;
+		Allocator& operator=(const Allocator&) = delete;
+
+		/**
+		 * \brief Allocates, reallocates or frees a block, has the semantics of lua_Alloc.
+		 * \param Pointer to the block (nullptr for new blocks).
+		 * \param Original size of the block (ignored for new blocks).
+		 * \param New size of the block (0 to free it).
+		 */
+		void* reallocate(void*, std::size_t, std::size_t);
+
+		/**
+		 * \brief Returns the memory usage of the allocator.
+		 */
+		const Stats& get_stats() const;
+
+		/**
+		 * \brief Returns the number of pooled blocks in use per size class.
+		 */
+		const std::vector<std::size_t>& get_class_usage() const;
+
+	private:
+		/**
+		 * \brief Returns the size class of a block, 0 for blocks allocated by malloc.
+		 * \param Size of the block.
+		 */
+		static std::size_t size_class_(std::size_t size)
+		{
+			return size <= max_pooled ? (size + granularity - 1) / granularity : 0;
+		}
+
+		/**
+		 * \brief Allocates a new block, returns nullptr on failure.
+		 * \param Size of the block.
+		 */
+		void* allocate_(std::size_t);
+
+		/**
+		 * \brief Frees a block.
+		 * \param Pointer to the block.
+		 * \param Size of the block.
+		 */
+		void free_(void*, std::size_t);
+
+		/**
+		 * \brief Adds blocks of a given size class from a new arena to it's free list,
+		 *        returns false if the arena could not be allocated.
+		 * \param The size class.
+		 */
+		bool refill_(std::size_t);
+
+		/**
+		 * Heads of the free lists (the first bytes of a free block point to the next one),
+		 * indexed by the size class.
+		 */
+		std::vector<void*> free_lists_;
+
+		/**
+		 * Number of blocks in use per size class.
+		 */
+		std::vector<std::size_t> class_usage_;
+
+		/**
+		 * All allocated arenas.
+		 */
+		std::vector<void*> arenas_;
+
+		/**
+		 * Memory usage.
+		 */
+		Stats stats_;
+};
+
+}
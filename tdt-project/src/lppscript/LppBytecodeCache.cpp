@@ -0,0 +1,226 @@
+#ifdef WIN32
+#include <direct.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <tools/MappedFile.hpp>
+#include "LppBytecodeCache.hpp"
+
+namespace
+{
+	/**
+	 * \brief FNV-1a hash, used because it is the same on all platforms
+	 *        (the hashes are stored in the cache files).
+	 * \param The data.
+	 * \param Size of the data.
+	 */
+	std::uint64_t hash(const char* data, std::size_t size)
+	{
+		std::uint64_t res{14695981039346656037ULL};
+		for(std::size_t i = 0; i < size; ++i)
+		{
+			res ^= (unsigned char)data[i];
+			res *= 1099511628211ULL;
+		}
+
+		return res;
+	}
+
+	/**
+	 * \brief Creates a directory and all it's parents.
+	 * \param Name of the directory.
+	 */
+	void make_directories(const std::string& name)
+	{
+		for(std::size_t i = 0; i != std::string::npos && i < name.size();)
+		{
+			i = name.find_first_of("/\\", i + 1);
+			auto dir = name.substr(0, i);
+#ifdef WIN32
+			_mkdir(dir.c_str());
+#else
+			mkdir(dir.c_str(), 0755);
+#endif
+		}
+	}
+
+	/**
+	 * \brief Writer used by lua_dump, appends the bytecode to a string.
+	 */
+	int write_bytecode(lua_State*, const void* data, std::size_t size, void* res)
+	{
+		static_cast<std::string*>(res)->append(static_cast<const char*>(data), size);
+
+		return 0;
+	}
+}
+
+lpp::BytecodeCache::BytecodeCache(lua_State* L, const std::string& dir)
+	: L_{L}, directory_{dir}, enabled_{true}, directory_created_{false}, stats_{}
+{ /* DUMMY BODY */ }
+
+int lpp::BytecodeCache::load(const std::string& fname)
+{
+	struct stat info{};
+	if(!enabled_ || stat(fname.c_str(), &info) != 0)
+		return luaL_loadfile(L_, fname.c_str()); // Lua reports missing files.
+
+	Header header{};
+	std::memcpy(header.magic, "TDTB", sizeof(header.magic));
+	header.version = LUA_VERSION_NUM;
+	header.mtime = (std::uint64_t)info.st_mtime;
+	header.size = (std::uint64_t)info.st_size;
+	auto chunk_name = "@" + fname; // Same as luaL_loadfile.
+
+	std::string cached_code{};
+	std::uint64_t cached_hash{};
+	{
+		MappedFile cached{get_cache_name_(fname)};
+		if(cached.is_open() && cached.size() >= sizeof(Header))
+		{
+			Header old{};
+			std::memcpy(&old, cached.data(), sizeof(Header));
+			auto code = cached.data() + sizeof(Header) + old.path_length;
+			bool valid = std::memcmp(old.magic, header.magic, sizeof(header.magic)) == 0
+						 && old.version == header.version && old.size == header.size
+						 && sizeof(Header) + old.path_length + old.code_size == cached.size()
+						 && fname.compare(0, std::string::npos, cached.data() + sizeof(Header), old.path_length) == 0;
+
+			if(valid && old.mtime == header.mtime)
+			{
+				if(luaL_loadbufferx(L_, code, old.code_size, chunk_name.c_str(), "b") == LUA_OK)
+				{
+					++stats_.hits;
+					return LUA_OK;
+				}
+				lua_pop(L_, 1); // Corrupted, compile it again.
+			}
+			else if(valid)
+			{ // Modified (or just touched), has to be hashed.
+				cached_code.assign(code, old.code_size);
+				cached_hash = old.hash;
+			}
+		}
+	}
+
+	std::ifstream file{fname, std::ios::binary};
+	if(!file)
+		return luaL_loadfile(L_, fname.c_str());
+	std::string source{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+	header.hash = hash(source.data(), source.size());
+
+	if(!cached_code.empty() && cached_hash == header.hash)
+	{
+		if(luaL_loadbufferx(L_, cached_code.data(), cached_code.size(), chunk_name.c_str(), "b") == LUA_OK)
+		{
+			++stats_.hits;
+			write_(fname, header, cached_code.data(), cached_code.size()); // New modification time.
+			return LUA_OK;
+		}
+		lua_pop(L_, 1);
+	}
+
+	return compile_(fname, source, header);
+}
+
+void lpp::BytecodeCache::set_enabled(bool on_off)
+{
+	enabled_ = on_off;
+}
+
+bool lpp::BytecodeCache::is_enabled() const
+{
+	return enabled_;
+}
+
+void lpp::BytecodeCache::set_directory(const std::string& dir)
+{
+	directory_ = dir;
+	directory_created_ = false;
+}
+
+const std::string& lpp::BytecodeCache::get_directory() const
+{
+	return directory_;
+}
+
+const lpp::BytecodeCache::Stats& lpp::BytecodeCache::get_stats() const
+{
+	return stats_;
+}
+
+int lpp::BytecodeCache::compile_(const std::string& fname, const std::string& source, Header& header)
+{
+	// Skips the UTF-8 BOM and a first line comment (e.g. #!/usr/bin/lua) like luaL_loadfile,
+	// the new line is kept so that the line numbers don't change.
+	std::size_t start{};
+	if(source.compare(0, 3, "\xEF\xBB\xBF") == 0)
+		start = 3;
+	if(start < source.size() && source[start] == '#')
+	{
+		start = source.find('\n', start);
+		if(start == std::string::npos)
+			start = source.size();
+	}
+
+	++stats_.compiled;
+	auto res = luaL_loadbufferx(L_, source.data() + start, source.size() - start, ("@" + fname).c_str(), nullptr);
+	if(res != LUA_OK)
+		return res;
+
+	std::string code{};
+	if(lua_dump(L_, &write_bytecode, &code, 0) == 0)
+		write_(fname, header, code.data(), code.size());
+	else
+		++stats_.write_errors;
+
+	return res;
+}
+
+void lpp::BytecodeCache::write_(const std::string& fname, Header& header, const char* code, std::size_t size)
+{
+	if(!directory_created_)
+	{
+		make_directories(directory_);
+		directory_created_ = true;
+	}
+
+	header.path_length = (std::uint32_t)fname.size();
+	header.code_size = (std::uint32_t)size;
+
+	// Written to a temporary file first, so that a crash cannot leave a partial cache file.
+	auto cache_name = get_cache_name_(fname);
+	auto tmp_name = cache_name + ".tmp";
+	{
+		std::ofstream file{tmp_name, std::ios::binary | std::ios::trunc};
+		file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		file.write(fname.data(), fname.size());
+		file.write(code, size);
+		if(!file)
+		{
+			++stats_.write_errors;
+			file.close();
+			std::remove(tmp_name.c_str());
+			return;
+		}
+	}
+
+	std::remove(cache_name.c_str()); // Rename does not replace files on Windows.
+	if(std::rename(tmp_name.c_str(), cache_name.c_str()) != 0)
+	{
+		++stats_.write_errors;
+		std::remove(tmp_name.c_str());
+	}
+}
+
+std::string lpp::BytecodeCache::get_cache_name_(const std::string& fname) const
+{
+	char name[17]{};
+	std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)hash(fname.data(), fname.size()));
+
+	return directory_ + "/" + name + ".luac";
+}
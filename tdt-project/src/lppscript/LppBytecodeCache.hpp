@@ -0,0 +1,139 @@
+#pragma once
+
+#include <lua.hpp>
+#include <cstdint>
+#include <string>
+#include <Typedefs.hpp>
+
+namespace lpp
+{
+
+/**
+ * Cache of compiled Lua scripts. Every script is compiled once and it's bytecode (with debug
+ * info, so error messages stay the same) is stored in a file in the cache directory named after
+ * the hash of the script's path. The file starts with the modification time, size and content hash
+ * of the source, if the modification time and size of the script did not change, the bytecode
+ * is loaded straight from the mapped file without reading the source. If only the modification
+ * time changed, the source is hashed and recompiled only if it's content changed.
+ * This way, starting the game and reloading all scripts compiles only scripts that changed.
+ */
+class BytecodeCache
+{
+	public:
+		/**
+		 * Statistics of the cache.
+		 */
+		struct Stats
+		{
+			tdt::uint hits; // Loaded from the cache.
+			tdt::uint compiled; // Compiled (and stored in the cache).
+			tdt::uint write_errors; // Compiled but not stored.
+		};
+
+		/**
+		 * \brief Constructor.
+		 * \param The Lua state scripts are loaded into.
+		 * \param Directory containing the cached bytecode.
+		 */
+		BytecodeCache(lua_State*, const std::string& = "cache/scripts");
+
+		/**
+		 * \brief Loads a script as a function onto the Lua stack (like luaL_loadfile)
+		 *        and returns the Lua status code (error message is on the stack on failure).
+		 * \param Name of the script file.
+		 */
+		int load(const std::string&);
+
+		/**
+		 * \brief Turns the cache on or off (scripts are always compiled if off).
+		 * \param True to turn the cache on, false otherwise.
+		 */
+		void set_enabled(bool);
+
+		/**
+		 * \brief Returns true if the cache is enabled, false otherwise.
+		 */
+		bool is_enabled() const;
+
+		/**
+		 * \brief Sets the directory containing the cached bytecode (it is created if necessary).
+		 * \param Name of the directory.
+		 */
+		void set_directory(const std::string&);
+
+		/**
+		 * \brief Returns the directory containing the cached bytecode.
+		 */
+		const std::string& get_directory() const;
+
+		/**
+		 * \brief Returns the statistics of the cache.
+		 */
+		const Stats& get_stats() const;
+
+	private:
+		/**
+		 * Header of a cache file, followed by the path of the script and the bytecode.
+		 */
+		struct Header
+		{
+			char magic[4];
+			std::uint32_t version; // LUA_VERSION_NUM, bytecode is version specific.
+			std::uint64_t mtime;
+			std::uint64_t size;
+			std::uint64_t hash;
+			std::uint32_t path_length;
+			std::uint32_t code_size;
+		};
+
+		/**
+		 * \brief Compiles a script from it's source, pushes the function onto the stack
+		 *        and stores it's bytecode in the cache, returns the Lua status code.
+		 * \param Name of the script.
+		 * \param Source of the script.
+		 * \param Header describing the source.
+		 */
+		int compile_(const std::string&, const std::string&, Header&);
+
+		/**
+		 * \brief Writes a cache file.
+		 * \param Name of the script.
+		 * \param Header of the file.
+		 * \param The bytecode.
+		 * \param Size of the bytecode.
+		 */
+		void write_(const std::string&, Header&, const char*, std::size_t);
+
+		/**
+		 * \brief Returns the name of the cache file of a given script.
+		 * \param Name of the script.
+		 */
+		std::string get_cache_name_(const std::string&) const;
+
+		/**
+		 * The Lua state scripts are loaded into.
+		 */
+		lua_State* L_;
+
+		/**
+		 * Directory containing the cached bytecode.
+		 */
+		std::string directory_;
+
+		/**
+		 * If false, scripts are always compiled.
+		 */
+		bool enabled_;
+
+		/**
+		 * True if the directory has been created (or already existed).
+		 */
+		bool directory_created_;
+
+		/**
+		 * Statistics of the cache.
+		 */
+		Stats stats_;
+};
+
+}
@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <tools/Profiler.hpp>
+#include "LppGC.hpp"
+
+lpp::GCController::GCController(lua_State* L)
+	: L_{L}, manual_{false}, paused_{false}, frame_start_{std::chrono::steady_clock::now()},
+	  budget_{1.f}, frame_time_{1000.f / 60.f}, step_size_{16}, pause_{1.5f}, stats_{}
+{ /* DUMMY BODY */ }
+
+void lpp::GCController::set_manual(bool manual)
+{
+	if(manual == manual_)
+		return;
+
+	manual_ = manual;
+	if(manual_)
+	{
+		lua_gc(L_, LUA_GCSTOP, 0);
+		paused_ = false;
+		stats_.live = get_memory_();
+	}
+	else
+		lua_gc(L_, LUA_GCRESTART, 0);
+}
+
+bool lpp::GCController::is_manual() const
+{
+	return manual_;
+}
+
+void lpp::GCController::start_frame()
+{
+	frame_start_ = std::chrono::steady_clock::now();
+}
+
+void lpp::GCController::update()
+{
+	if(!manual_)
+		return;
+
+	PROFILE_ZONE("Lua GC");
+	auto start = std::chrono::steady_clock::now();
+	auto memory = get_memory_();
+	if(memory > stats_.live * (1.f + (pause_ - 1.f) * 5.f))
+	{ // Stepping did not keep up.
+		lua_gc(L_, LUA_GCCOLLECT, 0);
+		++stats_.emergencies;
+		cycle_finished_();
+	}
+	else if(paused_ && memory > stats_.live * pause_)
+		paused_ = false;
+
+	std::chrono::duration<tdt::real, std::milli> spent = start - frame_start_;
+	auto budget = std::min(budget_, std::max(frame_time_ - spent.count(), budget_ * .1f));
+	auto end = start + std::chrono::duration<tdt::real, std::milli>{budget};
+	while(!paused_ && std::chrono::steady_clock::now() < end)
+	{
+		++stats_.steps;
+		if(lua_gc(L_, LUA_GCSTEP, (int)step_size_))
+			cycle_finished_();
+	}
+
+	std::chrono::duration<tdt::real, std::milli> time = std::chrono::steady_clock::now() - start;
+	stats_.last_time = time.count();
+	stats_.max_time = std::max(stats_.max_time, stats_.last_time);
+	stats_.total_time += stats_.last_time;
+}
+
+void lpp::GCController::collect()
+{
+	lua_gc(L_, LUA_GCCOLLECT, 0);
+	cycle_finished_();
+}
+
+void lpp::GCController::set_budget(tdt::real budget)
+{
+	budget_ = std::max(budget, 0.f);
+}
+
+tdt::real lpp::GCController::get_budget() const
+{
+	return budget_;
+}
+
+void lpp::GCController::set_frame_time(tdt::real time)
+{
+	frame_time_ = std::max(time, 0.f);
+}
+
+tdt::real lpp::GCController::get_frame_time() const
+{
+	return frame_time_;
+}
+
+void lpp::GCController::set_step_size(tdt::uint size)
+{
+	if(size > 0)
+		step_size_ = size;
+}
+
+tdt::uint lpp::GCController::get_step_size() const
+{
+	return step_size_;
+}
+
+void lpp::GCController::set_pause(tdt::real pause)
+{
+	if(pause > 1.f)
+		pause_ = pause;
+}
+
+tdt::real lpp::GCController::get_pause() const
+{
+	return pause_;
+}
+
+const lpp::GCController::Stats& lpp::GCController::get_stats()
+{
+	stats_.memory = get_memory_();
+
+	return stats_;
+}
+
+void lpp::GCController::reset_stats()
+{
+	stats_.steps = stats_.cycles = stats_.emergencies = 0;
+	stats_.last_time = stats_.max_time = stats_.total_time = 0.f;
+}
+
+std::size_t lpp::GCController::get_memory_() const
+{
+	return (std::size_t)lua_gc(L_, LUA_GCCOUNT, 0) * 1024 + (std::size_t)lua_gc(L_, LUA_GCCOUNTB, 0);
+}
+
+void lpp::GCController::cycle_finished_()
+{
+	++stats_.cycles;
+	stats_.live = get_memory_();
+	paused_ = true;
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <lua.hpp>
+#include <chrono>
+#include <cstddef>
+#include <Typedefs.hpp>
+
+namespace lpp
+{
+
+/**
+ * Controls the garbage collector of a Lua virtual machine. In the manual mode, the automatic
+ * collection (which runs whenever Lua allocates and can thus hit the middle of a frame) is stopped
+ * and the collector is instead stepped at the end of every frame, in the time left until the target
+ * frame time, but at most for the budget (and at least for a tenth of it, so that the collection keeps
+ * up with the garbage even if the frames are slow).
+ * Like the automatic collector, a new cycle starts only after the memory grew by a given ratio since
+ * the end of the last one. If the stepping cannot keep up and the memory grows too much, a full
+ * (emergency) collection is performed.
+ */
+class GCController
+{
+	public:
+		/**
+		 * Statistics of the collector.
+		 */
+		struct Stats
+		{
+			std::size_t memory; // In bytes.
+			std::size_t live; // Memory after the last finished cycle.
+			tdt::uint steps;
+			tdt::uint cycles;
+			tdt::uint emergencies;
+			tdt::real last_time; // Milliseconds spent in the last frame.
+			tdt::real max_time; // Longest frame (in milliseconds).
+			tdt::real total_time; // In milliseconds.
+		};
+
+		/**
+		 * \brief Constructor.
+		 * \param The controlled Lua state.
+		 */
+		GCController(lua_State*);
+
+		/**
+		 * \brief Switches between the manual (stepped every frame) and the automatic
+		 *        (default Lua) garbage collection.
+		 * \param True for the manual collection, false for the automatic one.
+		 */
+		void set_manual(bool);
+
+		/**
+		 * \brief Returns true if the garbage collection is manual, false otherwise.
+		 */
+		bool is_manual() const;
+
+		/**
+		 * \brief Marks the start of a frame.
+		 */
+		void start_frame();
+
+		/**
+		 * \brief Steps the collector in the rest of the frame (if manual).
+		 */
+		void update();
+
+		/**
+		 * \brief Performs a full garbage collection cycle.
+		 */
+		void collect();
+
+		/**
+		 * \brief Sets the maximal time spent in the collector per frame.
+		 * \param The time (in milliseconds).
+		 */
+		void set_budget(tdt::real);
+
+		/**
+		 * \brief Returns the maximal time spent in the collector per frame (in milliseconds).
+		 */
+		tdt::real get_budget() const;
+
+		/**
+		 * \brief Sets the target frame time, the collector uses what is left of it.
+		 * \param The time (in milliseconds).
+		 */
+		void set_frame_time(tdt::real);
+
+		/**
+		 * \brief Returns the target frame time (in milliseconds).
+		 */
+		tdt::real get_frame_time() const;
+
+		/**
+		 * \brief Sets the amount of work done in a single step.
+		 * \param Size of the step (in kilobytes of allocation it pays for).
+		 */
+		void set_step_size(tdt::uint);
+
+		/**
+		 * \brief Returns the amount of work done in a single step (in kilobytes).
+		 */
+		tdt::uint get_step_size() const;
+
+		/**
+		 * \brief Sets the ratio of the memory growth since the last cycle that starts
+		 *        a new cycle (and five times the growth causes an emergency collection).
+		 * \param The ratio (> 1).
+		 */
+		void set_pause(tdt::real);
+
+		/**
+		 * \brief Returns the ratio of the memory growth that starts a new cycle.
+		 */
+		tdt::real get_pause() const;
+
+		/**
+		 * \brief Returns the statistics of the collector.
+		 */
+		const Stats& get_stats();
+
+		/**
+		 * \brief Resets the time statistics.
+		 */
+		void reset_stats();
+
+	private:
+		/**
+		 * \brief Returns the memory used by the Lua state in bytes.
+		 */
+		std::size_t get_memory_() const;
+
+		/**
+		 * \brief Called when a cycle finishes, the collector waits until the memory grows again.
+		 */
+		void cycle_finished_();
+
+		/**
+		 * The controlled Lua state.
+		 */
+		lua_State* L_;
+
+		/**
+		 * If true, the collection is manual.
+		 */
+		bool manual_;
+
+		/**
+		 * If true, the last cycle has finished and no new one was started yet.
+		 */
+		bool paused_;
+
+		/**
+		 * Start of the current frame.
+		 */
+		std::chrono::steady_clock::time_point frame_start_;
+
+		/**
+		 * Parameters of the manual collection.
+		 */
+		tdt::real budget_;
+		tdt::real frame_time_;
+		tdt::uint step_size_;
+		tdt::real pause_;
+
+		/**
+		 * Statistics of the collector.
+		 */
+		Stats stats_;
+};
+
+}
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include "LppIdList.hpp"
+
+const char* lpp::IdList::metatable_{"lpp.idlist"};
+
+void lpp::IdList::init(lua_State* L)
+{
+	luaL_Reg methods[] = {
+		{"contains", &IdList::contains_},
+		{"to_table", &IdList::to_table_},
+		{nullptr, nullptr}
+	};
+
+	luaL_newmetatable(L, metatable_);
+	luaL_newlib(L, methods);
+	lua_pushcclosure(L, &IdList::index_, 1);
+	lua_setfield(L, -2, "__index");
+	lua_pushcfunction(L, &IdList::len_);
+	lua_setfield(L, -2, "__len");
+	lua_pushcfunction(L, &IdList::pairs_);
+	lua_setfield(L, -2, "__pairs");
+	lua_pushcfunction(L, &IdList::pairs_);
+	lua_setfield(L, -2, "__ipairs");
+	lua_pushcfunction(L, &IdList::tostring_);
+	lua_setfield(L, -2, "__tostring");
+	lua_pop(L, 1);
+}
+
+void lpp::IdList::push(lua_State* L, const tdt::uint* ids, std::size_t size)
+{
+	auto header = static_cast<Header*>(lua_newuserdata(L, sizeof(Header) + size * sizeof(tdt::uint)));
+	header->size = size;
+	if(size > 0)
+		std::memcpy(data_(header), ids, size * sizeof(tdt::uint));
+	luaL_setmetatable(L, metatable_);
+}
+
+void lpp::IdList::push(lua_State* L, const std::vector<tdt::uint>& ids)
+{
+	push(L, ids.data(), ids.size());
+}
+
+const tdt::uint* lpp::IdList::get(lua_State* L, int idx, std::size_t& size)
+{
+	auto header = static_cast<Header*>(luaL_testudata(L, idx, metatable_));
+	if(!header)
+		return nullptr;
+
+	size = header->size;
+	return data_(header);
+}
+
+lpp::IdList::Header* lpp::IdList::check_(lua_State* L, int idx)
+{
+	return static_cast<Header*>(luaL_checkudata(L, idx, metatable_));
+}
+
+tdt::uint* lpp::IdList::data_(Header* header)
+{
+	return reinterpret_cast<tdt::uint*>(header + 1);
+}
+
+int lpp::IdList::index_(lua_State* L)
+{
+	auto header = check_(L, 1);
+	if(lua_type(L, 2) == LUA_TNUMBER)
+	{
+		auto idx = lua_tointeger(L, 2);
+		if(idx >= 1 && (std::size_t)idx <= header->size)
+			lua_pushinteger(L, (lua_Integer)data_(header)[idx - 1]);
+		else
+			lua_pushnil(L);
+	}
+	else
+	{ // Methods.
+		lua_pushvalue(L, 2);
+		lua_rawget(L, lua_upvalueindex(1));
+	}
+	return 1;
+}
+
+int lpp::IdList::len_(lua_State* L)
+{
+	lua_pushinteger(L, (lua_Integer)check_(L, 1)->size);
+	return 1;
+}
+
+int lpp::IdList::pairs_(lua_State* L)
+{
+	check_(L, 1);
+	lua_pushcfunction(L, &IdList::next_);
+	lua_pushvalue(L, 1);
+	lua_pushinteger(L, 0);
+	return 3;
+}
+
+int lpp::IdList::next_(lua_State* L)
+{
+	auto header = check_(L, 1);
+	auto idx = (std::size_t)luaL_checkinteger(L, 2) + 1;
+	if(idx > header->size)
+	{
+		lua_pushnil(L);
+		return 1;
+	}
+
+	lua_pushinteger(L, (lua_Integer)idx);
+	lua_pushinteger(L, (lua_Integer)data_(header)[idx - 1]);
+	return 2;
+}
+
+int lpp::IdList::tostring_(lua_State* L)
+{
+	auto res = "idlist(" + std::to_string(check_(L, 1)->size) + ")";
+	lua_pushstring(L, res.c_str());
+	return 1;
+}
+
+int lpp::IdList::contains_(lua_State* L)
+{
+	auto header = check_(L, 1);
+	auto id = (tdt::uint)luaL_checkinteger(L, 2);
+
+	auto begin = data_(header);
+	auto end = begin + header->size;
+	lua_pushboolean(L, std::find(begin, end, id) != end);
+	return 1;
+}
+
+int lpp::IdList::to_table_(lua_State* L)
+{
+	auto header = check_(L, 1);
+	auto ids = data_(header);
+
+	lua_createtable(L, (int)header->size, 0);
+	for(std::size_t i = 0; i < header->size; ++i)
+	{
+		lua_pushinteger(L, (lua_Integer)ids[i]);
+		lua_rawseti(L, -2, (lua_Integer)(i + 1));
+	}
+	return 1;
+}
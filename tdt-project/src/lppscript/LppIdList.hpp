@@ -0,0 +1,92 @@
+#pragma once
+
+#include <lua.hpp>
+#include <cstddef>
+#include <vector>
+#include <Typedefs.hpp>
+
+namespace lpp
+{
+
+/**
+ * Packed array of entity IDs passed to Lua as a single userdata (an "idlist") instead of a table,
+ * so that returning thousands of IDs is one allocation and a memcpy instead of a table insert
+ * per element. Scripts use it like a read-only array: list[i], #list, ipairs(list) and pairs(list)
+ * all work, list:contains(id) is a linear search and list:to_table() creates a regular
+ * (modifiable) table with the same IDs.
+ */
+class IdList
+{
+	public:
+		/**
+		 * \brief Creates the metatable of the lists in a given Lua state.
+		 * \param The Lua state.
+		 */
+		static void init(lua_State*);
+
+		/**
+		 * \brief Pushes a new list containing given IDs onto the stack.
+		 * \param The Lua state.
+		 * \param Pointer to the IDs.
+		 * \param Number of the IDs.
+		 */
+		static void push(lua_State*, const tdt::uint*, std::size_t);
+
+		/**
+		 * \brief Pushes a new list containing given IDs onto the stack.
+		 * \param The Lua state.
+		 * \param The IDs.
+		 */
+		static void push(lua_State*, const std::vector<tdt::uint>&);
+
+		/**
+		 * \brief Returns a pointer to the IDs of the list at a given index of the stack
+		 *        and stores it's size in the last argument, returns nullptr if the value
+		 *        is not a list.
+		 * \param The Lua state.
+		 * \param Index of the list on the stack.
+		 * \param Variable the size of the list is stored into.
+		 */
+		static const tdt::uint* get(lua_State*, int, std::size_t&);
+
+	private:
+		/**
+		 * Header of the userdata, the IDs follow it.
+		 */
+		struct Header
+		{
+			std::size_t size;
+		};
+
+		/**
+		 * \brief Returns the list at a given index, raises a Lua error if the value
+		 *        is not a list.
+		 * \param The Lua state.
+		 * \param Index of the list on the stack.
+		 */
+		static Header* check_(lua_State*, int);
+
+		/**
+		 * \brief Returns a pointer to the IDs stored in a list.
+		 * \param Header of the list.
+		 */
+		static tdt::uint* data_(Header*);
+
+		/**
+		 * Metamethods and methods of the lists.
+		 */
+		static int index_(lua_State*);
+		static int len_(lua_State*);
+		static int pairs_(lua_State*);
+		static int next_(lua_State*);
+		static int tostring_(lua_State*);
+		static int contains_(lua_State*);
+		static int to_table_(lua_State*);
+
+		/**
+		 * Name of the metatable in the registry.
+		 */
+		static const char* metatable_;
+};
+
+}
@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include "LppProfiler.hpp"
+
+thread_local const char* lpp::ScriptProfiler::callsite_{"(other)"};
+
+namespace
+{
+	/**
+	 * \brief Writes a string as a JSON string literal.
+	 * \param The stream.
+	 * \param The string.
+	 */
+	void write_json_string(std::ostream& os, const std::string& str)
+	{
+		os << '"';
+		for(auto c : str)
+		{
+			if(c == '"' || c == '\\')
+				os << '\\' << c;
+			else if((unsigned char)c < 0x20)
+				os << ' ';
+			else
+				os << c;
+		}
+		os << '"';
+	}
+
+	/**
+	 * \brief Sums entry statistics by a key (callsite or blueprint), the
+	 *        result is sorted by time.
+	 * \param The entries.
+	 * \param Function returning the key of an entry.
+	 */
+	template<typename KEY>
+	std::vector<lpp::ScriptProfiler::EntryStats> group_entries(
+		const std::vector<lpp::ScriptProfiler::EntryStats>& entries, KEY key)
+	{
+		std::vector<lpp::ScriptProfiler::EntryStats> res{};
+		for(const auto& entry : entries)
+		{
+			auto name = key(entry);
+			auto it = std::find_if(res.begin(), res.end(), [&name](const lpp::ScriptProfiler::EntryStats& group) {
+				return group.name == name;
+			});
+
+			if(it == res.end())
+				res.push_back(lpp::ScriptProfiler::EntryStats{"", name, entry.calls, entry.total, entry.bytes});
+			else
+			{
+				it->calls += entry.calls;
+				it->total += entry.total;
+				it->bytes += entry.bytes;
+			}
+		}
+		std::sort(res.begin(), res.end(), [](const lpp::ScriptProfiler::EntryStats& lhs,
+											 const lpp::ScriptProfiler::EntryStats& rhs) -> bool {
+			return lhs.total > rhs.total;
+		});
+
+		return res;
+	}
+}
+
+lpp::ScriptProfiler::Callsite::Callsite(const char* name)
+	: previous_{ScriptProfiler::callsite_}
+{
+	ScriptProfiler::callsite_ = name;
+}
+
+lpp::ScriptProfiler::Callsite::~Callsite()
+{
+	ScriptProfiler::callsite_ = previous_;
+}
+
+lpp::ScriptProfiler::ScriptProfiler(lua_State* L)
+	: L_{L}, running_{false}, stack_{}, functions_{},
+	  function_ids_{}, entries_{}, entry_ids_{}
+{ /* DUMMY BODY */ }
+
+void lpp::ScriptProfiler::start()
+{
+	if(running_)
+		return;
+
+	stack_.clear();
+	running_ = true;
+	*static_cast<ScriptProfiler**>(lua_getextraspace(L_)) = this; // Used by the hook.
+	lua_sethook(L_, &ScriptProfiler::hook_, LUA_MASKCALL | LUA_MASKRET, 0);
+}
+
+void lpp::ScriptProfiler::stop()
+{
+	if(!running_)
+		return;
+
+	// Functions that have not returned yet are not accounted.
+	stack_.clear();
+	running_ = false;
+	if(lua_gethook(L_) == &ScriptProfiler::hook_)
+		lua_sethook(L_, nullptr, 0, 0);
+}
+
+void lpp::ScriptProfiler::reset()
+{
+	// Running functions keep their indices.
+	for(auto& function : functions_)
+		function.calls = function.total = function.self = function.bytes = 0;
+	for(auto& entry : entries_)
+		entry.calls = entry.total = entry.bytes = 0;
+}
+
+bool lpp::ScriptProfiler::is_running() const
+{
+	return running_;
+}
+
+std::vector<lpp::ScriptProfiler::FunctionStats> lpp::ScriptProfiler::get_functions() const
+{
+	std::vector<FunctionStats> res{};
+	std::copy_if(functions_.begin(), functions_.end(), std::back_inserter(res),
+				 [](const FunctionStats& function) { return function.calls > 0; });
+	std::sort(res.begin(), res.end(), [](const FunctionStats& lhs, const FunctionStats& rhs) -> bool {
+		return lhs.self > rhs.self;
+	});
+
+	return res;
+}
+
+std::vector<lpp::ScriptProfiler::EntryStats> lpp::ScriptProfiler::get_entries() const
+{
+	std::vector<EntryStats> res{};
+	std::copy_if(entries_.begin(), entries_.end(), std::back_inserter(res),
+				 [](const EntryStats& entry) { return entry.calls > 0; });
+	std::sort(res.begin(), res.end(), [](const EntryStats& lhs, const EntryStats& rhs) -> bool {
+		return lhs.total > rhs.total;
+	});
+
+	return res;
+}
+
+std::vector<lpp::ScriptProfiler::EntryStats> lpp::ScriptProfiler::get_blueprints() const
+{
+	return group_entries(get_entries(), [](const EntryStats& entry) -> std::string {
+		auto dot = entry.name.rfind('.');
+		return dot != std::string::npos ? entry.name.substr(0, dot) : entry.name;
+	});
+}
+
+std::vector<lpp::ScriptProfiler::EntryStats> lpp::ScriptProfiler::get_callsites() const
+{
+	return group_entries(get_entries(), [](const EntryStats& entry) -> std::string {
+		return entry.callsite;
+	});
+}
+
+bool lpp::ScriptProfiler::dump(const std::string& fname) const
+{
+	std::ofstream file{fname, std::ios::trunc};
+	if(!file)
+		return false;
+
+	// Times are in milliseconds.
+	file << std::fixed << std::setprecision(6) << "{\n\"functions\": [";
+	bool first{true};
+	for(const auto& function : get_functions())
+	{
+		file << (first ? "\n" : ",\n") << "{\"name\": ";
+		write_json_string(file, function.name);
+		file << ", \"calls\": " << function.calls << ", \"total_ms\": " << function.total / 1000000.0
+			 << ", \"self_ms\": " << function.self / 1000000.0 << ", \"bytes\": " << function.bytes << "}";
+		first = false;
+	}
+
+	auto write_entries = [&file](const char* name, const std::vector<EntryStats>& entries, bool callsite) {
+		file << "\n],\n\"" << name << "\": [";
+		bool first{true};
+		for(const auto& entry : entries)
+		{
+			file << (first ? "\n" : ",\n") << "{";
+			if(callsite)
+			{
+				file << "\"callsite\": ";
+				write_json_string(file, entry.callsite);
+				file << ", ";
+			}
+			file << "\"name\": ";
+			write_json_string(file, entry.name);
+			file << ", \"calls\": " << entry.calls << ", \"total_ms\": " << entry.total / 1000000.0
+				 << ", \"bytes\": " << entry.bytes << "}";
+			first = false;
+		}
+	};
+	write_entries("entries", get_entries(), true);
+	write_entries("blueprints", get_blueprints(), false);
+	write_entries("callsites", get_callsites(), false);
+	file << "\n]\n}\n";
+
+	return (bool)file;
+}
+
+std::size_t lpp::ScriptProfiler::enter_call(const std::string& fname)
+{
+	auto depth = stack_.size();
+	if(!running_)
+		return depth;
+
+	auto key = std::make_pair(callsite_, fname);
+	auto it = entry_ids_.find(key);
+	if(it == entry_ids_.end())
+	{
+		it = entry_ids_.emplace(key, entries_.size()).first;
+		entries_.push_back(EntryStats{callsite_, fname, 0, 0, 0});
+	}
+	push_(it->second, true);
+
+	return depth;
+}
+
+void lpp::ScriptProfiler::leave_call(std::size_t depth)
+{
+	while(running_ && stack_.size() > depth)
+		pop_();
+}
+
+void lpp::ScriptProfiler::hook_(lua_State* L, lua_Debug* ar)
+{
+	auto& profiler = **static_cast<ScriptProfiler**>(lua_getextraspace(L));
+	if(!profiler.running_)
+		return;
+
+	if(ar->event == LUA_HOOKRET)
+	{ // Entries are popped by leave_call.
+		if(!profiler.stack_.empty() && !profiler.stack_.back().entry)
+			profiler.pop_();
+		return;
+	}
+
+	// Tail calls replace the caller, whose return hook will not be called.
+	if(ar->event == LUA_HOOKTAILCALL && !profiler.stack_.empty() && !profiler.stack_.back().entry)
+		profiler.pop_();
+
+	lua_getinfo(L, "nS", ar);
+	std::pair<std::string, int> key{};
+	if(ar->what[0] == 'C')
+		key = std::make_pair(std::string{"[C] "} + (ar->name ? ar->name : "?"), -1);
+	else
+		key = std::make_pair(std::string{ar->short_src}, ar->linedefined);
+
+	auto it = profiler.function_ids_.find(key);
+	if(it == profiler.function_ids_.end())
+	{
+		std::string name{ar->name ? ar->name : (ar->what[0] == 'm' ? "main chunk" : "?")};
+		if(key.second >= 0)
+			name += " (" + key.first + ":" + std::to_string(key.second) + ")";
+		else
+			name = key.first;
+
+		it = profiler.function_ids_.emplace(key, profiler.functions_.size()).first;
+		profiler.functions_.push_back(FunctionStats{name, 0, 0, 0, 0});
+	}
+	profiler.push_(it->second, false);
+}
+
+std::uint64_t lpp::ScriptProfiler::now_()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()
+	).count();
+}
+
+void lpp::ScriptProfiler::push_(std::size_t function, bool entry)
+{
+	stack_.push_back(Frame{function, entry, now_(), 0, 0, 0});
+}
+
+void lpp::ScriptProfiler::pop_()
+{
+	auto frame = stack_.back();
+	stack_.pop_back();
+
+	auto time = now_() - frame.start;
+	if(frame.entry)
+	{
+		auto& entry = entries_[frame.function];
+		++entry.calls;
+		entry.total += time;
+		entry.bytes += frame.bytes + frame.child_bytes;
+	}
+	else
+	{
+		auto& function = functions_[frame.function];
+		++function.calls;
+		function.total += time;
+		function.self += time > frame.children ? time - frame.children : 0;
+		function.bytes += frame.bytes;
+	}
+
+	if(!stack_.empty())
+	{
+		stack_.back().children += time;
+		stack_.back().child_bytes += frame.bytes + frame.child_bytes;
+	}
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <lua.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lpp
+{
+
+/**
+ * Hook based profiler of the Lua virtual machine owned by lpp::Script. While running, it
+ * follows every Lua function call and return and measures the time spent in every function
+ * (with and without the functions it called), the number of calls and the number of bytes
+ * the Lua allocator allocated in it. Calls from C++ (lpp::Script::call) are accounted
+ * separately by the function name (e.g. "evil_ogre_ai.update", so that costs can be summed
+ * per blueprint table) and by the C++ callsite that made them (e.g. the system being updated,
+ * see Callsite).
+ * Stopped profiler removes it's hook, so the only remaining cost is a branch in the allocator.
+ */
+class ScriptProfiler
+{
+	public:
+		/**
+		 * Sets the name of the C++ code calling Lua while it exists.
+		 */
+		class Callsite
+		{
+			public:
+				/**
+				 * \brief Constructor.
+				 * \param Name of the callsite, has to outlive the profiler (string literal).
+				 */
+				Callsite(const char*);
+
+				/**
+				 * \brief Destructor, restores the previous callsite.
+				 */
+				~Callsite();
+
+				Callsite(const Callsite&) = delete;
+				Callsite& operator=(const Callsite&) = delete;
+
+			private:
+				/**
+				 * Callsite that was active before this one.
+				 */
+				const char* previous_;
+		};
+
+		/**
+		 * Costs of a Lua function.
+		 */
+		struct FunctionStats
+		{
+			std::string name;
+			std::uint64_t calls;
+			std::uint64_t total; // Nanoseconds including called functions.
+			std::uint64_t self; // Nanoseconds without called functions.
+			std::uint64_t bytes; // Allocated in this function only.
+		};
+
+		/**
+		 * Costs of the calls of a Lua function from a C++ callsite (including
+		 * the functions it called).
+		 */
+		struct EntryStats
+		{
+			std::string callsite;
+			std::string name;
+			std::uint64_t calls;
+			std::uint64_t total;
+			std::uint64_t bytes;
+		};
+
+		/**
+		 * \brief Constructor.
+		 * \param The profiled Lua state.
+		 */
+		ScriptProfiler(lua_State*);
+
+		/**
+		 * \brief Starts profiling (the collected data is kept).
+		 */
+		void start();
+
+		/**
+		 * \brief Stops profiling.
+		 */
+		void stop();
+
+		/**
+		 * \brief Deletes the collected data.
+		 */
+		void reset();
+
+		/**
+		 * \brief Returns true if profiling, false otherwise.
+		 */
+		bool is_running() const;
+
+		/**
+		 * \brief Returns the costs of all called Lua functions sorted by their self time.
+		 */
+		std::vector<FunctionStats> get_functions() const;
+
+		/**
+		 * \brief Returns the costs of all Lua functions called from C++ sorted by their time.
+		 */
+		std::vector<EntryStats> get_entries() const;
+
+		/**
+		 * \brief Returns the costs of the calls from C++ summed per blueprint table (the name
+		 *        of the called function without it's last field) sorted by their time.
+		 */
+		std::vector<EntryStats> get_blueprints() const;
+
+		/**
+		 * \brief Returns the costs of the calls from C++ summed per callsite sorted by their time.
+		 */
+		std::vector<EntryStats> get_callsites() const;
+
+		/**
+		 * \brief Writes the collected data into a JSON file, returns false if the file
+		 *        could not be written.
+		 * \param Name of the file.
+		 */
+		bool dump(const std::string&) const;
+
+		/**
+		 * \brief Notifies the profiler that C++ is going to call a Lua function, returns
+		 *        the depth of the profiler's call stack to pass to leave_call.
+		 * \param Name of the function.
+		 */
+		std::size_t enter_call(const std::string&);
+
+		/**
+		 * \brief Notifies the profiler that a call from C++ has finished (even by an error,
+		 *        which skips the return hooks of the unwound functions).
+		 * \param Depth of the call stack returned by enter_call.
+		 */
+		void leave_call(std::size_t);
+
+		/**
+		 * \brief Accounts an allocation of the Lua allocator.
+		 * \param Number of allocated bytes.
+		 */
+		void allocated(std::size_t bytes)
+		{
+			if(running_ && !stack_.empty())
+				stack_.back().bytes += bytes;
+		}
+
+	private:
+		/**
+		 * A function on the call stack.
+		 */
+		struct Frame
+		{
+			std::size_t function; // Index in functions_ or entries_.
+			bool entry; // Call from C++.
+			std::uint64_t start;
+			std::uint64_t children;
+			std::uint64_t bytes;
+			std::uint64_t child_bytes;
+		};
+
+		/**
+		 * \brief Hook called by Lua on every function call and return.
+		 * \param The Lua state.
+		 * \param Debug info of the event.
+		 */
+		static void hook_(lua_State*, lua_Debug*);
+
+		/**
+		 * \brief Returns the current time in nanoseconds.
+		 */
+		static std::uint64_t now_();
+
+		/**
+		 * \brief Pushes a function on the call stack.
+		 * \param Index of the function.
+		 * \param True if called from C++.
+		 */
+		void push_(std::size_t, bool);
+
+		/**
+		 * \brief Pops the top of the call stack and accounts it's costs.
+		 */
+		void pop_();
+
+		/**
+		 * The profiled Lua state.
+		 */
+		lua_State* L_;
+
+		/**
+		 * If true, the hook is set.
+		 */
+		bool running_;
+
+		/**
+		 * Shadow of Lua's call stack.
+		 */
+		std::vector<Frame> stack_;
+
+		/**
+		 * Costs of the functions and their indices by their identity
+		 * (source and line) or name and callsite for calls from C++.
+		 */
+		std::vector<FunctionStats> functions_;
+		std::map<std::pair<std::string, int>, std::size_t> function_ids_;
+		std::vector<EntryStats> entries_;
+		std::map<std::pair<const char*, std::string>, std::size_t> entry_ids_;
+
+		/**
+		 * Name of the C++ code currently calling Lua on this thread.
+		 */
+		static thread_local const char* callsite_;
+};
+
+}
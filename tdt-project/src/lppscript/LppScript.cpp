@@ -1,14 +1,25 @@
-#include <sstream>
+#include <cstdio>
 #include "LppScript.hpp"
 
 /**
  * lpp::Script definitions:
  */
 lpp::Script::Script()
-	: loaded_scripts_{}, L{}
+	: loaded_scripts_{}, L{}, allocator_{}, profiler_{}, gc_{}, bytecode_cache_{}, workers_{},
+	  batch_arrays_{}, batch_top_{}
 {
-	L = luaL_newstate();
+	L = lua_newstate(&Script::alloc_, this);
+	if(L)
+		lua_atpanic(L, [](state L) -> int {
+			std::fprintf(stderr, "PANIC: unprotected error in call to Lua API (%s)\n", lua_tostring(L, -1));
+			return 0;
+		});
+	profiler_.reset(new ScriptProfiler{L});
+	gc_.reset(new GCController{L});
+	bytecode_cache_.reset(new BytecodeCache{L});
+	workers_.reset(new WorkerPool{L});
 	luaL_openlibs(L);
+	IdList::init(L);
 }
 
 void lpp::Script::execute(const std::string& command)
@@ -24,43 +35,92 @@ void lpp::Script::register_function(const std::string& name, lua_CFunction fn)
 
 void lpp::Script::load(const std::string& fname)
 {
-	if(luaL_dofile(L, fname.c_str()))
+	if(bytecode_cache_->load(fname) || lua_pcall(L, 0, LUA_MULTRET, 0))
 		throw Exception("[Error][Lua] Cannot load script: " + fname +
 						".", L);
 
 	loaded_scripts_.emplace(fname);
+	workers_->reset(); // Functions might have been redefined.
 }
 
 bool lpp::Script::is_nil(const std::string& name)
 {
-	std::string name2{name};
-	if(name.find(".") != std::string::npos)
-		name2 = get_field_to_stack(name);
-	else
-		lua_getglobal(L, name2.c_str());
+	get_field_to_stack(name);
 
 	bool res = lua_isnil(L, -1);
 	lua_pop(L, 1);
 	return res == 1; // Lua returns C style bool (i.e. an integer).
 }
 
+bool lpp::Script::is_function(const std::string& name)
+{
+	get_field_to_stack(name);
+
+	bool res = lua_isfunction(L, -1);
+	lua_pop(L, 1);
+	return res;
+}
+
+void lpp::Script::push_batch_table_(std::size_t size)
+{
+	if(batch_top_ == batch_arrays_.size())
+	{
+		lua_createtable(L, (int)size, 0);
+		batch_arrays_.push_back(luaL_ref(L, LUA_REGISTRYINDEX));
+	}
+	lua_rawgeti(L, LUA_REGISTRYINDEX, batch_arrays_[batch_top_++]);
+
+	for(auto i = lua_rawlen(L, -1); i > size; --i)
+	{
+		lua_pushnil(L);
+		lua_rawseti(L, -2, (lua_Integer)i);
+	}
+}
+
 std::string lpp::Script::get_field_to_stack(const std::string& name)
 {
-	std::istringstream iss(name);
-	std::string tmp;
+	auto key = get_parent_to_stack_(name, false);
+	if(lua_istable(L, -1))
+		lua_getfield(L, -1, key.c_str());
+	else
+		lua_pushnil(L);
+	lua_remove(L, -2);
 
-	// Field extraction.
-	std::getline(iss, tmp, '.'); // Name of table.
-	lua_getglobal(L, tmp.c_str());
+	return key;
+}
 
-	while(std::getline(iss, tmp, '.'))
-	{ // Sub fields.
-		lua_pushstring(L, tmp.c_str());
-		if(lua_istable(L, -2))
-			lua_gettable(L, -2);
+std::string lpp::Script::get_parent_to_stack_(const std::string& name, bool create)
+{
+	lua_pushglobaltable(L);
+	std::size_t start{};
+	for(auto end = name.find('.'); end != std::string::npos; start = end + 1, end = name.find('.', start))
+	{
+		lua_pushlstring(L, name.c_str() + start, end - start);
+		lua_gettable(L, -2);
+		if(!lua_istable(L, -1))
+		{
+			if(!create)
+			{ // Leave nil as the parent.
+				lua_remove(L, -2);
+				return name.substr(name.rfind('.') + 1);
+			}
+			else if(!lua_isnil(L, -1))
+			{
+				lua_pop(L, 2);
+				throw Exception("[Error][Lua] Cannot set variable " + name + ", "
+								+ name.substr(0, end) + " is not a table.");
+			}
+
+			lua_pop(L, 1);
+			lua_newtable(L);
+			lua_pushlstring(L, name.c_str() + start, end - start);
+			lua_pushvalue(L, -2);
+			lua_settable(L, -4);
+		}
 		lua_remove(L, -2);
 	}
-	return tmp; // Last field name.
+
+	return name.substr(start);
 }
 
 void lpp::Script::clear_stack()
@@ -102,6 +162,40 @@ void lpp::Script::reload_all_scripts()
 		load(script);
 }
 
+lpp::ScriptProfiler& lpp::Script::get_profiler()
+{
+	return *profiler_;
+}
+
+const lpp::Allocator& lpp::Script::get_allocator() const
+{
+	return allocator_;
+}
+
+lpp::GCController& lpp::Script::get_gc()
+{
+	return *gc_;
+}
+
+void* lpp::Script::alloc_(void* ud, void* ptr, std::size_t osize, std::size_t nsize)
+{
+	auto& script = *static_cast<Script*>(ud);
+	if(nsize > 0 && script.profiler_ && (!ptr || nsize > osize))
+		script.profiler_->allocated(ptr ? nsize - osize : nsize);
+
+	return script.allocator_.reallocate(ptr, osize, nsize);
+}
+
+lpp::BytecodeCache& lpp::Script::get_bytecode_cache()
+{
+	return *bytecode_cache_;
+}
+
+lpp::WorkerPool& lpp::Script::get_worker_pool()
+{
+	return *workers_;
+}
+
 lpp::Script& lpp::Script::instance()
 {
 	static Script instance{};
@@ -3,10 +3,20 @@
 #include <lua.hpp>
 #include <string>
 #include <memory>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <tuple>
 #include <set>
 #include <Typedefs.hpp>
+#include <tools/Profiler.hpp>
+#include "LppProfiler.hpp"
+#include "LppAllocator.hpp"
+#include "LppGC.hpp"
+#include "LppBytecodeCache.hpp"
+#include "LppWorkerPool.hpp"
+#include "LppIdList.hpp"
 
 namespace lpp
 {
@@ -55,7 +65,7 @@ class Script
 		void register_function(const std::string&, lua_CFunction);
 
 		/**
-		 * \brief Loads, compiles and executes a Lua script.
+		 * \brief Loads, compiles (unless it's bytecode is cached) and executes a Lua script.
 		 * \param Name of the script file.
 		 */
 		void load(const std::string&);
@@ -66,6 +76,12 @@ class Script
 		 */
 		bool is_nil(const std::string&);
 
+		/**
+		 * \brief Returns true if a given value is a function, false otherwise.
+		 * \param Name of the variable containing the desired value.
+		 */
+		bool is_function(const std::string&);
+
 		/**
 		 * \brief Retrieves and returns a value from Lua.
 		 * \param Name of the variable containing the desired value.
@@ -76,11 +92,7 @@ class Script
 			if(!L)
 				throw Exception("[Error][Lua] Lua state is null.");
 
-			std::string sub_name{name}; // Access to values within tables.
-			if(name.find(".") != std::string::npos)
-				sub_name = get_field_to_stack(name);
-			else
-				lua_getglobal(L, name.c_str());
+			auto sub_name = get_field_to_stack(name); // Access to values within tables.
 
 			if(lua_isnil(L, -1))
 				throw Exception("[Error][Lua] Variable " + name + " is not defined or nil.", L);
@@ -98,16 +110,17 @@ class Script
 		template<typename Result, typename... Args>
 		Result call(const std::string& fname, Args... as)
 		{
+			PROFILE_ZONE(fname);
+
 			// Allows to call function that are stored in tables.
-			std::string fname2{fname};
-			if(fname2.find('.') != std::string::npos)
-				fname2 = get_field_to_stack(fname);
-			else
-				lua_getglobal(L, fname2.c_str());
+			get_field_to_stack(fname);
 
 			int arg_count = push_args<Args...>(as...);
 
-			if(lua_pcall(L, arg_count, 1, 0))
+			auto depth = profiler_->enter_call(fname);
+			auto err = lua_pcall(L, arg_count, 1, 0);
+			profiler_->leave_call(depth);
+			if(err)
 				throw Exception("[Error][Lua] Error while calling a Lua function: " + fname + ".", L);
 
 			return get_<Result>();
@@ -120,32 +133,132 @@ class Script
 		template<typename Result>
 		Result call(const std::string& fname)
 		{
+			PROFILE_ZONE(fname);
+
 			// Allows to call function that are stored in tables.
-			std::string fname2{fname};
-			if(fname2.find('.') != std::string::npos)
-				fname2 = get_field_to_stack(fname);
-			else
-				lua_getglobal(L, fname2.c_str());
+			get_field_to_stack(fname);
 
-			if(lua_pcall(L, 0, 1, 0))
+			auto depth = profiler_->enter_call(fname);
+			auto err = lua_pcall(L, 0, 1, 0);
+			profiler_->leave_call(depth);
+			if(err)
 				throw Exception("[Error][Lua] Error while calling a Lua function: " + fname + ".", L);
 
 			return get_<Result>();
 		}
 
 		/**
-		 * \brief Sets a given variable to a given value.
+		 * \brief Calls a given Lua function with arrays as arguments. The arrays are tables kept
+		 *        in the registry and reused by every batched call (only their contents change),
+		 *        so the called function must not keep references to them.
+		 * \param Name of the function.
+		 * \param Variadic list of vectors that are passed to the function as arrays.
+		 */
+		template<typename... Args>
+		void call_batch(const std::string& fname, const std::vector<Args>&... arrays)
+		{
+			PROFILE_ZONE(fname);
+
+			get_field_to_stack(fname);
+
+			auto first = batch_top_;
+			int arg_count = push_arrays_(arrays...);
+
+			auto depth = profiler_->enter_call(fname);
+			auto err = lua_pcall(L, arg_count, 0, 0);
+			profiler_->leave_call(depth);
+			batch_top_ = first;
+			if(err)
+				throw Exception("[Error][Lua] Error while calling a Lua function: " + fname + ".", L);
+		}
+
+		/**
+		 * \brief Calls a given Lua function with arrays as arguments (like call_batch) followed
+		 *        by an empty array, in which the function sets the entry of every element
+		 *        of the first array it answers positively to true.
+		 * \param Name of the function.
+		 * \param Vector the results are stored in (resized to the size of the first array).
+		 * \param First array passed to the function.
+		 * \param Variadic list of the remaining arrays passed to the function.
+		 */
+		template<typename T, typename... Args>
+		void query_batch(const std::string& fname, std::vector<bool>& results,
+						 const std::vector<T>& array, const std::vector<Args>&... arrays)
+		{
+			PROFILE_ZONE(fname);
+
+			get_field_to_stack(fname);
+
+			auto first = batch_top_;
+			int arg_count = push_arrays_(array, arrays...);
+			push_batch_table_(0);
+			lua_pushvalue(L, -1);
+			lua_insert(L, -(arg_count + 3)); // Keep the results below the function.
+
+			auto depth = profiler_->enter_call(fname);
+			auto err = lua_pcall(L, arg_count + 1, 0, 0);
+			profiler_->leave_call(depth);
+			batch_top_ = first;
+			if(err)
+			{
+				lua_remove(L, -2);
+				throw Exception("[Error][Lua] Error while calling a Lua function: " + fname + ".", L);
+			}
+
+			results.assign(array.size(), false);
+			for(std::size_t i = 0; i < array.size(); ++i)
+			{
+				lua_rawgeti(L, -1, (lua_Integer)i + 1);
+				results[i] = lua_toboolean(L, -1) == 1;
+				lua_pop(L, 1);
+			}
+			lua_pop(L, 1);
+		}
+
+		/**
+		 * \brief Sets a given variable to a given value (missing tables in the
+		 *        variable's name are created).
 		 * \param Variable to be changed.
 		 * \param Value that the variable should be changed to.
 		 */
 		template<typename T>
 		void set(const std::string& name, T val)
 		{
-			execute(name + " = " + std::to_string(val));
+			auto key = get_parent_to_stack_(name, true);
+			push_value_(val);
+			lua_setfield(L, -2, key.c_str());
+			lua_pop(L, 1);
+		}
+
+		/**
+		 * \brief Sets multiple fields of a table at once (the table is created if
+		 *        it does not exist, other fields are kept), used to initialize enums.
+		 * \param Name of the table.
+		 * \param List of field name - value pairs.
+		 */
+		template<typename T>
+		void set_table(const std::string& name, std::initializer_list<std::pair<const char*, T>> vals)
+		{
+			auto key = get_parent_to_stack_(name, true);
+			lua_getfield(L, -1, key.c_str());
+			if(!lua_istable(L, -1))
+			{
+				lua_pop(L, 1);
+				lua_newtable(L);
+				lua_pushvalue(L, -1);
+				lua_setfield(L, -3, key.c_str());
+			}
+
+			for(const auto& val : vals)
+			{
+				push_value_(val.second);
+				lua_setfield(L, -2, val.first);
+			}
+			lua_pop(L, 2);
 		}
 
 		/**
-		 * \brief Retrieves a Lua array table (integer indexing) in the form
+		 * \brief Retrieves a Lua array table (integer indexing) or an idlist in the form
 		 *        of a C++ vector.
 		 * \param Name of the array.
 		 */
@@ -156,20 +269,35 @@ class Script
 					throw Exception("[Error][Lua] Lua state is null.");
 
 			std::vector<T> tmp{};
-			std::string sub_name{name};
-			if(name.find(".") != std::string::npos)
-				sub_name = get_field_to_stack(name);
-			else
-				lua_getglobal(L, name.c_str());
-
+			get_field_to_stack(name);
 			if(lua_isnil(L, -1))
+			{
+				lua_pop(L, 1);
 				return std::vector<T>{};
+			}
 
-			lua_pushnil(L);
-			while(lua_next(L, -2))
+			std::size_t size{};
+			auto ids = IdList::get(L, -1, size);
+			if(ids)
+				copy_ids_(tmp, ids, size, std::is_arithmetic<T>{});
+			else if((size = lua_istable(L, -1) ? lua_rawlen(L, -1) : 0) > 0)
+			{ // Arrays have a known length, no need to traverse the hash part.
+				tmp.reserve(size);
+				for(std::size_t i = 1; i <= size; ++i)
+				{
+					lua_rawgeti(L, -1, (lua_Integer)i);
+					tmp.push_back(get_<T>());
+					lua_pop(L, 1);
+				}
+			}
+			else
 			{
-				tmp.push_back(get_<T>());
-				lua_pop(L, 1);
+				lua_pushnil(L);
+				while(lua_next(L, -2))
+				{
+					tmp.push_back(get_<T>());
+					lua_pop(L, 1);
+				}
 			}
 
 			clear_stack();
@@ -182,10 +310,37 @@ class Script
 		std::string get_stack_contents();
 
 		/**
-		 * \brief Reloads all script files that have been previously loaded.
+		 * \brief Reloads all script files that have been previously loaded (only
+		 *        the changed ones are compiled again).
 		 */
 		void reload_all_scripts();
 
+		/**
+		 * \brief Returns a reference to the profiler of the Lua virtual machine.
+		 */
+		ScriptProfiler& get_profiler();
+
+		/**
+		 * \brief Returns a reference to the memory allocator of the Lua virtual machine.
+		 */
+		const Allocator& get_allocator() const;
+
+		/**
+		 * \brief Returns a reference to the garbage collector controller of the Lua
+		 *        virtual machine.
+		 */
+		GCController& get_gc();
+
+		/**
+		 * \brief Returns a reference to the cache of compiled scripts.
+		 */
+		BytecodeCache& get_bytecode_cache();
+
+		/**
+		 * \brief Returns a reference to the pool of worker states evaluating pure functions.
+		 */
+		WorkerPool& get_worker_pool();
+
 		/**
 		 * \brief Returns a reference to the lpp::Script singleton.
 		 */
@@ -197,13 +352,129 @@ class Script
 		 */
 		Script();
 
+		/**
+		 * \brief Allocator of the Lua virtual machine, uses the pooled allocator
+		 *        and reports the allocated bytes to the profiler.
+		 * \param The script.
+		 * \param Pointer to the reallocated block (nullptr for new blocks).
+		 * \param Original size of the block (type of the object for new blocks).
+		 * \param New size of the block (0 to free it).
+		 */
+		static void* alloc_(void*, void*, std::size_t, std::size_t);
+
+		/**
+		 * \brief Appends the IDs of an idlist to a vector of numbers.
+		 * \param The vector.
+		 * \param Pointer to the IDs.
+		 * \param Number of the IDs.
+		 */
+		template<typename T>
+		void copy_ids_(std::vector<T>& vec, const tdt::uint* ids, std::size_t size, std::true_type)
+		{
+			vec.insert(vec.end(), ids, ids + size); // A memcpy for vectors of tdt::uint.
+		}
+
+		/**
+		 * \brief Overload for non numeric vectors, which cannot contain IDs.
+		 */
+		template<typename T>
+		void copy_ids_(std::vector<T>&, const tdt::uint*, std::size_t, std::false_type)
+		{
+			throw Exception("[Error][Lua] Cannot convert an idlist to a non numeric vector.");
+		}
+
+		/**
+		 * \brief Pushes the next unused batch array (creating it if necessary) onto
+		 *        the stack and removes it's entries past a given size.
+		 * \param Number of entries that will be kept.
+		 */
+		void push_batch_table_(std::size_t);
+
+		/**
+		 * \brief Pushes a vector as a batch array onto the stack.
+		 * \param The vector.
+		 */
+		template<typename T>
+		void push_array_(const std::vector<T>& array)
+		{
+			push_batch_table_(array.size());
+			for(std::size_t i = 0; i < array.size(); ++i)
+			{
+				push_arg<T>(array[i]);
+				lua_rawseti(L, -2, (lua_Integer)i + 1);
+			}
+		}
+
+		/**
+		 * \brief Pushes a variadic list of vectors as batch arrays onto the stack,
+		 *        returns the amount of arrays pushed.
+		 * \param First vector in the list.
+		 * \param Tail vector list used in recursive call.
+		 */
+		template<typename T, typename... Args>
+		int push_arrays_(const std::vector<T>& array, const std::vector<Args>&... arrays)
+		{
+			push_array_(array);
+			return push_arrays_(arrays...) + 1;
+		}
+
+		/**
+		 * \brief Bottom case of the push_arrays_ recursive call.
+		 */
+		int push_arrays_()
+		{
+			return 0;
+		}
+
 		/**
 		 * \brief Gets a nested value (inside a table hierarchy) on top of the stack and
-		 *        returns the name of the final variable (without table prefixes).
+		 *        returns the name of the final variable (without table prefixes),
+		 *        pushes nil if any of the tables does not exist.
 		 * \param Full name of the variable.
 		 */
 		std::string get_field_to_stack(const std::string&);
 
+		/**
+		 * \brief Gets the table containing a (possibly nested) variable on top of the stack
+		 *        (the global table for variables not in a table) and returns the name of the
+		 *        variable within it. If a table does not exist and should not be created, the
+		 *        value found instead of it (usually nil) is pushed, if it is not nil and should
+		 *        be replaced by a new table, an exception is thrown.
+		 * \param Full name of the variable.
+		 * \param If true, missing tables are created.
+		 */
+		std::string get_parent_to_stack_(const std::string&, bool);
+
+		/**
+		 * \brief Pushes a value that is being assigned to a variable onto the stack.
+		 * \param The value.
+		 */
+		void push_value_(bool val)
+		{
+			lua_pushboolean(L, val);
+		}
+
+		void push_value_(lua_Number val)
+		{
+			lua_pushnumber(L, val);
+		}
+
+		void push_value_(const char* val)
+		{
+			lua_pushstring(L, val);
+		}
+
+		void push_value_(const std::string& val)
+		{
+			lua_pushlstring(L, val.c_str(), val.size());
+		}
+
+		template<typename T>
+		typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type push_value_(T val)
+		{
+			lua_pushinteger(L, (lua_Integer)val);
+		}
+
 		/**
 		 * \brief Pops everything off the stack.
 		 */
@@ -258,6 +529,27 @@ class Script
 		 * Containes the names of all scripts loaded during the current runtime.
 		 */
 		std::set<std::string> loaded_scripts_;
+
+		/**
+		 * Memory allocator of the Lua virtual machine (has to outlive it).
+		 */
+		Allocator allocator_;
+
+		/**
+		 * Profiler, garbage collector controller, bytecode cache and worker pool of the Lua virtual machine.
+		 */
+		std::unique_ptr<ScriptProfiler> profiler_;
+		std::unique_ptr<GCController> gc_;
+		std::unique_ptr<BytecodeCache> bytecode_cache_;
+		std::unique_ptr<WorkerPool> workers_;
+
+		/**
+		 * Registry references of the arrays used by batched calls and the index
+		 * of the first one not used by a running batched call (so that batched
+		 * calls can be nested).
+		 */
+		std::vector<int> batch_arrays_;
+		std::size_t batch_top_;
 };
 
 /**
@@ -398,21 +690,4 @@ inline void Script::push_arg<bool>(bool arg)
 
 
 
-/**
- * Specializations for the method lpp::Script::register_value, for std::string it avoids calling
- * the std::to_string function and stores bools manually (std::to_strings converts it to 0 or 1,
- * which would cause lpp::Script::get throw, because Lua would interpret it as an integer).
- */
-template<>
-inline void Script::set<const std::string&>(const std::string& name, const std::string& val)
-{
-	execute(name + " = '" + val + "'");
-}
-
-template<>
-inline void Script::set<bool>(const std::string& name, bool val)
-{
-	execute(name + " = " + (val ? "true" : "false"));
-}
-
 }
\ No newline at end of file
@@ -0,0 +1,452 @@
+#include <algorithm>
+#include <cstring>
+#include <tools/Profiler.hpp>
+#include "LppWorkerPool.hpp"
+
+namespace
+{
+	/**
+	 * Number of calls a worker takes at once.
+	 */
+	constexpr tdt::uint chunk_size{32};
+
+	/**
+	 * Maximal depth of copied tables.
+	 */
+	constexpr int max_copy_depth{8};
+
+	/**
+	 * \brief Writer used by lua_dump, appends the bytecode to a string.
+	 */
+	int write_bytecode(lua_State*, const void* data, std::size_t size, void* res)
+	{
+		static_cast<std::string*>(res)->append(static_cast<const char*>(data), size);
+
+		return 0;
+	}
+
+	/**
+	 * \brief Pushes a (possibly nested, e.g. "game.enum") global variable onto the stack,
+	 *        pushes nil if any of the tables on the way does not exist.
+	 * \param The Lua state.
+	 * \param Name of the variable.
+	 */
+	void push_field(lua_State* L, const std::string& name)
+	{
+		lua_pushglobaltable(L);
+		std::size_t start{0};
+		while(true)
+		{
+			auto end = name.find('.', start);
+			if(!lua_istable(L, -1))
+			{
+				lua_pop(L, 1);
+				lua_pushnil(L);
+				return;
+			}
+			lua_getfield(L, -1, name.substr(start, end - start).c_str());
+			lua_remove(L, -2);
+
+			if(end == std::string::npos)
+				return;
+			start = end + 1;
+		}
+	}
+
+	/**
+	 * \brief Pops a value from one state and pushes it's copy onto another,
+	 *        values that cannot be copied are replaced with nil.
+	 * \param The source state.
+	 * \param The target state.
+	 * \param Depth of the value in the copied table.
+	 */
+	void copy_value(lua_State* from, lua_State* to, int depth)
+	{
+		switch(lua_type(from, -1))
+		{
+			case LUA_TBOOLEAN:
+				lua_pushboolean(to, lua_toboolean(from, -1));
+				break;
+			case LUA_TNUMBER:
+				if(lua_isinteger(from, -1))
+					lua_pushinteger(to, lua_tointeger(from, -1));
+				else
+					lua_pushnumber(to, lua_tonumber(from, -1));
+				break;
+			case LUA_TSTRING:
+			{
+				std::size_t length{};
+				auto str = lua_tolstring(from, -1, &length);
+				lua_pushlstring(to, str, length);
+				break;
+			}
+			case LUA_TTABLE:
+				if(depth >= max_copy_depth)
+				{
+					lua_pushnil(to);
+					break;
+				}
+
+				lua_newtable(to);
+				lua_pushnil(from);
+				while(lua_next(from, -2))
+				{
+					lua_pushvalue(from, -2);
+					copy_value(from, to, depth + 1); // Key.
+					copy_value(from, to, depth + 1); // Value.
+					if(!lua_isnil(to, -2))
+						lua_rawset(to, -3);
+					else
+						lua_pop(to, 2);
+				}
+				break;
+			default:
+				lua_pushnil(to);
+		}
+		lua_pop(from, 1);
+	}
+}
+
+lpp::WorkerPool::WorkerPool(lua_State* L)
+	: L_{L}, api_{}, tables_{}, workers_{}, mutex_{}, job_available_{}, job_done_{},
+	  stop_{false}, job_{}, job_number_{0}, next_call_{0}, active_{0}, failed_{false},
+	  min_calls_{chunk_size}, functions_{}, rejected_{}, version_{0}, last_error_{}
+{ /* DUMMY BODY */ }
+
+lpp::WorkerPool::~WorkerPool()
+{
+	stop();
+}
+
+void lpp::WorkerPool::set_api(lua_CFunction api, const std::vector<std::string>& tables)
+{
+	api_ = api;
+	tables_ = tables;
+}
+
+void lpp::WorkerPool::start(tdt::uint count)
+{
+	stop();
+
+	if(count == 0)
+	{ // Leave one core to the main thread.
+		count = std::thread::hardware_concurrency();
+		count = count > 1 ? count - 1 : 1;
+	}
+
+	// The states are created on the main thread, as they copy from the main state.
+	workers_.resize(count);
+	for(auto& worker : workers_)
+		create_state_(worker);
+
+	stop_ = false;
+	for(tdt::uint i = 0; i < workers_.size(); ++i)
+		workers_[i].thread = std::thread{&WorkerPool::work_, this, i, job_number_};
+}
+
+void lpp::WorkerPool::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		stop_ = true;
+	}
+	job_available_.notify_all();
+
+	for(auto& worker : workers_)
+	{
+		if(worker.thread.joinable())
+			worker.thread.join();
+		if(worker.L)
+			lua_close(worker.L);
+	}
+	workers_.clear();
+}
+
+bool lpp::WorkerPool::is_running() const
+{
+	return !workers_.empty();
+}
+
+tdt::uint lpp::WorkerPool::get_count() const
+{
+	return workers_.size();
+}
+
+void lpp::WorkerPool::set_min_calls(tdt::uint count)
+{
+	min_calls_ = count;
+}
+
+bool lpp::WorkerPool::is_pure(const std::string& table, const char* fname)
+{
+	if(rejected_.find(table + "." + fname) != rejected_.end())
+		return false;
+
+	push_field(L_, table + ".pure." + fname);
+	bool res = lua_toboolean(L_, -1) != 0;
+	lua_pop(L_, 1);
+
+	return res;
+}
+
+bool lpp::WorkerPool::evaluate(const std::string& table, const char* fname, tdt::uint first,
+							   const std::vector<tdt::uint>& args, std::vector<tdt::real>& results)
+{
+	if(workers_.empty() || args.size() < min_calls_)
+		return false;
+
+	auto name = table + "." + fname;
+	auto it = functions_.find(name);
+	if(it == functions_.end())
+	{
+		std::string bytecode{};
+		if(!is_pure(table, fname) || !dump_(name, bytecode))
+		{
+			rejected_.insert(name);
+			return false;
+		}
+		it = functions_.emplace(name, std::move(bytecode)).first;
+	}
+
+	PROFILE_ZONE("lpp::WorkerPool::evaluate");
+	results.resize(args.size());
+	{
+		std::unique_lock<std::mutex> lock{mutex_};
+		job_ = Job{&it->first, &it->second, first, &args, &results};
+		next_call_.store(0);
+		active_ = workers_.size();
+		failed_ = false;
+		++job_number_;
+		job_available_.notify_all();
+
+		job_done_.wait(lock, [this]() -> bool { return active_ == 0; });
+	}
+
+	if(failed_)
+	{ // Not pure after all (or just broken), the main state will report the error.
+		rejected_.insert(name);
+		functions_.erase(name);
+		return false;
+	}
+
+	return true;
+}
+
+void lpp::WorkerPool::reset()
+{
+	functions_.clear();
+	rejected_.clear();
+	++version_;
+}
+
+const std::string& lpp::WorkerPool::get_last_error() const
+{
+	return last_error_;
+}
+
+void lpp::WorkerPool::work_(tdt::uint idx, tdt::uint number)
+{
+	auto& worker = workers_[idx];
+	while(true)
+	{
+		{
+			std::unique_lock<std::mutex> lock{mutex_};
+			job_available_.wait(lock, [this, number]() -> bool { return stop_ || job_number_ != number; });
+			if(stop_)
+				return;
+			number = job_number_;
+		}
+
+		bool ok = evaluate_chunks_(worker);
+
+		std::lock_guard<std::mutex> lock{mutex_};
+		if(!ok)
+		{
+			failed_ = true;
+			auto msg = lua_tostring(worker.L, -1);
+			last_error_ = msg ? msg : "unknown error";
+			lua_pop(worker.L, 1);
+		}
+		if(--active_ == 0)
+			job_done_.notify_one();
+	}
+}
+
+bool lpp::WorkerPool::evaluate_chunks_(Worker& worker)
+{
+	auto L = worker.L;
+	if(worker.version != version_)
+	{ // Scripts were reloaded, drop the old functions.
+		lua_newtable(L);
+		lua_rawsetp(L, LUA_REGISTRYINDEX, &functions_);
+		worker.version = version_;
+	}
+
+	if(!push_function_(worker))
+		return false;
+
+	const auto& args = *job_.args;
+	auto& results = *job_.results;
+	while(true)
+	{
+		tdt::uint start = next_call_.fetch_add(chunk_size);
+		if(start >= args.size())
+			break;
+
+		tdt::uint end = std::min(start + chunk_size, (tdt::uint)args.size());
+		for(tdt::uint i = start; i < end; ++i)
+		{
+			lua_pushvalue(L, -1);
+			lua_pushinteger(L, (lua_Integer)job_.first);
+			lua_pushinteger(L, (lua_Integer)args[i]);
+			if(lua_pcall(L, 2, 1, 0) != LUA_OK)
+			{
+				next_call_.store(args.size()); // Stop the other workers.
+				lua_remove(L, -2);
+				return false;
+			}
+
+			switch(lua_type(L, -1))
+			{
+				case LUA_TNUMBER:
+					results[i] = (tdt::real)lua_tonumber(L, -1);
+					break;
+				case LUA_TBOOLEAN:
+					results[i] = lua_toboolean(L, -1) ? 1.f : 0.f;
+					break;
+				default:
+					results[i] = 0.f;
+			}
+			lua_pop(L, 1);
+		}
+	}
+	lua_pop(L, 1);
+
+	return true;
+}
+
+bool lpp::WorkerPool::push_function_(Worker& worker)
+{
+	auto L = worker.L;
+	const auto& name = *job_.name;
+
+	lua_rawgetp(L, LUA_REGISTRYINDEX, &functions_);
+	lua_getfield(L, -1, name.c_str());
+	if(!lua_isfunction(L, -1))
+	{
+		lua_pop(L, 1);
+		const auto& bytecode = *job_.bytecode;
+		if(luaL_loadbufferx(L, bytecode.data(), bytecode.size(), name.c_str(), "b") != LUA_OK)
+		{
+			lua_remove(L, -2);
+			return false;
+		}
+
+		// The only upvalue (if any) was set to the worker's globals by the load.
+		lua_pushvalue(L, -1);
+		lua_setfield(L, -3, name.c_str());
+	}
+	lua_remove(L, -2);
+
+	return true;
+}
+
+bool lpp::WorkerPool::dump_(const std::string& name, std::string& bytecode)
+{
+	push_field(L_, name);
+	bool res = lua_isfunction(L_, -1) != 0;
+	for(int i = 1; res; ++i)
+	{
+		auto upvalue = lua_getupvalue(L_, -1, i);
+		if(!upvalue)
+			break;
+		lua_pop(L_, 1);
+
+		// Only the global environment can be used, other upvalues would be lost.
+		res = i == 1 && std::strcmp(upvalue, "_ENV") == 0;
+	}
+
+	res = res && lua_dump(L_, &write_bytecode, &bytecode, 0) == 0;
+	lua_pop(L_, 1);
+
+	return res;
+}
+
+void lpp::WorkerPool::create_state_(Worker& worker)
+{
+	worker.allocator.reset(new Allocator{});
+	worker.L = lua_newstate(&WorkerPool::alloc_, worker.allocator.get());
+	worker.version = version_;
+	auto L = worker.L;
+	if(!L)
+		return;
+
+	// Only the libraries that cannot access files, the OS or other scripts.
+	luaL_requiref(L, "_G", luaopen_base, 1);
+	luaL_requiref(L, LUA_TABLIBNAME, luaopen_table, 1);
+	luaL_requiref(L, LUA_STRLIBNAME, luaopen_string, 1);
+	luaL_requiref(L, LUA_MATHLIBNAME, luaopen_math, 1);
+	lua_pop(L, 4);
+	for(auto fname : {"dofile", "loadfile", "load", "require", "collectgarbage"})
+	{
+		lua_pushnil(L);
+		lua_setglobal(L, fname);
+	}
+
+	lua_newtable(L);
+	lua_rawsetp(L, LUA_REGISTRYINDEX, &functions_);
+
+	if(api_)
+	{
+		lua_pushcfunction(L, api_);
+		if(lua_pcall(L, 0, 0, 0) != LUA_OK)
+		{
+			auto msg = lua_tostring(L, -1);
+			last_error_ = msg ? msg : "unknown error";
+			lua_pop(L, 1);
+		}
+	}
+
+	for(const auto& table : tables_)
+		copy_table_(L, table);
+}
+
+void lpp::WorkerPool::copy_table_(lua_State* L, const std::string& name)
+{
+	push_field(L_, name);
+	if(!lua_istable(L_, -1))
+	{
+		lua_pop(L_, 1);
+		return;
+	}
+
+	// Create the parent tables in the worker state.
+	lua_pushglobaltable(L);
+	std::size_t start{0};
+	auto end = name.find('.');
+	while(end != std::string::npos)
+	{
+		auto part = name.substr(start, end - start);
+		lua_getfield(L, -1, part.c_str());
+		if(!lua_istable(L, -1))
+		{
+			lua_pop(L, 1);
+			lua_newtable(L);
+			lua_pushvalue(L, -1);
+			lua_setfield(L, -3, part.c_str());
+		}
+		lua_remove(L, -2);
+
+		start = end + 1;
+		end = name.find('.', start);
+	}
+
+	copy_value(L_, L, 0);
+	lua_setfield(L, -2, name.substr(start).c_str());
+	lua_pop(L, 1);
+}
+
+void* lpp::WorkerPool::alloc_(void* ud, void* ptr, std::size_t osize, std::size_t nsize)
+{
+	return static_cast<Allocator*>(ud)->reallocate(ptr, osize, nsize);
+}
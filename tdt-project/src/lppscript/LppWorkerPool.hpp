@@ -0,0 +1,256 @@
+#pragma once
+
+#include <lua.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <Typedefs.hpp>
+#include "LppAllocator.hpp"
+
+namespace lpp
+{
+
+/**
+ * Pool of secondary (worker) Lua states that evaluate side-effect-free blueprint functions
+ * in parallel. A blueprint declares which of it's functions are pure in it's "pure" table
+ * (e.g. pure = { get_cost = true }), such functions may only read their arguments, globals
+ * and the read-only API registered in the worker states (see WorkerPool::set_api) and their
+ * results (the intent, e.g. the cost of a node) are returned to the main thread, which applies them.
+ * The worker states do not execute the scripts (whose top level code has side effects), instead
+ * every pure function is dumped from the main state and loaded into the workers the first time
+ * it is evaluated, which is why it cannot use upvalues (other than the global environment).
+ * Writes to globals only affect the worker state of the thread that made them.
+ * The main thread waits for the evaluation, so the game state is not changed while the workers
+ * read it. If a function cannot be evaluated by the workers (it is not pure, uses upvalues or
+ * raises an error), WorkerPool::evaluate returns false and the caller evaluates it in the main
+ * state, functions that failed are not offered to the workers again until the scripts are reloaded.
+ */
+class WorkerPool
+{
+	public:
+		/**
+		 * \brief Constructor.
+		 * \param The main Lua state, pure functions are taken from it.
+		 */
+		WorkerPool(lua_State*);
+
+		/**
+		 * \brief Destructor, stops the workers.
+		 */
+		~WorkerPool();
+
+		/**
+		 * \brief Sets the function that registers the read-only API in every worker state
+		 *        and the names of the global tables (containing constants only) that are copied
+		 *        from the main state to the worker states.
+		 * \param The function, called (in protected mode) in every new worker state.
+		 * \param Names of the copied tables (e.g. "game.enum").
+		 */
+		void set_api(lua_CFunction, const std::vector<std::string>& = {});
+
+		/**
+		 * \brief Creates the worker states and starts their threads, restarts the pool if it
+		 *        is already running.
+		 * \param Number of the workers, 0 uses the number of cores minus one.
+		 */
+		void start(tdt::uint = 0);
+
+		/**
+		 * \brief Stops and joins the workers and closes their states.
+		 */
+		void stop();
+
+		/**
+		 * \brief Returns true if the workers are running, false otherwise.
+		 */
+		bool is_running() const;
+
+		/**
+		 * \brief Returns the number of the workers.
+		 */
+		tdt::uint get_count() const;
+
+		/**
+		 * \brief Sets the minimal number of calls that are evaluated by the workers, smaller
+		 *        evaluations are left to the main thread as waking the workers would cost more.
+		 * \param The number of calls.
+		 */
+		void set_min_calls(tdt::uint);
+
+		/**
+		 * \brief Returns true if a given function is declared as pure by it's table
+		 *        (and did not fail in the workers), false otherwise.
+		 * \param Name of the table (blueprint).
+		 * \param Name of the function.
+		 */
+		bool is_pure(const std::string&, const char*);
+
+		/**
+		 * \brief Calls <table>.<function>(first, arg) for every given argument in the worker states
+		 *        and stores the results (numbers, booleans are converted to 0 or 1, anything else
+		 *        to 0) at the corresponding indices. Returns true if all calls were evaluated, false
+		 *        if the caller has to evaluate them on the main thread.
+		 * \param Name of the table (blueprint).
+		 * \param Name of the function.
+		 * \param First argument passed to all calls.
+		 * \param Second arguments, one per call.
+		 * \param Vector the results are stored into.
+		 */
+		bool evaluate(const std::string&, const char*, tdt::uint,
+					  const std::vector<tdt::uint>&, std::vector<tdt::real>&);
+
+		/**
+		 * \brief Forgets the loaded functions and failures, called when the scripts of the main
+		 *        state are reloaded.
+		 */
+		void reset();
+
+		/**
+		 * \brief Returns the message of the last error raised in a worker state.
+		 */
+		const std::string& get_last_error() const;
+
+		/**
+		 * Since the worker threads keep a pointer to the pool, all copy/move
+		 * operations are disabled for this class.
+		 */
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+		WorkerPool(WorkerPool&&) = delete;
+		WorkerPool& operator=(WorkerPool&&) = delete;
+
+	private:
+		/**
+		 * A single worker, it's state and the allocator of the state.
+		 */
+		struct Worker
+		{
+			lua_State* L;
+			std::unique_ptr<Allocator> allocator;
+			std::thread thread;
+			tdt::uint version; // Version of the functions loaded in the state.
+		};
+
+		/**
+		 * Evaluation currently handled by the workers.
+		 */
+		struct Job
+		{
+			const std::string* name;
+			const std::string* bytecode;
+			tdt::uint first;
+			const std::vector<tdt::uint>* args;
+			std::vector<tdt::real>* results;
+		};
+
+		/**
+		 * \brief Main loop of the worker threads.
+		 * \param Index of the worker.
+		 * \param Number of the last job before the worker started.
+		 */
+		void work_(tdt::uint, tdt::uint);
+
+		/**
+		 * \brief Evaluates chunks of the current job until there are none left,
+		 *        returns false if an error was raised.
+		 * \param The worker.
+		 */
+		bool evaluate_chunks_(Worker&);
+
+		/**
+		 * \brief Pushes the function of the current job onto the stack of a worker state,
+		 *        loading it if necessary.
+		 * \param The worker.
+		 */
+		bool push_function_(Worker&);
+
+		/**
+		 * \brief Dumps a pure function of the main state, returns false if it cannot be
+		 *        evaluated by the workers.
+		 * \param Full name of the function.
+		 * \param String the bytecode is stored into.
+		 */
+		bool dump_(const std::string&, std::string&);
+
+		/**
+		 * \brief Creates a new worker state with the read-only API and the copied tables.
+		 * \param The worker.
+		 */
+		void create_state_(Worker&);
+
+		/**
+		 * \brief Copies a table (recursively, functions and userdata are skipped) from the main
+		 *        state to a worker state.
+		 * \param The worker state.
+		 * \param Name of the table.
+		 */
+		void copy_table_(lua_State*, const std::string&);
+
+		/**
+		 * \brief Allocation function of the worker states.
+		 */
+		static void* alloc_(void*, void*, std::size_t, std::size_t);
+
+		/**
+		 * The main Lua state.
+		 */
+		lua_State* L_;
+
+		/**
+		 * Registers the read-only API in the worker states.
+		 */
+		lua_CFunction api_;
+
+		/**
+		 * Names of the tables copied to the worker states.
+		 */
+		std::vector<std::string> tables_;
+
+		/**
+		 * The workers.
+		 */
+		std::vector<Worker> workers_;
+
+		/**
+		 * Synchronization of the workers.
+		 */
+		std::mutex mutex_;
+		std::condition_variable job_available_;
+		std::condition_variable job_done_;
+		bool stop_;
+
+		/**
+		 * The current job, it's number (workers wait for a new one) and state.
+		 */
+		Job job_;
+		tdt::uint job_number_;
+		std::atomic<tdt::uint> next_call_;
+		tdt::uint active_;
+		bool failed_;
+
+		/**
+		 * Minimal number of calls evaluated by the workers.
+		 */
+		tdt::uint min_calls_;
+
+		/**
+		 * Dumped pure functions (full name -> bytecode), names of functions that
+		 * cannot be evaluated by the workers and version of the functions.
+		 */
+		std::map<std::string, std::string> functions_;
+		std::set<std::string> rejected_;
+		tdt::uint version_;
+
+		/**
+		 * Message of the last error raised in a worker.
+		 */
+		std::string last_error_;
+};
+
+}
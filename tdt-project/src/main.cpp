@@ -2,7 +2,11 @@
 #include <memory>
 #include <exception>
 #include <string>
+#include <vector>
+#include <cstdlib>
 #include <lppscript/LppScript.hpp>
+#include <tools/Journal.hpp>
+#include <tools/Benchmark.hpp>
 #include "Game.hpp"
 #ifdef WIN32
 #include "windows.h"
@@ -32,10 +36,53 @@ INT WINAPI WinMain(HINSTANCE hinst, HINSTANCE hprev, LPSTR cmd, int cmd_show)
 int main(int argc, char** argv)
 #endif
 {
+	/**
+	 * Command line arguments:
+	 *   --headless      Runs the simulation without a window, input and rendering.
+	 *   --script <file> Executes a Lua script after the game is initialized.
+	 *   --replay <name> Replays the journal saves/<name>.journal (as fast as possible
+	 *                   and exits when it ends if headless).
+	 *   --benchmark <scenario> Runs a benchmark scenario (see scripts/benchmarks.lua),
+	 *                   writes it's reports into <scenario>.json/.csv and exits.
+	 */
+#ifdef WIN32
+	std::vector<std::string> args{__argv + 1, __argv + __argc};
+#else
+	std::vector<std::string> args{argv + 1, argv + argc};
+#endif
+	bool headless{false};
+	std::string script{}, replay{}, benchmark{};
+	for(std::size_t i = 0; i < args.size(); ++i)
+	{
+		if(args[i] == "--headless")
+			headless = true;
+		else if(args[i] == "--script" && i + 1 < args.size())
+			script = args[++i];
+		else if(args[i] == "--replay" && i + 1 < args.size())
+			replay = args[++i];
+		else if(args[i] == "--benchmark" && i + 1 < args.size())
+			benchmark = args[++i];
+	}
+
 	try
 	{
 		lpp::Script::instance().register_function("show_msg", show_msg);
-		Game game{};
+		Game game{headless};
+		if(!script.empty())
+			lpp::Script::instance().load(script);
+		if(!benchmark.empty())
+		{
+			if(Benchmark::instance().run(game, benchmark))
+				return 0;
+			print_msg("Cannot run the benchmark " + benchmark + ".", "Benchmark error:");
+			return 1;
+		}
+		if(!replay.empty() && !Journal::instance().replay(game, replay, headless))
+		{
+			print_msg("Cannot replay the journal " + replay + " (missing, corrupted or recorded in the other mode).",
+					  "Replay error:");
+			return 1;
+		}
 		game.run();
 	}
 	catch(const Ogre::Exception& ex)
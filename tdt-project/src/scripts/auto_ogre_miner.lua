@@ -117,6 +117,9 @@ auto_ogre_miner = {
 	on_hit = function(id, hitter)
 	end,
 
+	-- Pathfinding functions that can be evaluated by the Lua worker states.
+	pure = { can_break = true, get_cost = true },
+
 	can_break = function(id, node)
 		return true
 	end,
@@ -0,0 +1,67 @@
+-- Benchmark scenarios, run with game.benchmark.run(name) or the --benchmark <name>
+-- command line argument. Attackers are spawned at the spawn nodes at the start, traps
+-- are placed at random free nodes of the area (radius in nodes) cleared around the
+-- starting area. Steps are simulated with the length of game.journal.get_step().
+local attackers = {
+	"evil_ogre_warrior", "evil_ogre_ice_mage", "evil_ogre_thunder_mage",
+	"evil_ogre_fire_mage", "evil_ogre_cleric"
+}
+local traps = { "damage_trap", "slow_trap", "freeze_trap", "kill_trap" }
+
+-- Small level, used to quickly check a change.
+game.benchmark.small = {
+	seed = 1,
+	width = 64,
+	height = 64,
+	steps = 1800,
+	wave_table = "game.wave.wave_test",
+	attackers = attackers,
+	attacker_count = 200,
+	traps = traps,
+	trap_count = 30,
+	clearing = 12
+}
+
+game.benchmark.medium = {
+	seed = 1,
+	width = 128,
+	height = 128,
+	steps = 3600,
+	wave_table = "game.wave.wave_test",
+	attackers = attackers,
+	attacker_count = 800,
+	traps = traps,
+	trap_count = 120,
+	clearing = 24
+}
+
+-- Stress test of the entity system, pathfinding and the Lua bindings.
+game.benchmark.stress_256 = {
+	seed = 1,
+	width = 256,
+	height = 256,
+	steps = 3600,
+	warmup = 60,
+	wave_table = "game.wave.wave_test",
+	attackers = attackers,
+	attacker_count = 2000,
+	traps = traps,
+	trap_count = 300,
+	clearing = 40
+}
+
+-- Stress test with incremental autosaves every 10 seconds.
+game.benchmark.stress_256_autosave = {
+	seed = 1,
+	width = 256,
+	height = 256,
+	steps = 3600,
+	warmup = 60,
+	wave_table = "game.wave.wave_test",
+	attackers = attackers,
+	attacker_count = 2000,
+	traps = traps,
+	trap_count = 300,
+	clearing = 40,
+	autosave = 10
+}
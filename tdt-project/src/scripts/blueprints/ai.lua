@@ -1,6 +1,10 @@
 -- AI blueprint used by the player's smart combat units, tries to find an enemy
 -- and attacks him (prefers enemies in sight).
 smart_friendly_combat_unit_ai = {
+	-- Runs in C++ (see NativeAI), the update function is used when native
+	-- behaviours are disabled.
+	native = true,
+
 	update = function(id)
 		local enemy = game.combat.closest_enemy_in_sight(id)
 		if enemy ~= game.const.no_ent then
@@ -21,6 +25,10 @@ smart_friendly_combat_unit_ai = {
 -- AI blueprint used by the player's dumb combat units, tries to find an enemy
 -- within range and in sight and attacks him.
 dumb_friendly_combat_unit_ai = {
+	-- Runs in C++ (see NativeAI), the update function is used when native
+	-- behaviours are disabled.
+	native = true,
+
 	update = function(id)
 		local enemy = game.combat.closest_enemy_in_sight(id)
 		if enemy ~= game.const.no_ent and game.combat.in_sight(id, enemy) then
@@ -35,6 +43,10 @@ dumb_friendly_combat_unit_ai = {
 -- and attacks it (prefers units in sight). If no unit is found, it attacks the
 -- dungeon throne.
 smart_enemy_combat_unit_ai = {
+	-- Runs in C++ (see NativeAI), the update function is used when native
+	-- behaviours are disabled.
+	native = true,
+
 	update = function(id)
 		local enemy = game.combat.closest_enemy_in_sight(id)
 		if enemy ~= game.const.no_ent then
@@ -63,6 +75,10 @@ smart_enemy_combat_unit_ai = {
 -- in range and in sight and attacks it. If no unit is found, it attacks the
 -- dungeon throne.
 dumb_enemy_combat_unit_ai = {
+	-- Runs in C++ (see NativeAI), the update function is used when native
+	-- behaviours are disabled.
+	native = true,
+
 	update = function(id)
 		local enemy = game.combat.closest_enemy_in_sight(id)
 		if enemy ~= game.const.no_ent and game.combat.in_sight(id, enemy) then
@@ -79,3 +95,12 @@ dumb_enemy_combat_unit_ai = {
 		end
 	end
 }
+
+-- Native behaviours replace only these update functions, a mod that reassigns
+-- update of a stock blueprint keeps running in Lua.
+for _, blueprint in ipairs({
+	"smart_friendly_combat_unit_ai", "dumb_friendly_combat_unit_ai",
+	"smart_enemy_combat_unit_ai", "dumb_enemy_combat_unit_ai"
+}) do
+	game.ai.pin_native(blueprint)
+end
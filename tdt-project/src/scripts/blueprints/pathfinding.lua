@@ -1,14 +1,17 @@
 -- Standard blueprint for entities that can use destructive pathfinding.
 can_break_blocks = {
+	-- Functions that can be evaluated by the Lua worker states.
+	pure = { can_break = true, get_cost = true },
+
 	can_break = function(id, node)
-		resident = game.grid.get_resident(node)
+		local resident = game.grid.get_resident(node)
 		return game.entity.has_component(resident,
 				game.enum.component.mine)
 	end,
 
 	get_cost = function(id, node)
-		resident = game.grid.get_resident(node)
-		hp = game.health.get(resident)
+		local resident = game.grid.get_resident(node)
+		local hp = game.health.get(resident)
 
 		return hp
 	end
@@ -17,13 +20,15 @@ can_break_blocks = {
 -- Strandard blueprint for entities that can move over free
 -- paths only.
 cannot_break_blocks = {
+	pure = { can_break = true, get_cost = true },
+
 	can_break = function(id, node)
 		return false
 	end,
 
 	get_cost = function(id, node)
-		resident = game.grid.get_resident(node)
-		hp = game.health.get(resident)
+		local resident = game.grid.get_resident(node)
+		local hp = game.health.get(resident)
 
 		return hp
 	end
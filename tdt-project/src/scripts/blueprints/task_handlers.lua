@@ -17,10 +17,14 @@ default_task_handler = {
 		elseif task_type == game.enum.task.go_to or
 		       task_type == game.enum.task.go_near or
 		       task_type == game.enum.task.get_in_range then
-			res = game.path.pathfind(id, target)
+			-- The path is solved asynchronously, the wait conditions
+			-- take pending requests into account.
+			res = game.path.request(id, target, task_type == game.enum.task.go_near)
 
-			if task_type == game.enum.task.go_near then
-				game.path.pop_last(id)
+			if task_type == game.enum.task.get_in_range then
+				game.task.wait(id, game.enum.task_wait.in_range)
+			else
+				game.task.wait(id, game.enum.task_wait.path)
 			end
 	   	elseif task_type == game.enum.task.go_kill then
 			local t1 = game.task.create(target, game.enum.task.get_in_range)
@@ -33,6 +37,7 @@ default_task_handler = {
 			res = false
 		elseif task_type == game.enum.task.kill then
 			game.combat.set_target(id, target)
+			game.task.wait(id, game.enum.task_wait.combat_target)
 			res = true
 		elseif task_type == game.enum.task.go_pick_up_gold then
 			local t1 = game.task.create(target, game.enum.task.go_near)
@@ -91,6 +96,8 @@ default_task_handler = {
 	-- Called from the C++ engine to check if a task has been
 	-- completed. The TaskComponent has an auxiliary boolean field
 	-- TaskComponent::complete that can be used for this.
+	-- Note: If handle_task set a wait condition (game.task.wait),
+	--       this is only called once that condition is met.
 	task_complete = function(id, task)
 		local task_type = game.task.get_type(task)
 		if task_type == game.enum.task.none or
@@ -15,7 +15,8 @@ local scripts = {
 	"blueprints/event_handling.lua", "blueprints/pathfinding.lua",
 	"blueprints/triggers.lua", "traps.lua", "light_crystal.lua",
 	"freezing_wave.lua", "slowing_wave.lua", "light_mana_crystal.lua",
-	"entity_spells.lua", "dungeon_throne.lua", "blueprints/upgrade.lua"
+	"entity_spells.lua", "dungeon_throne.lua", "blueprints/upgrade.lua",
+	"benchmarks.lua"
 }
 
 
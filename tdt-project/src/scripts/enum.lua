@@ -103,6 +103,15 @@ game.enum = {
 		deposit_gold = 9
 	},
 
+	task_wait = {
+		none = 0,
+		path = 1,
+		target = 2,
+		combat_target = 3,
+		in_range = 4,
+		time = 5
+	},
+
 	atk_type = {
 		none = 0,
 		melee = 1,
@@ -1,20 +1,37 @@
 #include <lppscript/LppScript.hpp>
 #include <Components.hpp>
+#include <Game.hpp>
 #include "AISystem.hpp"
 #include "EntitySystem.hpp"
 
-AISystem::AISystem(EntitySystem& ent)
-	: entities_{ent}, update_timer_{REAL_ZERO}, update_period_{.5f}
+AISystem::AISystem(EntitySystem& ent, CombatSystem& combat, const Game& game)
+	: entities_{ent}, combat_{combat}, game_{game}, update_timer_{REAL_ZERO},
+	  update_period_{.5f}, batch_{"update_batch"}, natives_{}
 { /* DUMMY BODY */ }
 
 void AISystem::update(tdt::real delta)
 {
+	static const auto update_fn = Symbol::get_function_id("update");
 	update_timer_ += delta;
 	if(update_timer_ > update_period_)
 		update_timer_ = REAL_ZERO;
 	else
 		return;
 
+	batch_.reset();
+	for(auto& native : natives_)
+	{ // Scripts can be reloaded or native behaviours disabled.
+		native.second.ids.clear();
+		native.second.behaviour = find_behaviour_(native.first);
+	}
+
+	/**
+	 * Entities are updated in the order of their IDs (which decides who claims a target
+	 * or a task first), so a run of entities updated at once (native or update_batch) is
+	 * flushed as soon as an entity with a different blueprint follows it.
+	 */
+	NativeAI::Context context{entities_, combat_, game_.get_throne_id()};
+	Symbol run{};
 	for(auto& ent : entities_.get_component_container<AIComponent>())
 	{
 		auto task_comp = entities_.get_component<TaskHandlerComponent>(ent.first);
@@ -24,9 +41,27 @@ void AISystem::update(tdt::real delta)
 			continue;
 		}
 
-		const std::string& blueprint  = ent.second.blueprint;
-		lpp::Script::instance().call<void, tdt::uint>(blueprint + ".update", ent.first);
+		if(run != Symbol{} && run != ent.second.blueprint)
+		{
+			flush_(context);
+			run = Symbol{};
+		}
+
+		auto& native = get_native_(ent.second.blueprint);
+		if(native.behaviour)
+		{
+			native.ids.push_back(ent.first);
+			run = ent.second.blueprint;
+		}
+		else if(batch_.is_batched(ent.second.blueprint))
+		{
+			batch_.add(ent.second.blueprint, ent.first);
+			run = ent.second.blueprint;
+		}
+		else
+			lpp::Script::instance().call<void, tdt::uint>(ent.second.blueprint.get_function(update_fn), ent.first);
 	}
+	flush_(context);
 }
 
 void AISystem::set_update_period(tdt::real val)
@@ -42,4 +77,42 @@ tdt::real AISystem::get_update_period() const
 void AISystem::force_update()
 {
 	update_timer_ = update_period_;
-}
\ No newline at end of file
+}
+
+AISystem::Native& AISystem::get_native_(const Symbol& blueprint)
+{
+	auto it = natives_.find(blueprint);
+	if(it == natives_.end())
+		it = natives_.emplace(blueprint, Native{find_behaviour_(blueprint), std::vector<tdt::uint>{}}).first;
+
+	return it->second;
+}
+
+NativeAI::Behaviour AISystem::find_behaviour_(const Symbol& blueprint) const
+{
+	auto behaviour = NativeAI::instance().get_behaviour(blueprint);
+	if(!behaviour)
+		return nullptr;
+
+	// Only the stock blueprints (not redefined by a mod) are marked as native
+	// and a mod could still replace just their update function.
+	auto& script = lpp::Script::instance();
+	auto flag = blueprint + ".native";
+	if(script.is_nil(flag) || !script.get<bool>(flag) || !NativeAI::instance().is_pinned_update(blueprint))
+		return nullptr;
+
+	return behaviour;
+}
+
+void AISystem::flush_(NativeAI::Context& context)
+{
+	for(auto& native : natives_)
+	{
+		if(!native.second.ids.empty())
+		{
+			native.second.behaviour(context, native.second.ids);
+			native.second.ids.clear();
+		}
+	}
+	batch_.call();
+}
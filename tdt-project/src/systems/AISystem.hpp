@@ -1,11 +1,18 @@
 #pragma once
 
+#include <map>
+#include <vector>
 #include <Typedefs.hpp>
+#include <tools/NativeAI.hpp>
+#include <tools/ScriptBatch.hpp>
 #include "System.hpp"
 class EntitySystem;
+class CombatSystem;
+class Game;
 
 /**
- * System handling the AI of entities by calling their update method every frame.
+ * System handling the AI of entities by calling their update method every frame,
+ * blueprints with a native behaviour (see NativeAI) are updated in C++.
  */
 class AISystem : public System
 {
@@ -13,8 +20,10 @@ class AISystem : public System
 		/**
 	     * Constructor.
 		 * \param Reference to the game's entity system.
+		 * \param Reference to the game's combat system (used by native behaviours).
+		 * \param Reference to the game (ID of the dungeon throne).
 		 */
-		AISystem(EntitySystem&);
+		AISystem(EntitySystem&, CombatSystem&, const Game&);
 
 		/**
 		 * Destructor.
@@ -22,8 +31,11 @@ class AISystem : public System
 		~AISystem() = default;
 
 		/**
-		 * \brief Updates all valid entities by calling their update function stored in the
-		 *        AIComponent::blueprint table.
+		 * \brief Updates all valid entities (in the order of their IDs) by calling their update
+		 *        function stored in the AIComponent::blueprint table. If the blueprint has a native
+		 *        behaviour, it is run for each run of consecutive entities with the blueprint at once,
+		 *        otherwise if the blueprint defines an update_batch function, it is called once per
+		 *        such run with an array of the entities.
 		 * \param Time since the last frame.
 		 */
 		void update(tdt::real) override;
@@ -48,13 +60,64 @@ class AISystem : public System
 		void force_update();
 
 	private:
+		/**
+		 * Entities of a single blueprint that has a native behaviour.
+		 */
+		struct Native
+		{
+			NativeAI::Behaviour behaviour; // nullptr if the blueprint runs in Lua.
+			std::vector<tdt::uint> ids;
+		};
+
+		/**
+		 * \brief Returns the native behaviour info of a given blueprint (checking
+		 *        it if necessary).
+		 * \param The blueprint.
+		 */
+		Native& get_native_(const Symbol&);
+
+		/**
+		 * \brief Returns the native behaviour of a given blueprint, nullptr
+		 *        if it should run in Lua.
+		 * \param The blueprint.
+		 */
+		NativeAI::Behaviour find_behaviour_(const Symbol&) const;
+
+		/**
+		 * \brief Runs the native behaviours and update_batch functions of the entities
+		 *        collected so far.
+		 * \param Game data used by the native behaviours.
+		 */
+		void flush_(NativeAI::Context&);
+
 		/**
 		 * Reference to the game's entity system.
 		 */
 		EntitySystem& entities_;
 
+		/**
+		 * Reference to the game's combat system.
+		 */
+		CombatSystem& combat_;
+
+		/**
+		 * Reference to the game.
+		 */
+		const Game& game_;
+
 		/**
 		 * Used to track the time and check if the entities should be updated.
 		 */
 		tdt::real update_timer_, update_period_;
+
+		/**
+		 * Entities whose blueprints define the update_batch function.
+		 */
+		ScriptBatch batch_;
+
+		/**
+		 * Entities whose blueprints have native behaviours (the vectors are kept
+		 * between updates so that filling them does not allocate).
+		 */
+		std::map<Symbol, Native> natives_;
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <tools/PathfindingAlgorithms.hpp>
 #include <tools/Pathfinding.hpp>
 #include <tools/Effects.hpp>
+#include <tools/Grid.hpp>
 #include <tools/RayCaster.hpp>
 #include <helpers/HealthHelper.hpp>
 #include <helpers/CombatHelper.hpp>
@@ -10,7 +11,8 @@
 
 CombatSystem::CombatSystem(EntitySystem& ents, Ogre::SceneManager& scene, GridSystem& grid)
 	: entities_{ents}, ray_query_{*scene.createRayQuery(Ogre::Ray{})},
-	  grid_{grid}, ray_caster_{scene}, run_away_queue_{}
+	  grid_{grid}, ray_caster_{scene}, run_away_queue_{},
+	  target_cache_{}, target_cache_generation_{}, target_cache_movement_generation_{}
 {
 	ray_query_.setSortByDistance(true);
 	ray_query_.setQueryMask((int)ENTITY_TYPE::WALL || (int)ENTITY_TYPE::BUILDING);
@@ -18,6 +20,8 @@ CombatSystem::CombatSystem(EntitySystem& ents, Ogre::SceneManager& scene, GridSy
 
 void CombatSystem::update(Ogre::Real delta)
 {
+	clear_target_cache();
+
 	// Running away.
 	if(!run_away_queue_.empty())
 	{
@@ -33,12 +37,15 @@ void CombatSystem::update(Ogre::Real delta)
 	for(auto& ent : entities_.get_component_container<CombatComponent>())
 	{
 		if(ent.second.cd_time < ent.second.cooldown)
-		{
+		{ // Running cooldowns are saved only by full saves.
 			ent.second.cd_time += delta;
 			continue;
 		}
 		else
+		{
 			ent.second.cd_time = 0;
+			entities_.mark_changed<CombatComponent>(ent.first);
+		}
 
 		if(ent.second.curr_target != Component::NO_ENTITY &&
 		   entities_.exists(ent.second.curr_target))
@@ -83,8 +90,10 @@ void CombatSystem::update(Ogre::Real delta)
 					if(on_path) // Enemy came to us, just start attacking!
 					{
 						AnimationHelper::stop(entities_, ent.first);
+						Grid::instance().remove_path_subscriber(ent.first, path_comp->path_queue);
 						path_comp->path_queue.clear();
 					}
+					PathService::instance().cancel(ent.first);
 
 					auto dmg = CombatHelper::get_dmg(ent.second.min_dmg, ent.second.max_dmg);
 					GraphicsHelper::look_at(entities_, ent.first, ent.second.curr_target);
@@ -131,7 +140,7 @@ void CombatSystem::update(Ogre::Real delta)
 		auto enemy_phys_comp = entities_.get_component<PhysicsComponent>(ent.second.target);
 
 		if(mov_comp && phys_comp && graph_comp && enemy_phys_comp &&
-		   graph_comp->node && graph_comp->entity)
+		   graph_comp->node && (graph_comp->entity || util::is_headless()))
 		{ // Moves the homing projectile in the target's direction and checks if hit occured.
 			auto& pos = phys_comp->position;
 			auto dir = enemy_phys_comp->position - pos;
@@ -139,7 +148,11 @@ void CombatSystem::update(Ogre::Real delta)
 
 			pos += dir * mov_comp->speed_modifier;
 			graph_comp->node->setPosition(pos);
-			auto radius = graph_comp->entity->getWorldBoundingSphere(true).getRadius();
+			tdt::real radius{};
+			if(graph_comp->entity)
+				radius = graph_comp->entity->getWorldBoundingSphere(true).getRadius();
+			else
+				radius = GraphicsHelper::get_bounds(entities_, ent.first, true).getHalfSize().length();
 
 			if(pos.squaredDistance(enemy_phys_comp->position) < radius * radius)
 			{ // That's a hit.
@@ -179,6 +192,8 @@ bool CombatSystem::in_sight(std::size_t ent_id, std::size_t target) const
 		else
 			return true;
 	}
+	else if(phys_comp && target_graph_comp && target_graph_comp->node && util::is_headless())
+		return in_sight_on_grid_(ent_id, target, phys_comp->position, target_graph_comp->node->getPosition());
 	else
 		return false;
 }
@@ -206,6 +221,8 @@ bool CombatSystem::in_sight_wrt_BB(std::size_t ent_id, std::size_t target) const
 		else
 			return true; // No structs found at all.
 	}
+	else if(phys_comp && target_graph_comp && target_graph_comp->node && util::is_headless())
+		return in_sight_on_grid_(ent_id, target, phys_comp->position, target_graph_comp->node->getPosition());
 	else
 		return false;
 }
@@ -213,17 +230,29 @@ bool CombatSystem::in_sight_wrt_BB(std::size_t ent_id, std::size_t target) const
 std::size_t CombatSystem::get_closest_entity(std::size_t id, bool only_sight, bool friendly) const
 {
 	if(friendly)
-		return get_closest_entity<CombatComponent>(id, util::IS_FRIENDLY(entities_, id), only_sight);
+	{
+		util::IS_FRIENDLY condition{entities_, id};
+		return get_closest_entity_cached_<CombatComponent>(id, TARGET_QUERY::FRIENDLY_ENTITY, condition, only_sight);
+	}
 	else
-		return get_closest_entity<CombatComponent>(id, util::IS_ENEMY(entities_, id), only_sight);
+	{
+		util::IS_ENEMY condition{entities_, id};
+		return get_closest_entity_cached_<CombatComponent>(id, TARGET_QUERY::ENEMY_ENTITY, condition, only_sight);
+	}
 }
 
 std::size_t CombatSystem::get_closest_structure(std::size_t id, bool only_sight, bool friendly) const
 {
 	if(friendly)
-		return get_closest_entity<StructureComponent>(id, util::IS_FRIENDLY(entities_, id), only_sight);
+	{
+		util::IS_FRIENDLY condition{entities_, id};
+		return get_closest_entity_cached_<StructureComponent>(id, TARGET_QUERY::FRIENDLY_STRUCTURE, condition, only_sight);
+	}
 	else
-		return get_closest_entity<StructureComponent>(id, util::IS_ENEMY(entities_, id), only_sight);
+	{
+		util::IS_ENEMY condition{entities_, id};
+		return get_closest_entity_cached_<StructureComponent>(id, TARGET_QUERY::ENEMY_STRUCTURE, condition, only_sight);
+	}
 }
 
 std::size_t CombatSystem::get_closest_entity_thats_not(std::size_t id, std::size_t ignored, bool only_sight, bool friendly) const
@@ -243,24 +272,20 @@ std::size_t CombatSystem::get_closest_entity_thats_not(std::size_t id, std::size
 std::size_t CombatSystem::get_closest_gold_deposit(std::size_t id, bool only_sight) const
 {
 	util::HAS_GOLD cond{entities_};
-	return get_closest_entity<MineComponent>(
-		id, [&](std::size_t ent) -> bool { return cond(ent) && FactionHelper::get_faction(entities_, ent) == FACTION::NEUTRAL; },
-		only_sight
-	);
+	auto condition = [&](std::size_t ent) -> bool { return cond(ent) && FactionHelper::get_faction(entities_, ent) == FACTION::NEUTRAL; };
+	return get_closest_entity_cached_<MineComponent>(id, TARGET_QUERY::GOLD_DEPOSIT, condition, only_sight);
 }
 
 std::size_t CombatSystem::get_closest_gold_vault(std::size_t id, bool only_sight, bool only_free) const
 {
+	util::IS_GOLD_VAULT cond{entities_};
 	if(only_free)
 	{
-		util::IS_GOLD_VAULT cond{entities_};
-		return get_closest_entity<StructureComponent>(
-			id, [&](std::size_t ent) -> bool { return cond(ent) && !GoldHelper::gold_full(entities_, ent); },
-			only_sight
-		);
+		auto condition = [&](std::size_t ent) -> bool { return cond(ent) && !GoldHelper::gold_full(entities_, ent); };
+		return get_closest_entity_cached_<StructureComponent>(id, TARGET_QUERY::FREE_GOLD_VAULT, condition, only_sight);
 	}
 	else
-		return get_closest_entity<StructureComponent>(id, util::IS_GOLD_VAULT(entities_), only_sight);
+		return get_closest_entity_cached_<StructureComponent>(id, TARGET_QUERY::GOLD_VAULT, cond, only_sight);
 }
 
 void CombatSystem::apply_heal_to_entities_in_range(std::size_t id, Ogre::Real range)
@@ -313,7 +338,7 @@ void CombatSystem::run_away_from_(std::size_t id, std::size_t from_id, std::size
 		std::size_t start_node{Grid::instance().get_node_from_position(phys->position.x, phys->position.z)};
 		std::size_t target{Component::NO_ENTITY}, target_node_count{0};
 
-		std::deque<std::size_t> path{};
+		std::deque<std::size_t> path{}, best_path{};
 		Ogre::Real min_distance{}; // Closest node from the path to the enemy.
 		util::heuristic::RUN_AWAY_HEURISTIC heuristic{entities_, from_id};
 
@@ -334,12 +359,16 @@ void CombatSystem::run_away_from_(std::size_t id, std::size_t from_id, std::size
 			{
 				target = new_target;
 				min_distance = new_min_distance;
+				best_path.swap(path);
 			}
 			++attempts;
 		}
 
-		if(!path.empty()) // Perform the actual pathfinding for the best target found.
-			util::pathfind<util::DEFAULT_PATHFINDING_ALGORITHM>(entities_, id, target, heuristic, true, false);
+		if(!best_path.empty()) // Use the path of the best target found, no need to search for it again.
+		{
+			PathService::instance().cancel(id);
+			util::assign_path(entities_, id, target, start_node, target, best_path, false);
+		}
 	}
 }
 
@@ -389,6 +418,81 @@ bool CombatSystem::enemy_in_range(std::size_t id)
 	return false;
 }
 
+void CombatSystem::set_target_cache_enabled(bool on_off)
+{
+	target_cache_enabled_ = on_off;
+	clear_target_cache();
+}
+
+bool CombatSystem::is_target_cache_enabled() const
+{
+	return target_cache_enabled_;
+}
+
+void CombatSystem::set_target_cache_size(tdt::uint size)
+{
+	target_cache_size_ = size > 0 ? size : 1;
+	clear_target_cache();
+}
+
+tdt::uint CombatSystem::get_target_cache_size() const
+{
+	return target_cache_size_;
+}
+
+void CombatSystem::clear_target_cache() const
+{
+	target_cache_.clear();
+	target_cache_generation_ = entities_.get_generation();
+	target_cache_movement_generation_ = entities_.get_movement_generation();
+}
+
+bool CombatSystem::in_sight_on_grid_(tdt::uint ent_id, tdt::uint target, const Ogre::Vector3& start,
+									 const Ogre::Vector3& end) const
+{
+	auto& grid = Grid::instance();
+	auto step = grid.get_distance() / 2.f;
+	Ogre::Vector2 direction{end.x - start.x, end.z - start.z};
+	auto length = direction.normalise();
+
+	// Samples the line at half of the node distance, so that no node is skipped.
+	for(tdt::real travelled = step; travelled < length; travelled += step)
+	{
+		auto node = grid.get_node_from_position(start.x + direction.x * travelled,
+												start.z + direction.y * travelled);
+		auto resident = GridNodeHelper::get_resident(entities_, node);
+		if(resident != Component::NO_ENTITY && resident != ent_id && resident != target)
+			return false;
+	}
+	return true;
+}
+
+CombatSystem::TargetCacheKey CombatSystem::get_target_cache_key_(tdt::uint id, TARGET_QUERY query,
+																 const Ogre::Vector3& position, bool only_sight) const
+{
+	if(target_cache_generation_ != entities_.get_generation()
+	   || target_cache_movement_generation_ != entities_.get_movement_generation())
+		clear_target_cache(); // Removed entities could still be in the entries and moved ones break the bounds.
+
+	auto cell = get_target_cell_(position);
+	return TargetCacheKey{query, FactionHelper::get_faction(entities_, id), cell.first, cell.second, only_sight};
+}
+
+bool CombatSystem::is_reachable_target_(tdt::uint id, tdt::uint target, bool only_sight) const
+{
+	return (!only_sight || in_sight(id, target))
+		   && util::pathfind(entities_, id, target, util::DEFAULT_HEURISTIC{entities_}, false);
+}
+
+std::pair<int, int> CombatSystem::get_target_cell_(const Ogre::Vector3& position) const
+{
+	auto distance = Grid::instance().get_distance();
+	if(distance <= 0.f)
+		distance = 1.f;
+
+	return std::make_pair((int)std::floor(position.x / distance), (int)std::floor(position.z / distance));
+}
+
 void CombatSystem::create_homing_projectile(std::size_t caster, CombatComponent& combat)
 {
 	std::size_t id = entities_.create_entity(combat.projectile_blueprint);
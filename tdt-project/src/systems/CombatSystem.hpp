@@ -1,6 +1,11 @@
 #pragma once
 
 #include <tuple>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <cmath>
 #include <bitset>
 #include <map>
 #include <string>
@@ -260,7 +265,208 @@ class CombatSystem : public System
 		 */
 		bool enemy_in_range(tdt::uint);
 
+		/**
+		 * \brief Enables or disables the target cache used by the closest entity
+		 *        (enemy, structure, gold deposit and gold vault) queries.
+		 * \param True to enable, false to disable.
+		 */
+		void set_target_cache_enabled(bool);
+
+		/**
+		 * \brief Returns true if the target cache is enabled, false otherwise.
+		 */
+		bool is_target_cache_enabled() const;
+
+		/**
+		 * \brief Sets the amount of candidates stored in a single target cache entry.
+		 * \param The new amount (at least 1).
+		 */
+		void set_target_cache_size(tdt::uint);
+
+		/**
+		 * \brief Returns the amount of candidates stored in a single target cache entry.
+		 */
+		tdt::uint get_target_cache_size() const;
+
+		/**
+		 * \brief Removes all entries from the target cache, called every update.
+		 */
+		void clear_target_cache() const;
+
 	private:
+		/**
+		 * Key of a target cache entry: query type, faction of the searching entity,
+		 * coordinates of the grid cell the searching entity stands in and the sight flag.
+		 */
+		using TargetCacheKey = std::tuple<TARGET_QUERY, FACTION, int, int, bool>;
+
+		/**
+		 * Entities closest to a grid cell that meet the condition of a query.
+		 */
+		struct TargetCacheEntry
+		{
+			/**
+			 * The candidates sorted by their distance from the origin.
+			 */
+			std::vector<tdt::uint> candidates;
+
+			/**
+			 * Position of the entity that created the entry, distances are measured from it.
+			 */
+			Ogre::Vector3 origin;
+
+			/**
+			 * Distance between the origin and the closest entity meeting the condition that
+			 * did not make it into the entry (max real if there is no such entity).
+			 */
+			tdt::real bound;
+
+			/**
+			 * Size of the searched component container when the entry was created.
+			 */
+			tdt::uint container_size;
+		};
+
+		/**
+		 * \brief Returns the ID of the closest entity that has a given component, meets
+		 *        a given condition and is accessible using the target cache, produces the
+		 *        same result as get_closest_entity (unless an entity starts meeting the
+		 *        condition after the entry was created, e.g. a gold vault gets emptied).
+		 * \param ID of the entity that is searching.
+		 * \param Type of the query (entities making the same query from the same cell share
+		 *        the entry, so the condition has to depend only on the faction of the searcher).
+		 * \param Functor representing the condition.
+		 * \param If true, only entities in sight get checked.
+		 * \note Only the candidates in the entry are checked for sight and accessibility, the full
+		 *       search is performed only if none of them qualifies and an entity outside of the entry
+		 *       could be closer to the searching entity.
+		 */
+		template<typename CONT, typename COND>
+		tdt::uint get_closest_entity_cached_(tdt::uint id, TARGET_QUERY query, COND& condition, bool only_sight) const
+		{
+			if(!target_cache_enabled_)
+				return get_closest_entity<CONT>(id, condition, only_sight);
+
+			auto phys_comp = entities_.get_component<PhysicsComponent>(id);
+			if(!phys_comp)
+				return Component::NO_ENTITY;
+
+			auto position = phys_comp->position;
+			auto key = get_target_cache_key_(id, query, position, only_sight);
+			auto it = target_cache_.find(key);
+			if(it != target_cache_.end() && it->second.container_size != get_container<CONT>().size())
+			{ // Entities added since the entry was created could be closer.
+				target_cache_.erase(it);
+				it = target_cache_.end();
+			}
+			if(it == target_cache_.end())
+				it = target_cache_.emplace(key, create_target_cache_entry_<CONT>(position, condition)).first;
+			const auto& entry = it->second;
+
+			std::vector<std::pair<tdt::real, tdt::uint>> candidates{};
+			candidates.reserve(entry.candidates.size());
+			for(auto candidate : entry.candidates)
+			{
+				if(candidate == id || !condition(candidate))
+					continue;
+
+				auto candidate_phys_comp = entities_.get_component<PhysicsComponent>(candidate);
+				if(candidate_phys_comp)
+					candidates.emplace_back(position.squaredDistance(candidate_phys_comp->position), candidate);
+			}
+			std::sort(candidates.begin(), candidates.end());
+
+			/**
+			 * Entities outside of the entry are at least bound - |position - origin| away
+			 * (triangle inequality), so candidates closer than that are the closest overall.
+			 */
+			auto complete = entry.bound == std::numeric_limits<tdt::real>::max();
+			auto limit = entry.bound - position.distance(entry.origin);
+			limit = limit > 0.f ? limit * limit : 0.f;
+
+			std::vector<tdt::uint> rejected{};
+			for(const auto& candidate : candidates)
+			{
+				if(!complete && candidate.first > limit)
+					break;
+
+				if(is_reachable_target_(id, candidate.second, only_sight))
+					return candidate.second;
+				else
+					rejected.push_back(candidate.second);
+			}
+
+			if(complete)
+				return Component::NO_ENTITY;
+
+			auto not_rejected = [&](tdt::uint ent) -> bool {
+				return std::find(rejected.begin(), rejected.end(), ent) == rejected.end() && condition(ent);
+			};
+			return get_closest_entity<CONT>(id, not_rejected, only_sight);
+		}
+
+		/**
+		 * \brief Creates a target cache entry containing the entities meeting a given
+		 *        condition that are closest to a given position.
+		 * \param Position of the searching entity.
+		 * \param Functor representing the condition.
+		 */
+		template<typename CONT, typename COND>
+		TargetCacheEntry create_target_cache_entry_(const Ogre::Vector3& origin, COND& condition) const
+		{
+			std::vector<std::pair<tdt::real, tdt::uint>> candidates{};
+			for(auto& ent : get_container<CONT>())
+			{
+				if(!condition(ent.first))
+					continue;
+
+				auto phys_comp = entities_.get_component<PhysicsComponent>(ent.first);
+				if(phys_comp)
+					candidates.emplace_back(origin.squaredDistance(phys_comp->position), ent.first);
+			}
+
+			TargetCacheEntry entry{};
+			entry.origin = origin;
+			entry.bound = std::numeric_limits<tdt::real>::max();
+			entry.container_size = get_container<CONT>().size();
+			if(candidates.size() > target_cache_size_)
+			{
+				std::partial_sort(candidates.begin(), candidates.begin() + target_cache_size_ + 1, candidates.end());
+				entry.bound = std::sqrt(candidates[target_cache_size_].first);
+				candidates.resize(target_cache_size_);
+			}
+
+			for(const auto& candidate : candidates)
+				entry.candidates.push_back(candidate.second);
+
+			return entry;
+		}
+
+		/**
+		 * \brief Returns true if a given entity can reach (and optionally see) a given target,
+		 *        false otherwise.
+		 * \param ID of the searching entity.
+		 * \param ID of the target.
+		 * \param If true, the target has to be in sight.
+		 */
+		bool is_reachable_target_(tdt::uint, tdt::uint, bool) const;
+
+		/**
+		 * \brief Returns the target cache key of a query made by a given entity, clears the
+		 *        cache if a component was removed or an entity moved since it was last used.
+		 * \param ID of the searching entity.
+		 * \param Type of the query.
+		 * \param Position of the searching entity.
+		 * \param If true, the query checks only entities in sight.
+		 */
+		TargetCacheKey get_target_cache_key_(tdt::uint, TARGET_QUERY, const Ogre::Vector3&, bool) const;
+
+		/**
+		 * \brief Returns the coordinates of the target cache cell containing a given position.
+		 * \param The position.
+		 */
+		std::pair<int, int> get_target_cell_(const Ogre::Vector3&) const;
+
 		/**
 		 * \brief Retuns a map containing pairs of IDs and components of a given type, use
 		 *        the type ALL_COMPONENTS to get the <ID, component bitset> container.
@@ -289,6 +495,17 @@ class CombatSystem : public System
 		 */
 		void run_away_from_(tdt::uint, tdt::uint, tdt::uint);
 
+		/**
+		 * \brief Returns true if no structure stands on the grid nodes between two given
+		 *        positions, used instead of ray casting in the headless mode (where
+		 *        there are no Ogre entities to cast rays at).
+		 * \param ID of the first entity.
+		 * \param ID of the second entity.
+		 * \param Position of the first entity.
+		 * \param Position of the second entity.
+		 * \note Structures the two entities stand on (or are) do not block the sight.
+		 */
+		bool in_sight_on_grid_(tdt::uint, tdt::uint, const Ogre::Vector3&, const Ogre::Vector3&) const;
 
 		/**
 		 * Reference to the game's entity system (component retrieval).
@@ -321,6 +538,33 @@ class CombatSystem : public System
 		 * all run away pathfindings are done.)
 		 */
 		std::queue<std::tuple<tdt::uint, tdt::uint, tdt::uint>> run_away_queue_;
+
+		/**
+		 * Results of the closest entity queries shared by entities making the same query
+		 * from the same grid cell until something moves (e.g. a wave spawned on a single node
+		 * during the AI update). Cleared every update, whenever an entity moves (see
+		 * EntitySystem::get_movement_generation) and whenever a component gets removed
+		 * (an entity died). Not synchronized, the queries are made only from the main thread.
+		 */
+		mutable std::map<TargetCacheKey, TargetCacheEntry> target_cache_;
+
+		/**
+		 * Generation of the component containers and movement generation (see
+		 * EntitySystem::get_generation and EntitySystem::get_movement_generation)
+		 * the target cache is valid for.
+		 */
+		mutable tdt::uint target_cache_generation_;
+		mutable tdt::uint target_cache_movement_generation_;
+
+		/**
+		 * Amount of candidates stored in a single target cache entry.
+		 */
+		tdt::uint target_cache_size_{8};
+
+		/**
+		 * If false, the closest entity queries perform full search every time.
+		 */
+		bool target_cache_enabled_{true};
 };
 
 /**
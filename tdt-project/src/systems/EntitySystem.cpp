@@ -31,7 +31,8 @@
 
 EntitySystem::EntitySystem(Ogre::SceneManager& mgr)
 	: scene_{mgr}, entities_{}, to_be_destroyed_{},
-	  components_to_be_removed_{}, entity_register_{}
+	  components_to_be_removed_{}, entity_register_{},
+	  task_pool_{}
 {
 	init_function_arrays();
 }
@@ -78,8 +79,8 @@ void EntitySystem::cleanup()
 	/**
 	 * Remove entire entities.
 	 * NOTE: Creating a new vector and swaping it with the to_be_destroyed_ vector,
-	 *       because when a TaskHandlerComponent is deleted, new entities (the tasks)
-	 *       are added which might result in iterator invalidation.
+	 *       because component clean ups (or destructors called from them) might
+	 *       mark other entities for removal, which might result in iterator invalidation.
 	 */
 	std::vector<tdt::uint> tmp_to_be_destroyed_{};
 	tmp_to_be_destroyed_.swap(to_be_destroyed_);
@@ -98,6 +99,8 @@ void EntitySystem::cleanup()
 				delete_component_now(id, i);
 		}
 		entities_.erase(id);
+		if(track_changes_)
+			destroyed_entities_.push_back(id);
 	}
 
 	// Call constructors.
@@ -110,6 +113,8 @@ tdt::uint EntitySystem::create_entity(const std::string& table_name, const Ogre:
 {
 	tdt::uint id = get_new_id();
 	entities_.emplace(std::make_pair(id, std::bitset<Component::count>{}));
+	if(track_changes_)
+		created_entities_.push_back(id);
 
 	if(table_name == "") // Allows to create empty entities that are setup manually.
 		return id;
@@ -189,7 +194,82 @@ void EntitySystem::delete_entities()
 {
 	for(auto& ent : entities_)
 		to_be_destroyed_.emplace_back(ent.first);
+	task_pool_.clear();
 	curr_id_ = 0;
+	invalidate_changes();
+}
+
+void EntitySystem::mark_changed(tdt::uint ent_id, int comp_id)
+{
+	if(track_changes_ && comp_id >= 0 && comp_id < Component::count)
+		record_change(ent_id, comp_id);
+}
+
+tdt::uint EntitySystem::get_generation() const
+{
+	return generation_;
+}
+
+tdt::uint EntitySystem::get_movement_generation() const
+{
+	return movement_generation_;
+}
+
+void EntitySystem::mark_moved()
+{
+	++movement_generation_;
+}
+
+void EntitySystem::set_change_tracking(bool on_off)
+{
+	if(!on_off)
+		invalidate_changes();
+	track_changes_ = on_off;
+}
+
+bool EntitySystem::get_change_tracking() const
+{
+	return track_changes_;
+}
+
+void EntitySystem::invalidate_changes()
+{
+	clear_changes();
+	changes_lost_ = true;
+}
+
+TaskPool& EntitySystem::get_task_pool()
+{
+	return task_pool_;
+}
+
+void EntitySystem::record_change(tdt::uint id, int type)
+{
+	auto& changes = changes_[type];
+	if(id >= changes.marked.size())
+	{
+		if(id == Component::NO_ENTITY)
+			return;
+		changes.marked.resize(id + 1);
+	}
+
+	if(!changes.marked[id])
+	{
+		changes.marked[id] = true;
+		changes.ids.push_back(id);
+	}
+}
+
+void EntitySystem::clear_changes()
+{
+	for(auto& changes : changes_)
+	{
+		for(auto id : changes.ids)
+			changes.marked[id] = false;
+		changes.ids.clear();
+	}
+	created_entities_.clear();
+	destroyed_entities_.clear();
 }
 
 void EntitySystem::init_function_arrays()
@@ -254,7 +334,7 @@ void EntitySystem::init_function_arrays()
 	adders_[GridNodeComponent::type] = &EntitySystem::add_component<GridNodeComponent>;
 	adders_[ProductComponent::type] = &EntitySystem::add_component<ProductComponent>;
 	adders_[PathfindingComponent::type] = &EntitySystem::add_component<PathfindingComponent>;
-	adders_[TaskComponent::type] = &EntitySystem::add_component<TaskComponent>;
+	adders_[TaskComponent::type] = nullptr; // Tasks are not entities, see TaskPool.
 	adders_[TaskHandlerComponent::type] = &EntitySystem::add_component<TaskHandlerComponent>;
 	adders_[StructureComponent::type] = &EntitySystem::add_component<StructureComponent>;
 	adders_[HomingComponent::type] = &EntitySystem::add_component<HomingComponent>;
@@ -299,7 +379,7 @@ void EntitySystem::init_function_arrays()
 	deleters_[GridNodeComponent::type] = &EntitySystem::delete_component<GridNodeComponent>;
 	deleters_[ProductComponent::type] = &EntitySystem::delete_component<ProductComponent>;
 	deleters_[PathfindingComponent::type] = &EntitySystem::delete_component<PathfindingComponent>;
-	deleters_[TaskComponent::type] = &EntitySystem::delete_component<TaskComponent>;
+	deleters_[TaskComponent::type] = nullptr;
 	deleters_[TaskHandlerComponent::type] = &EntitySystem::delete_component<TaskHandlerComponent>;
 	deleters_[StructureComponent::type] = &EntitySystem::delete_component<StructureComponent>;
 	deleters_[HomingComponent::type] = &EntitySystem::delete_component<HomingComponent>;
@@ -344,7 +424,7 @@ void EntitySystem::init_function_arrays()
 	immediate_deleters_[GridNodeComponent::type] = &EntitySystem::delete_component_now<GridNodeComponent>;
 	immediate_deleters_[ProductComponent::type] = &EntitySystem::delete_component_now<ProductComponent>;
 	immediate_deleters_[PathfindingComponent::type] = &EntitySystem::delete_component_now<PathfindingComponent>;
-	immediate_deleters_[TaskComponent::type] = &EntitySystem::delete_component_now<TaskComponent>;
+	immediate_deleters_[TaskComponent::type] = nullptr;
 	immediate_deleters_[TaskHandlerComponent::type] = &EntitySystem::delete_component_now<TaskHandlerComponent>;
 	immediate_deleters_[StructureComponent::type] = &EntitySystem::delete_component_now<StructureComponent>;
 	immediate_deleters_[HomingComponent::type] = &EntitySystem::delete_component_now<HomingComponent>;
@@ -10,6 +10,8 @@
 #include <lppscript/LppScript.hpp>
 #include <helpers/Helpers.hpp>
 #include <tools/Player.hpp>
+#include <tools/TaskPool.hpp>
+#include <tools/Grid.hpp>
 #include <tools/Util.hpp>
 #include <Typedefs.hpp>
 #include "System.hpp"
@@ -21,6 +23,7 @@
 class EntitySystem : public System
 {
 	friend class util::EntityDestroyer;
+	friend class QuickSaveRing;
 	typedef void (EntitySystem::*LoaderFuncPtr)(tdt::uint, const std::string&);
 	typedef void (EntitySystem::*AdderFuncPtr)(tdt::uint);
 	typedef void (EntitySystem::*DeleterFuncPtr)(tdt::uint);
@@ -101,7 +104,10 @@ class EntitySystem : public System
 		{
 			auto it = get_component_container<COMP>().find(id);
 			if(it != get_component_container<COMP>().end())
+			{
+				track_access<COMP>(id);
 				return &it->second;
+			}
 			else
 				return nullptr;
 		}
@@ -123,6 +129,21 @@ class EntitySystem : public System
 				get_component_container<COMP>().emplace(std::make_pair(id, std::move(comp)));
 				entities_[id].set(COMP::type); // Notify of the presence of this new component.
 			}
+			mark_changed<COMP>(id);
+		}
+
+		/**
+		 * \brief Assigns a component to an entity that didn't have it, used when bulk loading
+		 *        components of entities that were created in the order of their IDs.
+		 * \param ID of the entity (has to be higher than the IDs of all entities with this component).
+		 * \param Component to be assigned.
+		 */
+		template<typename COMP>
+		void insert_component(tdt::uint id, COMP comp)
+		{
+			auto& container = get_component_container<COMP>();
+			container.emplace_hint(container.end(), id, std::move(comp));
+			entities_[id].set(COMP::type);
 		}
 
 		/**
@@ -144,6 +165,7 @@ class EntitySystem : public System
 			{
 				it->second.set(COMP::type, true);
 				get_component_container<COMP>().emplace(id, COMP{});
+				mark_changed<COMP>(id);
 			}
 		}
 
@@ -171,6 +193,75 @@ class EntitySystem : public System
 		 */
 		void delete_component(tdt::uint, int);
 
+		/**
+		 * \brief Marks a component (type specified by template argument) of an entity as changed
+		 *        since the last incremental save, used by systems that modify the components
+		 *        they iterate over (components returned by get_component are marked automatically).
+		 * \param ID of the entity.
+		 */
+		template<typename COMP>
+		void mark_changed(tdt::uint id)
+		{
+			if(track_changes_)
+				record_change(id, COMP::type);
+		}
+
+		/**
+		 * \brief Allows to mark a component as changed based on it's ID.
+		 * \param ID of the entity.
+		 * \param ID of the component.
+		 */
+		void mark_changed(tdt::uint, int);
+
+		/**
+		 * \brief Returns the generation of the component containers, which changes whenever
+		 *        a component is removed or the containers are replaced (until then, pointers
+		 *        to components stay valid, because the containers are maps).
+		 */
+		tdt::uint get_generation() const;
+
+		/**
+		 * \brief Returns the movement generation, which changes whenever an existing entity
+		 *        changes it's position (used to invalidate results that depend on positions).
+		 */
+		tdt::uint get_movement_generation() const;
+
+		/**
+		 * \brief Changes the movement generation, called by everything that moves existing
+		 *        entities (PhysicsHelper::set_position, MovementSystem etc.).
+		 */
+		void mark_moved();
+
+		/**
+		 * \brief Marks a component as changed, called whenever a pointer to a component
+		 *        is handed out (get_component, component caches).
+		 * \param ID of the entity.
+		 */
+		template<typename COMP>
+		void track_access(tdt::uint id)
+		{
+			if(track_changes_)
+				record_change(id, COMP::type);
+		}
+
+		/**
+		 * \brief Turns tracking of changed components (used by incremental saves) on or off.
+		 * \param True to turn the tracking on, false otherwise.
+		 */
+		void set_change_tracking(bool);
+
+		/**
+		 * \brief Returns true if changed components are being tracked, false otherwise.
+		 */
+		bool get_change_tracking() const;
+
+		/**
+		 * \brief Forgets all tracked changes and marks them as incomplete, so that the next
+		 *        incremental save has to save everything (used when components are replaced
+		 *        wholesale, e.g. when a game is loaded).
+		 */
+		void invalidate_changes();
+
 		/**
 		 * \brief Registers an entity that has been loaded from a Lua script.
 		 *        (If it has been registered previously, the register ignores it.)
@@ -201,6 +292,12 @@ class EntitySystem : public System
 		 */
 		void delete_entities();
 
+		/**
+		 * \brief Returns a reference to the pool containing all tasks (tasks are
+		 *        not entities, see TaskPool).
+		 */
+		TaskPool& get_task_pool();
+
 		/**
 		 * Used in helpers when no component exists and we still need to return
 		 * the blueprint name (in this case the ERROR blueprint) by reference.
@@ -245,6 +342,8 @@ class EntitySystem : public System
 				ent->second.set(COMP::type, false);
 			clean_up_component<COMP>(id);
 			get_component_container<COMP>().erase(id);
+			mark_changed<COMP>(id);
+			++generation_;
 		}
 
 		/**
@@ -260,6 +359,18 @@ class EntitySystem : public System
 		 */
 		void init_function_arrays();
 
+		/**
+		 * \brief Records that a component of an entity has changed (or was removed).
+		 * \param ID of the entity.
+		 * \param Type of the component.
+		 */
+		void record_change(tdt::uint, int);
+
+		/**
+		 * \brief Forgets all tracked changes (called once they have been saved).
+		 */
+		void clear_changes();
+
 		/**
 		 * \brief Deletes all necessary data when destroying a component (like Ogre
 		 *        related objects, other entities, tasks etc.).
@@ -299,7 +410,6 @@ class EntitySystem : public System
 		std::map<tdt::uint, GridNodeComponent> grid_node_{};
 		std::map<tdt::uint, ProductComponent> product_{};
 		std::map<tdt::uint, PathfindingComponent> pathfinding_{};
-		std::map<tdt::uint, TaskComponent> task_{};
 		std::map<tdt::uint, TaskHandlerComponent> task_handler_{};
 		std::map<tdt::uint, StructureComponent> structure_{};
 		std::map<tdt::uint, HomingComponent> homing_{};
@@ -339,6 +449,11 @@ class EntitySystem : public System
 		 */
 		std::set<std::string> entity_register_;
 
+		/**
+		 * Contains all tasks (see TaskPool).
+		 */
+		TaskPool task_pool_;
+
 		/**
 		 * These arrays contain pointers to the component managment methods for easier
 		 * use when Lua interacts with C++, since Lua doesn't know anything about C++
@@ -361,6 +476,45 @@ class EntitySystem : public System
 		 * function.
 		 */
 		std::vector<tdt::uint> constructors_to_be_called_{};
+
+		/**
+		 * IDs of entities whose component of a given type changed since the last incremental
+		 * save, the bit vector (indexed by entity ID) prevents duplicates in the ID list.
+		 * Changes are recorded only on the main thread, so no locking is needed.
+		 */
+		struct ChangeSet
+		{
+			std::vector<bool> marked;
+			std::vector<tdt::uint> ids;
+		};
+		std::array<ChangeSet, Component::count> changes_{};
+
+		/**
+		 * Entities created and destroyed since the last incremental save.
+		 */
+		std::vector<tdt::uint> created_entities_{};
+		std::vector<tdt::uint> destroyed_entities_{};
+
+		/**
+		 * If true, changed components are being tracked.
+		 */
+		bool track_changes_{false};
+
+		/**
+		 * If true, the tracked changes are incomplete (tracking was off or components
+		 * were replaced wholesale since the last incremental save).
+		 */
+		bool changes_lost_{true};
+
+		/**
+		 * Generation of the component containers (see EntitySystem::get_generation).
+		 */
+		tdt::uint generation_{};
+
+		/**
+		 * Movement generation (see EntitySystem::get_movement_generation).
+		 */
+		tdt::uint movement_generation_{};
 };
 
 /**
@@ -456,12 +610,6 @@ inline std::map<tdt::uint, PathfindingComponent>& EntitySystem::get_component_co
 	return pathfinding_;
 }
 
-template<>
-inline std::map<tdt::uint, TaskComponent>& EntitySystem::get_component_container<TaskComponent>()
-{
-	return task_;
-}
-
 template<>
 inline std::map<tdt::uint, TaskHandlerComponent>& EntitySystem::get_component_container<TaskHandlerComponent>()
 {
@@ -635,7 +783,7 @@ inline std::map<tdt::uint, ActivationComponent>& EntitySystem::get_component_con
  * \note Following components can only be created manually and thus don't have load_component specialization.
  *       GridNodeComponent (created by GridSystem::add_node)
  *       ProductComponent (production id is assigned during runtime)
- *       TaskComponent     (tasks are specified by their types and are added through the TaskHelper)
+ *       TaskComponent     (tasks are not entities, they are stored in the TaskPool and created through the TaskHelper)
  */
 template<>
 inline void EntitySystem::load_component<PhysicsComponent>(tdt::uint id, const std::string& table_name)
@@ -674,13 +822,16 @@ inline void EntitySystem::load_component<GraphicsComponent>(tdt::uint id, const
 	// Ogre init of the entity and scene node.
 	auto& comp = res.first->second;
 	comp.node = scene_.getRootSceneNode()->createChildSceneNode("entity_" + std::to_string(id));
-	comp.entity = scene_.createEntity(comp.mesh);
-	comp.node->attachObject(comp.entity);
-	comp.entity->setQueryFlags(1);
+	if(!util::is_headless())
+	{ // Only the scene node is kept in the headless mode.
+		comp.entity = scene_.createEntity(comp.mesh);
+		comp.node->attachObject(comp.entity);
+		comp.entity->setQueryFlags(1);
 
 #if NO_SHADOWS == 1
-	comp.entity->setCastShadows(false);
+		comp.entity->setCastShadows(false);
 #endif
+	}
 
 	if(!script.get<bool>(table_name + ".GraphicsComponent.visible"))
 	{
@@ -699,11 +850,11 @@ inline void EntitySystem::load_component<GraphicsComponent>(tdt::uint id, const
 		comp.node->setScale(comp.scale);
 	}
 
-	if(comp.material != "NO_MAT")
+	if(comp.entity && comp.material != "NO_MAT")
 		comp.entity->setMaterialName(comp.material);
 
 	// Make the entity stand on ground.
-	auto half_height = comp.entity->getWorldBoundingBox(true).getHalfSize().y;
+	auto half_height = GraphicsHelper::get_bounds(*this, id, true).getHalfSize().y;
 	auto phys_comp = get_component<PhysicsComponent>(id);
 	if(phys_comp)
 	{
@@ -713,7 +864,7 @@ inline void EntitySystem::load_component<GraphicsComponent>(tdt::uint id, const
 	}
 
 	// This will allow specific querying.
-	if(!script.is_nil(table_name + ".GraphicsComponent.query_flags"))
+	if(comp.entity && !script.is_nil(table_name + ".GraphicsComponent.query_flags"))
 		comp.entity->setQueryFlags(script.get<int>(table_name + ".GraphicsComponent.query_flags"));
 
 	// Attach a light if a light component was loaded before the graphics one.
@@ -721,7 +872,8 @@ inline void EntitySystem::load_component<GraphicsComponent>(tdt::uint id, const
 	if(light && light->light && comp.node)
 		comp.node->attachObject(light->light); 
 
-	comp.entity->setRenderingDistance(4000.f);
+	if(comp.entity)
+		comp.entity->setRenderingDistance(4000.f);
 }
 
 template<>
@@ -1145,9 +1297,7 @@ inline void EntitySystem::clean_up_component<TaskHandlerComponent>(tdt::uint id)
 			comp->task_queue.push_back(comp->curr_task);
 		for(auto task : comp->task_queue)
 		{
-			to_be_destroyed_.push_back(task);
-
-			auto task_comp = get_component<TaskComponent>(task);
+			auto task_comp = task_pool_.get(task);
 			if(task_comp && (task_comp->task_type == TASK_TYPE::GO_PICK_UP_GOLD
 			   || task_comp->task_type == TASK_TYPE::PICK_UP_GOLD))
 			{ // Have someone else pick it up.
@@ -1176,7 +1326,10 @@ inline void EntitySystem::clean_up_component<TaskHandlerComponent>(tdt::uint id)
 					evt_comp->radius = 10000.f;
 				}
 			}
+			task_pool_.destroy(task);
 		}
+		comp->task_queue.clear();
+		comp->curr_task = Component::NO_ENTITY;
 	}
 }
 
@@ -1237,6 +1390,14 @@ inline void EntitySystem::clean_up_component<ProductionComponent>(tdt::uint id)
 		Player::instance().sub_max_unit(comp->max_produced);
 }
 
+template<>
+inline void EntitySystem::clean_up_component<PathfindingComponent>(tdt::uint id)
+{
+	auto comp = get_component<PathfindingComponent>(id);
+	if(comp)
+		Grid::instance().remove_path_subscriber(id, comp->path_queue);
+}
+
 template<>
 inline void EntitySystem::clean_up_component<ManaCrystalComponent>(tdt::uint id)
 {
@@ -47,7 +47,10 @@ void EventSystem::update(tdt::real delta)
 
 				// No handler found, increase radius.
 				if(evt.second.radius * evt.second.radius < std::numeric_limits<tdt::real>::max() - 100.f)
+				{
 					evt.second.radius += 5.f;
+					entities_.mark_changed<EventComponent>(evt.first);
+				}
 			}
 		}
 		if(destroy_evt)
@@ -77,6 +80,7 @@ tdt::real EventSystem::get_update_time_multiplier() const
 
 bool EventSystem::handle_event_(tdt::uint handler, tdt::uint evt)
 {
+	static const auto handle_event_fn = Symbol::get_function_id("handle_event");
 	auto type = EventHelper::get_event_type(entities_, evt);
 	switch(type)
 	{
@@ -93,9 +97,12 @@ bool EventSystem::handle_event_(tdt::uint handler, tdt::uint evt)
 			return true;
 		}
 		default: // Allows custom events handled in scripts.
+		{
+			auto comp = entities_.get_component<EventHandlerComponent>(handler);
+			Symbol table{comp ? comp->handler : Symbol{entities_.NO_BLUEPRINT}};
 			return lpp::Script::instance().call<bool, tdt::uint, tdt::uint>(
-				EventHandlerHelper::get_handler(entities_, handler) + ".handle_event",
-				handler, evt
+				table.get_function(handle_event_fn), handler, evt
 			);
+		}
 	}
 }
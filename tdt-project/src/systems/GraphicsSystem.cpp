@@ -25,6 +25,7 @@ void GraphicsSystem::update(tdt::real delta)
 			if(comp && comp->node)
 			{
 				ent.second.curr_radius += ent.second.delta;
+				entities_.mark_changed<ExplosionComponent>(ent.first);
 				if(comp->manual_scaling)
 				{
 					comp->scale += ent.second.delta;
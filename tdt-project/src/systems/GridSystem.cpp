@@ -2,6 +2,8 @@
 #include <tools/Pathfinding.hpp>
 #include <tools/PathfindingAlgorithms.hpp>
 #include <tools/Grid.hpp>
+#include <tools/PathService.hpp>
+#include <tools/Util.hpp>
 #include <helpers/Helpers.hpp>
 #include <gui/GUI.hpp>
 #include <set>
@@ -11,7 +13,8 @@
 #include "EntitySystem.hpp"
 
 GridSystem::GridSystem(EntitySystem& ents, Ogre::SceneManager& scene)
-	: entities_{ents}, scene_mgr_{scene},
+	: repair_queue_{}, queued_repairs_{},
+	  entities_{ents}, scene_mgr_{scene},
 	  graphics_loaded_{false}, graph_visible_{false}
 { /* DUMMY BODY */ }
 
@@ -53,29 +56,67 @@ void GridSystem::update(tdt::real)
 		}
 	}
 
-	// Correct pathfinding.
-	if(!unfreed.empty())
+	// New version of the grid for asynchronous pathfinding.
+	// Also refreshes the cached costs of nodes whose residents were damaged or healed.
+	std::set<tdt::uint> changed{unfreed};
+	changed.insert(freed.begin(), freed.end());
+	PathService::instance().invalidate(entities_, changed);
+
+	// Correct pathfinding, only entities whose paths lead through unfreed nodes are checked.
+	auto& grid = Grid::instance();
+	for(auto node : unfreed)
 	{
-		for(auto& ent : entities_.get_component_container<PathfindingComponent>())
+		for(auto id : grid.get_path_subscribers(node))
 		{
-			for(auto node : unfreed)
+			auto path_comp = entities_.get_component<PathfindingComponent>(id);
+			if(!path_comp)
 			{
-				if(std::find(ent.second.path_queue.begin(), ent.second.path_queue.end(),
-							 node) != ent.second.path_queue.end())
-				{
-					if(!util::pathfind<util::DEFAULT_PATHFINDING_ALGORITHM>(
-						entities_, ent.first, ent.second.target_id, util::DEFAULT_HEURISTIC{entities_}, true))
-					{ // Can't correct the path.
-						ent.second.path_queue.clear();
-						ent.second.target_id = Component::NO_ENTITY;
-					}
-					break; // Other unfreed nodes were taken into account already.
-				}
+				grid.remove_path_subscriber(id, node);
+				continue;
+			}
+
+			auto& path = path_comp->path_queue;
+			auto it = std::find(path.begin(), path.end(), node);
+			if(it == path.end())
+			{ // Path was changed or cleared since the subscription.
+				grid.remove_path_subscriber(id, node);
+				continue;
 			}
+
+			// Entities about to step on the node cannot wait for their turn.
+			if((tdt::uint)(it - path.begin()) < REPAIR_LOOKAHEAD)
+				repair_path_(id);
+			else if(queued_repairs_.insert(id).second)
+				repair_queue_.push_back(id);
 		}
 	}
+
+	// Queued entities may have come close to the block while waiting.
+	for(auto it = repair_queue_.begin(); it != repair_queue_.end();)
+	{
+		auto id = *it;
+		if(blocked_ahead_(id))
+		{
+			it = repair_queue_.erase(it);
+			queued_repairs_.erase(id);
+			repair_path_(id);
+		}
+		else
+			++it;
+	}
+
+	for(tdt::uint i = 0; i < MAX_PATH_REPAIRS && !repair_queue_.empty(); ++i)
+	{
+		auto id = repair_queue_.front();
+		repair_queue_.pop_front();
+		queued_repairs_.erase(id);
+		repair_path_(id);
+	}
 	Grid::instance().clear_unfreed();
 	Grid::instance().clear_freed();
+
+	// Apply finished asynchronous path requests.
+	PathService::instance().update(entities_);
 }
 
 void GridSystem::create_graphics()
@@ -90,9 +131,11 @@ void GridSystem::create_graphics()
 			graph_comp->mesh = "cube.mesh";
 			graph_comp->material = "colour/blue";
 			GraphicsHelper::init_graphics_component(entities_, entities_.get_scene_manager(), ent.first);
-			graph_comp->entity->setQueryFlags((Ogre::uint32)ENTITY_TYPE::NONE);
-
-			graph_comp->entity->setMaterialName(graph_comp->material);
+			if(graph_comp->entity)
+			{
+				graph_comp->entity->setQueryFlags((Ogre::uint32)ENTITY_TYPE::NONE);
+				graph_comp->entity->setMaterialName(graph_comp->material);
+			}
 			graph_comp->node->setScale(5, 10, 5);
 			graph_comp->node->setVisible(false);
 
@@ -166,6 +209,81 @@ void GridSystem::place_structure(tdt::uint ent_id, tdt::uint node_id, tdt::uint
 	}
 }
 
+void GridSystem::repair_path_(tdt::uint id)
+{
+	auto comp = entities_.get_component<PathfindingComponent>(id);
+	if(!comp || comp->path_queue.empty())
+		return;
+
+	auto blocked = [this](tdt::uint node) -> bool { return is_blocked_(node); };
+
+	auto& path = comp->path_queue;
+	auto first = std::find_if(path.begin(), path.end(), blocked);
+	if(first == path.end())
+		return; // Already corrected or the node was freed again.
+	auto last = std::find_if_not(first, path.end(), blocked);
+
+	if(last != path.end())
+	{ // Try to go around the blocked part only.
+		auto from = first == path.begin() ? comp->last_id : *(first - 1);
+		util::DEFAULT_HEURISTIC heuristic{entities_};
+		auto detour = util::DEFAULT_PATHFINDING_ALGORITHM::get_path(entities_, id, from, *last, heuristic, false);
+
+		if(!detour.empty())
+		{
+			// The detour starts at a node the entity either left already or has in the path.
+			std::deque<tdt::uint> new_path{path.begin(), first};
+			if(new_path.empty())
+				detour.pop_front();
+			else
+				new_path.pop_back();
+			new_path.insert(new_path.end(), detour.begin(), detour.end());
+			new_path.insert(new_path.end(), last + 1, path.end());
+
+			Grid::instance().remove_path_subscriber(id, path);
+			path.swap(new_path);
+			Grid::instance().add_path_subscriber(id, path);
+			if(!path.empty())
+				GraphicsHelper::look_at(entities_, id, path.front());
+			return;
+		}
+	}
+
+	/**
+	 * No detour, the entity goes as far as it can while the entire path gets
+	 * recalculated asynchronously (which may order destruction of the block).
+	 */
+	Grid::instance().remove_path_subscriber(id, std::deque<tdt::uint>{first, path.end()});
+	path.erase(first, path.end());
+	if(!PathService::instance().request(entities_, id, comp->target_id))
+	{ // Can't correct the path.
+		Grid::instance().remove_path_subscriber(id, comp->path_queue);
+		comp->path_queue.clear();
+		comp->target_id = Component::NO_ENTITY;
+	}
+}
+
+bool GridSystem::is_blocked_(tdt::uint node) const
+{
+	return !GridNodeHelper::is_free(entities_, node)
+		   && !StructureHelper::is_walk_through(entities_, GridNodeHelper::get_resident(entities_, node));
+}
+
+bool GridSystem::blocked_ahead_(tdt::uint id) const
+{
+	auto comp = entities_.get_component<PathfindingComponent>(id);
+	if(!comp)
+		return false;
+
+	auto& path = comp->path_queue;
+	for(tdt::uint i = 0; i < REPAIR_LOOKAHEAD && i < path.size(); ++i)
+	{
+		if(is_blocked_(path[i]))
+			return true;
+	}
+	return false;
+}
+
 void GridSystem::update_neighbours_(tdt::uint id)
 {
 	auto comp = entities_.get_component<GridNodeComponent>(id);
@@ -177,7 +295,7 @@ void GridSystem::update_neighbours_(tdt::uint id)
 	auto graph = entities_.get_component<GraphicsComponent>(comp->resident);
 	auto phys = entities_.get_component<PhysicsComponent>(comp->resident);
 	auto align = entities_.get_component<AlignComponent>(comp->resident);
-	if(comp && graph && phys && graph->node && graph->entity && align && node_phys)
+	if(comp && graph && phys && graph->node && (graph->entity || util::is_headless()) && align && node_phys)
 	{
 
 		auto& neigh = comp->neighbours;
@@ -225,14 +343,17 @@ void GridSystem::update_neighbours_(tdt::uint id)
 			graph->mesh = mesh;
 
 		graph->node->setScale(graph->scale);
-		graph->node->detachObject(graph->entity);
-		scene_mgr_.destroyEntity(graph->entity);
-		graph->entity = scene_mgr_.createEntity(graph->mesh);
-		graph->node->attachObject(graph->entity);
-		if(graph->material != "NO_MAT")
-			graph->entity->setMaterialName(graph->material);
+		if(graph->entity)
+		{
+			graph->node->detachObject(graph->entity);
+			scene_mgr_.destroyEntity(graph->entity);
+			graph->entity = scene_mgr_.createEntity(graph->mesh);
+			graph->node->attachObject(graph->entity);
+			if(graph->material != "NO_MAT")
+				graph->entity->setMaterialName(graph->material);
+			graph->entity->setRenderingDistance(4000.f);
+		}
 		graph->node->setOrientation(Ogre::Quaternion{}); // Reverses any rotations.
-		graph->entity->setRenderingDistance(4000.f);
 
 		Ogre::Vector3 pos{node_phys->position};
 		if(active_main_neighbours == 1)
@@ -249,7 +370,7 @@ void GridSystem::update_neighbours_(tdt::uint id)
 		else
 			pos += align->states[active_main_neighbours].position_offset;
 
-		phys->half_height = graph->entity->getWorldBoundingBox(true).getHalfSize().y;
+		phys->half_height = GraphicsHelper::get_bounds(entities_, comp->resident, true).getHalfSize().y;
 		phys->position.x = pos.x;
 		phys->position.y = phys->half_height + pos.y;
 		phys->position.z = pos.z;
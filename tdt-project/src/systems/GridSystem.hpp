@@ -1,6 +1,8 @@
 #pragma once
 
 #include <OGRE/Ogre.h>
+#include <deque>
+#include <set>
 #include "System.hpp"
 class EntitySystem;
 
@@ -24,8 +26,9 @@ class GridSystem : public System
 		~GridSystem() = default;
 
 		/**
-		 * \brief Checks if any nodes were freed or unfreed and if so, corrects
-		 *        any path that had those nodes in it.
+		 * \brief Checks if any nodes were freed or unfreed and if so, queues
+		 *        correction of any path that had those nodes in it.
+		 *        Queued corrections are spread over multiple frames.
 		 * \param Time since the last frame.
 		 */
 		void update(tdt::real) override;
@@ -70,6 +73,47 @@ class GridSystem : public System
 		 */
 		void update_neighbours_(tdt::uint);
 
+		/**
+		 * \brief Corrects the path of a given entity if it leads through
+		 *        a blocked node. The blocked part of the path is replaced by
+		 *        a local detour if possible, otherwise the entire path is
+		 *        recalculated.
+		 * \param ID of the entity.
+		 */
+		void repair_path_(tdt::uint);
+
+		/**
+		 * \brief Returns true if a given node is blocked for pathfinding entities
+		 *        (not free and it's resident is not walk through), false otherwise.
+		 * \param ID of the node.
+		 */
+		bool is_blocked_(tdt::uint) const;
+
+		/**
+		 * \brief Returns true if one of the next REPAIR_LOOKAHEAD nodes of a given
+		 *        entity's path is blocked, false otherwise.
+		 * \param ID of the entity.
+		 */
+		bool blocked_ahead_(tdt::uint) const;
+
+		/**
+		 * Maximal number of queued path corrections performed in one frame.
+		 */
+		static constexpr tdt::uint MAX_PATH_REPAIRS{8};
+
+		/**
+		 * Paths blocked within this many nodes from the entity are repaired
+		 * right away instead of waiting in the queue.
+		 */
+		static constexpr tdt::uint REPAIR_LOOKAHEAD{2};
+
+		/**
+		 * Entities whose paths are waiting for correction, the set is used
+		 * to avoid duplicates in the queue.
+		 */
+		std::deque<tdt::uint> repair_queue_;
+		std::set<tdt::uint> queued_repairs_;
+
 		/**
 		 * Reference to the game's entity system.
 		 */
@@ -5,19 +5,21 @@
 
 HealthSystem::HealthSystem(EntitySystem& ent)
 	: entities_{ent}, regen_timer_{}, regen_period_{10.f},
-	  regen_{false}
+	  regen_{false}, dtors_{"dtor_batch", true}
 { /* DUMMY BODY */ }
 
 void HealthSystem::update(tdt::real delta)
 {
 	update_regen(delta);
+	dtors_.reset();
 	for(auto& ent : entities_.get_component_container<HealthComponent>())
 	{
 		if(!ent.second.alive)
-			DestructorHelper::destroy(entities_, ent.first);
-		else if(regen_)
+			DestructorHelper::destroy(entities_, ent.first, dtors_);
+		else if(regen_ && ent.second.curr_hp < ent.second.max_hp) // Don't touch (and mark as changed) healthy entities.
 			HealthHelper::add_health(entities_, ent.first, ent.second.regen);
 	}
+	dtors_.call();
 }
 
 void HealthSystem::update_regen(tdt::real delta)
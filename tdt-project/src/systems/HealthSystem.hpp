@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Typedefs.hpp>
+#include <tools/ScriptBatch.hpp>
 #include "System.hpp"
 class EntitySystem;
 
@@ -69,4 +70,10 @@ class HealthSystem : public System
 		 * True if this frame's update should renerate health.
 		 */
 		bool regen_;
+
+		/**
+		 * Destructors of the entities that died this frame whose blueprints
+		 * define the dtor_batch function.
+		 */
+		ScriptBatch dtors_;
 };
\ No newline at end of file
@@ -2,7 +2,7 @@
 #include "InputSystem.hpp"
 #include "EntitySystem.hpp"
 
-InputSystem::InputSystem(EntitySystem& ents, OIS::Keyboard& key, Ogre::Camera& cam)
+InputSystem::InputSystem(EntitySystem& ents, OIS::Keyboard* key, Ogre::Camera& cam)
 	: entities_{ents}, first_person_{false}, first_person_id_{Component::NO_ENTITY}, keyboard_{key},
 	  KEY_UP{OIS::KC_W}, KEY_DOWN{OIS::KC_S}, KEY_LEFT{OIS::KC_A}, KEY_RIGHT{OIS::KC_D},
 	  cam_{cam}, cam_position_{}, cam_orientation_{}, ai_backup_{nullptr},
@@ -11,30 +11,31 @@ InputSystem::InputSystem(EntitySystem& ents, OIS::Keyboard& key, Ogre::Camera& c
 
 void InputSystem::update(tdt::real delta)
 {
-	if(first_person_)
+	static const auto handle_fn = Symbol::get_function_id("handle");
+	if(first_person_ && keyboard_)
 	{
 		bool moved{false}, rotated{false};
 
 		lpp::Script& script = lpp::Script::instance();
 		auto& in_comp = *entities_.get_component<InputComponent>(first_person_id_);
-		if(keyboard_.isKeyDown((OIS::KeyCode)KEY_UP))
+		if(keyboard_->isKeyDown((OIS::KeyCode)KEY_UP))
 		{
-			script.call<void, tdt::uint, int>(in_comp.input_handler + ".handle", first_person_id_, KEY_UP);
+			script.call<void, tdt::uint, int>(in_comp.input_handler.get_function(handle_fn), first_person_id_, KEY_UP);
 			moved = true;
 		}
-		if(keyboard_.isKeyDown((OIS::KeyCode)KEY_DOWN))
+		if(keyboard_->isKeyDown((OIS::KeyCode)KEY_DOWN))
 		{
-			script.call<void, tdt::uint, int>(in_comp.input_handler + ".handle", first_person_id_, KEY_DOWN);
+			script.call<void, tdt::uint, int>(in_comp.input_handler.get_function(handle_fn), first_person_id_, KEY_DOWN);
 			moved = true;
 		}
-		if(keyboard_.isKeyDown((OIS::KeyCode)KEY_LEFT))
+		if(keyboard_->isKeyDown((OIS::KeyCode)KEY_LEFT))
 		{
-			script.call<void, tdt::uint, int>(in_comp.input_handler + ".handle", first_person_id_, KEY_LEFT);
+			script.call<void, tdt::uint, int>(in_comp.input_handler.get_function(handle_fn), first_person_id_, KEY_LEFT);
 			rotated = true;
 		}
-		if(keyboard_.isKeyDown((OIS::KeyCode)KEY_RIGHT))
+		if(keyboard_->isKeyDown((OIS::KeyCode)KEY_RIGHT))
 		{
-			script.call<void, tdt::uint, int>(in_comp.input_handler + ".handle", first_person_id_, KEY_RIGHT);
+			script.call<void, tdt::uint, int>(in_comp.input_handler.get_function(handle_fn), first_person_id_, KEY_RIGHT);
 			rotated = true;
 		}
 
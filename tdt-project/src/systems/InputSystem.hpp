@@ -19,10 +19,10 @@ class InputSystem : public System
 		/**
 		 * Constructor.
 		 * \param Reference to the game's EntitySystem instance.
-		 * \param Reference to the keyboard being used.
+		 * \param Pointer to the keyboard being used (null in the headless mode).
 		 * \param Reference to the camera for it's manipulation during the 1st person mode.
 		 */
-		InputSystem(EntitySystem&, OIS::Keyboard&, Ogre::Camera&);
+		InputSystem(EntitySystem&, OIS::Keyboard*, Ogre::Camera&);
 
 		/**
 		 * Destructor.
@@ -74,9 +74,9 @@ class InputSystem : public System
 		tdt::uint first_person_id_;
 
 		/**
-		 * Reference to the keyboard being used.
+		 * Pointer to the keyboard being used (null in the headless mode).
 		 */
-		OIS::Keyboard& keyboard_;
+		OIS::Keyboard* keyboard_;
 
 		/**
 		 * Current keybindings, allow rebinding.
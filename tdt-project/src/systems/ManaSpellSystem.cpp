@@ -19,10 +19,14 @@ void ManaSpellSystem::update(tdt::real delta)
 
 		for(auto& ent : entities_.get_component_container<ManaComponent>())
 		{
+			if(ent.second.curr_mana == ent.second.max_mana)
+				continue;
+
 			if(ent.second.curr_mana + ent.second.mana_regen < ent.second.max_mana)
 				ent.second.curr_mana += ent.second.mana_regen;
 			else
 				ent.second.curr_mana = ent.second.max_mana;
+			entities_.mark_changed<ManaComponent>(ent.first);
 		}
 	}
 
@@ -33,6 +37,7 @@ void ManaSpellSystem::update(tdt::real delta)
 		{
 			SpellHelper::cast(entities_, ent.first);
 			ent.second.cd_time = REAL_ZERO;
+			entities_.mark_changed<SpellComponent>(ent.first);
 		}
 	}
 }
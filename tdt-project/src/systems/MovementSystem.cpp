@@ -1,5 +1,6 @@
 #include <Components.hpp>
 #include <helpers/Helpers.hpp>
+#include <tools/Grid.hpp>
 #include <limits>
 #include "MovementSystem.hpp"
 #include "EntitySystem.hpp"
@@ -40,6 +41,7 @@ void MovementSystem::update(Ogre::Real delta)
 			PhysicsHelper::move_to(entities_, ent.first, pos_next);
 			path_comp.last_id = next;
 			path_comp.path_queue.pop_front();
+			Grid::instance().remove_path_subscriber(ent.first, next);
 			if(!path_comp.path_queue.empty())
 				GraphicsHelper::look_at(entities_, ent.first, path_comp.path_queue.front());
 			else
@@ -97,6 +99,7 @@ bool MovementSystem::checked_move(std::size_t id, Ogre::Vector3 dir_vector)
 		if(can_move_to(id, new_pos))
 		{
 			phys_comp->position = new_pos;
+			entities_.mark_moved();
 
 			auto graph_comp = entities_.get_component<GraphicsComponent>(id);
 			if(graph_comp)
@@ -119,6 +122,7 @@ bool MovementSystem::move(std::size_t id, Ogre::Vector3 dir_vector)
 		auto dir = dir_vector * mov_comp->speed_modifier * last_delta_; 
 		new_pos += dir;
 		phys_comp->position = new_pos;
+		entities_.mark_moved();
 
 		auto graph_comp = entities_.get_component<GraphicsComponent>(id);
 		if(graph_comp)
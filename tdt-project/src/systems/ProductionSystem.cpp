@@ -22,6 +22,7 @@ void ProductionSystem::update(tdt::real delta)
 			spawn_entity(ent.first, ent.second.product_blueprint);
 			++ent.second.curr_produced;
 			ent.second.curr_cd = REAL_ZERO;
+			entities_.mark_changed<ProductionComponent>(ent.first);
 		}
 	}
 }
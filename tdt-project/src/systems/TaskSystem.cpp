@@ -1,4 +1,5 @@
 #include <numeric>
+#include <tools/PathService.hpp>
 #include "TaskSystem.hpp"
 #include "EntitySystem.hpp"
 #include "GridSystem.hpp"
@@ -10,17 +11,21 @@ TaskSystem::TaskSystem(EntitySystem& ents, GridSystem& grid, CombatSystem& comb)
 	  {TASK_TYPE::GO_NEAR, "GO_NEAR"}, {TASK_TYPE::GO_KILL, "GO_KILL"},
 	  {TASK_TYPE::KILL, "KILL"}, {TASK_TYPE::GET_IN_RANGE, "GET_IN_RANGE"},
 	  {TASK_TYPE::GO_PICK_UP_GOLD, "GO_PICK_UP_GOLD"}, {TASK_TYPE::PICK_UP_GOLD, "PICK_UP_GOLD"},
-	  {TASK_TYPE::GO_DEPOSIT_GOLD, "GO_DEPOSIT_GOLD"}, {TASK_TYPE::DEPOSIT_GOLD, "DEPOSIT_GOLD"}}
+	  {TASK_TYPE::GO_DEPOSIT_GOLD, "GO_DEPOSIT_GOLD"}, {TASK_TYPE::DEPOSIT_GOLD, "DEPOSIT_GOLD"}},
+	  batch_{"task_complete_batch", true}, polled_{}
 { /* DUMMY BODY */ }
 
 void TaskSystem::update(Ogre::Real delta)
 {
+	poll_batches_(delta);
 	for(auto& ent : entities_.get_component_container<TaskHandlerComponent>())
 	{
-		if((ent.second.busy && current_task_completed_(ent.first, ent.second)) ||
-		   (!ent.second.busy && ent.second.curr_task != Component::NO_ENTITY))
+		if(ent.second.busy && !current_task_completed_(ent.first, ent.second, delta))
+			continue;
+
+		if(ent.second.busy || ent.second.curr_task != Component::NO_ENTITY)
 		{
-			DestructorHelper::destroy(entities_, ent.second.curr_task);
+			entities_.get_task_pool().destroy(ent.second.curr_task);
 			ent.second.curr_task = Component::NO_ENTITY;
 			ent.second.busy = false;
 		}
@@ -30,7 +35,7 @@ void TaskSystem::update(Ogre::Real delta)
 			// Get next valid task if necessary.
 			while(!ent.second.task_queue.empty() &&
 				  (ent.second.curr_task == Component::NO_ENTITY ||
-				  !entities_.has_component<TaskComponent>(ent.second.curr_task)))
+				  !entities_.get_task_pool().exists(ent.second.curr_task)))
 			{
 				next_task_(ent.second);
 			}
@@ -62,14 +67,83 @@ void TaskSystem::next_task_(TaskHandlerComponent& comp)
 
 bool TaskSystem::handle_task_(std::size_t id, TaskHandlerComponent& handler)
 {
+	static const auto handle_task_fn = Symbol::get_function_id("handle_task");
+	// Handlers that don't specify a wait condition get polled every frame.
+	handler.wait_condition = TASK_WAIT::NONE;
+	handler.wait_time = 0.f;
+
 	return lpp::Script::instance().call<bool, std::size_t, std::size_t>(
-		        handler.blueprint + ".handle_task", id, handler.curr_task
+		        handler.blueprint.get_function(handle_task_fn), id, handler.curr_task
 	);
 }
 
-bool TaskSystem::current_task_completed_(std::size_t id, TaskHandlerComponent& handler)
+bool TaskSystem::current_task_completed_(std::size_t id, TaskHandlerComponent& handler, tdt::real delta)
 {
+	static const auto task_complete_fn = Symbol::get_function_id("task_complete");
+	auto polled = polled_.find(id);
+	if(polled != polled_.end())
+		return polled->second;
+
+	// Sleeping tasks don't need to call Lua at all.
+	if(!wait_condition_met_(id, handler, delta))
+		return false;
+
 	return lpp::Script::instance().call<bool, std::size_t, std::size_t>(
-				handler.blueprint + ".task_complete", id, handler.curr_task	
+				handler.blueprint.get_function(task_complete_fn), id, handler.curr_task	
 	);
 }
+
+void TaskSystem::poll_batches_(tdt::real delta)
+{
+	polled_.clear();
+	batch_.reset();
+	for(auto& ent : entities_.get_component_container<TaskHandlerComponent>())
+	{
+		if(!ent.second.busy || !batch_.is_batched(ent.second.blueprint))
+			continue;
+
+		if(wait_condition_met_(ent.first, ent.second, delta))
+			batch_.add(ent.second.blueprint, ent.first, ent.second.curr_task);
+		else
+			polled_.emplace(ent.first, false);
+	}
+	batch_.query(polled_);
+}
+
+
+bool TaskSystem::wait_condition_met_(tdt::uint id, TaskHandlerComponent& handler, tdt::real delta)
+{
+	if(handler.wait_condition == TASK_WAIT::NONE)
+		return true;
+
+	auto task = entities_.get_task_pool().get(handler.curr_task);
+	if(!task || !entities_.exists(task->target))
+		return true;
+
+	switch(handler.wait_condition)
+	{
+		case TASK_WAIT::PATH:
+			return PathfindingHelper::get_path(entities_, id).empty()
+				   && !PathService::instance().pending(id);
+		case TASK_WAIT::TARGET:
+			return false; // Target existence checked above.
+		case TASK_WAIT::COMBAT_TARGET:
+			return CombatHelper::get_target(entities_, id) == Component::NO_ENTITY;
+		case TASK_WAIT::IN_RANGE:
+		{
+			if(PathfindingHelper::get_path(entities_, id).empty())
+				return !PathService::instance().pending(id);
+
+			// Same 10% leeway the default task handler uses.
+			auto range = CombatHelper::get_range(entities_, id);
+			range -= range / 10.f;
+			return PhysicsHelper::get_distance(entities_, id, task->target) < range * range
+				   && combat_.in_sight(id, task->target);
+		}
+		case TASK_WAIT::TIME:
+			handler.wait_time -= delta;
+			return handler.wait_time <= 0.f;
+		default:
+			return true;
+	}
+}
\ No newline at end of file
@@ -3,8 +3,10 @@
 #include <deque>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <Typedefs.hpp>
 #include <Enums.hpp>
+#include <tools/ScriptBatch.hpp>
 #include "System.hpp"
 class GridSystem;
 class CombatSystem;
@@ -31,7 +33,9 @@ class TaskSystem : public System
 		~TaskSystem() = default;
 
 		/**
-		 * \brief Manages the lifetime of tasks on each frame.
+		 * \brief Manages the lifetime of tasks on each frame. Handlers whose blueprint defines
+		 *        the task_complete_batch function are checked for task completion once per
+		 *        blueprint before all other handlers.
 		 * \param Time since the last frame.
 		 */
 		void update(tdt::real) override;
@@ -60,11 +64,30 @@ class TaskSystem : public System
 		bool handle_task_(tdt::uint, TaskHandlerComponent&);
 
 		/**
-		 * \brief Checks whether the current task of a given entity has been completed.
+		 * \brief Checks whether the current task of a given entity has been completed
+		 *        (returns false while the task waits for it's condition).
 		 * \param ID of the handling entity.
 		 * \param Reference to the entity's TaskHandlerComponent.
+		 * \param Time since the last frame.
+		 */
+		bool current_task_completed_(tdt::uint, TaskHandlerComponent&, tdt::real);
+
+		/**
+		 * \brief Checks the completion of the current tasks of all busy handlers whose
+		 *        blueprint defines the task_complete_batch function.
+		 * \param Time since the last frame.
 		 */
-		bool current_task_completed_(tdt::uint, TaskHandlerComponent&);
+		void poll_batches_(tdt::real);
+
+		/**
+		 * \brief Checks whether the condition the current task of a given entity
+		 *        waits for has been met (only then is the task checked for completion
+		 *        in Lua).
+		 * \param ID of the handling entity.
+		 * \param Reference to the entity's TaskHandlerComponent.
+		 * \param Time since the last frame.
+		 */
+		bool wait_condition_met_(tdt::uint, TaskHandlerComponent&, tdt::real);
 
 		/**
 		 * Reference to the game's entity system.
@@ -85,4 +108,14 @@ class TaskSystem : public System
 		 * Map used for task type translation.
 		 */
 		std::map<TASK_TYPE, std::string> task_names_;
+
+		/**
+		 * Handlers (and their tasks) whose blueprints define the task_complete_batch function.
+		 */
+		ScriptBatch batch_;
+
+		/**
+		 * Results of the batched completion checks of this frame (ID of the handler -> completed).
+		 */
+		std::unordered_map<tdt::uint, bool> polled_;
 };
\ No newline at end of file
@@ -5,15 +5,20 @@
 #include "EntitySystem.hpp"
 
 TimeSystem::TimeSystem(EntitySystem& ents)
-	: entities_{ents}, time_multiplier_{1.f}
+	: entities_{ents}, time_multiplier_{1.f}, dtors_{"dtor_batch", true}
 { /* DUMMY BODY */ }
 
 void TimeSystem::update(tdt::real delta)
 {
+	// Running timers are saved only by full saves, incremental saves record them once they expire.
 	for(auto& ent : entities_.get_component_container<TimeComponent>())
 	{
 		if(ent.second.curr_time < ent.second.time_limit)
+		{
 			ent.second.curr_time += delta * time_multiplier_;
+			if(ent.second.curr_time >= ent.second.time_limit)
+				entities_.mark_changed<TimeComponent>(ent.first);
+		}
 		else
 			handle_event_(ent.first, ent.second);
 	}
@@ -21,34 +26,56 @@ void TimeSystem::update(tdt::real delta)
 	for(auto& ent : entities_.get_component_container<OnHitComponent>())
 	{
 		if(ent.second.curr_time < ent.second.cooldown)
+		{
 			ent.second.curr_time += delta * time_multiplier_;
+			if(ent.second.curr_time >= ent.second.cooldown)
+				entities_.mark_changed<OnHitComponent>(ent.first);
+		}
 	}
 
 	for(auto& ent : entities_.get_component_container<TriggerComponent>())
 	{
 		if(ent.second.curr_time < ent.second.cooldown)
+		{
 			ent.second.curr_time += delta * time_multiplier_;
+			if(ent.second.curr_time >= ent.second.cooldown)
+				entities_.mark_changed<TriggerComponent>(ent.first);
+		}
 	}
 
 	for(auto& ent : entities_.get_component_container<NotificationComponent>())
 	{
 		if(ent.second.curr_time < ent.second.cooldown)
+		{
 			ent.second.curr_time += delta * time_multiplier_;
+			if(ent.second.curr_time >= ent.second.cooldown)
+				entities_.mark_changed<NotificationComponent>(ent.first);
+		}
 	}
 
+	dtors_.reset();
 	for(auto& ent : entities_.get_component_container<LimitedLifeSpanComponent>())
 	{
 		if(ent.second.curr_time < ent.second.max_time)
+		{
 			ent.second.curr_time += delta * time_multiplier_;
+			if(ent.second.curr_time >= ent.second.max_time)
+				entities_.mark_changed<LimitedLifeSpanComponent>(ent.first);
+		}
 		else
-			DestructorHelper::destroy(entities_, ent.first);
+			DestructorHelper::destroy(entities_, ent.first, dtors_);
 	}
+	dtors_.call();
 }
 
 void TimeSystem::advance_all_timers(tdt::real delta)
 { // Note: Timers refers only to TimeComponents, ignore the others.
 	for(auto& ent : entities_.get_component_container<TimeComponent>())
+	{
 		ent.second.curr_time += delta;
+		if(ent.second.curr_time >= ent.second.time_limit)
+			entities_.mark_changed<TimeComponent>(ent.first);
+	}
 }
 
 void TimeSystem::advance_all_timers_of_type(tdt::real delta, TIME_EVENT type)
@@ -56,7 +83,11 @@ void TimeSystem::advance_all_timers_of_type(tdt::real delta, TIME_EVENT type)
 	for(auto& ent : entities_.get_component_container<TimeComponent>())
 	{
 		if(ent.second.event_type == type)
+		{
 			ent.second.curr_time += delta;
+			if(ent.second.curr_time >= ent.second.time_limit)
+				entities_.mark_changed<TimeComponent>(ent.first);
+		}
 	}
 }
 
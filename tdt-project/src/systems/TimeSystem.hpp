@@ -2,6 +2,7 @@
 
 #include <Enums.hpp>
 #include <Typedefs.hpp>
+#include <tools/ScriptBatch.hpp>
 #include "System.hpp"
 class EntitySystem;
 struct TimeComponent;
@@ -71,4 +72,10 @@ class TimeSystem : public System
 		 * Allows to speed up all timers.
 		 */
 		tdt::real time_multiplier_;
+
+		/**
+		 * Destructors of the entities whose life span ended this frame and whose
+		 * blueprints define the dtor_batch function.
+		 */
+		ScriptBatch dtors_;
 };
\ No newline at end of file
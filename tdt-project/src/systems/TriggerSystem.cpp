@@ -34,6 +34,7 @@ void TriggerSystem::update(tdt::real delta)
 							{
 								TriggerHelper::trigger(entities_, ent.first, other.first);
 								ent.second.curr_time = REAL_ZERO;
+								entities_.mark_changed<TriggerComponent>(ent.first);
 							}
 						}
 						break;
@@ -48,6 +49,7 @@ void TriggerSystem::update(tdt::real delta)
 							{
 								TriggerHelper::trigger(entities_, ent.first, other.first);
 								ent.second.curr_time = REAL_ZERO;
+								entities_.mark_changed<TriggerComponent>(ent.first);
 							}
 						}
 						break;
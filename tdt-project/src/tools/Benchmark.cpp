@@ -0,0 +1,387 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <Game.hpp>
+#include <gui/GUI.hpp>
+#include <helpers/Helpers.hpp>
+#include <lppscript/LppScript.hpp>
+#include <systems/EntitySystem.hpp>
+#include <systems/GridSystem.hpp>
+#include <systems/WaveSystem.hpp>
+#include "Benchmark.hpp"
+#include "GameSerializer.hpp"
+#include "Grid.hpp"
+#include "Journal.hpp"
+#include "PathService.hpp"
+#include "SelectionBox.hpp"
+#include "Spellcaster.hpp"
+#include "SystemScheduler.hpp"
+#include "Util.hpp"
+
+namespace
+{
+	/**
+	 * Number of calls of the global operator new.
+	 */
+	std::atomic<std::size_t> allocation_count{0};
+
+	/**
+	 * Half of the size of the starting area around the dungeon throne
+	 * (see RandomLevelGenerator), which is never cleared.
+	 */
+	constexpr tdt::uint start_area_radius = 3;
+
+	/**
+	 * \brief Returns a given percentile of sorted values (nearest rank).
+	 * \param The values sorted in ascending order.
+	 * \param The percentile (between 0 and 1).
+	 */
+	tdt::real percentile(const std::vector<tdt::real>& values, tdt::real p)
+	{
+		if(values.empty())
+			return 0.f;
+
+		auto rank = (std::size_t)std::ceil(p * values.size());
+		return values[rank > 0 ? rank - 1 : 0];
+	}
+}
+
+#if BENCHMARK_ALLOCATIONS == 1
+void* operator new(std::size_t size)
+{
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	auto ptr = std::malloc(size > 0 ? size : 1);
+	if(!ptr)
+		throw std::bad_alloc{};
+	return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+	return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+#endif
+
+Benchmark& Benchmark::instance()
+{
+	static Benchmark inst{};
+
+	return inst;
+}
+
+bool Benchmark::run(Game& game, const std::string& name, const std::string& output)
+{
+	Scenario scenario{};
+	if(running_ || !load_scenario_(name, scenario))
+		return false;
+
+	running_ = true;
+	auto autosave = game.game_serializer_->get_autosave_interval();
+	game.game_serializer_->set_autosave_interval(scenario.autosave);
+	start_(game, scenario);
+
+	auto& scheduler = *game.scheduler_;
+	auto& ents = *game.entity_system_;
+	auto step = Journal::instance().get_step();
+	auto names = scheduler.get_system_names();
+	std::vector<Step> steps{};
+	steps.reserve(scenario.steps);
+	for(tdt::uint i = 0; i < scenario.warmup + scenario.steps; ++i)
+	{
+		if(game.state_ != GAME_STATE::RUNNING)
+			break; // The game was won or lost.
+
+		auto allocations = get_allocation_count();
+		auto start = std::chrono::high_resolution_clock::now();
+		game.update(step);
+		auto time = std::chrono::high_resolution_clock::now() - start;
+		allocations = get_allocation_count() - allocations;
+
+		if(i >= scenario.warmup)
+		{
+			steps.push_back(Step{std::chrono::duration<tdt::real, std::milli>(time).count(),
+								 (tdt::uint)ents.get_component_list().size(), allocations,
+								 scheduler.get_system_times()});
+		}
+	}
+
+	PathService::instance().set_synchronous(false);
+	game.game_serializer_->set_autosave_interval(autosave);
+	running_ = false;
+
+	std::string report{output.empty() ? name : output};
+	bool res = write_json_(report, scenario, names, steps) && write_csv_(report, names, steps);
+
+	auto& console = GUI::instance().get_console();
+	if(res)
+		console.print_text("Benchmark " + name + " finished: " + std::to_string(steps.size())
+						   + " steps, reports written into " + report + ".json and "
+						   + report + ".csv.", Console::GREEN_TEXT);
+	else
+		console.print_text("Cannot write the reports of the benchmark " + name + ".", Console::RED_TEXT);
+	return res;
+}
+
+bool Benchmark::is_running() const
+{
+	return running_;
+}
+
+std::size_t Benchmark::get_allocation_count()
+{
+	return allocation_count.load(std::memory_order_relaxed);
+}
+
+Benchmark::Benchmark()
+	: running_{false}, attackers_{}, traps_{}
+{ /* DUMMY BODY */ }
+
+bool Benchmark::load_scenario_(const std::string& name, Scenario& scenario)
+{
+	auto& script = lpp::Script::instance();
+	std::string table{"game.benchmark." + name};
+	if(name.empty() || script.is_nil(table))
+		return false;
+
+	auto get_uint = [&script, &table](const std::string& field, tdt::uint def) -> tdt::uint {
+		return script.is_nil(table + "." + field) ? def : script.get<tdt::uint>(table + "." + field);
+	};
+
+	scenario.name = name;
+	scenario.seed = get_uint("seed", 0);
+	scenario.width = get_uint("width", 64);
+	scenario.height = get_uint("height", 64);
+	scenario.steps = get_uint("steps", 1800);
+	scenario.warmup = get_uint("warmup", 0);
+	scenario.attacker_count = get_uint("attacker_count", 0);
+	scenario.trap_count = get_uint("trap_count", 0);
+	scenario.clearing = get_uint("clearing", 0);
+	scenario.wave_table = script.is_nil(table + ".wave_table") ? "game.wave.wave_test"
+								: script.get<std::string>(table + ".wave_table");
+	scenario.attackers = script.get_vector<std::string>(table + ".attackers");
+	scenario.traps = script.get_vector<std::string>(table + ".traps");
+	scenario.autosave = script.is_nil(table + ".autosave") ? 0.f : script.get<tdt::real>(table + ".autosave");
+
+	return scenario.width > 2 * start_area_radius + 2 && scenario.height > 2 * start_area_radius + 2;
+}
+
+void Benchmark::start_(Game& game, const Scenario& scenario)
+{
+	Journal::instance().stop(game);
+	util::set_random_seed(scenario.seed);
+	lpp::Script::instance().execute("math.randomseed(" + std::to_string(scenario.seed) + ")");
+
+	// Synchronous pathfinding keeps the runs comparable.
+	PathService::instance().set_synchronous(true);
+
+	game.spell_caster_->stop_casting();
+	game.selection_box_->clear_selected_entities();
+	GUI::instance().get_tracker().clear();
+	game.wave_system_->set_wave_table(scenario.wave_table);
+	game.new_game(scenario.width, scenario.height);
+	game.set_state(GAME_STATE::RUNNING);
+
+	clear_area_(game, scenario);
+	attackers_ = spawn_attackers_(game, scenario);
+	traps_ = place_traps_(game, scenario);
+}
+
+void Benchmark::clear_area_(Game& game, const Scenario& scenario)
+{
+	if(scenario.clearing <= start_area_radius)
+		return;
+
+	auto& ents = *game.entity_system_;
+	auto& grid = Grid::instance();
+	int mid_w = scenario.width / 2, mid_h = scenario.height / 2;
+	for(tdt::uint x = 1; x < scenario.width - 1; ++x)
+	{
+		for(tdt::uint y = 1; y < scenario.height - 1; ++y)
+		{
+			tdt::uint dist = std::max(std::abs((int)x - mid_w), std::abs((int)y - mid_h));
+			if(dist <= start_area_radius || dist > scenario.clearing)
+				continue;
+
+			// Only walls and gold deposits are placed outside of the starting area.
+			auto node = grid.get_node(x, y);
+			auto resident = GridNodeHelper::get_resident(ents, node);
+			if(resident != Component::NO_ENTITY)
+				DestructorHelper::destroy(ents, resident, true);
+		}
+	}
+	ents.cleanup(); // Frees the nodes.
+}
+
+tdt::uint Benchmark::spawn_attackers_(Game& game, const Scenario& scenario)
+{
+	auto& ents = *game.entity_system_;
+	const auto& nodes = game.wave_system_->get_spawning_nodes();
+	if(scenario.attackers.empty() || nodes.empty())
+		return 0;
+
+	for(tdt::uint i = 0; i < scenario.attacker_count; ++i)
+	{
+		auto id = ents.create_entity(scenario.attackers[i % scenario.attackers.size()]);
+		PhysicsHelper::set_2d_position(ents, id, PhysicsHelper::get_2d_position(ents, nodes[i % nodes.size()]));
+	}
+	return scenario.attacker_count;
+}
+
+tdt::uint Benchmark::place_traps_(Game& game, const Scenario& scenario)
+{
+	if(scenario.traps.empty())
+		return 0;
+
+	auto& ents = *game.entity_system_;
+	auto& grid = Grid::instance();
+	std::vector<tdt::uint> free_nodes{};
+	for(tdt::uint x = 1; x < scenario.width - 1; ++x)
+	{
+		for(tdt::uint y = 1; y < scenario.height - 1; ++y)
+		{
+			auto node = grid.get_node(x, y);
+			if(GridNodeHelper::is_free(ents, node))
+				free_nodes.push_back(node);
+		}
+	}
+
+	auto& script = lpp::Script::instance();
+	tdt::uint placed{};
+	while(placed < scenario.trap_count && !free_nodes.empty())
+	{
+		auto idx = util::get_random(0, free_nodes.size());
+		auto node = free_nodes[idx];
+		free_nodes[idx] = free_nodes.back();
+		free_nodes.pop_back();
+
+		const auto& table = scenario.traps[placed % scenario.traps.size()];
+		auto pos = PhysicsHelper::get_2d_position(ents, node);
+		auto id = ents.create_entity(table, Ogre::Vector3{pos.x, 0.f, pos.y});
+		PhysicsHelper::set_2d_position(ents, id, pos);
+
+		tdt::uint radius{};
+		if(!script.is_nil(table + ".StructureComponent"))
+			radius = script.get<tdt::uint>(table + ".StructureComponent.radius");
+		game.grid_system_->place_structure(id, node, radius);
+		++placed;
+	}
+	return placed;
+}
+
+bool Benchmark::write_json_(const std::string& report, const Scenario& scenario,
+							const std::vector<std::string>& names, const std::vector<Step>& steps)
+{
+	std::ofstream file{report + ".json", std::ios::trunc};
+	if(!file)
+		return false;
+
+	std::vector<tdt::real> times{};
+	tdt::real total{};
+	std::size_t allocations{};
+	tdt::uint max_entities{};
+	for(const auto& step : steps)
+	{
+		times.push_back(step.time);
+		total += step.time;
+		allocations += step.allocations;
+		max_entities = std::max(max_entities, step.entities);
+	}
+	std::sort(times.begin(), times.end());
+	tdt::real count = steps.empty() ? 1.f : (tdt::real)steps.size();
+
+	file << "{\n"
+		 << "\t\"scenario\": \"" << scenario.name << "\",\n"
+		 << "\t\"seed\": " << scenario.seed << ",\n"
+		 << "\t\"width\": " << scenario.width << ",\n"
+		 << "\t\"height\": " << scenario.height << ",\n"
+		 << "\t\"wave_table\": \"" << scenario.wave_table << "\",\n"
+		 << "\t\"attackers\": " << attackers_ << ",\n"
+		 << "\t\"traps\": " << traps_ << ",\n"
+		 << "\t\"step_length\": " << Journal::instance().get_step() << ",\n"
+		 << "\t\"steps\": " << steps.size() << ",\n"
+		 << "\t\"frame_time_ms\": {\n"
+		 << "\t\t\"total\": " << total << ",\n"
+		 << "\t\t\"mean\": " << total / count << ",\n"
+		 << "\t\t\"p50\": " << percentile(times, .5f) << ",\n"
+		 << "\t\t\"p95\": " << percentile(times, .95f) << ",\n"
+		 << "\t\t\"p99\": " << percentile(times, .99f) << ",\n"
+		 << "\t\t\"max\": " << (times.empty() ? 0.f : times.back()) << "\n"
+		 << "\t},\n"
+		 << "\t\"entities\": {\n"
+		 << "\t\t\"start\": " << (steps.empty() ? 0 : steps.front().entities) << ",\n"
+		 << "\t\t\"end\": " << (steps.empty() ? 0 : steps.back().entities) << ",\n"
+		 << "\t\t\"max\": " << max_entities << "\n"
+		 << "\t},\n"
+		 << "\t\"allocations\": ";
+#if BENCHMARK_ALLOCATIONS == 1
+	file << "{\n"
+		 << "\t\t\"total\": " << allocations << ",\n"
+		 << "\t\t\"mean\": " << allocations / count << "\n"
+		 << "\t},\n";
+#else
+	file << "null,\n"; // Not counted in this build.
+#endif
+	file << "\t\"systems\": [";
+
+	for(std::size_t i = 0; i < names.size(); ++i)
+	{
+		tdt::real system_total{}, system_max{};
+		for(const auto& step : steps)
+		{
+			if(i < step.system_times.size())
+			{
+				system_total += step.system_times[i];
+				system_max = std::max(system_max, step.system_times[i]);
+			}
+		}
+
+		file << (i > 0 ? ",\n" : "\n")
+			 << "\t\t{\"name\": \"" << names[i] << "\", \"total_ms\": " << system_total
+			 << ", \"mean_ms\": " << system_total / count << ", \"max_ms\": " << system_max
+			 << ", \"share\": " << (total > 0.f ? system_total / total : 0.f) << "}";
+	}
+	file << "\n\t]\n}\n";
+
+	return (bool)file;
+}
+
+bool Benchmark::write_csv_(const std::string& report, const std::vector<std::string>& names,
+						   const std::vector<Step>& steps)
+{
+	std::ofstream file{report + ".csv", std::ios::trunc};
+	if(!file)
+		return false;
+
+	file << "step,time_ms,entities,allocations";
+	for(const auto& name : names)
+		file << "," << name;
+	file << "\n";
+
+	for(std::size_t i = 0; i < steps.size(); ++i)
+	{
+		const auto& step = steps[i];
+		file << i << "," << step.time << "," << step.entities << ",";
+#if BENCHMARK_ALLOCATIONS == 1
+		file << step.allocations;
+#endif
+		for(auto time : step.system_times)
+			file << "," << time;
+		file << "\n";
+	}
+
+	return (bool)file;
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <Typedefs.hpp>
+class Game;
+
+#ifndef BENCHMARK_ALLOCATIONS
+#define BENCHMARK_ALLOCATIONS 0
+#endif
+
+/**
+ * Runs benchmark scenarios, which are Lua tables in game.benchmark (see scripts/benchmarks.lua)
+ * describing a workload: size of the level (created by the default level generator), wave table,
+ * attackers spawned at the spawn nodes at the start, traps placed at random free nodes (optionally
+ * in an area cleared around the starting area) and the number of simulation steps.
+ * The game is seeded and runs in fixed steps (like a journal replay) using Game::update, the wall
+ * time of the steps and of the individual systems, entity counts and allocation counts are written
+ * into <output>.json (summary) and <output>.csv (per step).
+ * If BENCHMARK_ALLOCATIONS is defined as 1 (as in the Benchmark build configuration), the global
+ * operator new is replaced by one that counts the allocations (the Lua VM's allocations are not
+ * included), otherwise the allocation counts are left out of the reports (null in the summary,
+ * empty column in the CSV). It is off by default, since the counting would slow down every
+ * allocation of the normal game.
+ */
+class Benchmark
+{
+	public:
+		/**
+		 * \brief Returns a reference to the static instance of this class.
+		 */
+		static Benchmark& instance();
+
+		/**
+		 * \brief Runs a given scenario and writes it's reports, returns false if the scenario
+		 *        does not exist or the reports could not be written.
+		 * \param Reference to the game object.
+		 * \param Name of the scenario (table in game.benchmark).
+		 * \param Name of the report files (without extension), defaults to the scenario name.
+		 */
+		bool run(Game&, const std::string&, const std::string& = "");
+
+		/**
+		 * \brief Returns true if a benchmark is running, false otherwise.
+		 */
+		bool is_running() const;
+
+		/**
+		 * \brief Returns the number of calls of the global operator new since the game started.
+		 */
+		static std::size_t get_allocation_count();
+
+		/**
+		 * Since there should be only one benchmark runner at all times, all copy/move
+		 * operations are disabled for this class.
+		 */
+		Benchmark(const Benchmark&) = delete;
+		Benchmark& operator=(const Benchmark&) = delete;
+		Benchmark(Benchmark&&) = delete;
+		Benchmark& operator=(Benchmark&&) = delete;
+
+	private:
+		/**
+		 * Constructor.
+		 * Kept private since there should be only one benchmark runner at all times.
+		 */
+		Benchmark();
+
+		/**
+		 * Destructor.
+		 */
+		~Benchmark() {}
+
+		/**
+		 * Parameters of a scenario.
+		 */
+		struct Scenario
+		{
+			std::string name;
+			tdt::uint seed;
+			tdt::uint width;
+			tdt::uint height;
+			tdt::uint steps;
+			tdt::uint warmup;
+			std::string wave_table;
+			std::vector<std::string> attackers;
+			tdt::uint attacker_count;
+			std::vector<std::string> traps;
+			tdt::uint trap_count;
+			tdt::uint clearing;
+			tdt::real autosave;
+		};
+
+		/**
+		 * Measurements of a single simulation step.
+		 */
+		struct Step
+		{
+			tdt::real time;
+			tdt::uint entities;
+			std::size_t allocations;
+			std::vector<tdt::real> system_times;
+		};
+
+		/**
+		 * \brief Reads a scenario from game.benchmark.<name>, returns false if it does not exist.
+		 * \param Name of the scenario.
+		 * \param Output parameter for the scenario.
+		 */
+		bool load_scenario_(const std::string&, Scenario&);
+
+		/**
+		 * \brief Starts a new game with the scenario's level and populates it.
+		 * \param Reference to the game object.
+		 * \param The scenario.
+		 */
+		void start_(Game&, const Scenario&);
+
+		/**
+		 * \brief Removes the structures around the dungeon throne to make room for traps.
+		 * \param Reference to the game object.
+		 * \param The scenario.
+		 */
+		void clear_area_(Game&, const Scenario&);
+
+		/**
+		 * \brief Spawns the scenario's attackers at the spawn nodes of the wave system,
+		 *        returns the number of spawned attackers.
+		 * \param Reference to the game object.
+		 * \param The scenario.
+		 */
+		tdt::uint spawn_attackers_(Game&, const Scenario&);
+
+		/**
+		 * \brief Places the scenario's traps at random free nodes, returns the number
+		 *        of placed traps.
+		 * \param Reference to the game object.
+		 * \param The scenario.
+		 */
+		tdt::uint place_traps_(Game&, const Scenario&);
+
+		/**
+		 * \brief Writes the summary of the run into <name>.json, returns false on failure.
+		 * \param Name of the report.
+		 * \param The scenario.
+		 * \param Names of the systems.
+		 * \param Measured steps.
+		 */
+		bool write_json_(const std::string&, const Scenario&, const std::vector<std::string>&,
+						 const std::vector<Step>&);
+
+		/**
+		 * \brief Writes the measurements of every step into <name>.csv, returns false on failure.
+		 * \param Name of the report.
+		 * \param Names of the systems.
+		 * \param Measured steps.
+		 */
+		bool write_csv_(const std::string&, const std::vector<std::string>&, const std::vector<Step>&);
+
+		/**
+		 * If true, a benchmark is running.
+		 */
+		bool running_;
+
+		/**
+		 * Number of attackers and traps actually created in the current run
+		 * (there might not be enough room for all traps).
+		 */
+		tdt::uint attackers_;
+		tdt::uint traps_;
+};
@@ -0,0 +1,346 @@
+#include <string>
+#include <systems/EntitySystem.hpp>
+#include "ComponentProxy.hpp"
+
+/**
+ * Describes a field of a component accessible through proxies.
+ */
+#define FIELD(COMP, NAME, TYPE, WRITABLE) Field{#NAME, offsetof(COMP, NAME), FIELD_TYPE::TYPE, WRITABLE}
+
+/**
+ * Registry keys of the proxy cache and the table of metatables (indexed by component type).
+ */
+static const char* PROXY_CACHE = "tdt.component_proxies";
+static const char* PROXY_METATABLES = "tdt.component_metatables";
+
+EntitySystem* ComponentProxy::entities_{};
+std::array<ComponentProxy::Resolver, Component::count> ComponentProxy::resolvers_{};
+
+void ComponentProxy::init(lpp::Script::state L, EntitySystem& ents)
+{
+	entities_ = &ents;
+
+	lua_newtable(L); // Cache with weak values.
+	lua_newtable(L);
+	lua_pushstring(L, "v");
+	lua_setfield(L, -2, "__mode");
+	lua_setmetatable(L, -2);
+	lua_setfield(L, LUA_REGISTRYINDEX, PROXY_CACHE);
+
+	lua_newtable(L);
+	lua_setfield(L, LUA_REGISTRYINDEX, PROXY_METATABLES);
+
+	register_<PhysicsComponent>(L, {
+		FIELD(PhysicsComponent, solid, BOOL, true),
+		FIELD(PhysicsComponent, half_height, REAL, true),
+		Field{"x", offsetof(PhysicsComponent, position) + offsetof(Ogre::Vector3, x), FIELD_TYPE::REAL, false},
+		Field{"y", offsetof(PhysicsComponent, position) + offsetof(Ogre::Vector3, y), FIELD_TYPE::REAL, false},
+		Field{"z", offsetof(PhysicsComponent, position) + offsetof(Ogre::Vector3, z), FIELD_TYPE::REAL, false}
+	});
+	register_<HealthComponent>(L, {
+		FIELD(HealthComponent, curr_hp, UINT, false),
+		FIELD(HealthComponent, max_hp, UINT, false),
+		FIELD(HealthComponent, regen, UINT, true),
+		FIELD(HealthComponent, defense, UINT, false),
+		FIELD(HealthComponent, alive, BOOL, true)
+	});
+	register_<AIComponent>(L, {
+		FIELD(AIComponent, blueprint, SYMBOL, false)
+	});
+	register_<MovementComponent>(L, {
+		FIELD(MovementComponent, speed_modifier, REAL, true),
+		FIELD(MovementComponent, original_speed, REAL, true)
+	});
+	register_<CombatComponent>(L, {
+		FIELD(CombatComponent, curr_target, UINT, true),
+		FIELD(CombatComponent, min_dmg, UINT, true),
+		FIELD(CombatComponent, max_dmg, UINT, true),
+		FIELD(CombatComponent, cd_time, REAL, false),
+		FIELD(CombatComponent, cooldown, REAL, true),
+		FIELD(CombatComponent, range, REAL, true),
+		FIELD(CombatComponent, pursue, BOOL, false),
+		FIELD(CombatComponent, projectile_blueprint, SYMBOL, true)
+	});
+	register_<EventComponent>(L, {
+		FIELD(EventComponent, target, UINT, true),
+		FIELD(EventComponent, handler, UINT, false),
+		FIELD(EventComponent, radius, REAL, true),
+		FIELD(EventComponent, active, BOOL, true)
+	});
+	register_<TimeComponent>(L, {
+		FIELD(TimeComponent, curr_time, REAL, false),
+		FIELD(TimeComponent, time_limit, REAL, true),
+		FIELD(TimeComponent, target, UINT, true)
+	});
+	register_<ManaComponent>(L, {
+		FIELD(ManaComponent, curr_mana, UINT, false),
+		FIELD(ManaComponent, max_mana, UINT, false),
+		FIELD(ManaComponent, mana_regen, UINT, false)
+	});
+	register_<SpellComponent>(L, {
+		FIELD(SpellComponent, blueprint, SYMBOL, false),
+		FIELD(SpellComponent, cd_time, REAL, false),
+		FIELD(SpellComponent, cooldown, REAL, true)
+	});
+	register_<ProductionComponent>(L, {
+		FIELD(ProductionComponent, product_blueprint, SYMBOL, false),
+		FIELD(ProductionComponent, curr_produced, UINT, false),
+		FIELD(ProductionComponent, max_produced, UINT, false),
+		FIELD(ProductionComponent, cooldown, REAL, false),
+		FIELD(ProductionComponent, curr_cd, REAL, false)
+	});
+	register_<GridNodeComponent>(L, {
+		FIELD(GridNodeComponent, free, BOOL, false),
+		FIELD(GridNodeComponent, x, UINT, false),
+		FIELD(GridNodeComponent, y, UINT, false),
+		FIELD(GridNodeComponent, resident, UINT, false)
+	});
+	register_<ProductComponent>(L, {
+		FIELD(ProductComponent, producer, UINT, false)
+	});
+	register_<PathfindingComponent>(L, {
+		FIELD(PathfindingComponent, target_id, UINT, false),
+		FIELD(PathfindingComponent, last_id, UINT, false),
+		FIELD(PathfindingComponent, blueprint, SYMBOL, false)
+	});
+	register_<TaskHandlerComponent>(L, {
+		FIELD(TaskHandlerComponent, curr_task, UINT, false),
+		FIELD(TaskHandlerComponent, busy, BOOL, false),
+		FIELD(TaskHandlerComponent, blueprint, SYMBOL, false),
+		FIELD(TaskHandlerComponent, wait_time, REAL, false)
+	});
+	register_<StructureComponent>(L, {
+		FIELD(StructureComponent, radius, UINT, false),
+		FIELD(StructureComponent, walk_through, BOOL, false)
+	});
+	register_<HomingComponent>(L, {
+		FIELD(HomingComponent, source, UINT, false),
+		FIELD(HomingComponent, target, UINT, false),
+		FIELD(HomingComponent, dmg, UINT, false)
+	});
+	register_<EventHandlerComponent>(L, {
+		FIELD(EventHandlerComponent, handler, SYMBOL, false)
+	});
+	register_<DestructorComponent>(L, {
+		FIELD(DestructorComponent, blueprint, SYMBOL, false)
+	});
+	register_<GoldComponent>(L, {
+		FIELD(GoldComponent, max_amount, UINT, false),
+		FIELD(GoldComponent, curr_amount, UINT, false)
+	});
+	register_<FactionComponent>(L, {
+		FIELD(FactionComponent, faction, INT, false)
+	});
+	register_<PriceComponent>(L, {
+		FIELD(PriceComponent, price, UINT, true)
+	});
+	register_<ManaCrystalComponent>(L, {
+		FIELD(ManaCrystalComponent, cap_increase, UINT, false),
+		FIELD(ManaCrystalComponent, regen_increase, UINT, false)
+	});
+	register_<OnHitComponent>(L, {
+		FIELD(OnHitComponent, blueprint, SYMBOL, false),
+		FIELD(OnHitComponent, curr_time, REAL, false),
+		FIELD(OnHitComponent, cooldown, REAL, true)
+	});
+	register_<ConstructorComponent>(L, {
+		FIELD(ConstructorComponent, blueprint, SYMBOL, false)
+	});
+	register_<TriggerComponent>(L, {
+		FIELD(TriggerComponent, blueprint, SYMBOL, false),
+		FIELD(TriggerComponent, linked_entity, UINT, false),
+		FIELD(TriggerComponent, curr_time, REAL, false),
+		FIELD(TriggerComponent, cooldown, REAL, true),
+		FIELD(TriggerComponent, radius, REAL, true)
+	});
+	register_<UpgradeComponent>(L, {
+		FIELD(UpgradeComponent, blueprint, SYMBOL, true),
+		FIELD(UpgradeComponent, experience, UINT, false),
+		FIELD(UpgradeComponent, exp_needed, UINT, false),
+		FIELD(UpgradeComponent, level, UINT, false),
+		FIELD(UpgradeComponent, level_cap, UINT, false)
+	});
+	register_<NotificationComponent>(L, {
+		FIELD(NotificationComponent, curr_time, REAL, false),
+		FIELD(NotificationComponent, cooldown, REAL, true)
+	});
+	register_<ExplosionComponent>(L, {
+		FIELD(ExplosionComponent, delta, REAL, true),
+		FIELD(ExplosionComponent, max_radius, REAL, false),
+		FIELD(ExplosionComponent, curr_radius, REAL, false)
+	});
+	register_<LimitedLifeSpanComponent>(L, {
+		FIELD(LimitedLifeSpanComponent, curr_time, REAL, false),
+		FIELD(LimitedLifeSpanComponent, max_time, REAL, true)
+	});
+	register_<NameComponent>(L, {
+		FIELD(NameComponent, name, SYMBOL, false)
+	});
+	register_<ExperienceValueComponent>(L, {
+		FIELD(ExperienceValueComponent, value, UINT, false)
+	});
+	register_<CounterComponent>(L, {
+		FIELD(CounterComponent, curr_value, UINT, true),
+		FIELD(CounterComponent, max_value, UINT, true)
+	});
+	register_<SelectionComponent>(L, {
+		FIELD(SelectionComponent, blueprint, SYMBOL, false)
+	});
+	register_<ActivationComponent>(L, {
+		FIELD(ActivationComponent, blueprint, SYMBOL, false),
+		FIELD(ActivationComponent, activated, BOOL, false)
+	});
+}
+
+int ComponentProxy::push(lpp::Script::state L, tdt::uint id, int type)
+{
+	if(type < 0 || type >= Component::count || !resolvers_[type])
+		return luaL_error(L, "Component #%d cannot be accessed through a proxy.", type);
+
+	auto component = resolvers_[type](*entities_, id);
+	if(!component)
+	{
+		lua_pushnil(L);
+		return 1;
+	}
+
+	lua_getfield(L, LUA_REGISTRYINDEX, PROXY_CACHE);
+	auto key = (lua_Integer)(id * Component::count + type);
+	if(lua_rawgeti(L, -1, key) == LUA_TUSERDATA)
+	{
+		auto proxy = static_cast<Proxy*>(lua_touserdata(L, -1));
+		proxy->component = component;
+		proxy->generation = entities_->get_generation();
+		lua_remove(L, -2);
+		return 1;
+	}
+	lua_pop(L, 1);
+
+	auto proxy = static_cast<Proxy*>(lua_newuserdata(L, sizeof(Proxy)));
+	*proxy = Proxy{id, type, component, entities_->get_generation()};
+	lua_getfield(L, LUA_REGISTRYINDEX, PROXY_METATABLES);
+	lua_rawgeti(L, -1, type);
+	lua_setmetatable(L, -3);
+	lua_pop(L, 1);
+
+	lua_pushvalue(L, -1);
+	lua_rawseti(L, -3, key);
+	lua_remove(L, -2);
+	return 1;
+}
+
+template<typename COMP>
+void ComponentProxy::register_(lpp::Script::state L, std::initializer_list<Field> fields)
+{
+	resolvers_[COMP::type] = [](EntitySystem& ents, tdt::uint id) -> void* {
+		return ents.get_component<COMP>(id);
+	};
+
+	/**
+	 * Fields are stored in a table (upvalue of the metamethods) as integers
+	 * in the form of offset * 16 + type * 2 + writable.
+	 */
+	lua_getfield(L, LUA_REGISTRYINDEX, PROXY_METATABLES);
+	lua_newtable(L);
+	lua_newtable(L);
+	for(const auto& field : fields)
+	{
+		lua_pushinteger(L, (lua_Integer)(field.offset * 16 + (std::size_t)field.type * 2 + (field.writable ? 1 : 0)));
+		lua_setfield(L, -2, field.name);
+	}
+	lua_pushvalue(L, -1);
+	lua_pushcclosure(L, &ComponentProxy::index_, 1);
+	lua_setfield(L, -3, "__index");
+	lua_pushcclosure(L, &ComponentProxy::newindex_, 1);
+	lua_setfield(L, -2, "__newindex");
+	lua_pushcfunction(L, &ComponentProxy::tostring_);
+	lua_setfield(L, -2, "__tostring");
+	lua_rawseti(L, -2, COMP::type);
+	lua_pop(L, 1);
+}
+
+char* ComponentProxy::resolve_(lpp::Script::state L, Proxy& proxy)
+{
+	auto generation = entities_->get_generation();
+	if(proxy.generation != generation)
+	{ // Components have been removed since the pointer was resolved.
+		proxy.component = resolvers_[proxy.type](*entities_, proxy.id);
+		if(!proxy.component)
+			luaL_error(L, "Entity #%d does not have the component #%d anymore.", (int)proxy.id, proxy.type);
+		proxy.generation = generation;
+	}
+
+	return static_cast<char*>(proxy.component);
+}
+
+int ComponentProxy::index_(lpp::Script::state L)
+{
+	auto proxy = static_cast<Proxy*>(lua_touserdata(L, 1));
+	lua_pushvalue(L, 2);
+	if(lua_rawget(L, lua_upvalueindex(1)) != LUA_TNUMBER)
+		return luaL_error(L, "Component #%d has no field %s.", proxy->type, luaL_tolstring(L, 2, nullptr));
+
+	auto field = (std::size_t)lua_tointeger(L, -1);
+	auto ptr = resolve_(L, *proxy) + field / 16;
+	switch((FIELD_TYPE)(field % 16 / 2))
+	{
+		case FIELD_TYPE::BOOL:
+			lua_pushboolean(L, *reinterpret_cast<bool*>(ptr));
+			break;
+		case FIELD_TYPE::UINT:
+			lua_pushinteger(L, *reinterpret_cast<tdt::uint*>(ptr));
+			break;
+		case FIELD_TYPE::INT:
+			lua_pushinteger(L, *reinterpret_cast<int*>(ptr));
+			break;
+		case FIELD_TYPE::REAL:
+			lua_pushnumber(L, *reinterpret_cast<tdt::real*>(ptr));
+			break;
+		case FIELD_TYPE::SYMBOL:
+			lua_pushstring(L, reinterpret_cast<Symbol*>(ptr)->str().c_str());
+			break;
+	}
+	return 1;
+}
+
+int ComponentProxy::newindex_(lpp::Script::state L)
+{
+	auto proxy = static_cast<Proxy*>(lua_touserdata(L, 1));
+	lua_pushvalue(L, 2);
+	if(lua_rawget(L, lua_upvalueindex(1)) != LUA_TNUMBER)
+		return luaL_error(L, "Component #%d has no field %s.", proxy->type, luaL_tolstring(L, 2, nullptr));
+
+	auto field = (std::size_t)lua_tointeger(L, -1);
+	if(field % 2 == 0)
+		return luaL_error(L, "Field %s of component #%d is read only.", luaL_tolstring(L, 2, nullptr), proxy->type);
+
+	auto ptr = resolve_(L, *proxy) + field / 16;
+	switch((FIELD_TYPE)(field % 16 / 2))
+	{
+		case FIELD_TYPE::BOOL:
+			*reinterpret_cast<bool*>(ptr) = lua_toboolean(L, 3) == 1;
+			break;
+		case FIELD_TYPE::UINT:
+			*reinterpret_cast<tdt::uint*>(ptr) = (tdt::uint)luaL_checkinteger(L, 3);
+			break;
+		case FIELD_TYPE::INT:
+			*reinterpret_cast<int*>(ptr) = (int)luaL_checkinteger(L, 3);
+			break;
+		case FIELD_TYPE::REAL:
+			*reinterpret_cast<tdt::real*>(ptr) = (tdt::real)luaL_checknumber(L, 3);
+			break;
+		case FIELD_TYPE::SYMBOL:
+			*reinterpret_cast<Symbol*>(ptr) = Symbol{luaL_checkstring(L, 3)};
+			break;
+	}
+	entities_->mark_changed(proxy->id, proxy->type);
+	return 0;
+}
+
+int ComponentProxy::tostring_(lpp::Script::state L)
+{
+	auto proxy = static_cast<Proxy*>(lua_touserdata(L, 1));
+	lua_pushstring(L, ("component #" + std::to_string(proxy->type)
+					   + " of entity #" + std::to_string(proxy->id)).c_str());
+	return 1;
+}
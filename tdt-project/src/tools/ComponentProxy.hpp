@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <lppscript/LppScript.hpp>
+#include <Components.hpp>
+#include <Enums.hpp>
+#include <Typedefs.hpp>
+class EntitySystem;
+
+/**
+ * Lua userdata that gives scripts access to the fields of a single component of an entity
+ * (returned by game.entity.get(id, component)), e.g. proxy.curr_hp or proxy.range = 5.
+ * The proxy keeps a pointer to the component and reads the fields by their offsets, so accessing
+ * a field does not look the component up again. The pointer is resolved again only if the
+ * generation of the entity system changed (i.e. a component has been removed since), if the
+ * component does not exist anymore, accessing the proxy raises a Lua error.
+ * Proxies are cached (weakly), so getting a proxy of the same component twice returns
+ * the same userdata. Only fields that can be set without side effects (updating the GUI,
+ * the grid, scene nodes, ...) and that do not feed any cached state (path costs, the path
+ * service's grid snapshot, target queries) are writable, others have to be set through their helpers.
+ */
+class ComponentProxy
+{
+	public:
+		/**
+		 * \brief Creates the metatables of all proxies in a given Lua state.
+		 * \param The Lua state.
+		 * \param Entity system containing the components.
+		 */
+		static void init(lpp::Script::state, EntitySystem&);
+
+		/**
+		 * \brief Pushes a proxy of a given component onto the Lua stack (or nil if
+		 *        the entity does not have the component), returns the number of
+		 *        pushed values.
+		 * \param The Lua state.
+		 * \param ID of the entity.
+		 * \param Type of the component.
+		 */
+		static int push(lpp::Script::state, tdt::uint, int);
+
+	private:
+		/**
+		 * Description of a single accessible field of a component.
+		 */
+		struct Field
+		{
+			const char* name;
+			std::size_t offset;
+			FIELD_TYPE type;
+			bool writable;
+		};
+
+		/**
+		 * Contents of the proxy userdata.
+		 */
+		struct Proxy
+		{
+			tdt::uint id;
+			int type;
+			void* component;
+			tdt::uint generation;
+		};
+
+		using Resolver = void* (*)(EntitySystem&, tdt::uint);
+
+		/**
+		 * \brief Creates the metatable of the proxies of a given component type.
+		 * \param The Lua state.
+		 * \param Fields accessible through the proxy.
+		 */
+		template<typename COMP>
+		static void register_(lpp::Script::state, std::initializer_list<Field>);
+
+		/**
+		 * \brief Returns a pointer to the component of a given proxy, raises
+		 *        a Lua error if the component does not exist anymore.
+		 * \param The Lua state.
+		 * \param The proxy.
+		 */
+		static char* resolve_(lpp::Script::state, Proxy&);
+
+		/**
+		 * \brief Metamethods of the proxies, the fields of the component are
+		 *        an upvalue of __index and __newindex.
+		 * \param The Lua state.
+		 */
+		static int index_(lpp::Script::state);
+		static int newindex_(lpp::Script::state);
+		static int tostring_(lpp::Script::state);
+
+		/**
+		 * Entity system containing the components.
+		 */
+		static EntitySystem* entities_;
+
+		/**
+		 * Functions returning a pointer to a component of a given type (indexed by
+		 * the type, nullptr for components that have no proxies).
+		 */
+		static std::array<Resolver, Component::count> resolvers_;
+};
@@ -4,6 +4,8 @@
 #include <helpers/Helpers.hpp>
 #include "EntityPlacer.hpp"
 #include "Grid.hpp"
+#include "Journal.hpp"
+#include "Util.hpp"
 
 EntityPlacer::EntityPlacer(EntitySystem& ents, GridSystem& grid, Ogre::SceneManager& mgr)
 	: entities_{ents}, grid_{grid}, curr_position_{0, 0, 0},
@@ -37,14 +39,19 @@ void EntityPlacer::set_current_entity_table(const std::string& table_name, bool
 		mgr_.destroyEntity(ent_);
 		placing_node_->detachAllObjects();
 		placing_node_->setScale(1.f, 1.f, 1.f);
-		price_ = 0;
+		ent_ = nullptr;
 	}
-	ent_ = mgr_.createEntity(mesh);
-	ent_->setQueryFlags(0);
-	placing_node_->attachObject(ent_);
+	price_ = 0;
 
-	if(mat != "NO_MAT")
-		ent_->setMaterialName(mat);
+	if(!util::is_headless())
+	{ // No preview in the headless mode.
+		ent_ = mgr_.createEntity(mesh);
+		ent_->setQueryFlags(0);
+		placing_node_->attachObject(ent_);
+
+		if(mat != "NO_MAT")
+			ent_->setMaterialName(mat);
+	}
 	
 	if(!script.is_nil(table_name + ".StructureComponent"))
 	{
@@ -66,8 +73,10 @@ void EntityPlacer::set_current_entity_table(const std::string& table_name, bool
 		placing_node_->setScale(x, y, z);
 		half_height_ = y;
 	}
-	else
+	else if(ent_)
 		half_height_ = ent_->getWorldBoundingBox(true).getHalfSize().y;
+	else
+		half_height_ = GraphicsHelper::get_mesh_bounds(mesh).getHalfSize().y;
 }
 
 void EntityPlacer::update_position(const Ogre::Vector3& pos)
@@ -95,6 +104,10 @@ void EntityPlacer::update_position(const Ogre::Vector3& pos)
 
 tdt::uint EntityPlacer::place()
 {
+	Journal::instance().record(JOURNAL_COMMAND::PLACE, table_name_, {}, curr_position_.x,
+							   curr_position_.z, price_ > 0 ? 1 : 0);
+	Journal::Scope scope{};
+
 	if(!Player::instance().sub_gold(price_))
 	{
 		GUI::instance().get_log().print("\\[ERROR\\] Not enough gold to place that.");
@@ -132,6 +145,11 @@ tdt::uint EntityPlacer::place()
 	return id;
 }
 
+const Ogre::Vector3& EntityPlacer::get_position() const
+{
+	return curr_position_;
+}
+
 void EntityPlacer::set_visible(bool on_off)
 {
 	visible_ = on_off;
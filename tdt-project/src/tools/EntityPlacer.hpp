@@ -52,6 +52,11 @@ class EntityPlacer
 		 */
 		tdt::uint place();
 
+		/**
+		 * \brief Returns the position the entity would be placed at.
+		 */
+		const Ogre::Vector3& get_position() const;
+
 		/**
 		 * \brief Sets the visibility status of the placer (and it's dummy entity).
 		 * \param The new visibility status.
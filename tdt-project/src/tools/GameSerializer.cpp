@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <tuple>
 #include <Game.hpp>
 #include <gui/GUI.hpp>
 #include <systems/EntitySystem.hpp>
@@ -5,6 +10,8 @@
 #include <systems/WaveSystem.hpp>
 #include "GameSerializer.hpp"
 #include "Grid.hpp"
+#include "MappedFile.hpp"
+#include "Profiler.hpp"
 
 /**
  * \brief Macro that serves as a simpler way to use the serializers_ array when calling it's members.
@@ -17,7 +24,11 @@
 GameSerializer::GameSerializer(EntitySystem& ents)
 	: entities_{ents}, script_{lpp::Script::instance()},
 	  file_{}, save_entities_{}, save_components_{},
-	  serializers_{}
+	  serializers_{}, column_copiers_{}, column_loaders_{},
+	  autosave_{}, autosave_name_{}, autosave_interval_{300.f},
+	  autosave_timer_{}, autosave_slots_{3}, autosave_slot_{},
+	  incremental_autosaves_{true}, autosave_chain_length_{10},
+	  chain_length_{}, chain_id_{}, chain_name_{}, hashes_{}
 {
 	serializers_[PhysicsComponent::type] = &GameSerializer::save_component<PhysicsComponent>;
 	serializers_[HealthComponent::type] = &GameSerializer::save_component<HealthComponent>;
@@ -34,7 +45,7 @@ GameSerializer::GameSerializer(EntitySystem& ents)
 	serializers_[GridNodeComponent::type] = nullptr; // Cannot be saved, is generated with the graph.
 	serializers_[ProductComponent::type] = &GameSerializer::save_component<ProductComponent>;
 	serializers_[PathfindingComponent::type] = &GameSerializer::save_component<PathfindingComponent>;
-	serializers_[TaskComponent::type] = &GameSerializer::save_component<TaskComponent>;
+	serializers_[TaskComponent::type] = nullptr; // Tasks are not entities, saved in save_tasks.
 	serializers_[TaskHandlerComponent::type] = &GameSerializer::save_component<TaskHandlerComponent>;
 	serializers_[StructureComponent::type] = &GameSerializer::save_component<StructureComponent>;
 	serializers_[HomingComponent::type] = &GameSerializer::save_component<HomingComponent>;
@@ -63,9 +74,119 @@ GameSerializer::GameSerializer(EntitySystem& ents)
 	serializers_[SelectionComponent::type] = &GameSerializer::save_component<SelectionComponent>;
 	serializers_[DummyAlignComponent::type] = &GameSerializer::save_component<DummyAlignComponent>;
 	serializers_[ActivationComponent::type] = &GameSerializer::save_component<ActivationComponent>;
+
+	column_copiers_[PhysicsComponent::type] = &GameSerializer::copy_column<PhysicsComponent>;
+	column_copiers_[HealthComponent::type] = &GameSerializer::copy_column<HealthComponent>;
+	column_copiers_[AIComponent::type] = &GameSerializer::copy_column<AIComponent>;
+	column_copiers_[GraphicsComponent::type] = &GameSerializer::copy_column<GraphicsComponent>;
+	column_copiers_[MovementComponent::type] = &GameSerializer::copy_column<MovementComponent>;
+	column_copiers_[CombatComponent::type] = &GameSerializer::copy_column<CombatComponent>;
+	column_copiers_[EventComponent::type] = &GameSerializer::copy_column<EventComponent>;
+	column_copiers_[InputComponent::type] = &GameSerializer::copy_column<InputComponent>;
+	column_copiers_[TimeComponent::type] = &GameSerializer::copy_column<TimeComponent>;
+	column_copiers_[ManaComponent::type] = &GameSerializer::copy_column<ManaComponent>;
+	column_copiers_[SpellComponent::type] = &GameSerializer::copy_column<SpellComponent>;
+	column_copiers_[ProductionComponent::type] = &GameSerializer::copy_column<ProductionComponent>;
+	column_copiers_[GridNodeComponent::type] = nullptr; // Cannot be saved, is generated with the graph.
+	column_copiers_[ProductComponent::type] = &GameSerializer::copy_column<ProductComponent>;
+	column_copiers_[PathfindingComponent::type] = &GameSerializer::copy_column<PathfindingComponent>;
+	column_copiers_[TaskComponent::type] = nullptr; // Tasks are not entities, saved in take_snapshot.
+	column_copiers_[TaskHandlerComponent::type] = &GameSerializer::copy_column<TaskHandlerComponent>;
+	column_copiers_[StructureComponent::type] = &GameSerializer::copy_column<StructureComponent>;
+	column_copiers_[HomingComponent::type] = &GameSerializer::copy_column<HomingComponent>;
+	column_copiers_[EventHandlerComponent::type] = &GameSerializer::copy_column<EventHandlerComponent>;
+	column_copiers_[DestructorComponent::type] = &GameSerializer::copy_column<DestructorComponent>;
+	column_copiers_[GoldComponent::type] = &GameSerializer::copy_column<GoldComponent>;
+	column_copiers_[FactionComponent::type] = &GameSerializer::copy_column<FactionComponent>;
+	column_copiers_[PriceComponent::type] = &GameSerializer::copy_column<PriceComponent>;
+	column_copiers_[AlignComponent::type] = &GameSerializer::copy_column<AlignComponent>;
+	column_copiers_[MineComponent::type] = &GameSerializer::copy_column<MineComponent>;
+	column_copiers_[ManaCrystalComponent::type] = &GameSerializer::copy_column<ManaCrystalComponent>;
+	column_copiers_[OnHitComponent::type] = &GameSerializer::copy_column<OnHitComponent>;
+	column_copiers_[ConstructorComponent::type] = &GameSerializer::copy_column<ConstructorComponent>;
+	column_copiers_[TriggerComponent::type] = &GameSerializer::copy_column<TriggerComponent>;
+	column_copiers_[UpgradeComponent::type] = &GameSerializer::copy_column<UpgradeComponent>;
+	column_copiers_[NotificationComponent::type] = &GameSerializer::copy_column<NotificationComponent>;
+	column_copiers_[ExplosionComponent::type] = &GameSerializer::copy_column<ExplosionComponent>;
+	column_copiers_[LimitedLifeSpanComponent::type] = &GameSerializer::copy_column<LimitedLifeSpanComponent>;
+	column_copiers_[NameComponent::type] = &GameSerializer::copy_column<NameComponent>;
+	column_copiers_[ExperienceValueComponent::type] = &GameSerializer::copy_column<ExperienceValueComponent>;
+	column_copiers_[LightComponent::type] = &GameSerializer::copy_column<LightComponent>;
+	column_copiers_[CommandComponent::type] = &GameSerializer::copy_column<CommandComponent>;
+	column_copiers_[CounterComponent::type] = &GameSerializer::copy_column<CounterComponent>;
+	column_copiers_[PortalComponent::type] = &GameSerializer::copy_column<PortalComponent>;
+	column_copiers_[AnimationComponent::type] = &GameSerializer::copy_column<AnimationComponent>;
+	column_copiers_[SelectionComponent::type] = &GameSerializer::copy_column<SelectionComponent>;
+	column_copiers_[DummyAlignComponent::type] = &GameSerializer::copy_column<DummyAlignComponent>;
+	column_copiers_[ActivationComponent::type] = &GameSerializer::copy_column<ActivationComponent>;
+
+	column_loaders_[PhysicsComponent::type] = &GameSerializer::load_column<PhysicsComponent>;
+	column_loaders_[HealthComponent::type] = &GameSerializer::load_column<HealthComponent>;
+	column_loaders_[AIComponent::type] = &GameSerializer::load_column<AIComponent>;
+	column_loaders_[GraphicsComponent::type] = &GameSerializer::load_column<GraphicsComponent>;
+	column_loaders_[MovementComponent::type] = &GameSerializer::load_column<MovementComponent>;
+	column_loaders_[CombatComponent::type] = &GameSerializer::load_column<CombatComponent>;
+	column_loaders_[EventComponent::type] = &GameSerializer::load_column<EventComponent>;
+	column_loaders_[InputComponent::type] = &GameSerializer::load_column<InputComponent>;
+	column_loaders_[TimeComponent::type] = &GameSerializer::load_column<TimeComponent>;
+	column_loaders_[ManaComponent::type] = &GameSerializer::load_column<ManaComponent>;
+	column_loaders_[SpellComponent::type] = &GameSerializer::load_column<SpellComponent>;
+	column_loaders_[ProductionComponent::type] = &GameSerializer::load_column<ProductionComponent>;
+	column_loaders_[GridNodeComponent::type] = nullptr;
+	column_loaders_[ProductComponent::type] = &GameSerializer::load_column<ProductComponent>;
+	column_loaders_[PathfindingComponent::type] = &GameSerializer::load_column<PathfindingComponent>;
+	column_loaders_[TaskComponent::type] = nullptr;
+	column_loaders_[TaskHandlerComponent::type] = &GameSerializer::load_column<TaskHandlerComponent>;
+	column_loaders_[StructureComponent::type] = &GameSerializer::load_column<StructureComponent>;
+	column_loaders_[HomingComponent::type] = &GameSerializer::load_column<HomingComponent>;
+	column_loaders_[EventHandlerComponent::type] = &GameSerializer::load_column<EventHandlerComponent>;
+	column_loaders_[DestructorComponent::type] = &GameSerializer::load_column<DestructorComponent>;
+	column_loaders_[GoldComponent::type] = &GameSerializer::load_column<GoldComponent>;
+	column_loaders_[FactionComponent::type] = &GameSerializer::load_column<FactionComponent>;
+	column_loaders_[PriceComponent::type] = &GameSerializer::load_column<PriceComponent>;
+	column_loaders_[AlignComponent::type] = &GameSerializer::load_column<AlignComponent>;
+	column_loaders_[MineComponent::type] = &GameSerializer::load_column<MineComponent>;
+	column_loaders_[ManaCrystalComponent::type] = &GameSerializer::load_column<ManaCrystalComponent>;
+	column_loaders_[OnHitComponent::type] = &GameSerializer::load_column<OnHitComponent>;
+	column_loaders_[ConstructorComponent::type] = &GameSerializer::load_column<ConstructorComponent>;
+	column_loaders_[TriggerComponent::type] = &GameSerializer::load_column<TriggerComponent>;
+	column_loaders_[UpgradeComponent::type] = &GameSerializer::load_column<UpgradeComponent>;
+	column_loaders_[NotificationComponent::type] = &GameSerializer::load_column<NotificationComponent>;
+	column_loaders_[ExplosionComponent::type] = &GameSerializer::load_column<ExplosionComponent>;
+	column_loaders_[LimitedLifeSpanComponent::type] = &GameSerializer::load_column<LimitedLifeSpanComponent>;
+	column_loaders_[NameComponent::type] = &GameSerializer::load_column<NameComponent>;
+	column_loaders_[ExperienceValueComponent::type] = &GameSerializer::load_column<ExperienceValueComponent>;
+	column_loaders_[LightComponent::type] = &GameSerializer::load_column<LightComponent>;
+	column_loaders_[CommandComponent::type] = &GameSerializer::load_column<CommandComponent>;
+	column_loaders_[CounterComponent::type] = &GameSerializer::load_column<CounterComponent>;
+	column_loaders_[PortalComponent::type] = &GameSerializer::load_column<PortalComponent>;
+	column_loaders_[AnimationComponent::type] = &GameSerializer::load_column<AnimationComponent>;
+	column_loaders_[SelectionComponent::type] = &GameSerializer::load_column<SelectionComponent>;
+	column_loaders_[DummyAlignComponent::type] = &GameSerializer::load_column<DummyAlignComponent>;
+	column_loaders_[ActivationComponent::type] = &GameSerializer::load_column<ActivationComponent>;
+
+	update_change_tracking();
+}
+
+GameSerializer::~GameSerializer()
+{
+	if(autosave_.valid())
+		autosave_.wait();
 }
 
 void GameSerializer::save_game(Game& game, const std::string& fname)
+{
+	PROFILE_ZONE("GameSerializer::save_game");
+	SaveSnapshot snapshot{};
+	take_snapshot(game, snapshot);
+
+	// Manual saves are not compressed, so that they can be loaded in place.
+	auto error = write_snapshot(snapshot, fname, false);
+	if(!error.empty())
+		GUI::instance().get_console().print_text("<FAIL> " + error, Console::RED_TEXT);
+}
+
+void GameSerializer::export_game(Game& game, const std::string& fname)
 {
 	std::string file_name{"saves/" + fname + ".lua"};
 	file_.open(file_name);
@@ -145,6 +266,37 @@ void GameSerializer::save_game(Game& game, const std::string& fname)
 
 void GameSerializer::load_game(Game& game, const std::string& fname)
 {
+	PROFILE_ZONE("GameSerializer::load_game");
+	MappedFile snapshot{"saves/" + fname + ".sav"};
+	if(snapshot.is_open())
+	{
+		try
+		{
+			const char* data = snapshot.data();
+			tdt::uint size = snapshot.size();
+			std::string decompressed{};
+			if(SaveFormat::is_compressed(data, size))
+			{
+				decompressed = SaveFormat::decompress(data, size);
+				data = decompressed.data();
+				size = decompressed.size();
+			}
+
+			// Incremental autosaves are merged with their deltas before loading.
+			std::string merged{};
+			if(merge_deltas(fname, data, size, merged))
+				load_snapshot(game, merged.data(), merged.size());
+			else
+				load_snapshot(game, data, size);
+		}
+		catch(std::exception& ex)
+		{
+			GUI::instance().get_console().print_text("<FAIL> Could not load from file: " + fname, Console::RED_TEXT);
+			GUI::instance().get_console().print_text(ex.what(), Console::RED_TEXT);
+		}
+		return;
+	}
+
 	// Clean current game.
 	entities_.delete_entities();
 	entities_.cleanup();
@@ -173,15 +325,738 @@ void GameSerializer::load_game(Game& game, const std::string& fname)
 	}
 }
 
+void GameSerializer::load_snapshot(Game& game, const char* data, tdt::uint size)
+{
+	// The structure is checked first, so that a truncated save can't leave a half cleared game.
+	validate_snapshot(data, size);
+
+	SaveReader in{data, size};
+	char magic[4]{};
+	tdt::uint version{}, strings_offset{};
+	in.bytes(magic, 4);
+	in.value(version);
+	if(std::string(magic, 4) != std::string(SaveFormat::magic, 4) || version > SaveFormat::version)
+		throw std::runtime_error{"Unsupported save file format."};
+
+	if(version >= 2)
+	{
+		in.value(strings_offset);
+		in.read_strings(strings_offset);
+	}
+
+	tdt::uint chain{};
+	if(version >= 3)
+		in.value(chain); // Deltas are merged before loading.
+
+	// Clean current game.
+	entities_.delete_entities();
+	entities_.cleanup();
+	game.reset_unlocks();
+	GUI::instance().get_log().clear();
+
+	auto& player = Player::instance();
+	tdt::uint gold{}, max_mana{}, mana{}, mana_regen{};
+	in.value(gold);
+	in.value(max_mana);
+	in.value(mana);
+	in.value(mana_regen);
+	player.nulify_all_stats();
+	player.add_gold(gold);
+	player.add_max_mana(max_mana);
+	player.add_mana(mana);
+	player.add_mana_regen(mana_regen);
+
+	tdt::uint width{}, height{}, node_count{}, id{};
+	in.value(width);
+	in.value(height);
+	in.value(node_count);
+	game.create_empty_level(width, height);
+
+	auto& nodes = Grid::instance().nodes_;
+	if(node_count != nodes.size())
+		throw std::runtime_error{"Grid size mismatch in the save file."};
+	for(tdt::uint i = 0; i < node_count; ++i)
+	{
+		in.value(id);
+		in.map_entity(id, nodes[i]);
+	}
+
+	// New IDs are increasing, so components can be appended to their containers.
+	tdt::uint entity_count{};
+	in.value(entity_count);
+	for(tdt::uint i = 0; i < entity_count; ++i)
+	{
+		in.value(id);
+		in.map_entity(id, entities_.create_entity());
+	}
+
+	tdt::uint column_count{}, type{}, column_version{}, count{}, column_size{}, record_size{};
+	in.value(column_count);
+	for(tdt::uint i = 0; i < column_count; ++i)
+	{
+		in.value(type);
+		in.value(column_version);
+		in.value(count);
+		in.value(column_size);
+		if(version >= 2)
+			in.value(record_size);
+
+		auto start = in.position();
+		if(type < column_loaders_.size() && column_loaders_[type])
+			((this)->*column_loaders_[type])(in, count, column_version, record_size);
+		else
+			in.skip(column_size);
+
+		if(in.position() - start != column_size)
+			throw std::runtime_error{"Corrupted component column in the save file."};
+	}
+
+	load_runtime_data(in);
+	load_game_state(game, in);
+
+	// Activation can affect other entities, so it's done once they're all loaded.
+	for(auto& comp : entities_.get_component_container<ActivationComponent>())
+	{
+		if(comp.second.activated)
+		{
+			comp.second.activated = false;
+			ActivationHelper::activate(entities_, comp.first);
+		}
+	}
+
+	game.reset_camera();
+}
+
+void GameSerializer::validate_snapshot(const char* data, tdt::uint size)
+{
+	SaveReader in{data, size};
+	char magic[4]{};
+	tdt::uint version{}, strings_offset{}, value{};
+	in.bytes(magic, 4);
+	in.value(version);
+	if(std::string(magic, 4) != std::string(SaveFormat::magic, 4) || version > SaveFormat::version)
+		throw std::runtime_error{"Unsupported save file format."};
+
+	if(version >= 2)
+	{
+		in.value(strings_offset);
+		if(strings_offset > size)
+			throw std::runtime_error{"Unexpected end of the save file."};
+	}
+
+	if(version >= 3)
+		in.value(value); // Chain.
+	in.skip(4 * 4); // Player stats.
+
+	// Only the structure is checked, the contents are parsed once when loading.
+	tdt::uint width{}, height{}, count{};
+	in.value(width);
+	in.value(height);
+	in.value(count);
+	if(count != width * height)
+		throw std::runtime_error{"Grid size mismatch in the save file."};
+	in.skip(count * 4);
+	in.value(count);
+	in.skip(count * 4);
+
+	tdt::uint column_size{};
+	in.value(count);
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		in.skip(3 * 4); // Type, version and component count.
+		in.value(column_size);
+		if(version >= 2)
+			in.value(value); // Record size.
+		in.skip(column_size);
+	}
+}
+
+void GameSerializer::update(Game& game, tdt::real delta)
+{
+	finish_autosave();
+	if(autosave_interval_ <= 0.f)
+		return;
+
+	autosave_timer_ += delta;
+	if(autosave_timer_ >= autosave_interval_ && autosave(game))
+		autosave_timer_ = 0.f;
+}
+
+bool GameSerializer::autosave(Game& game)
+{
+	finish_autosave();
+	if(autosave_.valid())
+		return false;
+
+	std::unique_ptr<SaveSnapshot> snapshot{new SaveSnapshot{}};
+	bool full = !incremental_autosaves_ || entities_.changes_lost_
+		|| chain_length_ >= autosave_chain_length_;
+	if(full)
+	{
+		take_snapshot(game, *snapshot);
+
+		autosave_name_ = "autosave_" + std::to_string(autosave_slot_);
+		autosave_slot_ = (autosave_slot_ + 1) % autosave_slots_;
+		chain_name_ = autosave_name_;
+		chain_length_ = 0;
+		chain_id_ = 0;
+		if(incremental_autosaves_)
+		{
+			// Any nonzero value that differs from the IDs of older chains that might be left in the slot.
+			auto now = std::chrono::system_clock::now().time_since_epoch().count();
+			chain_id_ = static_cast<tdt::uint>(now) | 1;
+
+			for(auto& hashes : hashes_)
+				hashes.clear();
+			entities_.clear_changes();
+			entities_.changes_lost_ = false;
+		}
+		snapshot->chain = chain_id_;
+	}
+	else
+	{
+		take_delta(game, *snapshot);
+		snapshot->chain = chain_id_;
+		snapshot->sequence = ++chain_length_;
+		autosave_name_ = chain_name_ + "." + std::to_string(chain_length_);
+	}
+
+	autosave_ = std::async(std::launch::async,
+		[](std::unique_ptr<SaveSnapshot> snapshot, std::string fname, bool full) -> std::string {
+			auto error = write_snapshot(*snapshot, fname, true);
+
+			// Deltas of the previous chain in this slot are no longer valid.
+			if(error.empty() && full)
+			{
+				for(tdt::uint i = 1; ; ++i)
+				{
+					std::string delta{"saves/" + fname + "." + std::to_string(i) + ".delta"};
+					if(std::remove(delta.c_str()) != 0)
+						break;
+				}
+			}
+			return error;
+		}, std::move(snapshot), autosave_name_, full
+	);
+
+	return true;
+}
+
+void GameSerializer::set_autosave_interval(tdt::real interval)
+{
+	autosave_interval_ = interval;
+	autosave_timer_ = 0.f;
+	update_change_tracking();
+}
+
+tdt::real GameSerializer::get_autosave_interval() const
+{
+	return autosave_interval_;
+}
+
+void GameSerializer::set_autosave_slots(tdt::uint slots)
+{
+	autosave_slots_ = slots > 0 ? slots : 1;
+	if(autosave_slot_ >= autosave_slots_)
+		autosave_slot_ = 0;
+}
+
+tdt::uint GameSerializer::get_autosave_slots() const
+{
+	return autosave_slots_;
+}
+
+tdt::uint GameSerializer::get_state_hash(Game& game)
+{
+	SaveSnapshot snapshot{};
+	take_snapshot(game, snapshot);
+	SaveWriter out{};
+	snapshot.write(out);
+
+	return (tdt::uint)std::hash<std::string>{}(out.get_data());
+}
+
+void GameSerializer::set_incremental_autosaves(bool on_off)
+{
+	incremental_autosaves_ = on_off;
+	update_change_tracking();
+}
+
+bool GameSerializer::get_incremental_autosaves() const
+{
+	return incremental_autosaves_;
+}
+
+void GameSerializer::set_autosave_chain_length(tdt::uint length)
+{
+	autosave_chain_length_ = length;
+}
+
+tdt::uint GameSerializer::get_autosave_chain_length() const
+{
+	return autosave_chain_length_;
+}
+
+bool GameSerializer::merge_deltas(const std::string& fname, const char* data, tdt::uint size, std::string& merged)
+{
+	MappedFile first{"saves/" + fname + ".1.delta"};
+	if(!first.is_open())
+		return false;
+
+	// IDs are kept as they are, so that the entities of the base and the deltas match.
+	SaveSnapshot base{};
+	create_columns(base);
+	SaveReader in{data, size};
+	in.keep_ids(true);
+	base.read(in);
+	if(base.delta || base.chain == 0)
+		return false;
+
+	for(tdt::uint i = 1; ; ++i)
+	{
+		MappedFile file{"saves/" + fname + "." + std::to_string(i) + ".delta"};
+		if(!file.is_open())
+			break;
+
+		std::string contents{};
+		if(SaveFormat::is_compressed(file.data(), file.size()))
+			contents = SaveFormat::decompress(file.data(), file.size());
+		else
+			contents.assign(file.data(), file.size());
+
+		SaveSnapshot delta{};
+		create_columns(delta);
+		SaveReader delta_in{contents.data(), (tdt::uint)contents.size()};
+		delta_in.keep_ids(true);
+		delta.read(delta_in);
+
+		// Deltas left behind by an older chain in the same slot.
+		if(!delta.delta || delta.chain != base.chain || delta.sequence != i)
+			break;
+		base.apply(delta);
+	}
+
+	SaveWriter out{};
+	base.write(out);
+	merged = out.get_data();
+	return true;
+}
+
+void GameSerializer::take_snapshot(Game& game, SaveSnapshot& snapshot)
+{
+	PROFILE_ZONE("GameSerializer::take_snapshot");
+	auto& grid = Grid::instance();
+	snapshot.width = grid.width_;
+	snapshot.height = grid.height_;
+	snapshot.nodes = grid.nodes_;
+
+	for(const auto& ent : entities_.get_component_list())
+	{
+		if(!ent.second.test(GridNodeComponent::type))
+			snapshot.entities.push_back(ent.first);
+	}
+
+	for(auto copier : column_copiers_)
+	{
+		if(copier)
+			((this)->*copier)(snapshot, nullptr);
+	}
+
+	// Runtime data kept in Ogre objects and the grid.
+	for(auto& comp : entities_.get_component_container<GraphicsComponent>())
+	{
+		if(comp.second.entity && !entities_.has_component<GridNodeComponent>(comp.first))
+			snapshot.query_flags.emplace_back(comp.first, comp.second.entity->getQueryFlags());
+	}
+
+	for(auto& comp : entities_.get_component_container<LightComponent>())
+		snapshot.lights.emplace_back(comp.first, comp.second.light ? comp.second.light->isVisible() : true);
+
+	take_game_state(game, snapshot);
+}
+
+void GameSerializer::take_delta(Game& game, SaveSnapshot& snapshot)
+{
+	PROFILE_ZONE("GameSerializer::take_delta");
+	snapshot.delta = true;
+
+	// All components of new entities are saved.
+	auto& created = entities_.created_entities_;
+	std::sort(created.begin(), created.end());
+	created.erase(std::unique(created.begin(), created.end()), created.end());
+	for(auto id : created)
+	{
+		auto ent = entities_.entities_.find(id);
+		if(ent == entities_.entities_.end() || ent->second.test(GridNodeComponent::type))
+			continue;
+
+		snapshot.entities.push_back(id);
+		for(tdt::uint i = 0; i < ent->second.size(); ++i)
+		{
+			if(ent->second.test(i))
+				entities_.record_change(id, i);
+		}
+	}
+
+	auto& destroyed = entities_.destroyed_entities_;
+	std::sort(destroyed.begin(), destroyed.end());
+	destroyed.erase(std::unique(destroyed.begin(), destroyed.end()), destroyed.end());
+	for(auto id : destroyed)
+	{
+		if(entities_.exists(id))
+			continue;
+
+		snapshot.destroyed.push_back(id);
+		for(auto& hashes : hashes_)
+			hashes.erase(id);
+	}
+
+	for(tdt::uint i = 0; i < column_copiers_.size(); ++i)
+	{
+		if(!column_copiers_[i])
+			continue;
+
+		auto& ids = entities_.changes_[i].ids;
+		std::sort(ids.begin(), ids.end());
+		((this)->*column_copiers_[i])(snapshot, &ids);
+
+		// Components that were marked but are no longer present have been removed.
+		for(auto id : ids)
+		{
+			auto ent = entities_.entities_.find(id);
+			if(ent != entities_.entities_.end() && !ent->second.test(i)
+			   && !ent->second.test(GridNodeComponent::type))
+			{
+				snapshot.removed.emplace_back(id, i);
+				hashes_[i].erase(id);
+			}
+		}
+	}
+
+	for(auto id : entities_.changes_[GraphicsComponent::type].ids)
+	{
+		auto comp = entities_.get_component_container<GraphicsComponent>().find(id);
+		if(comp != entities_.get_component_container<GraphicsComponent>().end() && comp->second.entity
+		   && !entities_.has_component<GridNodeComponent>(id))
+			snapshot.query_flags.emplace_back(id, comp->second.entity->getQueryFlags());
+	}
+
+	for(auto id : entities_.changes_[LightComponent::type].ids)
+	{
+		auto comp = entities_.get_component_container<LightComponent>().find(id);
+		if(comp != entities_.get_component_container<LightComponent>().end())
+			snapshot.lights.emplace_back(id, comp->second.light ? comp->second.light->isVisible() : true);
+	}
+
+	entities_.clear_changes();
+	take_game_state(game, snapshot);
+}
+
+void GameSerializer::take_game_state(Game& game, SaveSnapshot& snapshot)
+{
+	auto& player = Player::instance();
+	snapshot.gold = player.get_gold();
+	snapshot.max_mana = player.get_max_mana();
+	snapshot.mana = player.get_mana();
+	snapshot.mana_regen = player.get_mana_regen();
+
+	for(auto& comp : entities_.get_component_container<GridNodeComponent>())
+	{
+		if(comp.second.neighbours[DIRECTION::PORTAL] != Component::NO_ENTITY)
+			snapshot.portals.emplace_back(comp.first, comp.second.neighbours[DIRECTION::PORTAL]);
+	}
+
+	auto& tasks = entities_.get_task_pool();
+	for(auto& ent : entities_.get_component_container<TaskHandlerComponent>())
+	{
+		// Current task goes first so that the handler continues with it after loading.
+		std::vector<tdt::uint> ent_tasks{ent.second.curr_task};
+		ent_tasks.insert(ent_tasks.end(), ent.second.task_queue.begin(), ent.second.task_queue.end());
+
+		for(auto task_id : ent_tasks)
+		{
+			auto task = tasks.get(task_id);
+			if(!task || (task->target != Component::NO_ENTITY && !entities_.exists(task->target)))
+				continue;
+			snapshot.tasks.emplace_back(ent.first, task->target, task->task_type);
+		}
+	}
+
+	snapshot.has_wave_system = game.wave_system_ != nullptr;
+	if(snapshot.has_wave_system)
+	{
+		auto& wsys = *game.wave_system_;
+		snapshot.wave_table = wsys.get_wave_table();
+		snapshot.wave_state = wsys.get_state();
+		snapshot.wave_count = wsys.get_wave_count();
+		snapshot.curr_wave = wsys.get_curr_wave_number();
+		snapshot.countdown = wsys.get_countdown_value();
+		snapshot.spawn_cooldown = wsys.get_spawn_cooldown();
+		snapshot.spawn_timer = wsys.get_spawn_timer();
+		snapshot.spawned = wsys.get_entities_spawned();
+		snapshot.wave_entities = wsys.get_wave_entities();
+		snapshot.entity_total = wsys.get_entity_total();
+		snapshot.wave_blueprints = wsys.get_entity_blueprints();
+		snapshot.spawn_nodes = wsys.get_spawning_nodes();
+	}
+
+	snapshot.spells = GUI::instance().get_spell_casting().get_spells();
+	snapshot.buildings = GUI::instance().get_builder().get_buildings();
+
+	const auto& unlocked = GUI::instance().get_research().get_unlocked();
+	for(tdt::uint i = 0; i < unlocked.size(); ++i)
+	{
+		if(unlocked[i])
+			snapshot.research.push_back(i);
+	}
+
+	snapshot.throne_id = game.throne_id_;
+}
+
+void GameSerializer::create_columns(SaveSnapshot& snapshot)
+{
+	std::vector<tdt::uint> none{};
+	for(auto copier : column_copiers_)
+	{
+		if(copier)
+			((this)->*copier)(snapshot, &none);
+	}
+}
+
+void GameSerializer::update_change_tracking()
+{
+	entities_.set_change_tracking(incremental_autosaves_ && autosave_interval_ > 0.f);
+}
+
+std::string GameSerializer::write_snapshot(SaveSnapshot& snapshot, const std::string& fname, bool compress)
+{
+	PROFILE_ZONE("GameSerializer::write_snapshot");
+	SaveWriter out{};
+	snapshot.write(out);
+
+	std::string file_name{"saves/" + fname + (snapshot.delta ? ".delta" : ".sav")};
+	std::string tmp_name{file_name + ".tmp"};
+	{
+		std::ofstream file{tmp_name, std::ios::binary | std::ios::trunc};
+		if(compress)
+		{
+			auto data = SaveFormat::compress(out.get_data());
+			file.write(data.data(), data.size());
+		}
+		else
+			file.write(out.get_data().data(), out.size());
+
+		if(!file)
+			return "Could not write to file: " + tmp_name;
+	}
+
+	std::remove(file_name.c_str());
+	if(std::rename(tmp_name.c_str(), file_name.c_str()) != 0)
+		return "Could not rename " + tmp_name + " to " + file_name;
+	return "";
+}
+
+void GameSerializer::finish_autosave()
+{
+	if(!autosave_.valid() || autosave_.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+		return;
+
+	std::string error{};
+	try
+	{
+		error = autosave_.get();
+	}
+	catch(std::exception& ex)
+	{
+		error = ex.what();
+	}
+
+	if(!error.empty())
+	{
+		GUI::instance().get_console().print_text("<FAIL> Autosave " + autosave_name_ + " failed.", Console::RED_TEXT);
+		GUI::instance().get_console().print_text(error, Console::RED_TEXT);
+
+		// The chain is broken, the next autosave will start a new one.
+		entities_.invalidate_changes();
+	}
+}
+
+void GameSerializer::load_runtime_data(SaveReader& in)
+{
+	for(auto& comp : entities_.get_component_container<GraphicsComponent>())
+		GraphicsHelper::init_graphics_component(entities_, entities_.get_scene_manager(), comp.first);
+
+	tdt::uint count{}, id{}, other{};
+	in.value(count);
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		in.entity(id);
+		in.value(other);
+		GraphicsHelper::set_query_flags(entities_, id, other);
+	}
+
+	for(auto& comp : entities_.get_component_container<LightComponent>())
+		LightHelper::init(entities_, comp.first);
+
+	bool visible{};
+	in.value(count);
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		in.entity(id);
+		in.value(visible);
+		LightHelper::set_visible(entities_, id, visible);
+	}
+
+	in.value(count);
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		in.entity(id);
+		in.entity(other);
+		GridNodeHelper::set_portal_neighbour(entities_, id, other);
+	}
+
+	// This will ensure that the grid nodes will have their residents also set,
+	// the list of free nodes is updated only once for all structures.
+	std::vector<tdt::uint> unfreed{};
+	for(auto& comp : entities_.get_component_container<StructureComponent>())
+	{
+		for(auto node : comp.second.residences)
+		{
+			auto node_comp = entities_.get_component<GridNodeComponent>(node);
+			if(node_comp)
+			{
+				if(node_comp->resident == Component::NO_ENTITY)
+					node_comp->resident = comp.first;
+				node_comp->free = false;
+				unfreed.push_back(node);
+			}
+		}
+	}
+	Grid::instance().add_unfreed(unfreed);
+
+	auto& player = Player::instance();
+	for(auto& comp : entities_.get_component_container<ProductionComponent>())
+	{
+		if(FactionHelper::get_faction(entities_, comp.first) == FACTION::FRIENDLY)
+		{
+			player.add_max_unit(comp.second.max_produced);
+			player.add_curr_unit(comp.second.curr_produced);
+		}
+	}
+}
+
+void GameSerializer::load_game_state(Game& game, SaveReader& in)
+{
+	tdt::uint count{}, handler{}, target{};
+	TASK_TYPE task_type{};
+	in.value(count);
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		in.entity(handler);
+		in.entity(target);
+		in.value(task_type);
+		if(handler != Component::NO_ENTITY)
+			TaskHelper::add_task(entities_, handler, TaskHelper::create_task(entities_, target, task_type));
+	}
+
+	bool has_wave_system{};
+	in.value(has_wave_system);
+	if(has_wave_system)
+	{
+		std::string table{};
+		WAVE_STATE state{};
+		tdt::uint wave_count{}, curr_wave{}, countdown{}, spawned{}, wave_entities{}, total{};
+		tdt::real spawn_cooldown{}, spawn_timer{};
+		in.value(table);
+		in.value(state);
+		in.value(wave_count);
+		in.value(curr_wave);
+		in.value(countdown);
+		in.value(spawn_cooldown);
+		in.value(spawn_timer);
+		in.value(spawned);
+		in.value(wave_entities);
+		in.value(total);
+
+		std::vector<std::string> blueprints{};
+		in.value(count);
+		blueprints.resize(count);
+		for(auto& blueprint : blueprints)
+			in.value(blueprint);
+
+		std::vector<tdt::uint> spawn_nodes{};
+		in.entities(spawn_nodes);
+
+		if(game.wave_system_)
+		{
+			auto& wsys = *game.wave_system_;
+			wsys.set_wave_table(table);
+			wsys.set_state(state);
+			wsys.set_wave_count(wave_count);
+			wsys.set_curr_wave_number(curr_wave);
+			wsys.set_countdown_value(countdown);
+			wsys.set_spawn_cooldown(spawn_cooldown);
+			wsys.set_spawn_timer(spawn_timer);
+			wsys.set_entities_spawned(spawned);
+			wsys.set_wave_entities(wave_entities);
+			wsys.set_entity_total(total);
+			for(const auto& blueprint : blueprints)
+				wsys.add_entity_blueprint(blueprint);
+			for(auto node : spawn_nodes)
+				wsys.add_spawn_node(node);
+			wsys.update_label_text();
+		}
+	}
+
+	std::string name{};
+	in.value(count);
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		in.value(name);
+		GUI::instance().get_spell_casting().register_spell(name);
+	}
+
+	in.value(count);
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		in.value(name);
+		GUI::instance().get_builder().register_building(name);
+	}
+
+	auto& research = GUI::instance().get_research();
+	tdt::uint index{};
+	in.value(count);
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		in.value(index);
+		research.dummy_unlock(index / research.cols_ + 1, index % research.cols_ + 1);
+	}
+
+	in.entity(target);
+	game.set_throne_id(target);
+}
+
 void GameSerializer::save_tasks()
 {
 	file_ << "\n-- TASKS: --\n";
-	for(auto& task_pair : task_pairs_)
+	auto& tasks = entities_.get_task_pool();
+	for(auto& ent : entities_.get_component_container<TaskHandlerComponent>())
 	{
-		file_ << "game.task.add(entity_" + std::to_string(task_pair.first) + ", entity_"
-			   + std::to_string(task_pair.second) + ")\n";
+		// Current task goes first so that the handler continues with it after loading.
+		std::vector<tdt::uint> ent_tasks{ent.second.curr_task};
+		ent_tasks.insert(ent_tasks.end(), ent.second.task_queue.begin(), ent.second.task_queue.end());
+
+		for(auto task_id : ent_tasks)
+		{
+			auto task = tasks.get(task_id);
+			if(!task || (task->target != Component::NO_ENTITY && !entities_.exists(task->target)))
+				continue;
+
+			// Tasks are not entities, so they are recreated instead of aliased.
+			file_ << "game.task.add(entity_" + std::to_string(ent.first) + ", game.task.create(entity_"
+				   + std::to_string(task->target) + ", " + std::to_string((int)task->task_type) + "))\n";
+		}
 	}
-	task_pairs_.clear();
 }
 
 std::string GameSerializer::save_wave_system(Game& game)
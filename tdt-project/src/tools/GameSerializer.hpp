@@ -4,9 +4,14 @@
 #include <vector>
 #include <fstream>
 #include <array>
+#include <future>
+#include <memory>
+#include <unordered_map>
 #include <Components.hpp>
 #include <Typedefs.hpp>
 #include <systems/EntitySystem.hpp>
+#include "SaveArchive.hpp"
+#include "SaveSnapshot.hpp"
 
 // Forward declaration.
 class Game;
@@ -16,12 +21,23 @@ namespace lpp
 }
 
 /**
- * Class that is used to save (by using Lua code generation)
- * and loading the game (by executing said code).
+ * Class that is used to save and load the game. Games are saved as binary
+ * snapshots (see SaveArchive.hpp for the layout), the old format (Lua code
+ * generation, loaded by executing said code) is still available as an export
+ * that is readable and editable by hand.
+ * The game is also periodically autosaved into a number of rotating slots (saves/autosave_<n>.sav),
+ * autosaves only copy the game's state into a SaveSnapshot on the main thread and are
+ * serialized, compressed and written on a background thread.
+ * Autosaves are incremental by default: a full snapshot starts a chain in an autosave slot
+ * and the following autosaves only write deltas with the components that changed since the
+ * previous one (tracked by the entity system), until the chain reaches it's maximal length
+ * and a new full snapshot is written (see SaveArchive.hpp for the format).
  */
 class GameSerializer
 {
 	typedef void (GameSerializer::*SerializerFuncPtr)(tdt::uint, const std::string&);
+	typedef void (GameSerializer::*ColumnCopierFuncPtr)(SaveSnapshot&, const std::vector<tdt::uint>*);
+	typedef void (GameSerializer::*ColumnLoaderFuncPtr)(SaveReader&, tdt::uint, tdt::uint, tdt::uint);
 	public:
 		/**
 		 * Constructor.
@@ -30,29 +46,234 @@ class GameSerializer
 		GameSerializer(EntitySystem&);
 
 		/**
-		 * Destructor.
+		 * Destructor, waits for the autosave that is being written (if any).
 		 */
-		~GameSerializer() {}
+		~GameSerializer();
 
 		/**
-		 * \brief Creates a Lua script that is to be used as a save file by
-		 *        serializing every entity into a sequence of commands that create
-		 *        this entity from scratch when executed.
+		 * \brief Saves the game into a binary snapshot (saves/<name>.sav).
 		 * \param Reference to the Game object (to be able to save all necessary data).
 		 * \param Name of the save file.
 		 */
 		void save_game(Game&, const std::string& = "quick_save");
 
 		/**
-		 * \brief Executes a given Lua script containing a serialized game, effectively
-		 *        restoring the state of that game.
+		 * \brief Creates a Lua script that can be used as a save file by
+		 *        serializing every entity into a sequence of commands that create
+		 *        this entity from scratch when executed (saves/<name>.lua).
+		 * \param Reference to the Game object (to be able to save all necessary data).
+		 * \param Name of the save file.
+		 */
+		void export_game(Game&, const std::string& = "quick_save");
+
+		/**
+		 * \brief Restores the state of a saved game, binary snapshots are preferred
+		 *        to exported Lua scripts of the same name.
 		 * \param Reference to the game object (currently used for console entries,
 		 *        but might be used more in the future).
 		 * \param Name of the save file to load.
 		 */
 		void load_game(Game&, const std::string& = "quick_save");
 
+		/**
+		 * \brief Advances the autosave timer, starts an autosave when the interval
+		 *        elapses and reports errors of finished autosaves.
+		 * \param Reference to the game object.
+		 * \param Time since the last frame.
+		 */
+		void update(Game&, tdt::real);
+
+		/**
+		 * \brief Takes a snapshot of the game and starts writing it into the next autosave
+		 *        slot on a background thread, returns false if the previous autosave
+		 *        hasn't been written yet.
+		 * \param Reference to the game object.
+		 */
+		bool autosave(Game&);
+
+		/**
+		 * \brief Sets the time between two autosaves (0 disables them).
+		 * \param The interval in seconds.
+		 */
+		void set_autosave_interval(tdt::real);
+
+		/**
+		 * \brief Returns the time between two autosaves.
+		 */
+		tdt::real get_autosave_interval() const;
+
+		/**
+		 * \brief Sets the number of autosave slots, the oldest autosave
+		 *        is overwritten once all of them are used.
+		 * \param Number of the slots.
+		 */
+		void set_autosave_slots(tdt::uint);
+
+		/**
+		 * \brief Returns the number of autosave slots.
+		 */
+		tdt::uint get_autosave_slots() const;
+
+		/**
+		 * \brief Returns a hash of everything that is saved, used to check that two runs
+		 *        of the game ended in the same state.
+		 * \param Reference to the game object.
+		 */
+		tdt::uint get_state_hash(Game&);
+
+		/**
+		 * \brief Turns incremental autosaves on or off.
+		 * \param True to save only changes between full autosaves, false to
+		 *        always save everything.
+		 */
+		void set_incremental_autosaves(bool);
+
+		/**
+		 * \brief Returns true if autosaves are incremental, false otherwise.
+		 */
+		bool get_incremental_autosaves() const;
+
+		/**
+		 * \brief Sets the number of deltas written after a full autosave before
+		 *        the next full autosave.
+		 * \param Number of the deltas.
+		 */
+		void set_autosave_chain_length(tdt::uint);
+
+		/**
+		 * \brief Returns the number of deltas written after a full autosave.
+		 */
+		tdt::uint get_autosave_chain_length() const;
+
 	private:
+		/**
+		 * \brief Restores the state of the game from a binary snapshot, throws
+		 *        std::runtime_error if the snapshot is invalid (the current game is left
+		 *        untouched if the snapshot's structure is invalid).
+		 * \param Reference to the game object.
+		 * \param Contents of the save file.
+		 * \param Size of the save file.
+		 */
+		void load_snapshot(Game&, const char*, tdt::uint);
+
+		/**
+		 * \brief Checks the structure of a binary snapshot (header, grid, entity lists and
+		 *        column sizes) without parsing it's contents and throws std::runtime_error
+		 *        if it is invalid.
+		 * \param Contents of the save file.
+		 * \param Size of the save file.
+		 */
+		void validate_snapshot(const char*, tdt::uint);
+
+		/**
+		 * \brief Merges the deltas of an incremental save into it's base and returns false
+		 *        if the save has no deltas. Throws std::runtime_error if a file is corrupted.
+		 * \param Name of the save.
+		 * \param Contents of the base file.
+		 * \param Size of the base file.
+		 * \param Output parameter for the merged snapshot.
+		 */
+		bool merge_deltas(const std::string&, const char*, tdt::uint, std::string&);
+
+		/**
+		 * \brief Copies everything that is saved into a snapshot.
+		 * \param Reference to the game object.
+		 * \param The snapshot.
+		 */
+		void take_snapshot(Game&, SaveSnapshot&);
+
+		/**
+		 * \brief Copies everything that changed since the last autosave into a delta
+		 *        snapshot and forgets the tracked changes.
+		 * \param Reference to the game object.
+		 * \param The snapshot.
+		 */
+		void take_delta(Game&, SaveSnapshot&);
+
+		/**
+		 * \brief Copies the parts of the game's state that are always saved whole (player,
+		 *        portals, tasks, wave system, unlocks and throne) into a snapshot.
+		 * \param Reference to the game object.
+		 * \param The snapshot.
+		 */
+		void take_game_state(Game&, SaveSnapshot&);
+
+		/**
+		 * \brief Creates empty columns of all saved component types in a snapshot,
+		 *        so that it can be read.
+		 * \param The snapshot.
+		 */
+		void create_columns(SaveSnapshot&);
+
+		/**
+		 * \brief Starts or stops tracking changes in the entity system depending on
+		 *        the autosave settings.
+		 */
+		void update_change_tracking();
+
+		/**
+		 * \brief Writes a snapshot into a save file (through a temporary file, so that
+		 *        a failed write doesn't destroy the previous save), returns an error
+		 *        message or an empty string on success. Doesn't access the game,
+		 *        so it can be called from any thread.
+		 * \param The snapshot.
+		 * \param Name of the save file.
+		 * \param If true, the file will be compressed.
+		 */
+		static std::string write_snapshot(SaveSnapshot&, const std::string&, bool);
+
+		/**
+		 * \brief Reports the result of the last autosave if it has been written.
+		 */
+		void finish_autosave();
+
+		/**
+		 * \brief Reads the runtime data and recreates everything that isn't
+		 *        part of the loaded components (scene nodes, lights, residents etc.).
+		 * \param Archive to read from.
+		 */
+		void load_runtime_data(SaveReader&);
+
+		/**
+		 * \brief Reads the wave system, unlocks and tasks.
+		 * \param Reference to the game object.
+		 * \param Archive to read from.
+		 */
+		void load_game_state(Game&, SaveReader&);
+
+		/**
+		 * \brief Copies components of a given type (specified as template argument)
+		 *        into a new column of a snapshot.
+		 * \param The snapshot.
+		 * \param IDs of entities whose components might have changed since the last autosave,
+		 *        only those whose contents really changed are copied (nullptr copies all).
+		 */
+		template<typename COMP>
+		void copy_column(SaveSnapshot&, const std::vector<tdt::uint>*);
+
+		/**
+		 * \brief Reads a column of components of a given type (specified as template argument)
+		 *        and inserts them into the entity system.
+		 * \param Archive to read from.
+		 * \param Number of components in the column.
+		 * \param Schema version of the column.
+		 * \param Size of the column's records (0 if the components were serialized).
+		 */
+		template<typename COMP>
+		void load_column(SaveReader&, tdt::uint, tdt::uint, tdt::uint);
+
+		/**
+		 * \brief Reads the components of a column as an array of fixed size records
+		 *        (the last argument tells if the component type has a record).
+		 * \param Archive to read from.
+		 * \param Number of components to read.
+		 * \param Size of the saved records.
+		 */
+		template<typename COMP>
+		void load_records(SaveReader&, tdt::uint, tdt::uint, std::true_type);
+		template<typename COMP>
+		void load_records(SaveReader&, tdt::uint, tdt::uint, std::false_type);
+
 		/**
 		 * \brief Adds commands to the save file that assign all tasks (has to be done last).
 		 */
@@ -90,12 +311,7 @@ class GameSerializer
 		lpp::Script& script_;
 
 		/**
-		 * Contains entity - task pairs that should be added in the save_tasks method.
-		 */
-		std::vector<std::pair<tdt::uint, tdt::uint>> task_pairs_;
-
-		/**
-		 * Main file stream (no need for ifstream, since loading is done through Lua).
+		 * Main file stream used by the Lua export (exported games are loaded through Lua).
 		 */
 		std::ofstream file_;
 
@@ -110,8 +326,142 @@ class GameSerializer
 		 * differencing between components.
 		 */
 		std::array<SerializerFuncPtr, Component::count> serializers_;
+
+		/**
+		 * Pointers to the copy_column and load_column instances (nullptr for components
+		 * that are not saved).
+		 */
+		std::array<ColumnCopierFuncPtr, Component::count> column_copiers_;
+		std::array<ColumnLoaderFuncPtr, Component::count> column_loaders_;
+
+		/**
+		 * Result (error message) of the autosave that is being written
+		 * and the name of it's file.
+		 */
+		std::future<std::string> autosave_;
+		std::string autosave_name_;
+
+		/**
+		 * Time between autosaves and time since the last one.
+		 */
+		tdt::real autosave_interval_;
+		tdt::real autosave_timer_;
+
+		/**
+		 * Number of autosave slots and the slot the next autosave goes to.
+		 */
+		tdt::uint autosave_slots_;
+		tdt::uint autosave_slot_;
+
+		/**
+		 * If true, autosaves are incremental.
+		 */
+		bool incremental_autosaves_;
+
+		/**
+		 * Maximal number of deltas in a chain, number of deltas in the current chain,
+		 * ID of the current chain and the name of it's base.
+		 */
+		tdt::uint autosave_chain_length_;
+		tdt::uint chain_length_;
+		tdt::uint chain_id_;
+		std::string chain_name_;
+
+		/**
+		 * Hashes of the saved contents of components (by type, then by entity ID) as of the last
+		 * autosave of the current chain, used to leave out components that were marked as changed
+		 * but are the same (e.g. were only read by a system that could modify them).
+		 */
+		std::array<std::unordered_map<tdt::uint, std::size_t>, Component::count> hashes_;
 };
 
+template<typename COMP>
+inline void GameSerializer::copy_column(SaveSnapshot& snapshot, const std::vector<tdt::uint>* ids)
+{
+	std::unique_ptr<SaveSnapshot::Column<COMP>> column{new SaveSnapshot::Column<COMP>{}};
+	auto& container = entities_.get_component_container<COMP>();
+	if(!ids)
+	{
+		column->components.reserve(container.size());
+		for(auto& comp : container)
+		{
+			// Nodes are generated with the graph.
+			if(!entities_.has_component<GridNodeComponent>(comp.first))
+				column->components.emplace_back(comp.first, comp.second);
+		}
+	}
+	else
+	{
+		auto& hashes = hashes_[COMP::type];
+		for(auto id : *ids)
+		{
+			auto comp = container.find(id);
+			if(comp == container.end() || entities_.has_component<GridNodeComponent>(id))
+				continue;
+
+			// The string table is included, so that the hash covers the strings and not their indices.
+			SaveWriter out{};
+			SaveFormat::serialize(out, comp->second, SaveFormat::schema<COMP>::version);
+			out.write_strings();
+			auto hash = std::hash<std::string>{}(out.get_data());
+
+			auto saved = hashes.find(id);
+			if(saved != hashes.end() && saved->second == hash)
+				continue;
+			hashes[id] = hash;
+			column->components.emplace_back(id, comp->second);
+		}
+	}
+	snapshot.columns[COMP::type] = std::move(column);
+}
+
+template<typename COMP>
+inline void GameSerializer::load_column(SaveReader& in, tdt::uint count, tdt::uint version, tdt::uint record_size)
+{
+	if(version > SaveFormat::schema<COMP>::version)
+		throw std::runtime_error{"Save file contains components of a newer version."};
+
+	if(record_size > 0)
+	{
+		load_records<COMP>(in, count, record_size, std::integral_constant<bool, SaveFormat::record<COMP>::fixed>{});
+		return;
+	}
+
+	tdt::uint id{};
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		COMP comp{};
+		in.entity(id);
+		SaveFormat::serialize(in, comp, version);
+		if(id != Component::NO_ENTITY)
+			entities_.insert_component(id, std::move(comp));
+	}
+}
+
+template<typename COMP>
+inline void GameSerializer::load_records(SaveReader& in, tdt::uint count, tdt::uint record_size, std::true_type)
+{
+	typedef typename SaveFormat::record<COMP>::type record_type;
+	if(record_size != sizeof(record_type))
+		throw std::runtime_error{"Save file contains records of a different size."};
+
+	in.align(SaveFormat::record_alignment);
+
+	auto records = in.records<record_type>(count);
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		auto id = in.translate(records[i].entity);
+		if(id != Component::NO_ENTITY)
+			entities_.insert_component(id, SaveFormat::record<COMP>::unpack(records[i]));
+	}
+}
+
+template<typename COMP>
+inline void GameSerializer::load_records(SaveReader&, tdt::uint, tdt::uint, std::false_type)
+{
+	throw std::runtime_error{"Save file contains records of a component that has none."};
+}
+
 template <>
 inline void GameSerializer::save_component<PhysicsComponent>(tdt::uint id, const std::string& tbl_name)
 {
@@ -329,21 +679,6 @@ inline void GameSerializer::save_component<PathfindingComponent>(tdt::uint id, c
 	save_components_.emplace_back(std::move(comm));
 }
 
-template <>
-inline void GameSerializer::save_component<TaskComponent>(tdt::uint id, const std::string& tbl_name)
-{
-	auto comp = entities_.get_component<TaskComponent>(id);
-	std::string comm{
-		  "game.entity.add_component(" + tbl_name + ", game.enum.component.task)\n"
-		+ "game.task.set_source(" + tbl_name + ", entity_" + std::to_string(comp->source) + ")\n"
-		+ "game.task.set_target(" + tbl_name + ", entity_" + std::to_string(comp->target) + ")\n"
-		+ "game.task.set_type(" + tbl_name + ", " + std::to_string((int)comp->task_type) + ")\n"
-	};
-	task_pairs_.emplace_back(comp->source, id);
-
-	save_components_.emplace_back(std::move(comm));
-}
-
 template<>
 inline void GameSerializer::save_component<TaskHandlerComponent>(tdt::uint id, const std::string& tbl_name)
 {
@@ -4,6 +4,7 @@
 #include <Components.hpp>
 #include <algorithm>
 #include "Grid.hpp"
+#include "PathService.hpp"
 #include "Util.hpp"
 
 bool Grid::in_board(tdt::uint id) const
@@ -31,6 +32,38 @@ void Grid::clear_unfreed()
 	unfreed_.clear();
 }
 
+void Grid::add_path_subscriber(tdt::uint id, const std::deque<tdt::uint>& path)
+{
+	for(auto node : path)
+		path_subscribers_[node].insert(id);
+}
+
+void Grid::remove_path_subscriber(tdt::uint id, tdt::uint node)
+{
+	auto it = path_subscribers_.find(node);
+	if(it != path_subscribers_.end())
+	{
+		it->second.erase(id);
+		if(it->second.empty())
+			path_subscribers_.erase(it);
+	}
+}
+
+void Grid::remove_path_subscriber(tdt::uint id, const std::deque<tdt::uint>& path)
+{
+	for(auto node : path)
+		remove_path_subscriber(id, node);
+}
+
+std::vector<tdt::uint> Grid::get_path_subscribers(tdt::uint node) const
+{
+	auto it = path_subscribers_.find(node);
+	if(it != path_subscribers_.end())
+		return std::vector<tdt::uint>{it->second.begin(), it->second.end()};
+	else
+		return std::vector<tdt::uint>{};
+}
+
 tdt::uint Grid::add_node(EntitySystem& ents, Ogre::Vector2 pos)
 {
 	if(nodes_.size() < width_ * height_)
@@ -77,6 +110,23 @@ void Grid::add_unfreed(tdt::uint id)
 	}
 }
 
+void Grid::add_unfreed(const std::vector<tdt::uint>& ids)
+{
+	std::set<tdt::uint> removed{};
+	for(auto id : ids)
+	{
+		if(in_board(id))
+		{
+			unfreed_.insert(id);
+			removed.insert(id);
+		}
+	}
+
+	free_nodes_.erase(std::remove_if(free_nodes_.begin(), free_nodes_.end(),
+									 [&removed](tdt::uint id) -> bool { return removed.count(id) > 0; }),
+					  free_nodes_.end());
+}
+
 void Grid::remove_node(tdt::uint id)
 {
 	std::remove(nodes_.begin(), nodes_.end(), id);
@@ -115,6 +165,8 @@ void Grid::create_graph(EntitySystem& ents, Ogre::Vector2 start, tdt::uint w, td
 		DestructorHelper::destroy(ents, node, true);
 	nodes_.clear();
 	nodes_.reserve(w * h);
+	path_subscribers_.clear();
+	PathService::instance().reset();
 	ents.cleanup(); // Create special cleanup only for entities with a given component?
 
 	start_ = start;
@@ -2,6 +2,8 @@
 
 #include <OGRE/Ogre.h>
 #include <set>
+#include <map>
+#include <deque>
 #include <vector>
 #include <Typedefs.hpp>
 class EntitySystem;
@@ -17,6 +19,7 @@ class Grid
 	 * (like dimensions and node distance) when saving the game.
 	 */
 	friend class GameSerializer;
+	friend class QuickSaveRing;
 	public:
 		/**
 		 * \brief Returns true if a given node is in the grid.
@@ -46,6 +49,40 @@ class Grid
 		 */
 		void clear_unfreed();
 
+		/**
+		 * \brief Registers a given entity as a subscriber of all nodes on a given path,
+		 *        so that it can be found quickly when any of those nodes gets unfreed.
+		 * \param ID of the pathfinding entity.
+		 * \param The entity's path.
+		 */
+		void add_path_subscriber(tdt::uint, const std::deque<tdt::uint>&);
+
+		/**
+		 * \brief Removes a given entity from the subscribers of a given node
+		 *        (called when the entity leaves the node).
+		 * \param ID of the pathfinding entity.
+		 * \param ID of the node.
+		 */
+		void remove_path_subscriber(tdt::uint, tdt::uint);
+
+		/**
+		 * \brief Removes a given entity from the subscribers of all nodes on a given path
+		 *        (called when the path is replaced or cleared).
+		 * \param ID of the pathfinding entity.
+		 * \param The entity's path.
+		 */
+		void remove_path_subscriber(tdt::uint, const std::deque<tdt::uint>&);
+
+		/**
+		 * \brief Returns the IDs of all entities whose registered paths lead through
+		 *        a given node.
+		 * \param ID of the node.
+		 * \note A node can be in a path multiple times while leaving it removes the
+		 *       subscription, so the caller has to check that the node is still in the
+		 *       entity's path.
+		 */
+		std::vector<tdt::uint> get_path_subscribers(tdt::uint) const;
+
 		/**
 		 * \brief Created a new node at the given position.
 		 * \param EntitySystem that contains the node.
@@ -65,6 +102,14 @@ class Grid
 		 */
 		void add_unfreed(tdt::uint);
 
+		/**
+		 * \brief Adds given nodes to the list of the unfreed nodes, removing
+		 *        them from the list of free nodes in a single pass (used when
+		 *        loading levels with many structures).
+		 * \param IDs of the nodes.
+		 */
+		void add_unfreed(const std::vector<tdt::uint>&);
+
 		/**
 		 * \brief Removes a given node from the node list.
 		 * \param ID of the node.
@@ -183,6 +228,12 @@ class Grid
 		 */
 		std::set<tdt::uint> freed_, unfreed_;
 
+		/**
+		 * Reverse index from nodes to the entities whose paths lead
+		 * through them, used to find paths that need correction.
+		 */
+		std::map<tdt::uint, std::set<tdt::uint>> path_subscribers_;
+
 		/**
 		 * Dimensions of the grid in node count.
 		 * (Actual dimensions = dimensions * distance.)
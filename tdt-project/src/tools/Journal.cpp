@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <Game.hpp>
+#include <gui/GUI.hpp>
+#include <helpers/Helpers.hpp>
+#include <lppscript/LppScript.hpp>
+#include <systems/EntitySystem.hpp>
+#include <systems/WaveSystem.hpp>
+#include "Journal.hpp"
+#include "EntityPlacer.hpp"
+#include "GameSerializer.hpp"
+#include "MappedFile.hpp"
+#include "PathService.hpp"
+#include "SaveArchive.hpp"
+#include "SelectionBox.hpp"
+#include "Spellcaster.hpp"
+#include "SystemScheduler.hpp"
+#include "Util.hpp"
+
+namespace
+{
+	/**
+	 * Header of journal files.
+	 */
+	constexpr char journal_magic[] = "TDTJ";
+	constexpr tdt::uint journal_version = 2;
+
+	/**
+	 * Maximal number of steps simulated in one frame in real time (the simulation slows down
+	 * instead of falling further behind) and the time a frame can take in fast replays.
+	 */
+	constexpr tdt::uint max_steps_per_frame = 10;
+	constexpr std::chrono::milliseconds fast_frame_budget{100};
+}
+
+Journal::Scope::Scope()
+{
+	++Journal::instance().depth_;
+}
+
+Journal::Scope::~Scope()
+{
+	--Journal::instance().depth_;
+}
+
+Journal& Journal::instance()
+{
+	static Journal inst{};
+
+	return inst;
+}
+
+void Journal::start_recording(Game& game, tdt::uint seed, tdt::uint width, tdt::uint height)
+{
+	stop(game);
+
+	seed_ = seed;
+	width_ = width;
+	height_ = height;
+	wave_table_ = game.wave_system_->get_wave_table();
+	headless_ = util::is_headless();
+	entries_.clear();
+	length_ = 0;
+	end_hash_ = 0;
+
+	start_(game);
+	recording_ = true;
+}
+
+void Journal::record(JOURNAL_COMMAND command, const std::string& name, const std::vector<tdt::uint>& ids,
+					 tdt::real x, tdt::real y, tdt::uint value)
+{
+	if(!recording_ || depth_ > 0)
+		return;
+
+	// Journal commands from the console control the recording, they are not part of it.
+	if(command == JOURNAL_COMMAND::LUA && name.find("game.journal.") != std::string::npos)
+		return;
+
+	entries_.push_back(Entry{tick_, command, name, ids, x, y, value});
+}
+
+void Journal::stop(Game& game)
+{
+	if(recording_)
+	{
+		length_ = tick_;
+		end_hash_ = game.game_serializer_->get_state_hash(game);
+	}
+
+	recording_ = false;
+	replaying_ = false;
+	fast_ = false;
+	PathService::instance().set_synchronous(false);
+}
+
+bool Journal::save(Game& game, const std::string& fname)
+{
+	if(recording_)
+	{ // Saved up to this moment, recording continues.
+		length_ = tick_;
+		end_hash_ = game.game_serializer_->get_state_hash(game);
+	}
+
+	SaveWriter out{};
+	tdt::uint version{journal_version}, strings_offset{}, count = entries_.size();
+	out.bytes(journal_magic, 4);
+	out.value(version);
+	out.value(strings_offset);
+	out.value(seed_);
+	out.value(width_);
+	out.value(height_);
+	out.value(wave_table_);
+	out.value(step_);
+	out.value(length_);
+	out.value(end_hash_);
+	out.value(headless_);
+
+	out.value(count);
+	for(auto& entry : entries_)
+	{
+		out.value(entry.tick);
+		out.value(entry.command);
+		out.value(entry.name);
+		count = entry.ids.size();
+		out.value(count);
+		for(auto& id : entry.ids)
+			out.value(id);
+		out.value(entry.x);
+		out.value(entry.y);
+		out.value(entry.value);
+	}
+
+	strings_offset = out.size();
+	out.write_strings();
+	out.patch(8, strings_offset);
+
+	std::ofstream file{"saves/" + fname + ".journal", std::ios::binary | std::ios::trunc};
+	file.write(out.get_data().data(), out.size());
+	return (bool)file;
+}
+
+bool Journal::replay(Game& game, const std::string& fname, bool fast)
+{
+	MappedFile file{"saves/" + fname + ".journal"};
+	if(!file.is_open())
+		return false;
+
+	tdt::uint seed{}, width{}, height{}, length{}, end_hash{};
+	bool headless{util::is_headless()};
+	std::string wave_table{};
+	tdt::real step{};
+	std::vector<Entry> entries{};
+	try
+	{
+		SaveReader in{file.data(), file.size()};
+		char magic[4]{};
+		tdt::uint version{}, strings_offset{}, count{}, id_count{};
+		in.bytes(magic, 4);
+		in.value(version);
+		if(std::string(magic, 4) != std::string(journal_magic, 4) || version > journal_version)
+			return false;
+
+		in.value(strings_offset);
+		in.read_strings(strings_offset);
+		in.value(seed);
+		in.value(width);
+		in.value(height);
+		in.value(wave_table);
+		in.value(step);
+		in.value(length);
+		in.value(end_hash);
+		if(version >= 2) // Older journals don't know their mode.
+			in.value(headless);
+
+		in.value(count);
+		entries.resize(count);
+		for(auto& entry : entries)
+		{
+			in.value(entry.tick);
+			in.value(entry.command);
+			in.value(entry.name);
+			in.value(id_count);
+			entry.ids.resize(id_count);
+			for(auto& id : entry.ids)
+				in.value(id);
+			in.value(entry.x);
+			in.value(entry.y);
+			in.value(entry.value);
+		}
+	}
+	catch(std::exception&)
+	{
+		return false;
+	}
+
+	if(headless != util::is_headless())
+	{ // Line of sight is tested differently without meshes, the replay would diverge.
+		GUI::instance().get_console().print_text("The journal " + fname + " was recorded in the "
+												 + (headless ? "headless" : "windowed") + " mode and cannot be replayed in the other one.",
+												 Console::RED_TEXT);
+		return false;
+	}
+
+	stop(game);
+	seed_ = seed;
+	width_ = width;
+	height_ = height;
+	wave_table_ = wave_table;
+	headless_ = headless;
+	step_ = step > 0.f ? step : step_;
+	length_ = length;
+	end_hash_ = end_hash;
+	entries_ = std::move(entries);
+
+	start_(game);
+	replaying_ = true;
+	fast_ = fast;
+	return true;
+}
+
+void Journal::update(Game& game, tdt::real delta)
+{
+	accumulator_ = std::min(accumulator_ + delta, step_ * max_steps_per_frame);
+	auto frame_start = std::chrono::high_resolution_clock::now();
+	while(fast_ ? replaying_ : accumulator_ >= step_)
+	{
+		if(replaying_)
+		{
+			replay_commands_(game);
+			if(tick_ >= length_)
+			{
+				finish_replay_(game);
+				break;
+			}
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+		{
+			Scope scope{};
+			game.scheduler_->update(step_);
+		}
+		auto time = std::chrono::high_resolution_clock::now() - start;
+		total_time_ += time;
+		max_time_ = std::max(max_time_, time);
+		++tick_;
+
+		if(!fast_)
+			accumulator_ -= step_;
+		else if(std::chrono::high_resolution_clock::now() - frame_start > fast_frame_budget)
+			break; // Let the frame be rendered.
+	}
+}
+
+bool Journal::is_deterministic() const
+{
+	return recording_ || replaying_;
+}
+
+bool Journal::is_recording() const
+{
+	return recording_;
+}
+
+bool Journal::is_replaying() const
+{
+	return replaying_;
+}
+
+tdt::uint Journal::get_tick() const
+{
+	return tick_;
+}
+
+void Journal::set_step(tdt::real step)
+{
+	if(step > 0.f)
+		step_ = step;
+}
+
+tdt::real Journal::get_step() const
+{
+	return step_;
+}
+
+Journal::Journal()
+	: seed_{}, width_{}, height_{}, wave_table_{}, step_{1.f / 60.f}, headless_{false},
+	  entries_{}, next_entry_{}, length_{}, end_hash_{},
+	  recording_{false}, replaying_{false}, fast_{false},
+	  tick_{}, accumulator_{}, depth_{},
+	  total_time_{}, max_time_{}
+{ /* DUMMY BODY */ }
+
+void Journal::start_(Game& game)
+{
+	util::set_random_seed(seed_);
+	lpp::Script::instance().execute("math.randomseed(" + std::to_string(seed_) + ")");
+	PathService::instance().set_synchronous(true);
+
+	tick_ = 0;
+	accumulator_ = 0.f;
+	next_entry_ = 0;
+	total_time_ = std::chrono::high_resolution_clock::duration::zero();
+	max_time_ = std::chrono::high_resolution_clock::duration::zero();
+
+	Scope scope{};
+	game.spell_caster_->stop_casting();
+	game.selection_box_->clear_selected_entities();
+	GUI::instance().get_tracker().clear();
+	game.wave_system_->set_wave_table(wave_table_);
+	game.new_game(width_, height_);
+	game.set_state(GAME_STATE::RUNNING);
+}
+
+void Journal::replay_commands_(Game& game)
+{
+	while(next_entry_ < entries_.size() && entries_[next_entry_].tick <= tick_)
+		replay_command_(game, entries_[next_entry_++]);
+}
+
+void Journal::replay_command_(Game& game, const Entry& entry)
+{
+	Scope scope{};
+	auto& ents = *game.entity_system_;
+	auto& placer = *game.placer_;
+	auto& caster = *game.spell_caster_;
+
+	// Commands use the selection, so the recorded one is used instead of the player's.
+	auto& selected = game.selection_box_->get_selected_entities();
+	auto players_selection = selected;
+	selected = entry.ids;
+
+	switch(entry.command)
+	{
+		case JOURNAL_COMMAND::PLACE:
+			placer.set_current_entity_table(entry.name, entry.value > 0);
+			placer.update_position(Ogre::Vector3{entry.x, 0.f, entry.y});
+			placer.place();
+			break;
+		case JOURNAL_COMMAND::CAST:
+			caster.stop_casting();
+			caster.set_spell(entry.name);
+			caster.set_spell_type((SPELL_TYPE)entry.value);
+			if((SPELL_TYPE)entry.value == SPELL_TYPE::PLACING)
+				placer.update_position(Ogre::Vector3{entry.x, 0.f, entry.y});
+			caster.cast(Ogre::Vector2{entry.x, entry.y});
+			caster.stop_casting();
+			break;
+		case JOURNAL_COMMAND::COMMAND:
+			switch((COMMAND_TYPE)entry.value)
+			{
+				case COMMAND_TYPE::MINE:
+					CommandHelper::command_to_mine(ents, *game.selection_box_);
+					break;
+				case COMMAND_TYPE::ATTACK:
+					CommandHelper::command_to_attack(ents, *game.selection_box_);
+					break;
+				case COMMAND_TYPE::REPOSITION:
+					CommandHelper::command_to_reposition(ents, entry.x, entry.y);
+					break;
+				case COMMAND_TYPE::RETURN_GOLD:
+					CommandHelper::command_to_return_gold(ents, *game.combat_system_);
+					break;
+				case COMMAND_TYPE::FALL_BACK:
+					CommandHelper::command_to_fall_back(ents);
+					break;
+				default:
+					break;
+			}
+			break;
+		case JOURNAL_COMMAND::RESEARCH:
+			if(entry.ids.size() == 2)
+				GUI::instance().get_research().unlock(entry.ids[0], entry.ids[1]);
+			break;
+		case JOURNAL_COMMAND::LUA:
+			try
+			{
+				lpp::Script::instance().execute(entry.name);
+			}
+			catch(lpp::Exception& ex)
+			{
+				GUI::instance().get_console().print_text(ex.what_lua(), Console::RED_TEXT);
+			}
+			break;
+		default:
+			break;
+	}
+
+	selected = players_selection;
+}
+
+void Journal::finish_replay_(Game& game)
+{
+	auto total = std::chrono::duration_cast<std::chrono::microseconds>(total_time_).count() / 1000.f;
+	auto max = std::chrono::duration_cast<std::chrono::microseconds>(max_time_).count() / 1000.f;
+	auto hash = game.game_serializer_->get_state_hash(game);
+
+	auto& console = GUI::instance().get_console();
+	console.print_text("Replay finished: " + std::to_string(tick_) + " steps in " + std::to_string(total)
+					   + " ms (average " + std::to_string(tick_ > 0 ? total / tick_ : 0.f) + " ms, maximum "
+					   + std::to_string(max) + " ms per step).", Console::GREEN_TEXT);
+	if(hash == end_hash_)
+		console.print_text("The final state matches the recording.", Console::GREEN_TEXT);
+	else
+		console.print_text("The final state differs from the recording!", Console::RED_TEXT);
+
+	stop(game);
+}
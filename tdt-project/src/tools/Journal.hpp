@@ -0,0 +1,232 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <Enums.hpp>
+#include <Typedefs.hpp>
+class Game;
+
+/**
+ * Records the commands of the player and plays them back, so that a game session can be
+ * reproduced exactly (e.g. to use a recorded session as a performance benchmark).
+ * While recording or replaying, the game runs in deterministic mode: the random generators
+ * (util::get_random and Lua's math.random) are seeded explicitly, the systems are updated
+ * sequentially with a fixed time step and paths are found synchronously. A journal starts with
+ * a new game and contains every placement (EntityPlacer), spell cast (Spellcaster), unit command
+ * (CommandHelper), research unlock and Lua command from the console together with the number
+ * of the step it was issued in.
+ * Commands issued by other commands (e.g. placing an entity by a spell) or during a step
+ * (e.g. by Lua scripts of entities) are not recorded, since the replay issues them again.
+ * Loading a game while recording breaks the replay. Journals can only be replayed in the mode
+ * (windowed or headless) they were recorded in.
+ */
+class Journal
+{
+	public:
+		/**
+		 * Suppresses recording of commands while it exists, used around commands that
+		 * were recorded and steps of the simulation.
+		 */
+		class Scope
+		{
+			public:
+				Scope();
+				~Scope();
+		};
+
+		/**
+		 * \brief Returns a reference to the static instance of this class.
+		 */
+		static Journal& instance();
+
+		/**
+		 * \brief Starts a new game in deterministic mode and starts recording.
+		 * \param Reference to the game object.
+		 * \param Seed of the random generators.
+		 * \param Width of the level.
+		 * \param Height of the level.
+		 */
+		void start_recording(Game&, tdt::uint, tdt::uint, tdt::uint);
+
+		/**
+		 * \brief Records a command if recording, otherwise does nothing.
+		 * \param Type of the command.
+		 * \param Name of the entity blueprint, spell or the Lua command.
+		 * \param IDs of the targets of the command (selected entities).
+		 * \param First coordinate of the command's position.
+		 * \param Second coordinate of the command's position.
+		 * \param Additional value (price flag, spell or command type).
+		 */
+		void record(JOURNAL_COMMAND, const std::string& = "", const std::vector<tdt::uint>& = {},
+					tdt::real = 0.f, tdt::real = 0.f, tdt::uint = 0);
+
+		/**
+		 * \brief Stops recording or replaying and returns to the normal mode.
+		 * \param Reference to the game object.
+		 */
+		void stop(Game&);
+
+		/**
+		 * \brief Saves the recorded journal into saves/<name>.journal, returns false
+		 *        if the file could not be written.
+		 * \param Reference to the game object.
+		 * \param Name of the journal.
+		 */
+		bool save(Game&, const std::string&);
+
+		/**
+		 * \brief Loads a journal from saves/<name>.journal and replays it from the start,
+		 *        returns false if the file could not be read.
+		 * \param Reference to the game object.
+		 * \param Name of the journal.
+		 * \param If true, the journal is played back as fast as possible instead of in real time.
+		 */
+		bool replay(Game&, const std::string&, bool = false);
+
+		/**
+		 * \brief Runs the simulation in fixed steps for the time that passed since the last
+		 *        frame and replays the commands of each step before it.
+		 * \param Reference to the game object.
+		 * \param Time since the last frame.
+		 */
+		void update(Game&, tdt::real);
+
+		/**
+		 * \brief Returns true if the game runs in deterministic mode (recording or replaying).
+		 */
+		bool is_deterministic() const;
+
+		/**
+		 * \brief Returns true if recording, false otherwise.
+		 */
+		bool is_recording() const;
+
+		/**
+		 * \brief Returns true if replaying, false otherwise.
+		 */
+		bool is_replaying() const;
+
+		/**
+		 * \brief Returns the number of steps simulated since the start of the journal.
+		 */
+		tdt::uint get_tick() const;
+
+		/**
+		 * \brief Sets the length of the simulation step, applies to the next recording.
+		 * \param Length of the step (in seconds).
+		 */
+		void set_step(tdt::real);
+
+		/**
+		 * \brief Returns the length of the simulation step.
+		 */
+		tdt::real get_step() const;
+
+		/**
+		 * Since there should be only one journal at all times, all copy/move
+		 * operations are disabled for this class.
+		 */
+		Journal(const Journal&) = delete;
+		Journal& operator=(const Journal&) = delete;
+		Journal(Journal&&) = delete;
+		Journal& operator=(Journal&&) = delete;
+
+	private:
+		/**
+		 * Constructor.
+		 * Kept private since there should be only one journal at all times.
+		 */
+		Journal();
+
+		/**
+		 * Destructor.
+		 */
+		~Journal() {}
+
+		/**
+		 * A single recorded command.
+		 */
+		struct Entry
+		{
+			tdt::uint tick;
+			JOURNAL_COMMAND command;
+			std::string name;
+			std::vector<tdt::uint> ids;
+			tdt::real x, y;
+			tdt::uint value;
+		};
+
+		/**
+		 * \brief Seeds the random generators, switches the game to deterministic mode
+		 *        and starts a new game with the journal's parameters.
+		 * \param Reference to the game object.
+		 */
+		void start_(Game&);
+
+		/**
+		 * \brief Issues the recorded commands of the current step.
+		 * \param Reference to the game object.
+		 */
+		void replay_commands_(Game&);
+
+		/**
+		 * \brief Issues a recorded command.
+		 * \param Reference to the game object.
+		 * \param The command.
+		 */
+		void replay_command_(Game&, const Entry&);
+
+		/**
+		 * \brief Prints the statistics of a finished replay into the console and
+		 *        returns to the normal mode.
+		 * \param Reference to the game object.
+		 */
+		void finish_replay_(Game&);
+
+		/**
+		 * Parameters of the journal's game.
+		 */
+		tdt::uint seed_;
+		tdt::uint width_;
+		tdt::uint height_;
+		std::string wave_table_;
+		tdt::real step_;
+
+		/**
+		 * True if the journal was recorded in the headless mode, which tests
+		 * line of sight on the grid instead of ray casting against meshes
+		 * (see CombatSystem::in_sight), so it can only be replayed in the same mode.
+		 */
+		bool headless_;
+
+		/**
+		 * Recorded commands (ordered by tick), index of the next replayed command,
+		 * number of steps of the whole journal and the state hash at it's end.
+		 */
+		std::vector<Entry> entries_;
+		tdt::uint next_entry_;
+		tdt::uint length_;
+		tdt::uint end_hash_;
+
+		/**
+		 * Current mode.
+		 */
+		bool recording_;
+		bool replaying_;
+		bool fast_;
+
+		/**
+		 * Number of simulated steps, time not simulated yet and the number
+		 * of active scopes.
+		 */
+		tdt::uint tick_;
+		tdt::real accumulator_;
+		tdt::uint depth_;
+
+		/**
+		 * Replay statistics (wall time of the simulation steps).
+		 */
+		std::chrono::high_resolution_clock::duration total_time_;
+		std::chrono::high_resolution_clock::duration max_time_;
+};
@@ -0,0 +1,91 @@
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdint>
+#endif
+#include "MappedFile.hpp"
+
+MappedFile::MappedFile(const std::string& fname)
+	: file_{nullptr}, mapping_{nullptr}, data_{nullptr}, size_{0}, open_{false}
+{
+#ifdef WIN32
+	HANDLE file = CreateFileA(fname.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+							  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+		return;
+	file_ = file;
+
+	LARGE_INTEGER size{};
+	if(!GetFileSizeEx(file, &size))
+		return;
+	size_ = (tdt::uint)size.QuadPart;
+
+	if(size_ > 0)
+	{ // Empty files cannot be mapped.
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(!mapping)
+			return;
+		mapping_ = mapping;
+
+		data_ = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if(!data_)
+			return;
+	}
+	open_ = true;
+#else
+	int fd = open(fname.c_str(), O_RDONLY);
+	if(fd < 0)
+		return;
+	file_ = (void*)(std::intptr_t)(fd + 1); // So that descriptor 0 is not nullptr.
+
+	struct stat info{};
+	if(fstat(fd, &info) != 0)
+		return;
+	size_ = (tdt::uint)info.st_size;
+
+	if(size_ > 0)
+	{ // Empty files cannot be mapped.
+		void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(data == MAP_FAILED)
+			return;
+		data_ = (const char*)data;
+	}
+	open_ = true;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef WIN32
+	if(data_)
+		UnmapViewOfFile(data_);
+	if(mapping_)
+		CloseHandle((HANDLE)mapping_);
+	if(file_)
+		CloseHandle((HANDLE)file_);
+#else
+	if(data_)
+		munmap((void*)data_, size_);
+	if(file_)
+		close((int)(std::intptr_t)file_ - 1);
+#endif
+}
+
+bool MappedFile::is_open() const
+{
+	return open_;
+}
+
+const char* MappedFile::data() const
+{
+	return data_;
+}
+
+tdt::uint MappedFile::size() const
+{
+	return size_;
+}
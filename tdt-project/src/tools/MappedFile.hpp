@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <Typedefs.hpp>
+
+/**
+ * Read-only view of a file mapped into memory, used to read large save files
+ * in place instead of copying them into a buffer first.
+ */
+class MappedFile
+{
+	public:
+		/**
+		 * \brief Constructor, maps a given file (check is_open for the result).
+		 * \param Name of the file.
+		 */
+		MappedFile(const std::string&);
+
+		/**
+		 * \brief Destructor, unmaps the file.
+		 */
+		~MappedFile();
+
+		/**
+		 * \brief Returns true if the file was mapped, false otherwise.
+		 */
+		bool is_open() const;
+
+		/**
+		 * \brief Returns a pointer to the contents of the file (nullptr
+		 *        if the file is empty or was not mapped).
+		 */
+		const char* data() const;
+
+		/**
+		 * \brief Returns the size of the file in bytes.
+		 */
+		tdt::uint size() const;
+
+		/**
+		 * Since the mapping is owned by this object, all copy/move operations
+		 * are disabled for this class.
+		 */
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&&) = delete;
+		MappedFile& operator=(MappedFile&&) = delete;
+
+	private:
+		/**
+		 * Handles of the file and the mapping (the file descriptor on
+		 * POSIX systems is stored in file_ as well).
+		 */
+		void* file_;
+		void* mapping_;
+
+		/**
+		 * Mapped contents of the file.
+		 */
+		const char* data_;
+		tdt::uint size_;
+
+		/**
+		 * True if the file was mapped.
+		 */
+		bool open_;
+};
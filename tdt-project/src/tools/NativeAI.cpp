@@ -0,0 +1,156 @@
+#include <systems/EntitySystem.hpp>
+#include <helpers/Helpers.hpp>
+#include <Components.hpp>
+#include <Enums.hpp>
+#include <lppscript/LppScript.hpp>
+#include "PathfindingAlgorithms.hpp"
+#include "Pathfinding.hpp"
+#include <systems/CombatSystem.hpp>
+#include "NativeAI.hpp"
+
+namespace
+{
+	/**
+	 * \brief Pushes the update function of a given blueprint (nil if there is none) onto the stack,
+	 *        the blueprints with native behaviours are global tables.
+	 * \param The Lua state.
+	 * \param Name of the blueprint.
+	 */
+	void push_update(lpp::Script::state L, const Symbol& blueprint)
+	{
+		lua_getglobal(L, blueprint.str().c_str());
+		if(lua_istable(L, -1))
+			lua_getfield(L, -1, "update");
+		else
+			lua_pushnil(L);
+		lua_remove(L, -2);
+	}
+
+	/**
+	 * \brief Orders an entity to go and kill a given target.
+	 * \param Game data.
+	 * \param ID of the entity.
+	 * \param ID of the target.
+	 */
+	void attack(NativeAI::Context& context, tdt::uint id, tdt::uint target)
+	{
+		auto task = TaskHelper::create_task(context.entities, target, TASK_TYPE::GO_KILL);
+		TaskHelper::add_task(context.entities, id, task);
+	}
+
+	/**
+	 * \brief Native smart_friendly_combat_unit_ai and smart_enemy_combat_unit_ai (see
+	 *        scripts/blueprints/ai.lua), attacks the closest enemy (prefers enemies in sight)
+	 *        and the enemy version attacks the dungeon throne if there are none.
+	 */
+	template<bool ATTACK_THRONE>
+	void smart_combat_unit(NativeAI::Context& context, const std::vector<tdt::uint>& ids)
+	{
+		for(auto id : ids)
+		{
+			auto enemy = context.combat.get_closest_entity(id, true);
+			if(enemy == Component::NO_ENTITY)
+				enemy = context.combat.get_closest_entity(id, false);
+			if(enemy == Component::NO_ENTITY && ATTACK_THRONE)
+				enemy = context.throne;
+
+			if(enemy != Component::NO_ENTITY)
+				attack(context, id, enemy);
+		}
+	}
+
+	/**
+	 * \brief Native dumb_friendly_combat_unit_ai and dumb_enemy_combat_unit_ai (see
+	 *        scripts/blueprints/ai.lua), attacks the closest enemy in sight and the enemy
+	 *        version attacks the dungeon throne if there is none.
+	 */
+	template<bool ATTACK_THRONE>
+	void dumb_combat_unit(NativeAI::Context& context, const std::vector<tdt::uint>& ids)
+	{
+		for(auto id : ids)
+		{
+			auto enemy = context.combat.get_closest_entity(id, true);
+			if(enemy != Component::NO_ENTITY && !context.combat.in_sight(id, enemy))
+				enemy = Component::NO_ENTITY;
+			if(enemy == Component::NO_ENTITY && ATTACK_THRONE)
+				enemy = context.throne;
+
+			if(enemy != Component::NO_ENTITY)
+				attack(context, id, enemy);
+		}
+	}
+}
+
+NativeAI& NativeAI::instance()
+{
+	static NativeAI inst{};
+
+	return inst;
+}
+
+void NativeAI::register_behaviour(const Symbol& blueprint, Behaviour behaviour)
+{
+	if(behaviour)
+		behaviours_[blueprint] = behaviour;
+	else
+		behaviours_.erase(blueprint);
+}
+
+NativeAI::Behaviour NativeAI::get_behaviour(const Symbol& blueprint) const
+{
+	if(!enabled_)
+		return nullptr;
+
+	auto it = behaviours_.find(blueprint);
+	if(it != behaviours_.end())
+		return it->second;
+	else
+		return nullptr;
+}
+
+void NativeAI::set_enabled(bool on_off)
+{
+	enabled_ = on_off;
+}
+
+bool NativeAI::is_enabled() const
+{
+	return enabled_;
+}
+
+void NativeAI::pin_update(const Symbol& blueprint)
+{
+	auto L = lpp::Script::instance().get_state();
+
+	auto it = updates_.find(blueprint);
+	if(it != updates_.end())
+		luaL_unref(L, LUA_REGISTRYINDEX, it->second);
+
+	push_update(L, blueprint);
+	updates_[blueprint] = luaL_ref(L, LUA_REGISTRYINDEX); // Pops the function.
+}
+
+bool NativeAI::is_pinned_update(const Symbol& blueprint) const
+{
+	auto it = updates_.find(blueprint);
+	if(it == updates_.end())
+		return false;
+
+	auto L = lpp::Script::instance().get_state();
+
+	push_update(L, blueprint);
+	lua_rawgeti(L, LUA_REGISTRYINDEX, it->second);
+	bool res = lua_rawequal(L, -1, -2) != 0;
+	lua_pop(L, 2);
+
+	return res;
+}
+
+NativeAI::NativeAI()
+	: behaviours_{}, updates_{}, enabled_{true}
+{
+	register_behaviour("smart_friendly_combat_unit_ai", &smart_combat_unit<false>);
+	register_behaviour("dumb_friendly_combat_unit_ai", &dumb_combat_unit<false>);
+	register_behaviour("smart_enemy_combat_unit_ai", &smart_combat_unit<true>);
+	register_behaviour("dumb_enemy_combat_unit_ai", &dumb_combat_unit<true>);
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <Typedefs.hpp>
+#include "Symbol.hpp"
+class EntitySystem;
+class CombatSystem;
+
+/**
+ * Registry of AI behaviours implemented in C++, addressed by the name of the AI blueprint
+ * they replace. AISystem runs a registered behaviour for runs of entities (consecutive in ID order)
+ * with the blueprint instead of calling the blueprint's Lua update function for each of them.
+ * A blueprint is only run natively if it's Lua table sets native = true and it's update
+ * function is still the one pinned when the stock blueprint was loaded, so mods that redefine
+ * a stock blueprint or just reassign it's update function keep running in Lua unchanged.
+ */
+class NativeAI
+{
+	public:
+		/**
+		 * Game data available to the behaviours.
+		 */
+		struct Context
+		{
+			EntitySystem& entities;
+			CombatSystem& combat;
+			tdt::uint throne;
+		};
+
+		/**
+		 * Behaviour updating the AI of given entities (which are not busy with tasks).
+		 */
+		using Behaviour = void (*)(Context&, const std::vector<tdt::uint>&);
+
+		/**
+		 * \brief Returns a reference to the static instance of this class.
+		 */
+		static NativeAI& instance();
+
+		/**
+		 * \brief Registers a behaviour (replacing the previous one of the blueprint, if any).
+		 * \param Name of the blueprint the behaviour replaces.
+		 * \param The behaviour, nullptr removes the registered one.
+		 */
+		void register_behaviour(const Symbol&, Behaviour);
+
+		/**
+		 * \brief Returns the behaviour registered for a given blueprint, nullptr
+		 *        if there is none or native behaviours are disabled.
+		 * \param Name of the blueprint.
+		 */
+		Behaviour get_behaviour(const Symbol&) const;
+
+		/**
+		 * \brief Remembers the current update function of a given blueprint (in the Lua
+		 *        registry) as the one it's native behaviour replaces.
+		 * \param Name of the blueprint.
+		 */
+		void pin_update(const Symbol&);
+
+		/**
+		 * \brief Returns true if the update function of a given blueprint is still the
+		 *        pinned one (i.e. it was not replaced by a mod), false otherwise.
+		 * \param Name of the blueprint.
+		 */
+		bool is_pinned_update(const Symbol&) const;
+
+		/**
+		 * \brief Enables or disables all native behaviours (disabled behaviours fall
+		 *        back to Lua, used to compare the two).
+		 * \param True to enable, false to disable.
+		 */
+		void set_enabled(bool);
+
+		/**
+		 * \brief Returns true if native behaviours are enabled, false otherwise.
+		 */
+		bool is_enabled() const;
+
+		/**
+		 * Since there should be only one registry at all times, all copy/move
+		 * operations are disabled for this class.
+		 */
+		NativeAI(const NativeAI&) = delete;
+		NativeAI& operator=(const NativeAI&) = delete;
+		NativeAI(NativeAI&&) = delete;
+		NativeAI& operator=(NativeAI&&) = delete;
+
+	private:
+		/**
+		 * Constructor, registers the stock behaviours.
+		 * Kept private since there should be only one registry at all times.
+		 */
+		NativeAI();
+
+		/**
+		 * Destructor.
+		 */
+		~NativeAI() = default;
+
+		/**
+		 * Registered behaviours.
+		 */
+		std::map<Symbol, Behaviour> behaviours_;
+
+		/**
+		 * Lua registry references to the pinned update functions.
+		 */
+		std::map<Symbol, int> updates_;
+
+		/**
+		 * If false, get_behaviour returns nullptr for every blueprint.
+		 */
+		bool enabled_;
+};
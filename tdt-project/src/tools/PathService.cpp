@@ -0,0 +1,574 @@
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <systems/EntitySystem.hpp>
+#include <helpers/Helpers.hpp>
+#include <lppscript/LppScript.hpp>
+#include "PathService.hpp"
+#include "Pathfinding.hpp"
+#include "PathfindingAlgorithms.hpp"
+#include "Profiler.hpp"
+#include "Grid.hpp"
+
+constexpr tdt::uint PathService::NO_NODE;
+
+PathService& PathService::instance()
+{
+	static PathService inst{};
+
+	return inst;
+}
+
+tdt::uint PathService::request(EntitySystem& ents, tdt::uint id, tdt::uint target, PATH_HEURISTIC heuristic,
+							   bool allow_destruction, bool go_near)
+{
+	auto path_comp = ents.get_component<PathfindingComponent>(id);
+	if(!path_comp || !ents.has_component<PhysicsComponent>(id)
+	   || !ents.has_component<PhysicsComponent>(target))
+		return 0;
+
+	if(!prepare_snapshot_(ents, path_comp->blueprint))
+		return 0;
+
+	auto pos_start = PhysicsHelper::get_position(ents, id);
+	auto pos_end = PhysicsHelper::get_position(ents, target);
+
+	Job job{};
+	job.ticket = next_ticket_++;
+	if(next_ticket_ == 0) // 0 means failure.
+		next_ticket_ = 1;
+	job.entity = id;
+	job.target = target;
+	job.start = Grid::instance().get_node_from_position(pos_start.x, pos_start.z);
+	job.end = Grid::instance().get_node_from_position(pos_end.x, pos_end.z);
+	job.heuristic = heuristic;
+	job.allow_destruction = allow_destruction;
+	job.go_near = go_near;
+	job.blueprint = path_comp->blueprint;
+	job.per_entity = !cacheable_(job.blueprint);
+	job.snapshot = snapshot_;
+
+	auto ticket = job.ticket;
+	pending_[id] = ticket;
+	solve_(ents, std::move(job));
+
+	return ticket;
+}
+
+bool PathService::pending(tdt::uint id) const
+{
+	return pending_.find(id) != pending_.end();
+}
+
+void PathService::cancel(tdt::uint id)
+{
+	// The job itself might be already solved, it will get dropped in update.
+	pending_.erase(id);
+}
+
+void PathService::update(EntitySystem& ents)
+{
+	std::vector<Job> finished{};
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		finished.swap(finished_);
+	}
+
+	for(auto& job : finished)
+	{
+		auto it = pending_.find(job.entity);
+		if(it == pending_.end() || it->second != job.ticket)
+			continue; // Cancelled or superseded by a newer request.
+
+		if(job.snapshot->version != version_ && !still_valid_(ents, job))
+		{ // The grid changed along the path, solve it again.
+			if(prepare_snapshot_(ents, job.blueprint))
+			{
+				job.snapshot = snapshot_;
+				job.path.clear();
+				solve_(ents, std::move(job));
+			}
+			else
+				pending_.erase(it);
+			continue;
+		}
+		pending_.erase(it);
+
+		if(util::assign_path(ents, job.entity, job.target, job.start, job.end, job.path, job.allow_destruction))
+		{
+			if(job.go_near)
+			{
+				auto& path = PathfindingHelper::get_path(ents, job.entity);
+				if(!path.empty())
+					path.pop_back();
+			}
+		}
+		else
+		{ // If a block destruction was ordered, the new tasks have to be handled.
+			auto handler = ents.get_component<TaskHandlerComponent>(job.entity);
+			if(handler && handler->curr_task == Component::NO_ENTITY)
+				handler->busy = false;
+		}
+	}
+}
+
+void PathService::invalidate(EntitySystem& ents, const std::set<tdt::uint>& nodes)
+{
+	if(nodes.empty() && dirty_.empty())
+		return;
+
+	if(!nodes.empty()) // Cost changes alone do not affect solved paths.
+		++version_;
+	if(!snapshot_)
+	{ // Will be created with the next request.
+		dirty_.clear();
+		return;
+	}
+
+	// Copy on write, jobs that are being solved keep the old snapshot.
+	auto snap = std::make_shared<Snapshot>(*snapshot_);
+	snap->version = version_;
+
+	std::vector<tdt::uint> changed{};
+	for(auto node : nodes)
+	{
+		auto it = snap->indices.find(node);
+		if(it != snap->indices.end())
+		{
+			update_node_(ents, *snap, it->second);
+			changed.push_back(it->second);
+		}
+	}
+	if(!nodes.empty())
+		update_portals_(ents, *snap);
+
+	for(auto node : dirty_)
+	{
+		auto it = snap->indices.find(node);
+		if(it != snap->indices.end() && nodes.find(node) == nodes.end())
+			changed.push_back(it->second);
+	}
+	dirty_.clear();
+
+	for(auto& blueprint : snap->costs)
+	{
+		auto costs = std::make_shared<Costs>(*blueprint.second);
+		update_costs_(*costs, blueprint.first, *snap, changed);
+		blueprint.second = costs;
+	}
+
+	snapshot_ = snap;
+}
+
+void PathService::invalidate_costs(EntitySystem& ents, tdt::uint id)
+{
+	if(!snapshot_ || snapshot_->costs.empty())
+		return; // Nothing is cached.
+
+	auto comp = ents.get_component<StructureComponent>(id);
+	if(comp)
+		dirty_.insert(comp->residences.begin(), comp->residences.end());
+}
+
+void PathService::reset()
+{
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		jobs_.clear();
+		finished_.clear();
+	}
+	pending_.clear();
+	snapshot_.reset();
+	dirty_.clear();
+	++version_;
+}
+
+void PathService::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		stop_ = true;
+		jobs_.clear();
+		finished_.clear();
+	}
+	job_available_.notify_all();
+
+	for(auto& worker : workers_)
+	{
+		if(worker.joinable())
+			worker.join();
+	}
+	workers_.clear();
+	pending_.clear();
+}
+
+tdt::uint PathService::get_version() const
+{
+	return version_;
+}
+
+void PathService::set_synchronous(bool on_off)
+{
+	synchronous_ = on_off;
+}
+
+PathService::PathService()
+	: workers_{}, mutex_{}, job_available_{}, jobs_{}, finished_{},
+	  stop_{false}, snapshot_{}, dirty_{}, pending_{}, next_ticket_{1}, version_{0},
+	  synchronous_{false}
+{
+	// Leave one core to the main thread.
+	tdt::uint count = std::thread::hardware_concurrency();
+	count = count > 2 ? std::min(count - 1, (tdt::uint)4) : 1;
+
+	for(tdt::uint i = 0; i < count; ++i)
+		workers_.emplace_back(&PathService::work_, this);
+}
+
+PathService::~PathService()
+{
+	shutdown();
+}
+
+void PathService::work_()
+{
+	while(true)
+	{
+		Job job{};
+		{
+			std::unique_lock<std::mutex> lock{mutex_};
+			job_available_.wait(lock, [this]() -> bool { return stop_ || !jobs_.empty(); });
+			if(stop_)
+				return;
+
+			job = std::move(jobs_.front());
+			jobs_.pop_front();
+		}
+
+		job.path = find_path_(job);
+
+		std::lock_guard<std::mutex> lock{mutex_};
+		finished_.emplace_back(std::move(job));
+	}
+}
+
+void PathService::submit_(Job&& job)
+{
+	if(workers_.empty() || synchronous_)
+	{ // Shut down or synchronous, solve it right away.
+		job.path = find_path_(job);
+		std::lock_guard<std::mutex> lock{mutex_};
+		finished_.emplace_back(std::move(job));
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		jobs_.emplace_back(std::move(job));
+	}
+	job_available_.notify_one();
+}
+
+void PathService::solve_(EntitySystem& ents, Job&& job)
+{
+	if(job.per_entity)
+	{ // The blueprint functions need the real entity, which only the main thread can call.
+		job.path = find_path_(ents, job);
+		std::lock_guard<std::mutex> lock{mutex_};
+		finished_.emplace_back(std::move(job));
+	}
+	else
+		submit_(std::move(job));
+}
+
+bool PathService::cacheable_(const Symbol& blueprint) const
+{
+	auto& workers = lpp::Script::instance().get_worker_pool();
+
+	return workers.is_pure(blueprint, "get_cost") && workers.is_pure(blueprint, "can_break");
+}
+
+bool PathService::prepare_snapshot_(EntitySystem& ents, const Symbol& blueprint)
+{
+	if(!snapshot_)
+		create_snapshot_(ents);
+
+	if(snapshot_->nodes.empty())
+		return false;
+
+	if(cacheable_(blueprint) && snapshot_->costs.find(blueprint) == snapshot_->costs.end())
+	{
+		auto costs = std::make_shared<Costs>();
+		costs->cost.resize(snapshot_->nodes.size());
+		costs->breakable.resize(snapshot_->nodes.size());
+		std::vector<tdt::uint> indices(snapshot_->nodes.size());
+		std::iota(indices.begin(), indices.end(), tdt::uint{});
+		update_costs_(*costs, blueprint, *snapshot_, indices);
+
+		auto snap = std::make_shared<Snapshot>(*snapshot_);
+		snap->costs.emplace(blueprint, costs);
+		snapshot_ = snap;
+	}
+
+	return true;
+}
+
+void PathService::create_snapshot_(EntitySystem& ents)
+{
+	auto snap = std::make_shared<Snapshot>();
+	snap->version = version_;
+
+	for(const auto& node : ents.get_component_container<GridNodeComponent>())
+	{
+		snap->indices.emplace(node.first, snap->ids.size());
+		snap->ids.push_back(node.first);
+	}
+
+	snap->nodes.resize(snap->ids.size());
+	for(tdt::uint i = 0; i < snap->nodes.size(); ++i)
+		update_node_(ents, *snap, i);
+	update_portals_(ents, *snap);
+
+	snapshot_ = snap;
+}
+
+void PathService::update_node_(EntitySystem& ents, Snapshot& snap, tdt::uint idx)
+{
+	auto& node = snap.nodes[idx];
+	auto comp = ents.get_component<GridNodeComponent>(snap.ids[idx]);
+	if(!comp)
+	{ // Removed node, make it unreachable.
+		node.neighbours.fill(NO_NODE);
+		node.free = false;
+		node.walk_through = false;
+		return;
+	}
+
+	for(tdt::uint i = 0; i < node.neighbours.size(); ++i)
+	{
+		auto it = snap.indices.find(comp->neighbours[i]);
+		node.neighbours[i] = it != snap.indices.end() ? it->second : NO_NODE;
+	}
+	node.x = comp->x;
+	node.y = comp->y;
+	node.free = comp->free;
+	node.walk_through = !comp->free && StructureHelper::is_walk_through(ents, comp->resident);
+}
+
+void PathService::update_portals_(EntitySystem& ents, Snapshot& snap)
+{
+	snap.portals.clear();
+	auto& grid = Grid::instance();
+	for(const auto& portal : ents.get_component_container<PortalComponent>())
+	{
+		auto linked = TriggerHelper::get_linked_entity(ents, portal.first);
+		if(linked == Component::NO_ENTITY)
+			continue;
+
+		auto pos = PhysicsHelper::get_2d_position(ents, portal.first);
+		auto node1 = snap.indices.find(grid.get_node_from_position(pos.x, pos.y));
+		pos = PhysicsHelper::get_2d_position(ents, linked);
+		auto node2 = snap.indices.find(grid.get_node_from_position(pos.x, pos.y));
+
+		if(node1 != snap.indices.end() && node2 != snap.indices.end())
+			snap.portals.emplace_back(node1->second, node2->second);
+	}
+}
+
+void PathService::update_costs_(Costs& costs, const Symbol& blueprint, const Snapshot& snap,
+								const std::vector<tdt::uint>& indices)
+{
+	static const auto get_cost_fn = Symbol::get_function_id("get_cost");
+	static const auto can_break_fn = Symbol::get_function_id("can_break");
+	auto& script = lpp::Script::instance();
+	auto& workers = script.get_worker_pool();
+	std::vector<tdt::uint> ids{};
+	std::vector<tdt::real> results{};
+
+	ids.reserve(indices.size());
+	for(auto idx : indices)
+		ids.push_back(snap.ids[idx]);
+
+	if(workers.evaluate(blueprint, "get_cost", Component::NO_ENTITY, ids, results))
+	{
+		for(tdt::uint i = 0; i < indices.size(); ++i)
+			costs.cost[indices[i]] = results[i] <= 0.f ? 1.f : results[i];
+	}
+	else
+	{
+		for(auto idx : indices)
+		{
+			auto cost = script.call<tdt::real, tdt::uint, tdt::uint>(blueprint.get_function(get_cost_fn), Component::NO_ENTITY, snap.ids[idx]);
+			costs.cost[idx] = cost <= 0.f ? 1.f : cost;
+		}
+	}
+
+	// Only blocked nodes are ever tested.
+	std::vector<tdt::uint> blocked{};
+	ids.clear();
+	for(auto idx : indices)
+	{
+		costs.breakable[idx] = false;
+		if(!snap.nodes[idx].free)
+		{
+			blocked.push_back(idx);
+			ids.push_back(snap.ids[idx]);
+		}
+	}
+
+	if(workers.evaluate(blueprint, "can_break", Component::NO_ENTITY, ids, results))
+	{
+		for(tdt::uint i = 0; i < blocked.size(); ++i)
+			costs.breakable[blocked[i]] = results[i] != 0.f;
+	}
+	else
+	{
+		for(auto idx : blocked)
+			costs.breakable[idx] = script.call<bool, tdt::uint, tdt::uint>(blueprint.get_function(can_break_fn), Component::NO_ENTITY, snap.ids[idx]);
+	}
+}
+
+bool PathService::still_valid_(EntitySystem& ents, const Job& job) const
+{
+	for(auto node : job.path)
+	{
+		auto it = job.snapshot->indices.find(node);
+		if(it == job.snapshot->indices.end()
+		   || job.snapshot->nodes[it->second].free != GridNodeHelper::is_free(ents, node))
+			return false;
+	}
+	return true;
+}
+
+std::deque<tdt::uint> PathService::find_path_(const Job& job)
+{
+	PROFILE_ZONE("PathService::find_path");
+	const auto& snap = *job.snapshot;
+	auto costs_it = snap.costs.find(job.blueprint);
+	auto start_it = snap.indices.find(job.start);
+	auto end_it = snap.indices.find(job.end);
+	if(costs_it == snap.costs.end() || start_it == snap.indices.end() || end_it == snap.indices.end())
+		return std::deque<tdt::uint>{};
+
+	const auto& costs = *costs_it->second;
+	const auto& nodes = snap.nodes;
+	tdt::uint start = start_it->second;
+	tdt::uint end = end_it->second;
+
+	auto manhattan = [&nodes](tdt::uint a, tdt::uint b) -> tdt::real {
+		return (tdt::real)(std::abs((int)nodes[a].x - (int)nodes[b].x) + std::abs((int)nodes[a].y - (int)nodes[b].y));
+	};
+	auto heuristic = [&](tdt::uint idx) -> tdt::real {
+		switch(job.heuristic)
+		{
+			case PATH_HEURISTIC::MANHATTAN:
+				return manhattan(idx, end);
+			case PATH_HEURISTIC::PORTAL:
+			{ // Same as util::heuristic::PORTAL_HEURISTIC, but uses grid coordinates.
+				auto direct = manhattan(idx, end);
+				if(snap.portals.empty())
+					return direct;
+
+				tdt::real closest_dist{std::numeric_limits<tdt::real>::max()};
+				const std::pair<tdt::uint, tdt::uint>* closest{nullptr};
+				for(const auto& portal : snap.portals)
+				{
+					tdt::real dx = (tdt::real)nodes[idx].x - (tdt::real)nodes[portal.first].x;
+					tdt::real dy = (tdt::real)nodes[idx].y - (tdt::real)nodes[portal.first].y;
+					if(dx * dx + dy * dy < closest_dist)
+					{
+						closest_dist = dx * dx + dy * dy;
+						closest = &portal;
+					}
+				}
+				return std::min(direct, manhattan(idx, closest->first) + manhattan(closest->second, end));
+			}
+			default:
+				return 0.f;
+		}
+	};
+
+	std::vector<tdt::real> score(nodes.size(), std::numeric_limits<tdt::real>::max());
+	std::vector<tdt::uint> came_from(nodes.size(), NO_NODE);
+	std::vector<char> closed(nodes.size(), 0);
+
+	using entry = std::pair<tdt::real, tdt::uint>;
+	std::priority_queue<entry, std::vector<entry>, std::greater<entry>> open{};
+	score[start] = 0.f;
+	open.emplace(heuristic(start), start);
+
+	bool found_path{false};
+	while(!open.empty())
+	{
+		auto current = open.top().second;
+		open.pop();
+		if(closed[current])
+			continue; // Outdated entry.
+
+		if(current == end)
+		{
+			found_path = true;
+			break;
+		}
+		closed[current] = 1;
+
+		const auto& neighbours = nodes[current].neighbours;
+		for(tdt::uint i = 0; i < neighbours.size(); ++i)
+		{
+			auto neighbour = neighbours[i];
+			if(neighbour == NO_NODE || closed[neighbour])
+				continue;
+
+			const auto& next = nodes[neighbour];
+			bool cannot_pass = !next.free && (!job.allow_destruction || !costs.breakable[neighbour])
+							   && !next.walk_through;
+			if(cannot_pass)
+				continue;
+
+			tdt::real cost = costs.cost[current];
+			if(i == DIRECTION::UP_LEFT || i == DIRECTION::UP_RIGHT || i == DIRECTION::DOWN_LEFT || i == DIRECTION::DOWN_RIGHT)
+				cost *= 1.41421356237f; // Same diagonal multiplier as in PathfindingHelper::get_cost.
+
+			auto new_score = score[current] + cost;
+			if(new_score < score[neighbour])
+			{
+				score[neighbour] = new_score;
+				came_from[neighbour] = current;
+				open.emplace(new_score + heuristic(neighbour), neighbour);
+			}
+		}
+	}
+
+	std::deque<tdt::uint> path{};
+	if(found_path)
+	{
+		for(auto current = end; current != NO_NODE; current = came_from[current])
+			path.push_front(snap.ids[current]);
+	}
+
+	return path;
+}
+
+std::deque<tdt::uint> PathService::find_path_(EntitySystem& ents, const Job& job)
+{
+	PROFILE_ZONE("PathService::find_path");
+	std::unique_ptr<util::heuristic::HEURISTIC> heuristic{};
+	switch(job.heuristic)
+	{
+		case PATH_HEURISTIC::MANHATTAN:
+			heuristic.reset(new util::heuristic::MANHATTAN_DISTANCE{ents});
+			break;
+		case PATH_HEURISTIC::PORTAL:
+			heuristic.reset(new util::heuristic::PORTAL_HEURISTIC{ents});
+			break;
+		default:
+			heuristic.reset(new util::heuristic::NO_HEURISTIC{ents});
+			break;
+	}
+
+	return util::DEFAULT_PATHFINDING_ALGORITHM::get_path(ents, job.entity, job.start, job.end,
+														  *heuristic, job.allow_destruction);
+}
@@ -0,0 +1,324 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <Components.hpp>
+#include <Enums.hpp>
+#include <Typedefs.hpp>
+class EntitySystem;
+
+/**
+ * Asynchronous pathfinding service. Path requests are solved by worker threads
+ * against an immutable snapshot of the pathfinding grid and the results are
+ * applied to the entities on the main thread in PathService::update.
+ * Since Lua cannot be called from the worker threads, the get_cost and can_break
+ * values of blueprints that declare both functions as pure (their results depend
+ * only on the node, so they get Component::NO_ENTITY as the first argument) are
+ * evaluated on the main thread (or in parallel by the Lua worker states, see
+ * lpp::WorkerPool) and cached per blueprint until the affected nodes or the health
+ * of their residents change. Paths of entities with other blueprints are solved
+ * on the main thread with the real entity ID, like util::pathfind does.
+ */
+class PathService
+{
+	public:
+		/**
+		 * \brief Returns a reference to the static instance of this class.
+		 */
+		static PathService& instance();
+
+		/**
+		 * \brief Submits a path request, returns its ticket (non zero) if the request
+		 *        was submitted, 0 otherwise. Any previous request of the entity is
+		 *        superseded.
+		 * \param Entity system containing the entity and the pathfinding grid.
+		 * \param ID of the pathfinding entity.
+		 * \param Target of the pathfinding.
+		 * \param Heuristic used by the pathfinding algorithm.
+		 * \param If true, the entity will be allowed to destroy blocks on it's way.
+		 * \param If true, the last node of the path will be removed (used to go near
+		 *        the target instead of on it).
+		 */
+		tdt::uint request(EntitySystem&, tdt::uint, tdt::uint, PATH_HEURISTIC = PATH_HEURISTIC::PORTAL,
+						  bool = true, bool = false);
+
+		/**
+		 * \brief Returns true if a given entity has a path request that has not
+		 *        been applied yet, false otherwise.
+		 * \param ID of the entity.
+		 */
+		bool pending(tdt::uint) const;
+
+		/**
+		 * \brief Cancels the pending request of a given entity (if any).
+		 * \param ID of the entity.
+		 */
+		void cancel(tdt::uint);
+
+		/**
+		 * \brief Applies the finished requests, this is the synchronization point
+		 *        between the worker threads and the rest of the game.
+		 * \param Entity system containing the entities and the pathfinding grid.
+		 */
+		void update(EntitySystem&);
+
+		/**
+		 * \brief Creates a new version of the grid snapshot with the given nodes updated.
+		 * \param Entity system containing the pathfinding grid.
+		 * \param IDs of the nodes that were changed (freed, unfreed etc.).
+		 */
+		void invalidate(EntitySystem&, const std::set<tdt::uint>&);
+
+		/**
+		 * \brief Marks the cached costs of the nodes a given structure resides on
+		 *        as outdated, they are refreshed in the next PathService::invalidate call.
+		 * \param Entity system containing the structure.
+		 * \param ID of the structure (e.g. one whose health changed).
+		 */
+		void invalidate_costs(EntitySystem&, tdt::uint);
+
+		/**
+		 * \brief Drops the grid snapshot and all pending requests, used when
+		 *        a new grid is created.
+		 */
+		void reset();
+
+		/**
+		 * \brief Stops and joins the worker threads, pending requests are dropped.
+		 */
+		void shutdown();
+
+		/**
+		 * \brief Returns the current version of the grid snapshot.
+		 */
+		tdt::uint get_version() const;
+
+		/**
+		 * \brief If set to true, requests are solved right away on the main thread (still applied
+		 *        in PathService::update), so that paths arrive in the same frame every time
+		 *        (used in deterministic mode).
+		 * \param True to solve requests synchronously, false to use the worker threads.
+		 */
+		void set_synchronous(bool);
+
+		/**
+		 * Since there should be only one path service at all times, all copy/move
+		 * operations are disabled for this class.
+		 */
+		PathService(const PathService&) = delete;
+		PathService& operator=(const PathService&) = delete;
+		PathService(PathService&&) = delete;
+		PathService& operator=(PathService&&) = delete;
+
+	private:
+		/**
+		 * Constructor.
+		 * Kept private since there should be only one path service at all times.
+		 */
+		PathService();
+
+		/**
+		 * Destructor.
+		 */
+		~PathService();
+
+		/**
+		 * Marks missing node indices.
+		 */
+		static constexpr tdt::uint NO_NODE{Component::NO_ENTITY};
+
+		/**
+		 * Grid node data needed by the pathfinding.
+		 */
+		struct Node
+		{
+			std::array<tdt::uint, GridNodeComponent::neighbour_count> neighbours; // Indices, not IDs.
+			tdt::uint x, y;
+			bool free, walk_through;
+		};
+
+		/**
+		 * Cached results of a pathfinding blueprint's get_cost and can_break functions.
+		 */
+		struct Costs
+		{
+			std::vector<tdt::real> cost;
+			std::vector<char> breakable;
+		};
+
+		/**
+		 * Immutable copy of the pathfinding grid used by the worker threads.
+		 */
+		struct Snapshot
+		{
+			tdt::uint version;
+			std::vector<tdt::uint> ids;
+			std::map<tdt::uint, tdt::uint> indices;
+			std::vector<Node> nodes;
+			std::vector<std::pair<tdt::uint, tdt::uint>> portals;
+			std::map<Symbol, std::shared_ptr<const Costs>> costs;
+		};
+
+		/**
+		 * A single path request and its result.
+		 */
+		struct Job
+		{
+			tdt::uint ticket, entity, target, start, end;
+			PATH_HEURISTIC heuristic;
+			bool allow_destruction, go_near, per_entity;
+			Symbol blueprint;
+			std::shared_ptr<const Snapshot> snapshot;
+			std::deque<tdt::uint> path;
+		};
+
+		/**
+		 * \brief Main loop of the worker threads.
+		 */
+		void work_();
+
+		/**
+		 * \brief Adds a job to the job queue and wakes a worker.
+		 * \param The job.
+		 */
+		void submit_(Job&&);
+
+		/**
+		 * \brief Solves a job right away, on the worker threads if possible.
+		 * \param Entity system containing the pathfinding grid.
+		 * \param The job.
+		 */
+		void solve_(EntitySystem&, Job&&);
+
+		/**
+		 * \brief Returns true if the results of a blueprint's get_cost and can_break
+		 *        functions do not depend on the pathfinding entity and can be cached,
+		 *        false otherwise.
+		 * \param Name of the pathfinding blueprint.
+		 */
+		bool cacheable_(const Symbol&) const;
+
+		/**
+		 * \brief Makes sure that the snapshot exists and contains the costs of a given
+		 *        blueprint (if they can be cached), returns false if there is no grid to snapshot.
+		 * \param Entity system containing the pathfinding grid.
+		 * \param Name of the pathfinding blueprint.
+		 */
+		bool prepare_snapshot_(EntitySystem&, const Symbol&);
+
+		/**
+		 * \brief Creates a new snapshot of the entire grid.
+		 * \param Entity system containing the pathfinding grid.
+		 */
+		void create_snapshot_(EntitySystem&);
+
+		/**
+		 * \brief Updates the data of a single node in a given snapshot.
+		 * \param Entity system containing the pathfinding grid.
+		 * \param The snapshot.
+		 * \param Index of the node.
+		 */
+		void update_node_(EntitySystem&, Snapshot&, tdt::uint);
+
+		/**
+		 * \brief Updates the list of portal pairs (used by the portal heuristic) in a given snapshot.
+		 * \param Entity system containing the portals.
+		 * \param The snapshot.
+		 */
+		void update_portals_(EntitySystem&, Snapshot&);
+
+		/**
+		 * \brief Evaluates a blueprint's get_cost and can_break functions for given nodes.
+		 * \param Costs of the blueprint.
+		 * \param Name of the blueprint.
+		 * \param Snapshot containing the nodes.
+		 * \param Indices of the nodes.
+		 */
+		void update_costs_(Costs&, const Symbol&, const Snapshot&, const std::vector<tdt::uint>&);
+
+		/**
+		 * \brief Returns true if a finished job can still be applied even though
+		 *        it was solved against an older snapshot (none of its nodes changed
+		 *        their state), false otherwise.
+		 * \param Entity system containing the pathfinding grid.
+		 * \param The job.
+		 */
+		bool still_valid_(EntitySystem&, const Job&) const;
+
+		/**
+		 * \brief A* search on a grid snapshot, returns the path (node IDs) or
+		 *        an empty deque if no path exists.
+		 * \param The job to solve.
+		 */
+		static std::deque<tdt::uint> find_path_(const Job&);
+
+		/**
+		 * \brief A* search using the blueprint functions of the pathfinding entity directly,
+		 *        returns the path (node IDs) or an empty deque if no path exists.
+		 * \param Entity system containing the entity and the pathfinding grid.
+		 * \param The job to solve.
+		 * \note Calls Lua, so this has to run on the main thread.
+		 */
+		static std::deque<tdt::uint> find_path_(EntitySystem&, const Job&);
+
+		/**
+		 * Worker threads.
+		 */
+		std::vector<std::thread> workers_;
+
+		/**
+		 * Guards jobs_, finished_ and stop_ (everything else is accessed
+		 * only from the main thread).
+		 */
+		mutable std::mutex mutex_;
+		std::condition_variable job_available_;
+
+		/**
+		 * Jobs waiting for a worker and jobs waiting to be applied.
+		 */
+		std::deque<Job> jobs_;
+		std::vector<Job> finished_;
+
+		/**
+		 * If true, the workers will finish.
+		 */
+		bool stop_;
+
+		/**
+		 * Current snapshot of the grid (nullptr if it has to be created).
+		 */
+		std::shared_ptr<const Snapshot> snapshot_;
+
+		/**
+		 * Nodes whose cached costs are outdated.
+		 */
+		std::set<tdt::uint> dirty_;
+
+		/**
+		 * Latest ticket of every entity with a pending request.
+		 */
+		std::map<tdt::uint, tdt::uint> pending_;
+
+		/**
+		 * Ticket of the next request.
+		 */
+		tdt::uint next_ticket_;
+
+		/**
+		 * Version of the grid, increased on every change.
+		 */
+		tdt::uint version_;
+
+		/**
+		 * If true, the worker threads are not used.
+		 */
+		bool synchronous_;
+};
@@ -4,6 +4,7 @@
 #include <helpers/Helpers.hpp>
 #include <Typedefs.hpp>
 #include "PathfindingAlgorithms.hpp"
+#include "PathService.hpp"
 
 /**
  * Util namespace contains general tools and utilities used by the game's
@@ -12,33 +13,26 @@
 namespace util
 {
 	/**
-	 * \brief Finds a path using a given algorithm (specified as a template parameter)
-	 *        and heuristic and adds the path to the pathfinding entity if needed.
+	 * \brief Assigns a found path to a pathfinding entity. If the path leads through
+	 *        a blocked node and destruction is allowed, the entity is ordered to
+	 *        destroy the node's resident instead and the path is not assigned.
+	 *        Returns true if the path was assigned, false otherwise.
 	 * \param Entity system containing the entity and the pathfinding grid.
 	 * \param ID of the pathfinding entity.
 	 * \param Target of the pathfinding.
-	 * \param Heuristic used by the pathfinding algorithm.
-	 * \param If true, the path will be added to the pathdinding entity's pathfinding
-	 *        component.
+	 * \param ID of the starting node.
+	 * \param ID of the ending node.
+	 * \param The path (will be moved from).
 	 * \param If true, the entity will be allowed to destroy blocks on it's way.
 	 */
-	template<typename ALGORITHM = util::DEFAULT_PATHFINDING_ALGORITHM>
-	bool pathfind(EntitySystem& ents, tdt::uint id, tdt::uint target,
-				  util::heuristic::HEURISTIC& heuristic, bool add_path = true, bool allow_destruction = true)
+	inline bool assign_path(EntitySystem& ents, tdt::uint id, tdt::uint target, tdt::uint start,
+							tdt::uint end, std::deque<tdt::uint>& path, bool allow_destruction = true)
 	{
 		auto path_comp = ents.get_component<PathfindingComponent>(id);
-		if(!path_comp || !ents.has_component<PhysicsComponent>(id)
-		   || !ents.has_component<PhysicsComponent>(target))
+		if(!path_comp || path.empty())
 			return false;
 
-		auto pos_start = PhysicsHelper::get_position(ents, id);
-		auto pos_end = PhysicsHelper::get_position(ents, target);
-		tdt::uint start{Grid::instance().get_node_from_position(pos_start.x, pos_start.z)},
-			        end{Grid::instance().get_node_from_position(pos_end.x, pos_end.z)};
-
-		auto path = ALGORITHM::get_path(ents, id, start, end, heuristic, allow_destruction);
-		bool destruction{false};
-		if(allow_destruction && add_path && !path.empty())
+		if(allow_destruction)
 		{ // Finds the first blocked node and orders the entity to destroy it's resident.
 			for(auto node : path)
 			{
@@ -47,6 +41,7 @@ namespace util
 					auto resident = GridNodeHelper::get_resident(ents, node);
 					if(StructureHelper::is_walk_through(ents, resident))
 						continue;
+
 					if(resident != target)
 					{
 						auto comp = ents.get_component<TaskHandlerComponent>(id);
@@ -58,34 +53,60 @@ namespace util
 							TaskHelper::add_task(ents, id, task_kill, true);
 							TaskHelper::add_task(ents, id, task_get_in_range, true);
 							comp->curr_task = Component::NO_ENTITY;
-							destruction = true;
-							break;
 						}
-						else
-							return false;
+						return false;
 					}
 				}
 			}
 		}
 
-		if(!path.empty() && !destruction && add_path)
-		{
-			path_comp->path_queue.swap(path);
-			path_comp->last_id = start;
-			path_comp->target_id = end;
+		Grid::instance().remove_path_subscriber(id, path_comp->path_queue);
+		path_comp->path_queue.swap(path);
+		path_comp->last_id = start;
+		path_comp->target_id = end;
 
-			if(path_comp->path_queue.size() >= 3)
-				path_comp->path_queue.pop_front(); // This will stop the entity from returning when halfway to the second node.
+		if(path_comp->path_queue.size() >= 3)
+			path_comp->path_queue.pop_front(); // This will stop the entity from returning when halfway to the second node.
+		Grid::instance().add_path_subscriber(id, path_comp->path_queue);
 
-			// In case the entity moves backwards.
-			GraphicsHelper::look_at(ents, id, path_comp->path_queue.front());
-			AnimationHelper::play(ents, id, ANIMATION_TYPE::WALK, true);
-			return true;
-		}
+		// In case the entity moves backwards.
+		GraphicsHelper::look_at(ents, id, path_comp->path_queue.front());
+		AnimationHelper::play(ents, id, ANIMATION_TYPE::WALK, true);
+		return true;
+	}
 
+	/**
+	 * \brief Finds a path using a given algorithm (specified as a template parameter)
+	 *        and heuristic and adds the path to the pathfinding entity if needed.
+	 * \param Entity system containing the entity and the pathfinding grid.
+	 * \param ID of the pathfinding entity.
+	 * \param Target of the pathfinding.
+	 * \param Heuristic used by the pathfinding algorithm.
+	 * \param If true, the path will be added to the pathdinding entity's pathfinding
+	 *        component.
+	 * \param If true, the entity will be allowed to destroy blocks on it's way.
+	 * \note This runs on the calling thread, see PathService for asynchronous pathfinding.
+	 */
+	template<typename ALGORITHM = util::DEFAULT_PATHFINDING_ALGORITHM>
+	bool pathfind(EntitySystem& ents, tdt::uint id, tdt::uint target,
+				  util::heuristic::HEURISTIC& heuristic, bool add_path = true, bool allow_destruction = true)
+	{
+		auto path_comp = ents.get_component<PathfindingComponent>(id);
+		if(!path_comp || !ents.has_component<PhysicsComponent>(id)
+		   || !ents.has_component<PhysicsComponent>(target))
+			return false;
+
+		auto pos_start = PhysicsHelper::get_position(ents, id);
+		auto pos_end = PhysicsHelper::get_position(ents, target);
+		tdt::uint start{Grid::instance().get_node_from_position(pos_start.x, pos_start.z)},
+			        end{Grid::instance().get_node_from_position(pos_end.x, pos_end.z)};
+
+		auto path = ALGORITHM::get_path(ents, id, start, end, heuristic, allow_destruction);
 		if(!add_path)
 			return !path.empty();
-		else
-			return false;
+
+		// A synchronous path replaces any pending asynchronous one.
+		PathService::instance().cancel(id);
+		return assign_path(ents, id, target, start, end, path, allow_destruction);
 	}
 }
\ No newline at end of file
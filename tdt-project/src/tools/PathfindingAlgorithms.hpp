@@ -55,11 +55,8 @@ namespace pathfinding
 			std::map<tdt::uint, tdt::real> score;
 			std::map<tdt::uint, tdt::real> estimate;
 
-			for(auto& node : ents.get_component_container<GridNodeComponent>())
-			{ // Starting score and estimate is "infinity".
-				score.emplace(node.first, std::numeric_limits<tdt::real>::max());
-				estimate.emplace(node.first, std::numeric_limits<tdt::real>::max());
-			}
+			// Nodes missing from score and estimate are considered to have "infinite" values,
+			// so only the explored part of the grid is touched (short path repairs stay cheap).
 			score[start] = 0;
 			estimate[start] = heuristic.get_cost(start, end);
 
@@ -96,7 +93,8 @@ namespace pathfinding
 					auto new_score = score[current] + s;
 
 					// Either unvisited or we found a better path to it.
-					if(new_score < score[neighbour])
+					auto old_score = score.find(neighbour);
+					if(old_score == score.end() || new_score < old_score->second)
 					{
 						path_edges[neighbour] = current;
 						score[neighbour] = new_score;
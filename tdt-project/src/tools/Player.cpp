@@ -214,6 +214,16 @@ tdt::uint Player::get_mana_regen() const
 	return mana_regen_;
 }
 
+tdt::uint Player::get_curr_units() const
+{
+	return units_curr_;
+}
+
+tdt::uint Player::get_max_units() const
+{
+	return units_max_;
+}
+
 void Player::reset()
 {
 	gold_ = 1000;
@@ -123,6 +123,16 @@ class Player
 		 */
 		tdt::uint get_mana_regen() const;
 
+		/**
+		 * \brief Returns the amount of currently alive units.
+		 */
+		tdt::uint get_curr_units() const;
+
+		/**
+		 * \brief Returns the amount of all units (even those that are respawning).
+		 */
+		tdt::uint get_max_units() const;
+
 		/**
 		 * \brief Sets all of the player's stats to their default values.
 		 */
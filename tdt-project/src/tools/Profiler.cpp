@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <unordered_map>
+#include "Profiler.hpp"
+
+std::atomic<bool> Profiler::enabled_{false};
+thread_local Profiler::BufferHandle Profiler::thread_buffer_{};
+
+namespace
+{
+	/**
+	 * Number of frames whose starts are remembered for the zone statistics.
+	 */
+	constexpr tdt::uint frame_history = 600;
+}
+
+Profiler& Profiler::instance()
+{
+	static Profiler inst{};
+
+	return inst;
+}
+
+template<typename FUNC>
+void Profiler::for_each_event_(FUNC func)
+{
+	std::lock_guard<std::mutex> lock{mutex_};
+	for(auto& buffer : buffers_)
+	{
+		std::lock_guard<std::mutex> buffer_lock{buffer->mutex};
+		auto& events = buffer->events;
+		if(buffer->full)
+		{
+			for(std::size_t i = buffer->next; i < events.size(); ++i)
+				func(events[i], buffer->thread);
+		}
+		for(std::size_t i = 0; i < buffer->next; ++i)
+			func(events[i], buffer->thread);
+	}
+}
+
+void Profiler::start()
+{
+	get_buffer_(); // The main thread's buffer is the first one.
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		for(auto& buffer : buffers_)
+		{
+			std::lock_guard<std::mutex> buffer_lock{buffer->mutex};
+			buffer->events.assign(buffer_size_, Event{});
+			buffer->next = 0;
+			buffer->full = false;
+		}
+		next_frame_ = 0;
+		frame_count_ = 0;
+	}
+	enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::stop()
+{
+	enabled_.store(false, std::memory_order_relaxed);
+}
+
+bool Profiler::is_running() const
+{
+	return enabled_.load(std::memory_order_relaxed);
+}
+
+void Profiler::next_frame()
+{
+	if(!is_running())
+		return;
+
+	std::lock_guard<std::mutex> lock{mutex_};
+	frames_[next_frame_] = now_();
+	next_frame_ = (next_frame_ + 1) % frames_.size();
+	++frame_count_;
+}
+
+bool Profiler::dump(const std::string& fname)
+{
+	std::ofstream file{fname, std::ios::trunc};
+	if(!file)
+		return false;
+
+	// Timestamps of the trace format are in microseconds.
+	file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+	bool first{true};
+	for_each_event_([&file, &first](const Event& event, tdt::uint thread) {
+		file << (first ? "\n" : ",\n")
+			 << "{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << thread
+			 << ", \"ts\": " << event.start / 1000.0 << ", \"dur\": " << (event.end - event.start) / 1000.0 << "}";
+		first = false;
+	});
+
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		for(const auto& buffer : buffers_)
+		{
+			file << (first ? "\n" : ",\n")
+				 << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->thread
+				 << ", \"args\": {\"name\": \"" << (buffer->thread == 0 ? "main" : "thread " + std::to_string(buffer->thread))
+				 << "\"}}";
+			first = false;
+		}
+	}
+	file << "\n]}\n";
+
+	return (bool)file;
+}
+
+std::vector<Profiler::ZoneStats> Profiler::get_zone_stats(tdt::uint frames)
+{
+	std::uint64_t from{}, to{};
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+
+		// The current frame is not finished yet.
+		frames = std::min(frames, std::min(frame_count_ > 0 ? frame_count_ - 1 : 0, (tdt::uint)frames_.size() - 1));
+		if(frames == 0)
+			return std::vector<ZoneStats>{};
+
+		auto last = (next_frame_ + frames_.size() - 1) % frames_.size();
+		to = frames_[last];
+		from = frames_[(last + frames_.size() - frames) % frames_.size()];
+	}
+
+	std::map<const char*, ZoneStats> zones{};
+	for_each_event_([&zones, from, to](const Event& event, tdt::uint) {
+		if(event.start < from || event.start >= to)
+			return;
+
+		auto& zone = zones[event.name];
+		auto time = (event.end - event.start) / 1000000.f;
+		zone.time += time;
+		zone.max = std::max(zone.max, time);
+		++zone.calls;
+	});
+
+	std::vector<ZoneStats> res{};
+	for(auto& zone : zones)
+	{
+		zone.second.name = zone.first;
+		zone.second.time /= frames;
+		zone.second.calls /= frames;
+		res.push_back(zone.second);
+	}
+	std::sort(res.begin(), res.end(), [](const ZoneStats& lhs, const ZoneStats& rhs) -> bool {
+		return lhs.time > rhs.time;
+	});
+
+	return res;
+}
+
+void Profiler::set_buffer_size(tdt::uint size)
+{
+	if(size > 0)
+		buffer_size_ = size;
+}
+
+tdt::uint Profiler::get_buffer_size() const
+{
+	return buffer_size_;
+}
+
+Profiler::Profiler()
+	: epoch_{std::chrono::steady_clock::now()}, mutex_{}, buffers_{}, names_{},
+	  frames_(frame_history, 0), next_frame_{}, frame_count_{}, buffer_size_{1 << 16}
+{ /* DUMMY BODY */ }
+
+std::uint64_t Profiler::now_()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - instance().epoch_
+	).count();
+}
+
+const char* Profiler::intern_(const std::string& name)
+{
+	// Zone names (mostly Lua functions) repeat, so the lookup in the shared set is cached.
+	thread_local std::unordered_map<std::string, const char*> cache{};
+	auto it = cache.find(name);
+	if(it != cache.end())
+		return it->second;
+
+	auto& profiler = instance();
+	std::lock_guard<std::mutex> lock{profiler.mutex_};
+	auto res = profiler.names_.insert(name).first->c_str();
+	cache.emplace(name, res);
+
+	return res;
+}
+
+void Profiler::record_(const char* name, std::uint64_t start, std::uint64_t end)
+{
+	auto& buffer = get_buffer_();
+	std::lock_guard<std::mutex> lock{buffer.mutex};
+	if(buffer.events.empty())
+		return;
+
+	buffer.events[buffer.next] = Event{name, start, end};
+	buffer.next = (buffer.next + 1) % buffer.events.size();
+	buffer.full = buffer.full || buffer.next == 0;
+}
+
+Profiler::Buffer& Profiler::get_buffer_()
+{
+	if(thread_buffer_.buffer)
+		return *thread_buffer_.buffer;
+
+	std::lock_guard<std::mutex> lock{mutex_};
+	for(auto& buffer : buffers_)
+	{
+		if(!buffer->used)
+		{
+			buffer->used = true;
+			thread_buffer_.buffer = buffer.get();
+			return *buffer;
+		}
+	}
+
+	buffers_.emplace_back(new Buffer{});
+	auto& buffer = *buffers_.back();
+	buffer.events.assign(buffer_size_, Event{});
+	buffer.next = 0;
+	buffer.full = false;
+	buffer.thread = buffers_.size() - 1;
+	buffer.used = true;
+	thread_buffer_.buffer = &buffer;
+
+	return buffer;
+}
+
+Profiler::BufferHandle::~BufferHandle()
+{
+	if(buffer)
+	{
+		std::lock_guard<std::mutex> lock{Profiler::instance().mutex_};
+		buffer->used = false;
+	}
+}
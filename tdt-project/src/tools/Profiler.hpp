@@ -0,0 +1,275 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <Typedefs.hpp>
+
+#ifndef PROFILER_ZONES
+#define PROFILER_ZONES 1
+#endif
+
+#if PROFILER_ZONES == 1
+/**
+ * Measures the rest of the current scope as a zone of the profiler, the name
+ * has to be a string literal or an std::string (which is interned).
+ */
+#define PROFILE_ZONE(NAME) Profiler::Zone profiler_zone_{NAME}
+#else
+#define PROFILE_ZONE(NAME)
+#endif
+
+/**
+ * Frame profiler that records scoped zones (system updates, Lua calls, path searches,
+ * serialization) with nanosecond timestamps into ring buffers, one per thread.
+ * While the profiler is stopped, a zone only checks an atomic flag, if PROFILER_ZONES
+ * is defined as 0, zones are not compiled at all.
+ * The recorded zones can be exported into the Chrome trace event format (which can be
+ * opened in chrome://tracing or Perfetto) or summed up over the last few frames
+ * (used by the profiler overlay).
+ */
+class Profiler
+{
+	public:
+		/**
+		 * Records the time between it's construction and destruction as a zone.
+		 */
+		class Zone
+		{
+			public:
+				/**
+				 * \brief Constructor.
+				 * \param Name of the zone, has to outlive the profiler (string literal).
+				 */
+				Zone(const char* name)
+					: name_{Profiler::enabled_.load(std::memory_order_relaxed) ? name : nullptr},
+					  start_{name_ ? Profiler::now_() : 0}
+				{ /* DUMMY BODY */ }
+
+				/**
+				 * \brief Constructor.
+				 * \param Name of the zone, interned by the profiler.
+				 */
+				Zone(const std::string& name)
+					: name_{Profiler::enabled_.load(std::memory_order_relaxed) ? Profiler::intern_(name) : nullptr},
+					  start_{name_ ? Profiler::now_() : 0}
+				{ /* DUMMY BODY */ }
+
+				/**
+				 * \brief Destructor, records the zone.
+				 */
+				~Zone()
+				{
+					if(name_)
+						Profiler::instance().record_(name_, start_, Profiler::now_());
+				}
+
+				Zone(const Zone&) = delete;
+				Zone& operator=(const Zone&) = delete;
+
+			private:
+				/**
+				 * Name of the zone (nullptr if the profiler was stopped) and the time
+				 * the zone started at.
+				 */
+				const char* name_;
+				std::uint64_t start_;
+		};
+
+		/**
+		 * Timings of a single zone over a number of frames.
+		 */
+		struct ZoneStats
+		{
+			std::string name;
+			tdt::real time; // Average per frame (in milliseconds).
+			tdt::real max; // Longest call (in milliseconds).
+			tdt::uint calls; // Average per frame.
+		};
+
+		/**
+		 * \brief Returns a reference to the static instance of this class.
+		 */
+		static Profiler& instance();
+
+		/**
+		 * \brief Clears the buffers and starts recording zones.
+		 */
+		void start();
+
+		/**
+		 * \brief Stops recording zones, the recorded ones are kept.
+		 */
+		void stop();
+
+		/**
+		 * \brief Returns true if zones are being recorded, false otherwise.
+		 */
+		bool is_running() const;
+
+		/**
+		 * \brief Marks the start of a new frame.
+		 */
+		void next_frame();
+
+		/**
+		 * \brief Writes the recorded zones into a file in the Chrome trace event format,
+		 *        returns false if the file could not be written.
+		 * \param Name of the file.
+		 */
+		bool dump(const std::string&);
+
+		/**
+		 * \brief Returns the timings of the zones recorded in a number of last
+		 *        frames, sorted by their time.
+		 * \param Number of frames.
+		 */
+		std::vector<ZoneStats> get_zone_stats(tdt::uint);
+
+		/**
+		 * \brief Sets the number of zones kept per thread, applies after the next start.
+		 * \param Number of zones.
+		 */
+		void set_buffer_size(tdt::uint);
+
+		/**
+		 * \brief Returns the number of zones kept per thread.
+		 */
+		tdt::uint get_buffer_size() const;
+
+		/**
+		 * Since there should be only one profiler at all times, all copy/move
+		 * operations are disabled for this class.
+		 */
+		Profiler(const Profiler&) = delete;
+		Profiler& operator=(const Profiler&) = delete;
+		Profiler(Profiler&&) = delete;
+		Profiler& operator=(Profiler&&) = delete;
+
+	private:
+		/**
+		 * Constructor.
+		 * Kept private since there should be only one profiler at all times.
+		 */
+		Profiler();
+
+		/**
+		 * Destructor.
+		 */
+		~Profiler() {}
+
+		/**
+		 * A single recorded zone (times are in nanoseconds since the profiler's creation).
+		 */
+		struct Event
+		{
+			const char* name;
+			std::uint64_t start;
+			std::uint64_t end;
+		};
+
+		/**
+		 * Ring buffer of a single thread, the mutex is only contended
+		 * while the zones are being read.
+		 */
+		struct Buffer
+		{
+			std::mutex mutex;
+			std::vector<Event> events;
+			std::size_t next;
+			bool full;
+			tdt::uint thread;
+			bool used;
+		};
+
+		/**
+		 * Owner of a buffer, releases it for reuse when it's thread ends
+		 * (autosaves run on short lived threads).
+		 */
+		struct BufferHandle
+		{
+			Buffer* buffer{nullptr};
+			~BufferHandle();
+		};
+
+		/**
+		 * \brief Returns the current time in nanoseconds since the profiler's creation.
+		 */
+		static std::uint64_t now_();
+
+		/**
+		 * \brief Returns a pointer to a copy of a given zone name that lives as long
+		 *        as the profiler.
+		 * \param Name of the zone.
+		 */
+		static const char* intern_(const std::string&);
+
+		/**
+		 * \brief Adds a zone to the buffer of the calling thread.
+		 * \param Name of the zone.
+		 * \param Start of the zone.
+		 * \param End of the zone.
+		 */
+		void record_(const char*, std::uint64_t, std::uint64_t);
+
+		/**
+		 * \brief Returns the buffer of the calling thread, creates it if necessary.
+		 */
+		Buffer& get_buffer_();
+
+		/**
+		 * \brief Calls a given function for every recorded zone (in the order they
+		 *        were recorded in each thread).
+		 * \param The function, takes the event and the index of it's thread.
+		 */
+		template<typename FUNC>
+		void for_each_event_(FUNC func);
+
+		/**
+		 * If true, the zones are recorded.
+		 */
+		static std::atomic<bool> enabled_;
+
+		/**
+		 * Buffer of the calling thread.
+		 */
+		static thread_local BufferHandle thread_buffer_;
+
+		/**
+		 * Time the timestamps are relative to.
+		 */
+		std::chrono::steady_clock::time_point epoch_;
+
+		/**
+		 * Guards buffers_, names_ and frames_.
+		 */
+		std::mutex mutex_;
+
+		/**
+		 * Buffers of all threads that recorded a zone, kept for the lifetime
+		 * of the profiler (buffers of finished threads are reused).
+		 */
+		std::vector<std::unique_ptr<Buffer>> buffers_;
+
+		/**
+		 * Interned zone names.
+		 */
+		std::unordered_set<std::string> names_;
+
+		/**
+		 * Starts of the last frames (ring buffer).
+		 */
+		std::vector<std::uint64_t> frames_;
+		std::size_t next_frame_;
+		tdt::uint frame_count_;
+
+		/**
+		 * Number of zones kept per thread.
+		 */
+		tdt::uint buffer_size_;
+};
@@ -0,0 +1,377 @@
+#include <algorithm>
+#include <Game.hpp>
+#include <gui/GUI.hpp>
+#include <helpers/Helpers.hpp>
+#include <systems/EntitySystem.hpp>
+#include <systems/WaveSystem.hpp>
+#include "QuickSaveRing.hpp"
+#include "Grid.hpp"
+#include "PathService.hpp"
+#include "Profiler.hpp"
+#include "Player.hpp"
+#include "SelectionBox.hpp"
+#include "Util.hpp"
+
+template<typename COMP>
+void QuickSaveRing::Container<COMP>::restore(EntitySystem& ents)
+{
+	ents.get_component_container<COMP>() = components;
+}
+
+template<typename COMP>
+void QuickSaveRing::copy_container_(State& state)
+{
+	state.containers[COMP::type].reset(new Container<COMP>{entities_.get_component_container<COMP>()});
+}
+
+template<typename COMP>
+const std::map<tdt::uint, COMP>& QuickSaveRing::get_saved_(const State& state)
+{
+	return static_cast<const Container<COMP>&>(*state.containers[COMP::type]).components;
+}
+
+QuickSaveRing::QuickSaveRing(EntitySystem& ents, tdt::uint capacity)
+	: entities_{ents}, states_{}, capacity_{std::max<tdt::uint>(capacity, 1)}, copiers_{}
+{
+	copiers_[PhysicsComponent::type] = &QuickSaveRing::copy_container_<PhysicsComponent>;
+	copiers_[HealthComponent::type] = &QuickSaveRing::copy_container_<HealthComponent>;
+	copiers_[AIComponent::type] = &QuickSaveRing::copy_container_<AIComponent>;
+	copiers_[GraphicsComponent::type] = &QuickSaveRing::copy_container_<GraphicsComponent>;
+	copiers_[MovementComponent::type] = &QuickSaveRing::copy_container_<MovementComponent>;
+	copiers_[CombatComponent::type] = &QuickSaveRing::copy_container_<CombatComponent>;
+	copiers_[EventComponent::type] = &QuickSaveRing::copy_container_<EventComponent>;
+	copiers_[InputComponent::type] = &QuickSaveRing::copy_container_<InputComponent>;
+	copiers_[TimeComponent::type] = &QuickSaveRing::copy_container_<TimeComponent>;
+	copiers_[ManaComponent::type] = &QuickSaveRing::copy_container_<ManaComponent>;
+	copiers_[SpellComponent::type] = &QuickSaveRing::copy_container_<SpellComponent>;
+	copiers_[ProductionComponent::type] = &QuickSaveRing::copy_container_<ProductionComponent>;
+	copiers_[GridNodeComponent::type] = &QuickSaveRing::copy_container_<GridNodeComponent>;
+	copiers_[ProductComponent::type] = &QuickSaveRing::copy_container_<ProductComponent>;
+	copiers_[PathfindingComponent::type] = &QuickSaveRing::copy_container_<PathfindingComponent>;
+	copiers_[TaskComponent::type] = nullptr; // Tasks are kept in the task pool.
+	copiers_[TaskHandlerComponent::type] = &QuickSaveRing::copy_container_<TaskHandlerComponent>;
+	copiers_[StructureComponent::type] = &QuickSaveRing::copy_container_<StructureComponent>;
+	copiers_[HomingComponent::type] = &QuickSaveRing::copy_container_<HomingComponent>;
+	copiers_[EventHandlerComponent::type] = &QuickSaveRing::copy_container_<EventHandlerComponent>;
+	copiers_[DestructorComponent::type] = &QuickSaveRing::copy_container_<DestructorComponent>;
+	copiers_[GoldComponent::type] = &QuickSaveRing::copy_container_<GoldComponent>;
+	copiers_[FactionComponent::type] = &QuickSaveRing::copy_container_<FactionComponent>;
+	copiers_[PriceComponent::type] = &QuickSaveRing::copy_container_<PriceComponent>;
+	copiers_[AlignComponent::type] = &QuickSaveRing::copy_container_<AlignComponent>;
+	copiers_[MineComponent::type] = &QuickSaveRing::copy_container_<MineComponent>;
+	copiers_[ManaCrystalComponent::type] = &QuickSaveRing::copy_container_<ManaCrystalComponent>;
+	copiers_[OnHitComponent::type] = &QuickSaveRing::copy_container_<OnHitComponent>;
+	copiers_[ConstructorComponent::type] = &QuickSaveRing::copy_container_<ConstructorComponent>;
+	copiers_[TriggerComponent::type] = &QuickSaveRing::copy_container_<TriggerComponent>;
+	copiers_[UpgradeComponent::type] = &QuickSaveRing::copy_container_<UpgradeComponent>;
+	copiers_[NotificationComponent::type] = &QuickSaveRing::copy_container_<NotificationComponent>;
+	copiers_[ExplosionComponent::type] = &QuickSaveRing::copy_container_<ExplosionComponent>;
+	copiers_[LimitedLifeSpanComponent::type] = &QuickSaveRing::copy_container_<LimitedLifeSpanComponent>;
+	copiers_[NameComponent::type] = &QuickSaveRing::copy_container_<NameComponent>;
+	copiers_[ExperienceValueComponent::type] = &QuickSaveRing::copy_container_<ExperienceValueComponent>;
+	copiers_[LightComponent::type] = &QuickSaveRing::copy_container_<LightComponent>;
+	copiers_[CommandComponent::type] = &QuickSaveRing::copy_container_<CommandComponent>;
+	copiers_[CounterComponent::type] = &QuickSaveRing::copy_container_<CounterComponent>;
+	copiers_[PortalComponent::type] = &QuickSaveRing::copy_container_<PortalComponent>;
+	copiers_[AnimationComponent::type] = &QuickSaveRing::copy_container_<AnimationComponent>;
+	copiers_[SelectionComponent::type] = &QuickSaveRing::copy_container_<SelectionComponent>;
+	copiers_[DummyAlignComponent::type] = &QuickSaveRing::copy_container_<DummyAlignComponent>;
+	copiers_[ActivationComponent::type] = &QuickSaveRing::copy_container_<ActivationComponent>;
+}
+
+void QuickSaveRing::save(Game& game)
+{
+	PROFILE_ZONE("QuickSaveRing::save");
+	std::unique_ptr<State> state{new State{}};
+	for(auto copier : copiers_)
+	{
+		if(copier)
+			((this)->*copier)(*state);
+	}
+	state->entities = entities_.entities_;
+	state->to_be_destroyed = entities_.to_be_destroyed_;
+	state->components_to_be_removed = entities_.components_to_be_removed_;
+	state->constructors_to_be_called = entities_.constructors_to_be_called_;
+	state->curr_id = entities_.curr_id_;
+	state->tasks = entities_.task_pool_;
+
+	// Scene data that is kept only in Ogre objects.
+	for(auto& comp : entities_.get_component_container<GraphicsComponent>())
+	{
+		SceneData data{Ogre::Quaternion::IDENTITY, 0, true};
+		if(comp.second.node)
+			data.orientation = comp.second.node->getOrientation();
+		if(comp.second.entity)
+			data.query_flags = comp.second.entity->getQueryFlags();
+		state->scene.emplace(comp.first, data);
+	}
+	for(auto& comp : entities_.get_component_container<LightComponent>())
+	{
+		auto& data = state->scene.emplace(comp.first, SceneData{Ogre::Quaternion::IDENTITY, 0, true}).first->second;
+		data.light_visible = comp.second.light ? comp.second.light->isVisible() : true;
+	}
+
+	auto& grid = Grid::instance();
+	state->nodes = grid.nodes_;
+	state->freed = grid.freed_;
+	state->unfreed = grid.unfreed_;
+	state->path_subscribers = grid.path_subscribers_;
+	state->free_nodes = grid.free_nodes_;
+
+	auto& player = Player::instance();
+	state->gold = player.get_gold();
+	state->max_mana = player.get_max_mana();
+	state->mana = player.get_mana();
+	state->mana_regen = player.get_mana_regen();
+	state->max_units = player.get_max_units();
+	state->curr_units = player.get_curr_units();
+
+	state->has_wave_system = game.wave_system_ != nullptr;
+	if(state->has_wave_system)
+	{
+		auto& wsys = *game.wave_system_;
+		state->wave_table = wsys.get_wave_table();
+		state->wave_state = wsys.get_state();
+		state->wave_count = wsys.get_wave_count();
+		state->curr_wave = wsys.get_curr_wave_number();
+		state->countdown = wsys.get_countdown_value();
+		state->spawn_cooldown = wsys.get_spawn_cooldown();
+		state->spawn_timer = wsys.get_spawn_timer();
+		state->spawned = wsys.get_entities_spawned();
+		state->wave_entities = wsys.get_wave_entities();
+		state->entity_total = wsys.get_entity_total();
+		state->wave_blueprints = wsys.get_entity_blueprints();
+		state->spawn_nodes = wsys.get_spawning_nodes();
+		state->endless_mode = wsys.get_endless_mode();
+	}
+
+	state->spells = GUI::instance().get_spell_casting().get_spells();
+	state->buildings = GUI::instance().get_builder().get_buildings();
+	state->research = GUI::instance().get_research().get_unlocked();
+	state->throne_id = game.throne_id_;
+
+	states_.push_back(std::move(state));
+	while(states_.size() > capacity_)
+		states_.pop_front();
+}
+
+bool QuickSaveRing::load(Game& game, tdt::uint index)
+{
+	PROFILE_ZONE("QuickSaveRing::load");
+	if(index >= states_.size())
+		return false;
+	const auto& state = *states_[states_.size() - 1 - index];
+
+	// Selection markers and tracking are not part of the state.
+	game.selection_box_->clear_selected_entities();
+	GUI::instance().get_tracker().clear();
+
+	std::set<tdt::uint> kept{};
+	release_scene_objects_(state, kept);
+
+	for(auto& container : state.containers)
+	{
+		if(container)
+			container->restore(entities_);
+	}
+	entities_.entities_ = state.entities;
+	entities_.invalidate_changes(); // The next autosave has to be a full one.
+	++entities_.generation_; // Pointers to the replaced components (e.g. in helper caches) are invalid.
+	entities_.to_be_destroyed_ = state.to_be_destroyed;
+	entities_.components_to_be_removed_ = state.components_to_be_removed;
+	entities_.constructors_to_be_called_ = state.constructors_to_be_called;
+	entities_.curr_id_ = state.curr_id;
+	entities_.task_pool_ = state.tasks;
+
+	auto& grid = Grid::instance();
+	grid.nodes_ = state.nodes;
+	grid.freed_ = state.freed;
+	grid.unfreed_ = state.unfreed;
+	grid.path_subscribers_ = state.path_subscribers;
+	grid.free_nodes_ = state.free_nodes;
+	PathService::instance().reset();
+
+	auto& player = Player::instance();
+	player.nulify_all_stats();
+	player.add_gold(state.gold);
+	player.add_max_mana(state.max_mana);
+	player.add_mana(state.mana);
+	player.add_mana_regen(state.mana_regen);
+	player.add_max_unit(state.max_units);
+	player.add_curr_unit(state.curr_units);
+
+	if(state.has_wave_system && game.wave_system_)
+	{
+		auto& wsys = *game.wave_system_;
+		wsys.set_wave_table(state.wave_table);
+		wsys.set_state(state.wave_state);
+		wsys.set_wave_count(state.wave_count);
+		wsys.set_curr_wave_number(state.curr_wave);
+		wsys.set_countdown_value(state.countdown);
+		wsys.set_spawn_cooldown(state.spawn_cooldown);
+		wsys.set_spawn_timer(state.spawn_timer);
+		wsys.set_entities_spawned(state.spawned);
+		wsys.set_wave_entities(state.wave_entities);
+		wsys.set_entity_total(state.entity_total);
+		wsys.clear_entity_blueprints();
+		for(const auto& blueprint : state.wave_blueprints)
+			wsys.add_entity_blueprint(blueprint);
+		wsys.clear_spawn_nodes();
+		for(auto node : state.spawn_nodes)
+			wsys.add_spawn_node(node);
+		wsys.set_endless_mode(state.endless_mode);
+		wsys.update_label_text();
+	}
+
+	game.reset_unlocks();
+	for(const auto& spell : state.spells)
+		GUI::instance().get_spell_casting().register_spell(spell);
+	for(const auto& building : state.buildings)
+		GUI::instance().get_builder().register_building(building);
+	auto& research = GUI::instance().get_research();
+	for(tdt::uint i = 0; i < state.research.size(); ++i)
+	{
+		if(state.research[i])
+			research.dummy_unlock(i / research.cols_ + 1, i % research.cols_ + 1);
+	}
+	game.set_throne_id(state.throne_id);
+
+	restore_scene_objects_(state, kept);
+	return true;
+}
+
+void QuickSaveRing::clear()
+{
+	states_.clear();
+}
+
+void QuickSaveRing::set_capacity(tdt::uint capacity)
+{
+	capacity_ = std::max<tdt::uint>(capacity, 1);
+	while(states_.size() > capacity_)
+		states_.pop_front();
+}
+
+tdt::uint QuickSaveRing::get_capacity() const
+{
+	return capacity_;
+}
+
+tdt::uint QuickSaveRing::get_size() const
+{
+	return states_.size();
+}
+
+bool QuickSaveRing::same_scene_objects_(const State& state, tdt::uint id)
+{
+	/**
+	 * Pointers are only compared, never dereferenced, so saved pointers to objects that
+	 * were destroyed since are harmless, the current objects are equal to them only if
+	 * they are still alive (or were allocated at the same address for the same entity
+	 * with the same mesh and material, which makes them equivalent).
+	 */
+	const auto& saved_graphics = get_saved_<GraphicsComponent>(state);
+	auto graph = entities_.get_component<GraphicsComponent>(id);
+	auto saved_graph = saved_graphics.find(id);
+	if((graph != nullptr) != (saved_graph != saved_graphics.end()))
+		return false;
+
+	if(graph)
+	{
+		const auto& saved = saved_graph->second;
+		if(!graph->node || (!graph->entity && !util::is_headless()) || graph->node != saved.node || graph->entity != saved.entity
+		   || graph->mesh != saved.mesh || graph->material != saved.material
+		   || graph->manual_scaling != saved.manual_scaling || graph->scale != saved.scale)
+			return false;
+	}
+
+	const auto& saved_lights = get_saved_<LightComponent>(state);
+	auto light = entities_.get_component<LightComponent>(id);
+	auto saved_light = saved_lights.find(id);
+	if((light != nullptr) != (saved_light != saved_lights.end()))
+		return false;
+
+	if(light && (!light->light || light->light != saved_light->second.light || light->node != saved_light->second.node))
+		return false;
+
+	return true;
+}
+
+void QuickSaveRing::release_scene_objects_(const State& state, std::set<tdt::uint>& kept)
+{
+	std::vector<tdt::uint> released{};
+	for(const auto& ent : entities_.entities_)
+	{
+		if(!ent.second.test(GraphicsComponent::type) && !ent.second.test(LightComponent::type))
+			continue;
+
+		if(same_scene_objects_(state, ent.first))
+			kept.insert(ent.first);
+		else
+			released.push_back(ent.first);
+	}
+
+	for(auto id : released)
+	{
+		entities_.clean_up_component<LightComponent>(id);
+		entities_.clean_up_component<GraphicsComponent>(id);
+	}
+}
+
+void QuickSaveRing::restore_scene_objects_(const State& state, const std::set<tdt::uint>& kept)
+{
+	// Graphics initialization attaches lights, so the stale ones have to be dropped first.
+	for(auto& comp : entities_.get_component_container<LightComponent>())
+	{
+		if(kept.count(comp.first) == 0)
+		{
+			comp.second.light = nullptr;
+			comp.second.node = nullptr;
+		}
+	}
+
+	auto& scene = entities_.get_scene_manager();
+	for(auto& comp : entities_.get_component_container<GraphicsComponent>())
+	{
+		if(kept.count(comp.first) > 0)
+		{ // Same objects, only the state that is not compared has to be restored.
+			comp.second.node->setVisible(comp.second.visible);
+			auto phys = entities_.get_component<PhysicsComponent>(comp.first);
+			if(phys)
+				comp.second.node->setPosition(phys->position);
+		}
+		else
+		{
+			comp.second.node = nullptr;
+			comp.second.entity = nullptr;
+			GraphicsHelper::init_graphics_component(entities_, scene, comp.first);
+
+			auto anim = entities_.get_component<AnimationComponent>(comp.first);
+			if(anim)
+				anim->current_animation = nullptr;
+		}
+
+		auto data = state.scene.find(comp.first);
+		if(data != state.scene.end())
+		{
+			if(comp.second.node)
+				comp.second.node->setOrientation(data->second.orientation);
+			if(comp.second.entity)
+				comp.second.entity->setQueryFlags(data->second.query_flags);
+		}
+	}
+
+	for(auto& comp : entities_.get_component_container<LightComponent>())
+	{
+		if(kept.count(comp.first) == 0)
+			LightHelper::init(entities_, comp.first);
+
+		auto data = state.scene.find(comp.first);
+		if(data != state.scene.end())
+			LightHelper::set_visible(entities_, comp.first, data->second.light_visible);
+	}
+
+	// Markers were destroyed when the selection was cleared.
+	for(auto& comp : entities_.get_component_container<SelectionComponent>())
+		comp.second.entity = nullptr;
+}
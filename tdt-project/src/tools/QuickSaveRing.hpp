@@ -0,0 +1,234 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <OGRE/Ogre.h>
+#include <Components.hpp>
+#include <Enums.hpp>
+#include <Typedefs.hpp>
+#include "TaskPool.hpp"
+
+// Forward declarations.
+class Game;
+class EntitySystem;
+
+/**
+ * Keeps the last few states of the game in memory, so that quick saves and quick loads
+ * don't touch the disk and don't rebuild the world. A state contains copies of the whole
+ * component storage (entity IDs are kept, so nothing has to be translated), the task pool,
+ * the grid, the wave system, the player and the unlocks.
+ * Loading copies the storage back and reconciles the Ogre objects incrementally: entities
+ * whose scene objects (graphics, light and selection marker) are the same as when the state
+ * was saved keep them and only have their transformations and visibility restored, scene objects
+ * of the other entities are destroyed and recreated from the restored components.
+ */
+class QuickSaveRing
+{
+	public:
+		/**
+		 * \brief Constructor.
+		 * \param Reference to the game's entity system.
+		 * \param Maximal number of kept states.
+		 */
+		QuickSaveRing(EntitySystem&, tdt::uint = 5);
+
+		/**
+		 * \brief Destructor.
+		 */
+		~QuickSaveRing() {}
+
+		/**
+		 * \brief Saves the current state of the game, the oldest state is dropped
+		 *        if the ring is full.
+		 * \param Reference to the game object.
+		 */
+		void save(Game&);
+
+		/**
+		 * \brief Restores a saved state, returns false if there is no such state.
+		 * \param Reference to the game object.
+		 * \param Number of saves made after the restored state (0 = the last save).
+		 */
+		bool load(Game&, tdt::uint = 0);
+
+		/**
+		 * \brief Drops all saved states (used when a new level is created).
+		 */
+		void clear();
+
+		/**
+		 * \brief Sets the maximal number of kept states, drops the oldest states
+		 *        if there are more.
+		 * \param The new capacity.
+		 */
+		void set_capacity(tdt::uint);
+
+		/**
+		 * \brief Returns the maximal number of kept states.
+		 */
+		tdt::uint get_capacity() const;
+
+		/**
+		 * \brief Returns the number of kept states.
+		 */
+		tdt::uint get_size() const;
+
+	private:
+		/**
+		 * Copy of the container of a single component type.
+		 */
+		class ContainerBase
+		{
+			public:
+				virtual ~ContainerBase() {}
+
+				/**
+				 * \brief Copies the saved components back into the entity system.
+				 * \param The entity system.
+				 */
+				virtual void restore(EntitySystem&) = 0;
+		};
+
+		template<typename COMP>
+		class Container : public ContainerBase
+		{
+			public:
+				Container(const std::map<tdt::uint, COMP>& comps)
+					: components{comps}
+				{ /* DUMMY BODY */ }
+
+				void restore(EntitySystem&) override;
+
+				std::map<tdt::uint, COMP> components;
+		};
+
+		/**
+		 * Data of an entity's scene objects that is not part of it's components.
+		 */
+		struct SceneData
+		{
+			Ogre::Quaternion orientation;
+			tdt::uint query_flags;
+			bool light_visible;
+		};
+
+		/**
+		 * A single saved state.
+		 */
+		struct State
+		{
+			/**
+			 * Component storage.
+			 */
+			std::map<tdt::uint, std::bitset<Component::count>> entities;
+			std::array<std::unique_ptr<ContainerBase>, Component::count> containers;
+			std::vector<tdt::uint> to_be_destroyed;
+			std::vector<std::pair<tdt::uint, int>> components_to_be_removed;
+			std::vector<tdt::uint> constructors_to_be_called;
+			tdt::uint curr_id;
+			TaskPool tasks;
+			std::map<tdt::uint, SceneData> scene;
+
+			/**
+			 * Grid.
+			 */
+			std::vector<tdt::uint> nodes;
+			std::set<tdt::uint> freed, unfreed;
+			std::map<tdt::uint, std::set<tdt::uint>> path_subscribers;
+			std::vector<tdt::uint> free_nodes;
+
+			/**
+			 * Player stats.
+			 */
+			tdt::uint gold, max_mana, mana, mana_regen, max_units, curr_units;
+
+			/**
+			 * Wave system.
+			 */
+			bool has_wave_system;
+			std::string wave_table;
+			WAVE_STATE wave_state;
+			tdt::uint wave_count, curr_wave, countdown, spawned, wave_entities, entity_total;
+			tdt::real spawn_cooldown, spawn_timer;
+			std::vector<std::string> wave_blueprints;
+			std::vector<tdt::uint> spawn_nodes;
+			bool endless_mode;
+
+			/**
+			 * Unlocks.
+			 */
+			std::vector<std::string> spells, buildings;
+			std::array<bool, 42> research;
+
+			tdt::uint throne_id;
+		};
+		typedef void (QuickSaveRing::*ContainerCopierFuncPtr)(State&);
+
+		/**
+		 * \brief Copies the component container of a given type (specified as template
+		 *        argument) into a state.
+		 * \param The state.
+		 */
+		template<typename COMP>
+		void copy_container_(State&);
+
+		/**
+		 * \brief Returns the saved container of a given component type (specified
+		 *        as template argument).
+		 * \param The state.
+		 */
+		template<typename COMP>
+		static const std::map<tdt::uint, COMP>& get_saved_(const State&);
+
+		/**
+		 * \brief Returns true if an entity has the same scene objects as it had when a given
+		 *        state was saved (in which case they can be kept).
+		 * \param The state.
+		 * \param ID of the entity.
+		 */
+		bool same_scene_objects_(const State&, tdt::uint);
+
+		/**
+		 * \brief Destroys the scene objects of entities that cannot keep them, IDs of
+		 *        entities that keep them are inserted into the given set.
+		 * \param The state that is being loaded.
+		 * \param Output set of entities that keep their scene objects.
+		 */
+		void release_scene_objects_(const State&, std::set<tdt::uint>&);
+
+		/**
+		 * \brief Restores the transformations of kept scene objects and recreates
+		 *        the scene objects of the other entities.
+		 * \param The state that is being loaded.
+		 * \param Entities that kept their scene objects.
+		 */
+		void restore_scene_objects_(const State&, const std::set<tdt::uint>&);
+
+		/**
+		 * Reference to the game's entity system.
+		 */
+		EntitySystem& entities_;
+
+		/**
+		 * Saved states, the newest at the back.
+		 */
+		std::deque<std::unique_ptr<State>> states_;
+
+		/**
+		 * Maximal number of kept states.
+		 */
+		tdt::uint capacity_;
+
+		/**
+		 * Pointers to the copy_container_ instances (nullptr for components that
+		 * are not stored in containers).
+		 */
+		std::array<ContainerCopierFuncPtr, Component::count> copiers_;
+};
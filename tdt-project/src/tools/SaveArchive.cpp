@@ -0,0 +1,410 @@
+#include <algorithm>
+#include <cstring>
+#include "SaveArchive.hpp"
+
+namespace
+{
+	/**
+	 * Value used in save files for Component::NO_ENTITY.
+	 */
+	const std::uint32_t NO_ENTITY_VALUE{0xFFFFFFFF};
+}
+
+SaveWriter::SaveWriter()
+	: data_{}, string_ids_{}, strings_{}
+{ /* DUMMY BODY */ }
+
+void SaveWriter::value(bool& val)
+{
+	char tmp = val ? 1 : 0;
+	bytes(&tmp, 1);
+}
+
+void SaveWriter::value(tdt::uint& val)
+{
+	std::uint32_t tmp = val == Component::NO_ENTITY ? NO_ENTITY_VALUE : (std::uint32_t)val;
+	bytes(&tmp, sizeof(tmp));
+}
+
+void SaveWriter::value(tdt::real& val)
+{
+	float tmp = (float)val;
+	bytes(&tmp, sizeof(tmp));
+}
+
+void SaveWriter::value(std::string& val)
+{
+	auto res = string_ids_.emplace(val, strings_.size());
+	if(res.second)
+		strings_.push_back(&res.first->first);
+
+	tdt::uint index = res.first->second;
+	value(index);
+}
+
+void SaveWriter::value(Symbol& val)
+{
+	std::string tmp{val.str()};
+	value(tmp);
+}
+
+void SaveWriter::value(Ogre::Vector3& val)
+{
+	value(val.x);
+	value(val.y);
+	value(val.z);
+}
+
+void SaveWriter::value(Ogre::Degree& val)
+{
+	tdt::real tmp = val.valueDegrees();
+	value(tmp);
+}
+
+void SaveWriter::entity(tdt::uint& id)
+{
+	value(id);
+}
+
+void SaveWriter::bytes(const void* src, tdt::uint size)
+{
+	data_.append((const char*)src, size);
+}
+
+void SaveWriter::align(tdt::uint alignment)
+{
+	if(data_.size() % alignment != 0)
+		data_.append(alignment - data_.size() % alignment, '\0');
+}
+
+void SaveWriter::write_strings()
+{
+	tdt::uint count = strings_.size();
+	value(count);
+	for(auto str : strings_)
+	{
+		tdt::uint size = str->size();
+		value(size);
+		bytes(str->data(), str->size());
+	}
+}
+
+void SaveWriter::patch(tdt::uint offset, tdt::uint val)
+{
+	std::uint32_t tmp = (std::uint32_t)val;
+	std::memcpy(&data_[offset], &tmp, sizeof(tmp));
+}
+
+tdt::uint SaveWriter::size() const
+{
+	return data_.size();
+}
+
+const std::string& SaveWriter::get_data() const
+{
+	return data_;
+}
+
+SaveReader::SaveReader(const char* data, tdt::uint size)
+	: data_{data}, size_{size}, position_{0}, ids_{},
+	  keep_ids_{false}, strings_{}, interned_{false}
+{ /* DUMMY BODY */ }
+
+void SaveReader::value(bool& val)
+{
+	char tmp{};
+	bytes(&tmp, 1);
+	val = tmp != 0;
+}
+
+void SaveReader::value(tdt::uint& val)
+{
+	std::uint32_t tmp{};
+	bytes(&tmp, sizeof(tmp));
+	val = tmp == NO_ENTITY_VALUE ? Component::NO_ENTITY : (tdt::uint)tmp;
+}
+
+void SaveReader::value(tdt::real& val)
+{
+	float tmp{};
+	bytes(&tmp, sizeof(tmp));
+	val = (tdt::real)tmp;
+}
+
+void SaveReader::value(std::string& val)
+{
+	tdt::uint size{};
+	value(size);
+	if(interned_)
+	{ // Size is the index in the string table.
+		if(size >= strings_.size())
+			throw std::runtime_error{"Invalid string index in the save file."};
+		val = strings_[size];
+		return;
+	}
+
+	require_(size);
+	val.assign(data_ + position_, size);
+	position_ += size;
+}
+
+void SaveReader::value(Symbol& val)
+{
+	std::string tmp{};
+	value(tmp);
+	val = Symbol{tmp};
+}
+
+void SaveReader::value(Ogre::Vector3& val)
+{
+	value(val.x);
+	value(val.y);
+	value(val.z);
+}
+
+void SaveReader::value(Ogre::Degree& val)
+{
+	tdt::real tmp{};
+	value(tmp);
+	val = Ogre::Degree{tmp};
+}
+
+void SaveReader::entity(tdt::uint& id)
+{
+	value(id);
+	id = translate(id);
+}
+
+void SaveReader::bytes(void* dest, tdt::uint size)
+{
+	require_(size);
+	std::memcpy(dest, data_ + position_, size);
+	position_ += size;
+}
+
+void SaveReader::align(tdt::uint alignment)
+{
+	if(position_ % alignment != 0)
+		skip(alignment - position_ % alignment);
+}
+
+void SaveReader::read_strings(tdt::uint offset)
+{
+	auto position = position_;
+	position_ = offset;
+	require_(0);
+
+	tdt::uint count{};
+	value(count);
+	strings_.clear();
+	strings_.reserve(count);
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		strings_.emplace_back();
+		value(strings_.back());
+	}
+
+	position_ = position;
+	interned_ = true;
+}
+
+void SaveReader::skip(tdt::uint size)
+{
+	require_(size);
+	position_ += size;
+}
+
+tdt::uint SaveReader::position() const
+{
+	return position_;
+}
+
+void SaveReader::map_entity(tdt::uint saved, tdt::uint id)
+{
+	ids_[saved] = id;
+}
+
+tdt::uint SaveReader::translate(tdt::uint id) const
+{
+	if(keep_ids_)
+		return id;
+
+	auto it = ids_.find(id);
+	return it != ids_.end() ? it->second : Component::NO_ENTITY;
+}
+
+void SaveReader::keep_ids(bool on_off)
+{
+	keep_ids_ = on_off;
+}
+
+void SaveReader::require_(tdt::uint size) const
+{
+	if(position_ > size_ || size_ - position_ < size)
+		throw std::runtime_error{"Unexpected end of the save file."};
+}
+
+namespace
+{
+	/**
+	 * Parameters of the compression, matches are at least min_match bytes long
+	 * and at most max_offset bytes back.
+	 */
+	const tdt::uint min_match{4};
+	const tdt::uint max_offset{0xFFFF};
+	const tdt::uint hash_bits{14};
+
+	/**
+	 * \brief Appends a length that didn't fit into it's token nibble.
+	 * \param The compressed data.
+	 * \param Remaining length.
+	 */
+	void append_length(std::string& out, tdt::uint length)
+	{
+		while(length >= 0xFF)
+		{
+			out.push_back((char)0xFF);
+			length -= 0xFF;
+		}
+		out.push_back((char)length);
+	}
+
+	/**
+	 * \brief Appends a sequence of literals followed by a match (match length
+	 *        of 0 means the last sequence, which has no match).
+	 * \param The compressed data.
+	 * \param The literals.
+	 * \param Number of literals.
+	 * \param Distance of the match.
+	 * \param Length of the match.
+	 */
+	void append_sequence(std::string& out, const char* literals, tdt::uint literal_count,
+						 tdt::uint offset, tdt::uint match_length)
+	{
+		tdt::uint match_rest = match_length > 0 ? match_length - min_match : 0;
+		char token = (char)((std::min<tdt::uint>(literal_count, 15) << 4) | std::min<tdt::uint>(match_rest, 15));
+		out.push_back(token);
+		if(literal_count >= 15)
+			append_length(out, literal_count - 15);
+		out.append(literals, literal_count);
+
+		if(match_length > 0)
+		{
+			out.push_back((char)(offset & 0xFF));
+			out.push_back((char)(offset >> 8));
+			if(match_rest >= 15)
+				append_length(out, match_rest - 15);
+		}
+	}
+
+	/**
+	 * \brief Reads a length that didn't fit into it's token nibble.
+	 * \param Current position in the compressed data.
+	 * \param End of the compressed data.
+	 */
+	tdt::uint read_length(const unsigned char*& in, const unsigned char* end)
+	{
+		tdt::uint length{};
+		unsigned char byte{};
+		do
+		{
+			if(in >= end)
+				throw std::runtime_error{"Corrupted compressed save file."};
+			byte = *in++;
+			length += byte;
+		}
+		while(byte == 0xFF);
+		return length;
+	}
+}
+
+std::string SaveFormat::compress(const std::string& data)
+{
+	std::string out{compressed_magic, 4};
+	std::uint32_t size = (std::uint32_t)data.size();
+	out.append((const char*)&size, sizeof(size));
+	out.reserve(out.size() + data.size() / 2);
+
+	// Last positions of 4 byte sequences by their hash.
+	std::vector<std::uint32_t> table(1 << hash_bits, 0xFFFFFFFF);
+	const char* src = data.data();
+	tdt::uint pos{}, anchor{}, n = data.size();
+	while(pos + min_match <= n)
+	{
+		std::uint32_t seq{};
+		std::memcpy(&seq, src + pos, sizeof(seq));
+		auto hash = (seq * 2654435761U) >> (32 - hash_bits);
+		tdt::uint candidate = table[hash];
+		table[hash] = (std::uint32_t)pos;
+
+		if(candidate != 0xFFFFFFFF && pos - candidate <= max_offset
+		   && std::memcmp(src + candidate, src + pos, min_match) == 0)
+		{
+			tdt::uint length = min_match;
+			while(pos + length < n && src[candidate + length] == src[pos + length])
+				++length;
+
+			append_sequence(out, src + anchor, pos - anchor, pos - candidate, length);
+			pos += length;
+			anchor = pos;
+		}
+		else
+			++pos;
+	}
+	append_sequence(out, src + anchor, n - anchor, 0, 0);
+
+	return out;
+}
+
+std::string SaveFormat::decompress(const char* data, tdt::uint size)
+{
+	if(!is_compressed(data, size) || size < 8)
+		throw std::runtime_error{"Corrupted compressed save file."};
+
+	std::uint32_t original_size{};
+	std::memcpy(&original_size, data + 4, sizeof(original_size));
+	std::string out{};
+	out.reserve(original_size);
+
+	auto in = (const unsigned char*)data + 8;
+	auto end = (const unsigned char*)data + size;
+	while(in < end)
+	{
+		unsigned char token = *in++;
+		tdt::uint literal_count = token >> 4;
+		if(literal_count == 15)
+			literal_count += read_length(in, end);
+		if((tdt::uint)(end - in) < literal_count || out.size() + literal_count > original_size)
+			throw std::runtime_error{"Corrupted compressed save file."};
+		out.append((const char*)in, literal_count);
+		in += literal_count;
+
+		if(in == end)
+			break; // Last sequence.
+
+		if(end - in < 2)
+			throw std::runtime_error{"Corrupted compressed save file."};
+		tdt::uint offset = in[0] | (in[1] << 8);
+		in += 2;
+		tdt::uint length = token & 0x0F;
+		if(length == 15)
+			length += read_length(in, end);
+		length += min_match;
+		if(offset == 0 || offset > out.size() || out.size() + length > original_size)
+			throw std::runtime_error{"Corrupted compressed save file."};
+
+		// Matches can overlap with the bytes they produce, so this copies byte by byte.
+		auto from = out.size() - offset;
+		for(tdt::uint i = 0; i < length; ++i)
+			out.push_back(out[from + i]);
+	}
+
+	if(out.size() != original_size)
+		throw std::runtime_error{"Corrupted compressed save file."};
+	return out;
+}
+
+bool SaveFormat::is_compressed(const char* data, tdt::uint size)
+{
+	return data && size >= 4 && std::memcmp(data, compressed_magic, 4) == 0;
+}
@@ -0,0 +1,903 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <Components.hpp>
+#include <Typedefs.hpp>
+
+/**
+ * Layout of a binary save file (all values are little endian):
+ *   header:     magic "TDTS", format version, offset of the string table, ID of the
+ *               incremental save chain the snapshot is the base of (0 if none)
+ *   player:     gold, max mana, mana, mana regen
+ *   grid:       width, height, IDs of the grid nodes in grid order
+ *   entities:   IDs of all saved entities
+ *   components: column count, then every column as component type, schema version
+ *               of that type, component count, byte size, record size and the packed
+ *               components (each prefixed by the ID of it's entity)
+ *   runtime:    data kept in Ogre objects (query flags, light visibility), portal links
+ *   tasks:      handler, target and type of every task
+ *   wave system, unlocks, throne ID
+ *   strings:    count, then every string as it's length and characters
+ * Unsigned integers (including entity IDs) are stored as 32bit values, Component::NO_ENTITY
+ * is stored as 0xFFFFFFFF. Strings are interned, every distinct string is stored only once
+ * in the string table and referenced by it's index (version 1 stored them inline).
+ * Columns of unknown component types are skipped by their size, new fields have to be appended
+ * to the serialize function of their component and guarded by the schema version of the component
+ * (see SaveFormat::schema).
+ * Components that have a fixed size record (see SaveFormat::record) are stored as an 8 byte aligned
+ * array of these records (record size is 0 for the other columns), which is used in place when
+ * loading, so that large levels (thousands of walls, gold deposits etc.) load without decoding
+ * the individual fields.
+ *
+ * Incremental saves consist of a base snapshot (<name>.sav) and a chain of delta files
+ * (<name>.1.delta, <name>.2.delta, ...), each containing only what changed since the previous
+ * file of the chain. A delta has the same layout as a snapshot with these differences:
+ *   header:     magic "TDTD", format version, offset of the string table, chain ID,
+ *               sequence number of the delta (starting at 1)
+ *   grid:       left out (the grid cannot change)
+ *   entities:   IDs of entities created since the previous file, followed by the IDs
+ *               of entities destroyed since then
+ *   components: only changed components, followed by the count of removed components
+ *               and their entity ID and type pairs
+ *   runtime:    query flags and light visibility only of changed entities
+ * Player stats, portals, tasks, the wave system, unlocks and the throne are small and
+ * saved whole in every delta. A chain is loaded by merging the deltas into the base
+ * (until the first delta that is missing or belongs to another chain) and loading the result.
+ */
+namespace SaveFormat
+{
+	constexpr char magic[] = "TDTS";
+	constexpr char delta_magic[] = "TDTD";
+	constexpr tdt::uint version = 3;
+
+	/**
+	 * Alignment of record arrays.
+	 */
+	constexpr tdt::uint record_alignment = 8;
+
+	/**
+	 * Magic of compressed save files (autosaves), which contain the size of
+	 * the original save file followed by it's compressed contents.
+	 */
+	constexpr char compressed_magic[] = "TDTZ";
+
+	/**
+	 * \brief Compresses a save file (LZ77 with the LZ4 block layout, which is fast enough
+	 *        to be used for every autosave), returns the compressed file including it's header.
+	 * \param Contents of the save file.
+	 */
+	std::string compress(const std::string&);
+
+	/**
+	 * \brief Returns the original contents of a compressed save file, throws
+	 *        std::runtime_error if the file is corrupted.
+	 * \param Contents of the compressed file.
+	 * \param Size of the compressed file.
+	 */
+	std::string decompress(const char*, tdt::uint);
+
+	/**
+	 * \brief Returns true if a given file is a compressed save file.
+	 * \param Contents of the file.
+	 * \param Size of the file.
+	 */
+	bool is_compressed(const char*, tdt::uint);
+
+	/**
+	 * Schema version of a component type, has to be increased every time
+	 * the serialize function of that component changes.
+	 */
+	template<typename COMP>
+	struct schema
+	{
+		static constexpr tdt::uint version = 1;
+	};
+}
+
+/**
+ * Archive that packs values into a binary buffer.
+ * Has the same interface as SaveReader so that a single serialize function
+ * can be used for both saving and loading.
+ */
+class SaveWriter
+{
+	public:
+		/**
+		 * \brief Constructor.
+		 */
+		SaveWriter();
+
+		/**
+		 * \brief Writes a single value.
+		 * \param The value.
+		 */
+		void value(bool&);
+		void value(tdt::uint&);
+		void value(tdt::real&);
+		void value(std::string&);
+		void value(Symbol&);
+		void value(Ogre::Vector3&);
+		void value(Ogre::Degree&);
+
+		template<typename ENUM>
+		typename std::enable_if<std::is_enum<ENUM>::value>::type value(ENUM& val)
+		{
+			tdt::uint tmp = (tdt::uint)val;
+			value(tmp);
+		}
+
+		template<std::size_t N>
+		void value(std::bitset<N>& val)
+		{
+			static_assert(N <= 32, "Bitset too large for the save format.");
+			tdt::uint tmp = (tdt::uint)val.to_ulong();
+			value(tmp);
+		}
+
+		/**
+		 * \brief Writes the ID of an entity.
+		 * \param The ID.
+		 */
+		void entity(tdt::uint&);
+
+		/**
+		 * \brief Writes a list of entity IDs.
+		 * \param The list.
+		 */
+		template<typename CONT>
+		void entities(CONT& ids)
+		{
+			tdt::uint count = ids.size();
+			value(count);
+			for(auto& id : ids)
+				entity(id);
+		}
+
+		/**
+		 * \brief Writes raw bytes (without their size).
+		 * \param Pointer to the data.
+		 * \param Number of bytes.
+		 */
+		void bytes(const void*, tdt::uint);
+
+		/**
+		 * \brief Writes a fixed size record.
+		 * \param The record.
+		 */
+		template<typename RECORD>
+		void record(const RECORD& rec)
+		{
+			static_assert(std::is_trivially_copyable<RECORD>::value, "Records have to be trivially copyable.");
+			bytes(&rec, sizeof(RECORD));
+		}
+
+		/**
+		 * \brief Pads the data with zeros to a given alignment.
+		 * \param The alignment.
+		 */
+		void align(tdt::uint);
+
+		/**
+		 * \brief Writes the table of all strings written so far.
+		 */
+		void write_strings();
+
+		/**
+		 * \brief Overwrites an unsigned integer that was already written,
+		 *        used for sizes that are not known beforehand.
+		 * \param Offset of the value.
+		 * \param The new value.
+		 */
+		void patch(tdt::uint, tdt::uint);
+
+		/**
+		 * \brief Returns the number of bytes written.
+		 */
+		tdt::uint size() const;
+
+		/**
+		 * \brief Returns the written data.
+		 */
+		const std::string& get_data() const;
+
+	private:
+		/**
+		 * The written data.
+		 */
+		std::string data_;
+
+		/**
+		 * Interned strings, string -> index in the string table and
+		 * the strings in the order of their indices.
+		 */
+		std::map<std::string, tdt::uint> string_ids_;
+		std::vector<const std::string*> strings_;
+};
+
+/**
+ * Archive that reads values packed by a SaveWriter and translates saved
+ * entity IDs to the IDs of the newly created entities.
+ */
+class SaveReader
+{
+	public:
+		/**
+		 * \brief Constructor.
+		 * \param The data to read (has to outlive the reader).
+		 * \param Size of the data in bytes.
+		 */
+		SaveReader(const char*, tdt::uint);
+
+		/**
+		 * \brief Reads a single value, throws std::runtime_error if the data ended.
+		 * \param Reference to the value.
+		 */
+		void value(bool&);
+		void value(tdt::uint&);
+		void value(tdt::real&);
+		void value(std::string&);
+		void value(Symbol&);
+		void value(Ogre::Vector3&);
+		void value(Ogre::Degree&);
+
+		template<typename ENUM>
+		typename std::enable_if<std::is_enum<ENUM>::value>::type value(ENUM& val)
+		{
+			tdt::uint tmp{};
+			value(tmp);
+			val = (ENUM)tmp;
+		}
+
+		template<std::size_t N>
+		void value(std::bitset<N>& val)
+		{
+			tdt::uint tmp{};
+			value(tmp);
+			val = std::bitset<N>{(unsigned long)tmp};
+		}
+
+		/**
+		 * \brief Reads the ID of an entity and translates it to the new ID
+		 *        (Component::NO_ENTITY if the entity was not saved).
+		 * \param Reference to the ID.
+		 */
+		void entity(tdt::uint&);
+
+		/**
+		 * \brief Reads a list of entity IDs, entities that were not saved are left out.
+		 * \param Reference to the list.
+		 */
+		template<typename CONT>
+		void entities(CONT& ids)
+		{
+			tdt::uint count{}, id{};
+			value(count);
+			ids.clear();
+			for(tdt::uint i = 0; i < count; ++i)
+			{
+				entity(id);
+				if(id != Component::NO_ENTITY)
+					ids.push_back(id);
+			}
+		}
+
+		/**
+		 * \brief Reads raw bytes.
+		 * \param Pointer to the destination.
+		 * \param Number of bytes.
+		 */
+		void bytes(void*, tdt::uint);
+
+		/**
+		 * \brief Returns a pointer to a given number of fixed size records, which
+		 *        are used in place (the reader's data has to be aligned).
+		 * \param Number of records.
+		 */
+		template<typename RECORD>
+		const RECORD* records(tdt::uint count)
+		{
+			require_(count * sizeof(RECORD));
+			auto res = reinterpret_cast<const RECORD*>(data_ + position_);
+			position_ += count * sizeof(RECORD);
+			return res;
+		}
+
+		/**
+		 * \brief Skips the padding written by SaveWriter::align.
+		 * \param The alignment.
+		 */
+		void align(tdt::uint);
+
+		/**
+		 * \brief Reads the string table at a given offset (without changing the
+		 *        current position), strings are read inline if there is no table.
+		 * \param Offset of the table.
+		 */
+		void read_strings(tdt::uint);
+
+		/**
+		 * \brief Skips a given number of bytes.
+		 * \param Number of bytes.
+		 */
+		void skip(tdt::uint);
+
+		/**
+		 * \brief Returns the number of bytes read.
+		 */
+		tdt::uint position() const;
+
+		/**
+		 * \brief Registers the new ID of a saved entity.
+		 * \param Saved ID.
+		 * \param New ID.
+		 */
+		void map_entity(tdt::uint, tdt::uint);
+
+		/**
+		 * \brief Returns the new ID of a saved entity (Component::NO_ENTITY
+		 *        if the entity was not saved).
+		 * \param Saved ID.
+		 */
+		tdt::uint translate(tdt::uint) const;
+
+		/**
+		 * \brief If true, saved entity IDs are read as they are instead of being translated,
+		 *        used when save files are merged without loading them.
+		 * \param True to keep the IDs, false otherwise.
+		 */
+		void keep_ids(bool);
+
+	private:
+		/**
+		 * Throws std::runtime_error if less than a given number of bytes remain.
+		 * \param Number of bytes.
+		 */
+		void require_(tdt::uint) const;
+
+		/**
+		 * The data being read and it's size.
+		 */
+		const char* data_;
+		tdt::uint size_;
+
+		/**
+		 * Offset of the next value.
+		 */
+		tdt::uint position_;
+
+		/**
+		 * Saved ID -> new ID.
+		 */
+		std::map<tdt::uint, tdt::uint> ids_;
+		bool keep_ids_;
+
+		/**
+		 * The string table.
+		 */
+		std::vector<std::string> strings_;
+		bool interned_;
+};
+
+/**
+ * Functions describing the saved fields of the components, used with both archives.
+ * Runtime data (Ogre objects, current attack targets, paths and task queues) is not saved,
+ * it is recreated by GameSerializer after the components are loaded.
+ */
+namespace SaveFormat
+{
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, PhysicsComponent& comp, tdt::uint)
+	{
+		ar.value(comp.solid);
+		ar.value(comp.position);
+		ar.value(comp.half_height);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, HealthComponent& comp, tdt::uint)
+	{
+		ar.value(comp.curr_hp);
+		ar.value(comp.max_hp);
+		ar.value(comp.regen);
+		ar.value(comp.defense);
+		ar.value(comp.alive);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, AIComponent& comp, tdt::uint)
+	{
+		ar.value(comp.blueprint);
+		ar.value(comp.state);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, GraphicsComponent& comp, tdt::uint)
+	{
+		ar.value(comp.mesh);
+		ar.value(comp.material);
+		ar.value(comp.visible);
+		ar.value(comp.manual_scaling);
+		ar.value(comp.scale);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, MovementComponent& comp, tdt::uint)
+	{
+		ar.value(comp.speed_modifier);
+		ar.value(comp.original_speed);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, CombatComponent& comp, tdt::uint)
+	{ // NOTE: Attack target will be set via a task.
+		ar.value(comp.min_dmg);
+		ar.value(comp.max_dmg);
+		ar.value(comp.cd_time);
+		ar.value(comp.cooldown);
+		ar.value(comp.range);
+		ar.value(comp.atk_type);
+		ar.value(comp.pursue);
+		ar.value(comp.projectile_blueprint);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, EventComponent& comp, tdt::uint)
+	{
+		ar.value(comp.event_type);
+		ar.entity(comp.target);
+		ar.entity(comp.handler);
+		ar.value(comp.radius);
+		ar.value(comp.active);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, InputComponent& comp, tdt::uint)
+	{
+		ar.value(comp.input_handler);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, TimeComponent& comp, tdt::uint)
+	{
+		ar.value(comp.curr_time);
+		ar.value(comp.time_limit);
+		ar.entity(comp.target);
+		ar.value(comp.event_type);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, ManaComponent& comp, tdt::uint)
+	{
+		ar.value(comp.curr_mana);
+		ar.value(comp.max_mana);
+		ar.value(comp.mana_regen);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, SpellComponent& comp, tdt::uint)
+	{
+		ar.value(comp.blueprint);
+		ar.value(comp.cd_time);
+		ar.value(comp.cooldown);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, ProductionComponent& comp, tdt::uint)
+	{
+		ar.value(comp.product_blueprint);
+		ar.value(comp.curr_produced);
+		ar.value(comp.max_produced);
+		ar.value(comp.cooldown);
+		ar.value(comp.curr_cd);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, ProductComponent& comp, tdt::uint)
+	{
+		ar.entity(comp.producer);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, PathfindingComponent& comp, tdt::uint)
+	{ // Every task that was being completed when saving will be executed again with new pathfinding.
+		ar.value(comp.blueprint);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, TaskHandlerComponent& comp, tdt::uint)
+	{ // Tasks are saved separately.
+		ar.value(comp.blueprint);
+		ar.value(comp.possible_tasks);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, StructureComponent& comp, tdt::uint)
+	{
+		ar.value(comp.radius);
+		ar.value(comp.walk_through);
+		ar.entities(comp.residences);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, HomingComponent& comp, tdt::uint)
+	{
+		ar.entity(comp.source);
+		ar.entity(comp.target);
+		ar.value(comp.dmg);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, EventHandlerComponent& comp, tdt::uint)
+	{
+		ar.value(comp.handler);
+		ar.value(comp.possible_events);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, DestructorComponent& comp, tdt::uint)
+	{
+		ar.value(comp.blueprint);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, GoldComponent& comp, tdt::uint)
+	{
+		ar.value(comp.max_amount);
+		ar.value(comp.curr_amount);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, FactionComponent& comp, tdt::uint)
+	{
+		ar.value(comp.faction);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, PriceComponent& comp, tdt::uint)
+	{
+		ar.value(comp.price);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, AlignComponent& comp, tdt::uint)
+	{
+		for(auto& state : comp.states)
+		{
+			ar.value(state.scale);
+			ar.value(state.position_offset);
+			ar.value(state.mesh);
+			ar.value(state.material);
+		}
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE&, MineComponent&, tdt::uint)
+	{ /* DUMMY BODY */ }
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, ManaCrystalComponent& comp, tdt::uint)
+	{
+		ar.value(comp.cap_increase);
+		ar.value(comp.regen_increase);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, OnHitComponent& comp, tdt::uint)
+	{
+		ar.value(comp.blueprint);
+		ar.value(comp.curr_time);
+		ar.value(comp.cooldown);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, ConstructorComponent& comp, tdt::uint)
+	{
+		ar.value(comp.blueprint);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, TriggerComponent& comp, tdt::uint)
+	{
+		ar.value(comp.blueprint);
+		ar.entity(comp.linked_entity);
+		ar.value(comp.curr_time);
+		ar.value(comp.cooldown);
+		ar.value(comp.radius);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, UpgradeComponent& comp, tdt::uint)
+	{
+		ar.value(comp.blueprint);
+		ar.value(comp.experience);
+		ar.value(comp.exp_needed);
+		ar.value(comp.level);
+		ar.value(comp.level_cap);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, NotificationComponent& comp, tdt::uint)
+	{
+		ar.value(comp.curr_time);
+		ar.value(comp.cooldown);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, ExplosionComponent& comp, tdt::uint)
+	{
+		ar.value(comp.delta);
+		ar.value(comp.max_radius);
+		ar.value(comp.curr_radius);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, LimitedLifeSpanComponent& comp, tdt::uint)
+	{
+		ar.value(comp.curr_time);
+		ar.value(comp.max_time);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, NameComponent& comp, tdt::uint)
+	{
+		ar.value(comp.name);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, ExperienceValueComponent& comp, tdt::uint)
+	{
+		ar.value(comp.value);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE&, LightComponent&, tdt::uint)
+	{ /* DUMMY BODY (visibility is saved with the runtime data). */ }
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, CommandComponent& comp, tdt::uint)
+	{
+		ar.value(comp.possible_commands);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, CounterComponent& comp, tdt::uint)
+	{
+		ar.value(comp.curr_value);
+		ar.value(comp.max_value);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE&, PortalComponent&, tdt::uint)
+	{ /* DUMMY BODY */ }
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, AnimationComponent& comp, tdt::uint)
+	{
+		ar.value(comp.possible_animations);
+		ar.value(comp.stop_current_animation);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, SelectionComponent& comp, tdt::uint)
+	{
+		ar.value(comp.blueprint);
+		ar.value(comp.material);
+		ar.value(comp.scale);
+		ar.value(comp.marker_type);
+		ar.value(comp.rotation);
+	}
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE&, DummyAlignComponent&, tdt::uint)
+	{ /* DUMMY BODY */ }
+
+	template<typename ARCHIVE>
+	void serialize(ARCHIVE& ar, ActivationComponent& comp, tdt::uint)
+	{
+		ar.value(comp.blueprint);
+		ar.value(comp.activated);
+	}
+
+	/**
+	 * Fixed size record of a component type. Only components without strings,
+	 * containers and entity references can have a record, the record has to
+	 * provide functions that convert the component to and from the record.
+	 */
+	template<typename COMP>
+	struct record
+	{
+		static constexpr bool fixed = false;
+	};
+
+	template<>
+	struct record<PhysicsComponent>
+	{
+		static constexpr bool fixed = true;
+		struct type
+		{
+			std::uint32_t entity;
+			float x, y, z, half_height;
+			std::uint32_t solid;
+		};
+
+		static type pack(tdt::uint id, const PhysicsComponent& comp)
+		{
+			return type{(std::uint32_t)id, (float)comp.position.x, (float)comp.position.y,
+						(float)comp.position.z, (float)comp.half_height, comp.solid ? 1U : 0U};
+		}
+
+		static PhysicsComponent unpack(const type& rec)
+		{
+			return PhysicsComponent{rec.solid != 0, Ogre::Vector3{rec.x, rec.y, rec.z}, rec.half_height};
+		}
+	};
+
+	template<>
+	struct record<HealthComponent>
+	{
+		static constexpr bool fixed = true;
+		struct type
+		{
+			std::uint32_t entity, curr_hp, max_hp, regen, defense, alive;
+		};
+
+		static type pack(tdt::uint id, const HealthComponent& comp)
+		{
+			return type{(std::uint32_t)id, (std::uint32_t)comp.curr_hp, (std::uint32_t)comp.max_hp,
+						(std::uint32_t)comp.regen, (std::uint32_t)comp.defense, comp.alive ? 1U : 0U};
+		}
+
+		static HealthComponent unpack(const type& rec)
+		{
+			HealthComponent comp{rec.max_hp, rec.regen, rec.defense, rec.alive != 0};
+			comp.curr_hp = rec.curr_hp;
+			return comp;
+		}
+	};
+
+	template<>
+	struct record<MovementComponent>
+	{
+		static constexpr bool fixed = true;
+		struct type
+		{
+			std::uint32_t entity;
+			float speed_modifier, original_speed;
+		};
+
+		static type pack(tdt::uint id, const MovementComponent& comp)
+		{
+			return type{(std::uint32_t)id, (float)comp.speed_modifier, (float)comp.original_speed};
+		}
+
+		static MovementComponent unpack(const type& rec)
+		{
+			MovementComponent comp{};
+			comp.speed_modifier = rec.speed_modifier;
+			comp.original_speed = rec.original_speed;
+			return comp;
+		}
+	};
+
+	template<>
+	struct record<ManaComponent>
+	{
+		static constexpr bool fixed = true;
+		struct type
+		{
+			std::uint32_t entity, curr_mana, max_mana, mana_regen;
+		};
+
+		static type pack(tdt::uint id, const ManaComponent& comp)
+		{
+			return type{(std::uint32_t)id, (std::uint32_t)comp.curr_mana,
+						(std::uint32_t)comp.max_mana, (std::uint32_t)comp.mana_regen};
+		}
+
+		static ManaComponent unpack(const type& rec)
+		{
+			ManaComponent comp{};
+			comp.curr_mana = rec.curr_mana;
+			comp.max_mana = rec.max_mana;
+			comp.mana_regen = rec.mana_regen;
+			return comp;
+		}
+	};
+
+	template<>
+	struct record<GoldComponent>
+	{
+		static constexpr bool fixed = true;
+		struct type
+		{
+			std::uint32_t entity, max_amount, curr_amount;
+		};
+
+		static type pack(tdt::uint id, const GoldComponent& comp)
+		{
+			return type{(std::uint32_t)id, (std::uint32_t)comp.max_amount, (std::uint32_t)comp.curr_amount};
+		}
+
+		static GoldComponent unpack(const type& rec)
+		{
+			GoldComponent comp{};
+			comp.max_amount = rec.max_amount;
+			comp.curr_amount = rec.curr_amount;
+			return comp;
+		}
+	};
+
+	template<>
+	struct record<FactionComponent>
+	{
+		static constexpr bool fixed = true;
+		struct type
+		{
+			std::uint32_t entity, faction;
+		};
+
+		static type pack(tdt::uint id, const FactionComponent& comp)
+		{
+			return type{(std::uint32_t)id, (std::uint32_t)comp.faction};
+		}
+
+		static FactionComponent unpack(const type& rec)
+		{
+			FactionComponent comp{};
+			comp.faction = (FACTION)rec.faction;
+			return comp;
+		}
+	};
+
+	template<>
+	struct record<PriceComponent>
+	{
+		static constexpr bool fixed = true;
+		struct type
+		{
+			std::uint32_t entity, price;
+		};
+
+		static type pack(tdt::uint id, const PriceComponent& comp)
+		{
+			return type{(std::uint32_t)id, (std::uint32_t)comp.price};
+		}
+
+		static PriceComponent unpack(const type& rec)
+		{
+			PriceComponent comp{};
+			comp.price = rec.price;
+			return comp;
+		}
+	};
+
+	template<>
+	struct record<ManaCrystalComponent>
+	{
+		static constexpr bool fixed = true;
+		struct type
+		{
+			std::uint32_t entity, cap_increase, regen_increase;
+		};
+
+		static type pack(tdt::uint id, const ManaCrystalComponent& comp)
+		{
+			return type{(std::uint32_t)id, (std::uint32_t)comp.cap_increase, (std::uint32_t)comp.regen_increase};
+		}
+
+		static ManaCrystalComponent unpack(const type& rec)
+		{
+			ManaCrystalComponent comp{};
+			comp.cap_increase = rec.cap_increase;
+			comp.regen_increase = rec.regen_increase;
+			return comp;
+		}
+	};
+}
@@ -0,0 +1,360 @@
+#include <iterator>
+#include <map>
+#include "SaveSnapshot.hpp"
+
+void SaveSnapshot::write(SaveWriter& out)
+{
+	tdt::uint version = SaveFormat::version, strings_offset{};
+	out.bytes(delta ? SaveFormat::delta_magic : SaveFormat::magic, 4);
+	out.value(version);
+	out.value(strings_offset);
+	out.value(chain);
+	if(delta)
+		out.value(sequence);
+
+	out.value(gold);
+	out.value(max_mana);
+	out.value(mana);
+	out.value(mana_regen);
+
+	// Nodes are saved only to be able to translate their IDs.
+	if(!delta)
+	{
+		out.value(width);
+		out.value(height);
+		out.entities(nodes);
+	}
+	out.entities(entities);
+	if(delta)
+		out.entities(destroyed);
+
+	// Deltas leave out columns without changes.
+	tdt::uint count{};
+	for(auto& column : columns)
+	{
+		if(column && (!delta || column->size() > 0))
+			++count;
+	}
+	out.value(count);
+	for(auto& column : columns)
+	{
+		if(column && (!delta || column->size() > 0))
+			column->write(out);
+	}
+
+	if(delta)
+	{
+		count = removed.size();
+		out.value(count);
+		for(auto& comp : removed)
+		{
+			out.entity(comp.first);
+			out.value(comp.second);
+		}
+	}
+
+	count = query_flags.size();
+	out.value(count);
+	for(auto& flags : query_flags)
+	{
+		out.entity(flags.first);
+		out.value(flags.second);
+	}
+
+	count = lights.size();
+	out.value(count);
+	for(auto& light : lights)
+	{
+		out.entity(light.first);
+		out.value(light.second);
+	}
+
+	count = portals.size();
+	out.value(count);
+	for(auto& portal : portals)
+	{
+		out.entity(portal.first);
+		out.entity(portal.second);
+	}
+
+	count = tasks.size();
+	out.value(count);
+	for(auto& task : tasks)
+	{
+		out.entity(std::get<0>(task));
+		out.entity(std::get<1>(task));
+		out.value(std::get<2>(task));
+	}
+
+	out.value(has_wave_system);
+	if(has_wave_system)
+	{
+		out.value(wave_table);
+		out.value(wave_state);
+		out.value(wave_count);
+		out.value(curr_wave);
+		out.value(countdown);
+		out.value(spawn_cooldown);
+		out.value(spawn_timer);
+		out.value(spawned);
+		out.value(wave_entities);
+		out.value(entity_total);
+
+		count = wave_blueprints.size();
+		out.value(count);
+		for(auto& blueprint : wave_blueprints)
+			out.value(blueprint);
+		out.entities(spawn_nodes);
+	}
+
+	count = spells.size();
+	out.value(count);
+	for(auto& spell : spells)
+		out.value(spell);
+
+	count = buildings.size();
+	out.value(count);
+	for(auto& building : buildings)
+		out.value(building);
+
+	count = research.size();
+	out.value(count);
+	for(auto& i : research)
+		out.value(i);
+
+	out.entity(throne_id);
+
+	// Strings are interned, so the table is complete only at the end.
+	strings_offset = out.size();
+	out.write_strings();
+	out.patch(8, strings_offset);
+}
+
+void SaveSnapshot::read(SaveReader& in)
+{
+	char magic[4]{};
+	tdt::uint version{}, strings_offset{};
+	in.bytes(magic, 4);
+	in.value(version);
+	delta = std::string(magic, 4) == std::string(SaveFormat::delta_magic, 4);
+	if((!delta && std::string(magic, 4) != std::string(SaveFormat::magic, 4))
+	   || (delta && version < 3) || version > SaveFormat::version)
+		throw std::runtime_error{"Unsupported save file format."};
+
+	if(version >= 2)
+	{
+		in.value(strings_offset);
+		in.read_strings(strings_offset);
+	}
+
+	chain = 0;
+	if(version >= 3)
+		in.value(chain);
+	if(delta)
+		in.value(sequence);
+
+	in.value(gold);
+	in.value(max_mana);
+	in.value(mana);
+	in.value(mana_regen);
+
+	if(!delta)
+	{
+		in.value(width);
+		in.value(height);
+		in.entities(nodes);
+	}
+	in.entities(entities);
+	if(delta)
+		in.entities(destroyed);
+
+	tdt::uint count{}, type{}, column_version{}, comp_count{}, column_size{}, record_size{};
+	in.value(count);
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		in.value(type);
+		in.value(column_version);
+		in.value(comp_count);
+		in.value(column_size);
+		if(version >= 2)
+			in.value(record_size);
+
+		auto start = in.position();
+		if(type < columns.size() && columns[type])
+			columns[type]->read(in, comp_count, column_version, record_size);
+		else
+			in.skip(column_size);
+
+		if(in.position() - start != column_size)
+			throw std::runtime_error{"Corrupted component column in the save file."};
+	}
+
+	tdt::uint id{}, other{};
+	if(delta)
+	{
+		in.value(count);
+		removed.resize(count);
+		for(auto& comp : removed)
+		{
+			in.entity(comp.first);
+			in.value(comp.second);
+		}
+	}
+
+	in.value(count);
+	query_flags.clear();
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		in.entity(id);
+		in.value(other);
+		query_flags.emplace_back(id, other);
+	}
+
+	bool visible{};
+	in.value(count);
+	lights.clear();
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		in.entity(id);
+		in.value(visible);
+		lights.emplace_back(id, visible);
+	}
+
+	in.value(count);
+	portals.clear();
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		in.entity(id);
+		in.entity(other);
+		portals.emplace_back(id, other);
+	}
+
+	TASK_TYPE task_type{};
+	in.value(count);
+	tasks.clear();
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		in.entity(id);
+		in.entity(other);
+		in.value(task_type);
+		tasks.emplace_back(id, other, task_type);
+	}
+
+	in.value(has_wave_system);
+	if(has_wave_system)
+	{
+		in.value(wave_table);
+		in.value(wave_state);
+		in.value(wave_count);
+		in.value(curr_wave);
+		in.value(countdown);
+		in.value(spawn_cooldown);
+		in.value(spawn_timer);
+		in.value(spawned);
+		in.value(wave_entities);
+		in.value(entity_total);
+
+		in.value(count);
+		wave_blueprints.resize(count);
+		for(auto& blueprint : wave_blueprints)
+			in.value(blueprint);
+		in.entities(spawn_nodes);
+	}
+
+	in.value(count);
+	spells.resize(count);
+	for(auto& spell : spells)
+		in.value(spell);
+
+	in.value(count);
+	buildings.resize(count);
+	for(auto& building : buildings)
+		in.value(building);
+
+	in.value(count);
+	research.resize(count);
+	for(auto& i : research)
+		in.value(i);
+
+	in.entity(throne_id);
+}
+
+void SaveSnapshot::apply(const SaveSnapshot& other)
+{
+	gold = other.gold;
+	max_mana = other.max_mana;
+	mana = other.mana;
+	mana_regen = other.mana_regen;
+
+	std::set<tdt::uint> gone{other.destroyed.begin(), other.destroyed.end()};
+	std::vector<tdt::uint> all_entities{};
+	std::set_union(entities.begin(), entities.end(), other.entities.begin(), other.entities.end(),
+				   std::back_inserter(all_entities));
+	entities.clear();
+	for(auto id : all_entities)
+	{
+		if(gone.count(id) == 0)
+			entities.push_back(id);
+	}
+
+	std::array<std::set<tdt::uint>, Component::count> removed_by_type{};
+	for(const auto& comp : other.removed)
+	{
+		if(comp.second < removed_by_type.size())
+			removed_by_type[comp.second].insert(comp.first);
+	}
+
+	for(tdt::uint i = 0; i < columns.size(); ++i)
+	{
+		if(!columns[i])
+			continue;
+
+		removed_by_type[i].insert(gone.begin(), gone.end());
+		columns[i]->erase(removed_by_type[i]);
+		if(other.columns[i] && other.columns[i]->size() > 0)
+			columns[i]->merge(*other.columns[i]);
+	}
+
+	// Runtime data is saved only for changed entities.
+	std::map<tdt::uint, tdt::uint> all_flags{query_flags.begin(), query_flags.end()};
+	for(const auto& flags : other.query_flags)
+		all_flags[flags.first] = flags.second;
+	query_flags.clear();
+	for(const auto& flags : all_flags)
+	{
+		if(gone.count(flags.first) == 0)
+			query_flags.emplace_back(flags);
+	}
+
+	std::map<tdt::uint, bool> all_lights{lights.begin(), lights.end()};
+	for(const auto& light : other.lights)
+		all_lights[light.first] = light.second;
+	lights.clear();
+	for(const auto& light : all_lights)
+	{
+		if(gone.count(light.first) == 0)
+			lights.emplace_back(light);
+	}
+
+	portals = other.portals;
+	tasks = other.tasks;
+
+	has_wave_system = other.has_wave_system;
+	wave_table = other.wave_table;
+	wave_state = other.wave_state;
+	wave_count = other.wave_count;
+	curr_wave = other.curr_wave;
+	countdown = other.countdown;
+	spawn_cooldown = other.spawn_cooldown;
+	spawn_timer = other.spawn_timer;
+	spawned = other.spawned;
+	wave_entities = other.wave_entities;
+	entity_total = other.entity_total;
+	wave_blueprints = other.wave_blueprints;
+	spawn_nodes = other.spawn_nodes;
+
+	spells = other.spells;
+	buildings = other.buildings;
+	research = other.research;
+	throne_id = other.throne_id;
+}
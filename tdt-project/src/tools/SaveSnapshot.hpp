@@ -0,0 +1,327 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <Components.hpp>
+#include <Enums.hpp>
+#include <Typedefs.hpp>
+#include "SaveArchive.hpp"
+
+/**
+ * Frame consistent copy of everything a binary save contains. It is taken by the GameSerializer
+ * on the main thread (components are copied into packed arrays, which is much cheaper than
+ * serializing them) and can be written afterwards without any access to the game, which
+ * allows autosaves to be serialized and compressed on a background thread.
+ * A snapshot can also be a delta of an incremental save (see SaveArchive.hpp), snapshots read
+ * from a base and it's deltas are merged into a single snapshot that is loaded as usual.
+ */
+struct SaveSnapshot
+{
+	/**
+	 * Copy of all saved components of a single type.
+	 */
+	class ColumnBase
+	{
+		public:
+			virtual ~ColumnBase() {}
+
+			/**
+			 * \brief Writes the column (see SaveArchive.hpp for the layout).
+			 * \param Archive to write to.
+			 */
+			virtual void write(SaveWriter&) = 0;
+
+			/**
+			 * \brief Reads components of a column whose header was already read and appends
+			 *        them to the column.
+			 * \param Archive to read from.
+			 * \param Number of components.
+			 * \param Schema version of the components.
+			 * \param Size of the records (0 if the components are not stored in records).
+			 */
+			virtual void read(SaveReader&, tdt::uint, tdt::uint, tdt::uint) = 0;
+
+			/**
+			 * \brief Replaces components by those of the same entities in another column of the
+			 *        same type and adds the rest (both columns have to be sorted by entity IDs).
+			 * \param The other column.
+			 */
+			virtual void merge(const ColumnBase&) = 0;
+
+			/**
+			 * \brief Removes components of given entities.
+			 * \param IDs of the entities.
+			 */
+			virtual void erase(const std::set<tdt::uint>&) = 0;
+
+			/**
+			 * \brief Returns the number of components in the column.
+			 */
+			virtual tdt::uint size() const = 0;
+	};
+
+	template<typename COMP>
+	class Column : public ColumnBase
+	{
+		public:
+			void write(SaveWriter&) override;
+			void read(SaveReader&, tdt::uint, tdt::uint, tdt::uint) override;
+			void merge(const ColumnBase&) override;
+			void erase(const std::set<tdt::uint>&) override;
+			tdt::uint size() const override;
+
+			/**
+			 * Copied components and IDs of their entities in the order of the
+			 * component container.
+			 */
+			std::vector<std::pair<tdt::uint, COMP>> components;
+
+		private:
+			/**
+			 * \brief Writes the components as an array of fixed size records (the argument
+			 *        tells if the component type has a record), returns false if it has none.
+			 * \param Archive to write to.
+			 */
+			bool write_records_(SaveWriter&, std::true_type);
+			bool write_records_(SaveWriter&, std::false_type);
+
+			/**
+			 * \brief Reads components stored as an array of fixed size records (the last
+			 *        argument tells if the component type has a record).
+			 * \param Archive to read from.
+			 * \param Number of components.
+			 * \param Size of the records.
+			 */
+			void read_records_(SaveReader&, tdt::uint, tdt::uint, std::true_type);
+			void read_records_(SaveReader&, tdt::uint, tdt::uint, std::false_type);
+	};
+
+	/**
+	 * \brief Writes the whole snapshot into an archive.
+	 * \param Archive to write to.
+	 */
+	void write(SaveWriter&);
+
+	/**
+	 * \brief Reads a snapshot (of any supported version) or a delta, throws std::runtime_error
+	 *        if the data is corrupted.
+	 *        Columns of all component types that should be read have to be created (empty)
+	 *        beforehand, columns of other types are skipped.
+	 * \param Archive to read from (should keep the saved entity IDs).
+	 */
+	void read(SaveReader&);
+
+	/**
+	 * \brief Merges a delta that follows this snapshot into it.
+	 * \param The delta.
+	 */
+	void apply(const SaveSnapshot&);
+
+	/**
+	 * If true, the snapshot is a delta of an incremental save.
+	 */
+	bool delta;
+
+	/**
+	 * ID of the incremental save chain (0 if none) and the sequence number of a delta in it.
+	 */
+	tdt::uint chain, sequence;
+
+	/**
+	 * Player stats.
+	 */
+	tdt::uint gold, max_mana, mana, mana_regen;
+
+	/**
+	 * Grid dimensions and the IDs of it's nodes in grid order.
+	 */
+	tdt::uint width, height;
+	std::vector<tdt::uint> nodes;
+
+	/**
+	 * IDs of all saved entities (created entities in a delta) and their components
+	 * by type (nullptr for types that are not saved).
+	 */
+	std::vector<tdt::uint> entities;
+	std::array<std::unique_ptr<ColumnBase>, Component::count> columns;
+
+	/**
+	 * Entities destroyed and components (entity ID and type) removed since
+	 * the previous file of the chain (deltas only).
+	 */
+	std::vector<tdt::uint> destroyed;
+	std::vector<std::pair<tdt::uint, tdt::uint>> removed;
+
+	/**
+	 * Runtime data: query flags of graphics components, light visibility and portal links.
+	 */
+	std::vector<std::pair<tdt::uint, tdt::uint>> query_flags;
+	std::vector<std::pair<tdt::uint, bool>> lights;
+	std::vector<std::pair<tdt::uint, tdt::uint>> portals;
+
+	/**
+	 * Handler, target and type of all tasks.
+	 */
+	std::vector<std::tuple<tdt::uint, tdt::uint, TASK_TYPE>> tasks;
+
+	/**
+	 * State of the wave system (if present).
+	 */
+	bool has_wave_system;
+	std::string wave_table;
+	WAVE_STATE wave_state;
+	tdt::uint wave_count, curr_wave, countdown, spawned, wave_entities, entity_total;
+	tdt::real spawn_cooldown, spawn_timer;
+	std::vector<std::string> wave_blueprints;
+	std::vector<tdt::uint> spawn_nodes;
+
+	/**
+	 * Unlocked spells, buildings and indices of unlocked researches.
+	 */
+	std::vector<std::string> spells, buildings;
+	std::vector<tdt::uint> research;
+
+	tdt::uint throne_id;
+};
+
+template<typename COMP>
+inline void SaveSnapshot::Column<COMP>::write(SaveWriter& out)
+{
+	tdt::uint type = COMP::type;
+	tdt::uint version = SaveFormat::schema<COMP>::version;
+	tdt::uint count = components.size(), size{}, record_size{};
+	out.value(type);
+	out.value(version);
+	out.value(count);
+	auto size_offset = out.size();
+	out.value(size);
+	out.value(record_size);
+
+	auto start = out.size();
+	if(!write_records_(out, std::integral_constant<bool, SaveFormat::record<COMP>::fixed>{}))
+	{
+		for(auto& comp : components)
+		{
+			out.entity(comp.first);
+			SaveFormat::serialize(out, comp.second, version);
+		}
+	}
+	out.patch(size_offset, out.size() - start);
+}
+
+template<typename COMP>
+inline void SaveSnapshot::Column<COMP>::read(SaveReader& in, tdt::uint count, tdt::uint version, tdt::uint record_size)
+{
+	if(version > SaveFormat::schema<COMP>::version)
+		throw std::runtime_error{"Save file contains components of a newer version."};
+
+	if(record_size > 0)
+	{
+		read_records_(in, count, record_size, std::integral_constant<bool, SaveFormat::record<COMP>::fixed>{});
+		return;
+	}
+
+	components.reserve(components.size() + count);
+	tdt::uint id{};
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		COMP comp{};
+		in.entity(id);
+		SaveFormat::serialize(in, comp, version);
+		if(id != Component::NO_ENTITY)
+			components.emplace_back(id, std::move(comp));
+	}
+}
+
+template<typename COMP>
+inline void SaveSnapshot::Column<COMP>::merge(const ColumnBase& other_column)
+{
+	const auto& other = static_cast<const Column<COMP>&>(other_column).components;
+	std::vector<std::pair<tdt::uint, COMP>> res{};
+	res.reserve(components.size() + other.size());
+
+	auto it = components.begin();
+	auto other_it = other.begin();
+	while(it != components.end() || other_it != other.end())
+	{
+		if(other_it == other.end() || (it != components.end() && it->first < other_it->first))
+			res.emplace_back(std::move(*it++));
+		else
+		{
+			if(it != components.end() && it->first == other_it->first)
+				++it;
+			res.emplace_back(*other_it++);
+		}
+	}
+	components.swap(res);
+}
+
+template<typename COMP>
+inline void SaveSnapshot::Column<COMP>::erase(const std::set<tdt::uint>& ids)
+{
+	if(ids.empty())
+		return;
+
+	components.erase(std::remove_if(components.begin(), components.end(),
+		[&ids](const std::pair<tdt::uint, COMP>& comp) -> bool {
+			return ids.count(comp.first) > 0;
+		}), components.end()
+	);
+}
+
+template<typename COMP>
+inline tdt::uint SaveSnapshot::Column<COMP>::size() const
+{
+	return components.size();
+}
+
+template<typename COMP>
+inline bool SaveSnapshot::Column<COMP>::write_records_(SaveWriter& out, std::true_type)
+{
+	typedef typename SaveFormat::record<COMP>::type record_type;
+	out.patch(out.size() - 4, sizeof(record_type));
+	out.align(SaveFormat::record_alignment);
+
+	for(auto& comp : components)
+		out.record(SaveFormat::record<COMP>::pack(comp.first, comp.second));
+	return true;
+}
+
+template<typename COMP>
+inline bool SaveSnapshot::Column<COMP>::write_records_(SaveWriter&, std::false_type)
+{
+	return false;
+}
+
+template<typename COMP>
+inline void SaveSnapshot::Column<COMP>::read_records_(SaveReader& in, tdt::uint count, tdt::uint record_size, std::true_type)
+{
+	typedef typename SaveFormat::record<COMP>::type record_type;
+	if(record_size != sizeof(record_type))
+		throw std::runtime_error{"Save file contains records of a different size."};
+
+	in.align(SaveFormat::record_alignment);
+
+	auto records = in.records<record_type>(count);
+	components.reserve(components.size() + count);
+	for(tdt::uint i = 0; i < count; ++i)
+	{
+		auto id = in.translate(records[i].entity);
+		if(id != Component::NO_ENTITY)
+			components.emplace_back(id, SaveFormat::record<COMP>::unpack(records[i]));
+	}
+}
+
+template<typename COMP>
+inline void SaveSnapshot::Column<COMP>::read_records_(SaveReader&, tdt::uint, tdt::uint, std::false_type)
+{
+	throw std::runtime_error{"Save file contains records of a component that has none."};
+}
@@ -0,0 +1,81 @@
+#include <lppscript/LppScript.hpp>
+#include "ScriptBatch.hpp"
+
+ScriptBatch::ScriptBatch(const std::string& function, bool with_args)
+	: function_{Symbol::get_function_id(function.c_str())}, with_args_{with_args}, batches_{}, results_{}
+{ /* DUMMY BODY */ }
+
+void ScriptBatch::reset()
+{
+	auto& script = lpp::Script::instance();
+	for(auto& batch : batches_)
+	{
+		batch.second.ids.clear();
+		batch.second.args.clear();
+		batch.second.batched = script.is_function(batch.first.get_function(function_));
+	}
+}
+
+bool ScriptBatch::is_batched(const Symbol& blueprint)
+{
+	return get_batch_(blueprint).batched;
+}
+
+void ScriptBatch::add(const Symbol& blueprint, tdt::uint id, tdt::uint arg)
+{
+	auto& batch = get_batch_(blueprint);
+	batch.ids.push_back(id);
+	if(with_args_)
+		batch.args.push_back(arg);
+}
+
+void ScriptBatch::call()
+{
+	auto& script = lpp::Script::instance();
+	for(auto& batch : batches_)
+	{
+		if(batch.second.ids.empty())
+			continue;
+
+		auto& fname = batch.first.get_function(function_);
+		if(with_args_)
+			script.call_batch(fname, batch.second.ids, batch.second.args);
+		else
+			script.call_batch(fname, batch.second.ids);
+		batch.second.ids.clear();
+		batch.second.args.clear();
+	}
+}
+
+void ScriptBatch::query(std::unordered_map<tdt::uint, bool>& results)
+{
+	auto& script = lpp::Script::instance();
+	for(auto& batch : batches_)
+	{
+		if(batch.second.ids.empty())
+			continue;
+
+		auto& fname = batch.first.get_function(function_);
+		if(with_args_)
+			script.query_batch(fname, results_, batch.second.ids, batch.second.args);
+		else
+			script.query_batch(fname, results_, batch.second.ids);
+
+		for(std::size_t i = 0; i < batch.second.ids.size(); ++i)
+			results[batch.second.ids[i]] = results_[i];
+		batch.second.ids.clear();
+		batch.second.args.clear();
+	}
+}
+
+ScriptBatch::Batch& ScriptBatch::get_batch_(const Symbol& blueprint)
+{
+	auto it = batches_.find(blueprint);
+	if(it == batches_.end())
+	{
+		auto batched = lpp::Script::instance().is_function(blueprint.get_function(function_));
+		it = batches_.emplace(blueprint, Batch{batched, {}, {}}).first;
+	}
+
+	return it->second;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <Typedefs.hpp>
+#include "Symbol.hpp"
+
+/**
+ * Groups entities by their blueprint and calls an optional batched function of the blueprint
+ * (e.g. "update_batch") once per blueprint with an array of the entities' IDs (and optionally
+ * an array of one more argument per entity) instead of calling the per entity function once
+ * for every entity. Blueprints that don't define the batched function are reported as not
+ * batched and the caller falls back to the per entity function.
+ * The vectors are kept between uses so that filling them does not allocate.
+ */
+class ScriptBatch
+{
+	public:
+		/**
+		 * \brief Constructor.
+		 * \param Name of the batched function in the blueprint tables.
+		 * \param If true, an array of arguments is passed after the array of IDs.
+		 */
+		ScriptBatch(const std::string&, bool = false);
+
+		/**
+		 * \brief Removes all entities from the batches and checks again which
+		 *        blueprints define the batched function (scripts can be reloaded).
+		 */
+		void reset();
+
+		/**
+		 * \brief Returns true if a given blueprint defines the batched function.
+		 * \param The blueprint.
+		 */
+		bool is_batched(const Symbol&);
+
+		/**
+		 * \brief Adds an entity to the batch of a given blueprint.
+		 * \param The blueprint.
+		 * \param ID of the entity.
+		 * \param Argument of the entity (ignored if the batch has no arguments).
+		 */
+		void add(const Symbol&, tdt::uint, tdt::uint = 0);
+
+		/**
+		 * \brief Calls the batched function of every blueprint that has entities
+		 *        in it's batch and empties the batches.
+		 */
+		void call();
+
+		/**
+		 * \brief Calls the batched function of every blueprint that has entities
+		 *        in it's batch as a query (see lpp::Script::query_batch) and empties
+		 *        the batches.
+		 * \param Map the results get stored in (ID of the entity -> result).
+		 */
+		void query(std::unordered_map<tdt::uint, bool>&);
+
+	private:
+		/**
+		 * Entities of a single blueprint.
+		 */
+		struct Batch
+		{
+			bool batched;
+			std::vector<tdt::uint> ids;
+			std::vector<tdt::uint> args;
+		};
+
+		/**
+		 * \brief Returns the batch of a given blueprint (creating it if necessary).
+		 * \param The blueprint.
+		 */
+		Batch& get_batch_(const Symbol&);
+
+		/**
+		 * ID of the name of the batched function (see Symbol::get_function_id).
+		 */
+		Symbol::Function function_;
+
+		/**
+		 * If true, the array of arguments is passed to the batched function.
+		 */
+		bool with_args_;
+
+		/**
+		 * Batches of all blueprints encountered so far.
+		 */
+		std::map<Symbol, Batch> batches_;
+
+		/**
+		 * Results of the last query of a single blueprint.
+		 */
+		std::vector<bool> results_;
+};
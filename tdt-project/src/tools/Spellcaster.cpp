@@ -4,6 +4,7 @@
 #include "Spellcaster.hpp"
 #include "EntityPlacer.hpp"
 #include "SelectionBox.hpp"
+#include "Journal.hpp"
 
 Spellcaster::Spellcaster(EntityPlacer& placer, SelectionBox& selector)
 	: placer_{placer}, selector_{selector}, script_{lpp::Script::instance()},
@@ -42,7 +43,15 @@ void Spellcaster::cast(Ogre::Vector2 mouse_position)
 		stop_casting();
 		return;
 	}
-	else if(!script_.call<bool>("game.spell.spells." + curr_spell_.spell_ + ".pay_mana"))
+
+	auto position = mouse_position;
+	if(curr_spell_.type_ == SPELL_TYPE::PLACING)
+		position = Ogre::Vector2{placer_.get_position().x, placer_.get_position().z};
+	Journal::instance().record(JOURNAL_COMMAND::CAST, curr_spell_.spell_, selected,
+							   position.x, position.y, (tdt::uint)curr_spell_.type_);
+	Journal::Scope scope{};
+
+	if(!script_.call<bool>("game.spell.spells." + curr_spell_.spell_ + ".pay_mana"))
 	{
 		GUI::instance().get_log().print("\\[ERROR\\] Not enough mana to cast that.");
 		stop_casting();
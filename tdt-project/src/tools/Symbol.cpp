@@ -0,0 +1,150 @@
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "Symbol.hpp"
+
+namespace
+{
+	/**
+	 * Storage of the interned strings. Entries are allocated in chunks that never move,
+	 * so reading a string by it's index does not need a lock.
+	 */
+	class SymbolTable
+	{
+		public:
+			static constexpr std::uint32_t chunk_size = 1024;
+			static constexpr std::uint32_t max_chunks = 4096;
+			static constexpr std::uint32_t max_functions = 32;
+
+			struct Entry
+			{
+				Entry()
+				{
+					for(auto& function : functions)
+						function.store(nullptr, std::memory_order_relaxed);
+				}
+
+				std::string str;
+				std::atomic<const std::string*> functions[max_functions]; // Function ID -> full name.
+				std::deque<std::string> full_names; // Storage of the full names (references stay valid).
+			};
+
+			static SymbolTable& instance()
+			{
+				static SymbolTable inst{};
+
+				return inst;
+			}
+
+			std::uint32_t intern(const std::string& str)
+			{
+				std::lock_guard<std::mutex> lock{mutex_};
+				auto it = ids_.find(str);
+				if(it != ids_.end())
+					return it->second;
+
+				auto id = count_.load(std::memory_order_relaxed);
+				if(id / chunk_size >= max_chunks)
+					throw std::length_error{"Too many symbols."};
+				if(!chunks_[id / chunk_size])
+					chunks_[id / chunk_size].reset(new Entry[chunk_size]);
+				get(id).str = str;
+				ids_.emplace(str, id);
+				count_.store(id + 1, std::memory_order_release);
+
+				return id;
+			}
+
+			Entry& get(std::uint32_t id)
+			{
+				return chunks_[id / chunk_size][id % chunk_size];
+			}
+
+			const std::string& get_function(std::uint32_t id, Symbol::Function function)
+			{
+				auto& slot = get(id).functions[function];
+				auto full_name = slot.load(std::memory_order_acquire);
+				if(full_name)
+					return *full_name;
+
+				// First call of this function of the symbol.
+				std::lock_guard<std::mutex> lock{mutex_};
+				auto& entry = get(id);
+				full_name = slot.load(std::memory_order_relaxed);
+				if(!full_name)
+				{
+					entry.full_names.emplace_back(entry.str + "." + function_names_[function]);
+					full_name = &entry.full_names.back();
+					slot.store(full_name, std::memory_order_release);
+				}
+
+				return *full_name;
+			}
+
+			Symbol::Function get_function_id(const char* name)
+			{
+				std::lock_guard<std::mutex> lock{mutex_};
+				for(std::uint32_t i = 0; i < function_names_.size(); ++i)
+				{
+					if(function_names_[i] == name)
+						return i;
+				}
+
+				if(function_names_.size() >= max_functions)
+					throw std::length_error{"Too many function names."};
+				function_names_.emplace_back(name);
+
+				return (Symbol::Function)(function_names_.size() - 1);
+			}
+
+			std::uint32_t get_count() const
+			{
+				return count_.load(std::memory_order_acquire);
+			}
+
+		private:
+			SymbolTable()
+				: mutex_{}, ids_{}, function_names_{}, chunks_{new std::unique_ptr<Entry[]>[max_chunks]}, count_{0}
+			{
+				intern(""); // The empty symbol.
+			}
+
+			std::mutex mutex_;
+			std::unordered_map<std::string, std::uint32_t> ids_;
+			std::vector<std::string> function_names_;
+			std::unique_ptr<std::unique_ptr<Entry[]>[]> chunks_;
+			std::atomic<std::uint32_t> count_;
+	};
+}
+
+Symbol::Symbol(const std::string& str)
+	: id_{str.empty() ? 0 : SymbolTable::instance().intern(str)}
+{ /* DUMMY BODY */ }
+
+Symbol::Symbol(const char* str)
+	: Symbol{std::string{str}}
+{ /* DUMMY BODY */ }
+
+const std::string& Symbol::str() const
+{
+	return SymbolTable::instance().get(id_).str;
+}
+
+const std::string& Symbol::get_function(Function function) const
+{
+	return SymbolTable::instance().get_function(id_, function);
+}
+
+Symbol::Function Symbol::get_function_id(const char* name)
+{
+	return SymbolTable::instance().get_function_id(name);
+}
+
+std::uint32_t Symbol::get_count()
+{
+	return SymbolTable::instance().get_count();
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Interned string used for the names of Lua tables stored in components (blueprints,
+ * handlers, entity names). Every distinct string is stored only once in a global table
+ * and the symbol is just it's 32bit index, so components are smaller, copying them does
+ * not copy strings and comparisons are integer comparisons.
+ * The table also caches the names of the functions in the symbol's table (e.g. "ogre.update")
+ * in a slot array indexed by function IDs (see Symbol::get_function_id), so that calling a blueprint's
+ * function neither builds a new string nor searches for it.
+ * Symbols convert to const std::string& implicitly, the referenced strings live as long as
+ * the program. Reading the string of a symbol and the cached names of it's functions is thread
+ * safe and lock free, creating new symbols, function IDs and the first lookup of a function
+ * name of a symbol lock the table.
+ */
+class Symbol
+{
+	public:
+		/**
+		 * Index of an interned function name.
+		 */
+		typedef std::uint32_t Function;
+
+		/**
+		 * \brief Constructor, creates the empty symbol.
+		 */
+		Symbol()
+			: id_{0}
+		{ /* DUMMY BODY */ }
+
+		/**
+		 * \brief Constructor.
+		 * \param The string to intern.
+		 */
+		Symbol(const std::string&);
+		Symbol(const char*);
+
+		/**
+		 * \brief Returns the interned string.
+		 */
+		const std::string& str() const;
+
+		/**
+		 * \brief Implicit conversion to the interned string.
+		 */
+		operator const std::string&() const
+		{
+			return str();
+		}
+
+		/**
+		 * \brief Returns the full name of a function in the table this symbol names
+		 *        (i.e. <symbol>.<name>).
+		 * \param ID of the function's name (see Symbol::get_function_id).
+		 */
+		const std::string& get_function(Function) const;
+
+		/**
+		 * \brief Returns the ID of a function name, callers should obtain it once
+		 *        (e.g. in a static variable) and reuse it. Throws std::length_error
+		 *        if there are too many function names.
+		 * \param Name of the function.
+		 */
+		static Function get_function_id(const char*);
+
+		/**
+		 * \brief Returns the index of this symbol in the table.
+		 */
+		std::uint32_t get_id() const
+		{
+			return id_;
+		}
+
+		/**
+		 * \brief Returns the number of interned strings.
+		 */
+		static std::uint32_t get_count();
+
+		friend bool operator==(const Symbol& lhs, const Symbol& rhs)
+		{
+			return lhs.id_ == rhs.id_;
+		}
+
+		friend bool operator!=(const Symbol& lhs, const Symbol& rhs)
+		{
+			return lhs.id_ != rhs.id_;
+		}
+
+		friend bool operator<(const Symbol& lhs, const Symbol& rhs)
+		{
+			return lhs.id_ < rhs.id_;
+		}
+
+	private:
+		/**
+		 * Index of the interned string.
+		 */
+		std::uint32_t id_;
+};
+
+/**
+ * Concatenation with strings (used when building Lua code and names of nested fields).
+ */
+inline std::string operator+(const std::string& lhs, const Symbol& rhs)
+{
+	return lhs + rhs.str();
+}
+
+inline std::string operator+(const Symbol& lhs, const std::string& rhs)
+{
+	return lhs.str() + rhs;
+}
+
+inline std::string operator+(const char* lhs, const Symbol& rhs)
+{
+	return lhs + rhs.str();
+}
+
+inline std::string operator+(const Symbol& lhs, const char* rhs)
+{
+	return lhs.str() + rhs;
+}
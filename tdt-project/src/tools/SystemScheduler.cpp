@@ -0,0 +1,59 @@
+#include <typeinfo>
+#include <lppscript/LppScript.hpp>
+#include "SystemScheduler.hpp"
+#include "Profiler.hpp"
+
+namespace
+{
+	/**
+	 * \brief Returns the name of a system's class without the compiler specific
+	 *        decoration of the type name.
+	 * \param The system.
+	 */
+	std::string system_name(const System& sys)
+	{
+		std::string name{typeid(sys).name()};
+		if(name.compare(0, 6, "class ") == 0) // MSVC.
+			return name.substr(6);
+
+		auto start = name.find_first_not_of("0123456789"); // Itanium mangling.
+		return start != std::string::npos ? name.substr(start) : name;
+	}
+}
+
+SystemScheduler::SystemScheduler(const std::vector<System*>& systems)
+	: nodes_{}
+{
+	for(auto sys : systems)
+		nodes_.push_back(Node{sys, system_name(*sys), {}});
+}
+
+void SystemScheduler::update(tdt::real delta)
+{
+	for(auto& node : nodes_)
+	{
+		PROFILE_ZONE(node.name.c_str());
+		lpp::ScriptProfiler::Callsite callsite{node.name.c_str()};
+		auto start = std::chrono::high_resolution_clock::now();
+		node.system->update(delta);
+		node.time = std::chrono::high_resolution_clock::now() - start;
+	}
+}
+
+std::vector<std::string> SystemScheduler::get_system_names() const
+{
+	std::vector<std::string> names{};
+	for(const auto& node : nodes_)
+		names.push_back(node.name);
+
+	return names;
+}
+
+std::vector<tdt::real> SystemScheduler::get_system_times() const
+{
+	std::vector<tdt::real> times{};
+	for(const auto& node : nodes_)
+		times.push_back(std::chrono::duration<tdt::real, std::milli>(node.time).count());
+
+	return times;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <systems/System.hpp>
+#include <Typedefs.hpp>
+
+/**
+ * Updates the game's systems on the main thread in the order they were added
+ * and measures the wall time of every system in each update (used by the benchmarks).
+ */
+class SystemScheduler
+{
+	public:
+		/**
+		 * \brief Constructor.
+		 * \param Systems in the order they should be updated in.
+		 */
+		SystemScheduler(const std::vector<System*>&);
+
+		/**
+		 * \brief Destructor.
+		 */
+		~SystemScheduler() = default;
+
+		/**
+		 * \brief Updates all systems.
+		 * \param Time since the last frame.
+		 */
+		void update(tdt::real);
+
+		/**
+		 * \brief Returns the names of the systems in the order they were added.
+		 */
+		std::vector<std::string> get_system_names() const;
+
+		/**
+		 * \brief Returns the wall time (in milliseconds) each system took in the last update,
+		 *        in the order the systems were added.
+		 */
+		std::vector<tdt::real> get_system_times() const;
+
+	private:
+		/**
+		 * A single system and the time it's last update took.
+		 */
+		struct Node
+		{
+			System* system;
+			std::string name;
+			std::chrono::high_resolution_clock::duration time;
+		};
+
+		/**
+		 * The systems in the order they are updated in.
+		 */
+		std::vector<Node> nodes_;
+};
@@ -0,0 +1,94 @@
+#include "TaskPool.hpp"
+
+TaskPool::TaskPool()
+	: slots_{}, free_{}, count_{0}
+{ /* DUMMY BODY */ }
+
+tdt::uint TaskPool::create(tdt::uint target, TASK_TYPE type)
+{
+	tdt::uint index{};
+	if(!free_.empty())
+	{
+		index = free_.back();
+		free_.pop_back();
+	}
+	else if(slots_.size() < MAX_SLOTS)
+	{
+		index = slots_.size();
+		slots_.push_back(Slot{TaskComponent{}, 0, false});
+	}
+	else
+		return Component::NO_ENTITY;
+
+	auto& slot = slots_[index];
+	slot.task = TaskComponent{target, Component::NO_ENTITY, type};
+	slot.alive = true;
+	++count_;
+
+	return (slot.generation << INDEX_BITS) | index;
+}
+
+void TaskPool::destroy(tdt::uint id)
+{
+	if(!get_slot_(id))
+		return;
+
+	tdt::uint index = id & INDEX_MASK;
+	auto& slot = slots_[index];
+	slot.alive = false;
+	slot.generation = (slot.generation + 1) & GENERATION_MASK;
+	free_.push_back(index);
+	--count_;
+}
+
+TaskComponent* TaskPool::get(tdt::uint id)
+{
+	auto slot = get_slot_(id);
+	if(slot)
+		return &slots_[id & INDEX_MASK].task;
+	else
+		return nullptr;
+}
+
+bool TaskPool::exists(tdt::uint id) const
+{
+	return get_slot_(id) != nullptr;
+}
+
+void TaskPool::clear()
+{
+	// Slots are kept allocated, only their handles get invalidated.
+	free_.clear();
+	for(tdt::uint i = slots_.size(); i > 0; --i)
+	{
+		auto& slot = slots_[i - 1];
+		if(slot.alive)
+		{
+			slot.alive = false;
+			slot.generation = (slot.generation + 1) & GENERATION_MASK;
+		}
+		free_.push_back(i - 1);
+	}
+	count_ = 0;
+}
+
+tdt::uint TaskPool::size() const
+{
+	return count_;
+}
+
+const TaskPool::Slot* TaskPool::get_slot_(tdt::uint id) const
+{
+	if(id == Component::NO_ENTITY || (id >> INDEX_BITS) > GENERATION_MASK)
+		return nullptr;
+
+	tdt::uint index = id & INDEX_MASK;
+	if(index >= slots_.size())
+		return nullptr;
+
+	auto& slot = slots_[index];
+	if(slot.alive && slot.generation == (id >> INDEX_BITS))
+		return &slot;
+	else
+		return nullptr;
+}
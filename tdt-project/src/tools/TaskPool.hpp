@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vector>
+#include <Components.hpp>
+#include <Typedefs.hpp>
+
+/**
+ * Storage for tasks, which used to be full entities with a single TaskComponent.
+ * Tasks are created and destroyed very often (every move order, every breakable
+ * wall hit by the pathfinding etc.) and need no other components, so they are
+ * kept in a slab of reusable slots and referred to by compact handles.
+ * A handle consists of the slot index and the slot's generation, so handles
+ * of destroyed tasks stay invalid even when their slot gets reused.
+ */
+class TaskPool
+{
+	public:
+		/**
+		 * \brief Constructor.
+		 */
+		TaskPool();
+
+		/**
+		 * \brief Destructor.
+		 */
+		~TaskPool() = default;
+
+		/**
+		 * \brief Creates a new task and returns its handle.
+		 * \param Target of the task.
+		 * \param Type of the task.
+		 */
+		tdt::uint create(tdt::uint, TASK_TYPE);
+
+		/**
+		 * \brief Destroys a given task, invalidating its handle.
+		 * \param Handle of the task.
+		 */
+		void destroy(tdt::uint);
+
+		/**
+		 * \brief Returns a pointer to the task with a given handle or
+		 *        nullptr if the task does not exist.
+		 * \param Handle of the task.
+		 */
+		TaskComponent* get(tdt::uint);
+
+		/**
+		 * \brief Returns true if a task with a given handle exists,
+		 *        false otherwise.
+		 * \param Handle of the task.
+		 */
+		bool exists(tdt::uint) const;
+
+		/**
+		 * \brief Destroys all tasks, used before loading a new game.
+		 */
+		void clear();
+
+		/**
+		 * \brief Returns the number of living tasks.
+		 */
+		tdt::uint size() const;
+
+	private:
+		/**
+		 * A single slot of the pool.
+		 */
+		struct Slot
+		{
+			TaskComponent task;
+			tdt::uint generation;
+			bool alive;
+		};
+
+		/**
+		 * \brief Returns the slot a given handle points to or nullptr if
+		 *        the handle is not valid.
+		 * \param Handle of the task.
+		 */
+		const Slot* get_slot_(tdt::uint) const;
+
+		/**
+		 * Handles are kept in 32 bits so that they behave the same on both
+		 * 32 and 64 bit builds (and fit into Lua integers on both).
+		 * The last index is never used, so that no handle is equal to Component::NO_ENTITY.
+		 */
+		static constexpr tdt::uint INDEX_BITS{20};
+		static constexpr tdt::uint INDEX_MASK{(1U << INDEX_BITS) - 1};
+		static constexpr tdt::uint GENERATION_MASK{(1U << (32 - INDEX_BITS)) - 1};
+		static constexpr tdt::uint MAX_SLOTS{INDEX_MASK};
+
+		/**
+		 * Task slots and indices of the slots that are free.
+		 */
+		std::vector<Slot> slots_;
+		std::vector<tdt::uint> free_;
+
+		/**
+		 * Number of living tasks.
+		 */
+		tdt::uint count_;
+};
@@ -90,15 +90,39 @@ int util::get_enum_direction(EntitySystem& ents, tdt::uint id, tdt::uint target)
 		return DIRECTION::NONE;
 }
 
+/**
+ * Generator used by util::get_random, seeded explicitly in deterministic mode.
+ */
+static std::mt19937 random_generator{std::random_device{}()};
+
 tdt::uint util::get_random(tdt::uint min, tdt::uint max)
 {
 	static std::uniform_int_distribution<tdt::uint> dist{0, std::numeric_limits<tdt::uint>::max()};
-	static std::mt19937 mt{std::random_device{}()};
 
-	auto res = dist(mt) % max;
+	auto res = dist(random_generator) % max;
 	return (res >= min) ? res : res + min;
 }
 
+void util::set_random_seed(tdt::uint seed)
+{
+	random_generator.seed(seed);
+}
+
+/**
+ * Determines if the game runs without rendering, set once at startup.
+ */
+static bool headless{false};
+
+void util::set_headless(bool val)
+{
+	headless = val;
+}
+
+bool util::is_headless()
+{
+	return headless;
+}
+
 tdt::uint util::abs(int val)
 {
 	if(val < 0)
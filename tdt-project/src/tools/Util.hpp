@@ -194,6 +194,7 @@ namespace util
 	class EntityDestroyer
 	{
 		friend void DestructorHelper::destroy(EntitySystem&, tdt::uint, bool, tdt::uint);
+		friend void DestructorHelper::destroy(EntitySystem&, tdt::uint, ScriptBatch&, tdt::uint);
 
 		/**
 		 * \brief Destroy a given entity.
@@ -220,6 +221,27 @@ namespace util
 	 */
 	tdt::uint get_random(tdt::uint, tdt::uint);
 
+	/**
+	 * \brief Seeds the generator used by get_random, so that the sequence
+	 *        of random numbers can be repeated.
+	 * \param The seed.
+	 */
+	void set_random_seed(tdt::uint);
+
+	/**
+	 * \brief Sets the headless mode, in which the game runs without a window, input devices
+	 *        and rendering (Ogre entities are not created and their bounds are read
+	 *        from the mesh files).
+	 * \param True to run headless, false otherwise.
+	 * \note Has to be set before the game is created.
+	 */
+	void set_headless(bool);
+
+	/**
+	 * \brief Returns true if the game runs in the headless mode, false otherwise.
+	 */
+	bool is_headless();
+
 	/**
 	 * \brief Returns the absolute value of a given integer.
 	 * \param The number we want absolute value of.